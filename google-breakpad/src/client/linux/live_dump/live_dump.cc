@@ -0,0 +1,148 @@
+// Copyright (c) 2011, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// live_dump.cc: Command line tool that writes a minidump of a running
+// process, stopping it only while its threads and memory are copied.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <vector>
+
+#include "client/linux/minidump_writer/process_snapshot.h"
+#include "client/minidump_file_writer.h"
+#include "common/minidump_container.h"
+
+using google_breakpad::MinidumpFileWriter;
+using google_breakpad::ProcessSnapshot;
+using google_breakpad::kDefaultMinidumpContainerBlockSize;
+using std::vector;
+
+// The minidump is staged in a buffer of this size, and written out in
+// pieces no smaller.
+static const size_t kWriteBufferSize = 1024 * 1024;
+
+//=============================================================================
+static void Usage(int argc, const char *argv[]) {
+  fprintf(stderr, "Write a minidump of a running process.\n");
+  fprintf(stderr, "Usage: %s [-m ADDRESS:SIZE]... [-s SIZE] [-v] [-z] "
+          "<pid> <minidump file>\n", argv[0]);
+  fprintf(stderr, "\t-m: Also include the SIZE bytes of memory at ADDRESS,\n");
+  fprintf(stderr, "\t    both in hexadecimal.  May be repeated\n");
+  fprintf(stderr, "\t-s: Bytes of each thread's stack to include\n");
+  fprintf(stderr, "\t    [default: %lu]\n",
+          static_cast<unsigned long>(ProcessSnapshot::kDefaultMaxStackSize));
+  fprintf(stderr, "\t-v: Report how long the process was stopped\n");
+  fprintf(stderr, "\t-z: Write a block-compressed minidump container\n");
+  fprintf(stderr, "\t-h: Usage\n");
+  fprintf(stderr, "\t-?: Usage\n");
+}
+
+//=============================================================================
+int main(int argc, const char *argv[]) {
+  extern int optind;
+  int ch;
+  bool verbose = false;
+  bool compress = false;
+  size_t max_stack_size = ProcessSnapshot::kDefaultMaxStackSize;
+  vector<const char *> regions;
+
+  while ((ch = getopt(argc, (char * const *)argv, "m:s:vzh?")) != -1) {
+    switch (ch) {
+      case 'm':
+        regions.push_back(optarg);
+        break;
+      case 's':
+        max_stack_size = strtoul(optarg, NULL, 0);
+        break;
+      case 'v':
+        verbose = true;
+        break;
+      case 'z':
+        compress = true;
+        break;
+      case '?':
+      case 'h':
+        Usage(argc, argv);
+        exit(0);
+        break;
+    }
+  }
+
+  if ((argc - optind) != 2) {
+    fprintf(stderr, "Must specify a process id and a minidump file\n");
+    Usage(argc, argv);
+    exit(1);
+  }
+
+  char *end;
+  pid_t pid = strtol(argv[optind], &end, 10);
+  const char *minidump_path = argv[optind + 1];
+  if (*end != '\0' || pid <= 0) {
+    fprintf(stderr, "%s: Invalid process id: %s\n", argv[0], argv[optind]);
+    exit(1);
+  }
+
+  ProcessSnapshot snapshot(pid);
+  snapshot.set_max_stack_size(max_stack_size);
+  for (size_t i = 0; i < regions.size(); i++) {
+    unsigned long long address, size;
+    if (sscanf(regions[i], "%llx:%llx", &address, &size) != 2) {
+      fprintf(stderr, "%s: Invalid memory region: %s\n", argv[0], regions[i]);
+      exit(1);
+    }
+    snapshot.AddMemoryRegion(address, size);
+  }
+
+  if (!snapshot.Capture()) {
+    fprintf(stderr, "%s: Unable to capture process %d\n", argv[0], pid);
+    return 1;
+  }
+  if (verbose) {
+    fprintf(stderr, "Stopped %lu threads for %llu microseconds\n",
+            static_cast<unsigned long>(snapshot.threads().size()),
+            static_cast<unsigned long long>(
+                snapshot.stopped_microseconds()));
+  }
+
+  MinidumpFileWriter writer;
+  if (!writer.Open(minidump_path)) {
+    fprintf(stderr, "%s: Unable to create %s\n", argv[0], minidump_path);
+    return 1;
+  }
+  writer.EnableWriteBuffer(kWriteBufferSize);
+  if (compress)
+    writer.EnableCompression(kDefaultMinidumpContainerBlockSize);
+  if (!snapshot.WriteMinidump(&writer) || !writer.Close()) {
+    fprintf(stderr, "%s: Unable to write %s\n", argv[0], minidump_path);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,662 @@
+// Copyright (c) 2011, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// process_snapshot.cc: Capture a minidump of a running Linux process from
+// outside it.
+//
+// See process_snapshot.h for documentation.
+
+#include "client/linux/minidump_writer/process_snapshot.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ptrace.h>
+#include <sys/syscall.h>
+#include <sys/time.h>
+#include <sys/uio.h>
+#include <sys/utsname.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "client/minidump_file_writer-inl.h"
+#include "common/linux/eintr_wrapper.h"
+#include "common/linux/file_id.h"
+
+namespace google_breakpad {
+
+namespace {
+
+// The largest number of ranges to pass to one process_vm_readv call.
+// This is UIO_MAXIOV, which not every C library defines.
+const size_t kMaxReadsPerCall = 1024;
+
+// Return the current time, in microseconds.
+u_int64_t NowMicroseconds() {
+  struct timeval now;
+  gettimeofday(&now, NULL);
+  return static_cast<u_int64_t>(now.tv_sec) * 1000000 + now.tv_usec;
+}
+
+// Read |remote_count| ranges described by |remote| from process |pid| into
+// the |local_count| buffers described by |local|.  Return the number of
+// bytes read, or -1 with errno set.  Not every C library has a
+// process_vm_readv wrapper, so call the kernel directly.
+ssize_t ProcessVMReadv(pid_t pid, const struct iovec *local,
+                       unsigned long local_count,
+                       const struct iovec *remote,
+                       unsigned long remote_count) {
+#if defined(__NR_process_vm_readv)
+  return syscall(__NR_process_vm_readv, pid, local, local_count,
+                 remote, remote_count, 0UL);
+#else
+  errno = ENOSYS;
+  return -1;
+#endif
+}
+
+// Return true if |thread| is the process's main thread.
+struct IsMainThread {
+  explicit IsMainThread(pid_t pid) : pid_(pid) { }
+  bool operator()(const ProcessSnapshot::Thread &thread) const {
+    return thread.tid == pid_;
+  }
+  pid_t pid_;
+};
+
+}  // namespace
+
+const size_t ProcessSnapshot::kDefaultMaxStackSize = 32 * 1024;
+
+ProcessSnapshot::ProcessSnapshot(pid_t pid)
+    : pid_(pid),
+      max_stack_size_(kDefaultMaxStackSize),
+      stopped_microseconds_(0),
+      mem_fd_(-1) {
+}
+
+ProcessSnapshot::~ProcessSnapshot() {
+  if (mem_fd_ != -1)
+    close(mem_fd_);
+}
+
+void ProcessSnapshot::AddMemoryRegion(u_int64_t address, size_t size) {
+  requested_regions_.push_back(std::make_pair(address, size));
+}
+
+bool ProcessSnapshot::Capture() {
+  mappings_.clear();
+  threads_.clear();
+  regions_.clear();
+  memory_.clear();
+
+  u_int64_t start_time = NowMicroseconds();
+  bool result = AttachThreads() && ReadMappings();
+
+  // Fetch every thread's registers.
+  for (size_t i = 0; result && i < threads_.size(); i++) {
+    Thread *thread = &threads_[i];
+    if (ptrace(PTRACE_GETREGS, thread->tid, NULL, &thread->regs) == -1 ||
+        ptrace(PTRACE_GETFPREGS, thread->tid, NULL, &thread->fpregs) == -1)
+      result = false;
+#if defined(__i386__)
+    if (ptrace(PTRACE_GETFPXREGS, thread->tid, NULL, &thread->fpxregs) == -1)
+      memset(&thread->fpxregs, 0, sizeof(thread->fpxregs));
+#endif
+  }
+
+  if (result) {
+    // Lay out every stack and requested region in memory_, clipped to
+    // what is actually mapped, and then read them all at once.
+    std::vector<Read> reads;
+    size_t memory_size = 0;
+    size_t page_size = getpagesize();
+    for (size_t i = 0; i < threads_.size(); i++) {
+      Thread *thread = &threads_[i];
+#if defined(__x86_64__)
+      u_int64_t stack_pointer = thread->regs.rsp;
+#elif defined(__i386__)
+      u_int64_t stack_pointer = thread->regs.esp;
+#else
+#error "This CPU is not supported."
+#endif
+      // Start at the page holding the stack pointer, so that the area just
+      // below it, which leaf functions may use, is included.
+      thread->stack.address = stack_pointer & ~(page_size - 1);
+      thread->stack.offset = memory_size;
+      thread->stack.size = ReadableSize(thread->stack.address,
+                                        max_stack_size_);
+      Read read = { thread->stack.address, thread->stack.offset,
+                    thread->stack.size, &thread->stack.size };
+      reads.push_back(read);
+      memory_size += thread->stack.size;
+    }
+
+    regions_.resize(requested_regions_.size());
+    for (size_t i = 0; i < requested_regions_.size(); i++) {
+      Region *region = &regions_[i];
+      region->address = requested_regions_[i].first;
+      region->offset = memory_size;
+      region->size = ReadableSize(region->address,
+                                  requested_regions_[i].second);
+      Read read = { region->address, region->offset, region->size,
+                    &region->size };
+      reads.push_back(read);
+      memory_size += region->size;
+    }
+
+    memory_.resize(memory_size);
+    ReadMemory(reads);
+  }
+
+  DetachThreads();
+  stopped_microseconds_ = NowMicroseconds() - start_time;
+
+  return result;
+}
+
+bool ProcessSnapshot::AttachThreads() {
+  char task_path[64];
+  snprintf(task_path, sizeof(task_path), "/proc/%d/task", pid_);
+
+  // Threads can be created while the others are being stopped, so keep
+  // listing them until a pass finds no new ones.
+  bool found_new_thread = true;
+  while (found_new_thread) {
+    found_new_thread = false;
+    DIR *task_dir = opendir(task_path);
+    if (!task_dir)
+      return false;
+
+    struct dirent *entry;
+    while ((entry = readdir(task_dir)) != NULL) {
+      char *end;
+      long tid = strtol(entry->d_name, &end, 10);
+      if (*end != '\0' || tid <= 0)
+        continue;
+
+      bool known = false;
+      for (size_t i = 0; i < threads_.size() && !known; i++)
+        known = (threads_[i].tid == tid);
+      if (known)
+        continue;
+
+      // The thread may have exited since it was listed.
+      if (ptrace(PTRACE_ATTACH, tid, NULL, NULL) == -1)
+        continue;
+      if (HANDLE_EINTR(waitpid(tid, NULL, __WALL)) == -1) {
+        ptrace(PTRACE_DETACH, tid, NULL, NULL);
+        continue;
+      }
+
+      Thread thread;
+      memset(&thread, 0, sizeof(thread));
+      thread.tid = tid;
+      threads_.push_back(thread);
+      found_new_thread = true;
+    }
+    closedir(task_dir);
+  }
+
+  // Minidump readers expect the main thread to come first.
+  std::stable_partition(threads_.begin(), threads_.end(), IsMainThread(pid_));
+  return !threads_.empty();
+}
+
+void ProcessSnapshot::DetachThreads() {
+  for (size_t i = 0; i < threads_.size(); i++)
+    ptrace(PTRACE_DETACH, threads_[i].tid, NULL, NULL);
+}
+
+bool ProcessSnapshot::ReadMappings() {
+  char maps_path[64];
+  snprintf(maps_path, sizeof(maps_path), "/proc/%d/maps", pid_);
+  FILE *maps = fopen(maps_path, "r");
+  if (!maps)
+    return false;
+
+  char line[PATH_MAX + 128];
+  while (fgets(line, sizeof(line), maps)) {
+    unsigned long long start, end, offset;
+    char permissions[5];
+    int path_start = 0;
+    if (sscanf(line, "%llx-%llx %4s %llx %*s %*s %n",
+               &start, &end, permissions, &offset, &path_start) < 4)
+      continue;
+
+    Mapping mapping;
+    mapping.start = start;
+    mapping.end = end;
+    mapping.offset = offset;
+    mapping.readable = (permissions[0] == 'r');
+    mapping.executable = (permissions[2] == 'x');
+    if (path_start) {
+      mapping.path = line + path_start;
+      size_t newline = mapping.path.find('\n');
+      if (newline != std::string::npos)
+        mapping.path.erase(newline);
+    }
+    mappings_.push_back(mapping);
+  }
+
+  fclose(maps);
+  return !mappings_.empty();
+}
+
+size_t ProcessSnapshot::ReadableSize(u_int64_t address, size_t size) const {
+  // mappings_ is sorted by address, as /proc/<pid>/maps lists it.
+  u_int64_t end = address;
+  for (size_t i = 0; i < mappings_.size() && end < address + size; i++) {
+    const Mapping &mapping = mappings_[i];
+    if (mapping.end <= end)
+      continue;
+    if (mapping.start > end || !mapping.readable)
+      break;
+    end = mapping.end;
+  }
+  return static_cast<size_t>(std::min<u_int64_t>(end - address, size));
+}
+
+void ProcessSnapshot::ReadMemory(const std::vector<Read> &reads) {
+  struct iovec local[kMaxReadsPerCall];
+  struct iovec remote[kMaxReadsPerCall];
+
+  size_t next = 0;
+  while (next < reads.size() && mem_fd_ == -1) {
+    size_t count = std::min(reads.size() - next, kMaxReadsPerCall);
+    for (size_t i = 0; i < count; i++) {
+      const Read &read = reads[next + i];
+      local[i].iov_base = read.size ? &memory_[read.offset] : NULL;
+      local[i].iov_len = read.size;
+      remote[i].iov_base =
+          reinterpret_cast<void *>(static_cast<uintptr_t>(read.address));
+      remote[i].iov_len = read.size;
+    }
+
+    ssize_t bytes = ProcessVMReadv(pid_, local, count, remote, count);
+    if (bytes == -1) {
+      if (errno == ENOSYS || errno == EPERM) {
+        // Fall back on /proc/<pid>/mem for this read and the rest.
+        char mem_path[64];
+        snprintf(mem_path, sizeof(mem_path), "/proc/%d/mem", pid_);
+        mem_fd_ = open(mem_path, O_RDONLY);
+        if (mem_fd_ != -1)
+          break;
+      }
+      bytes = 0;
+    }
+
+    // The kernel reads whole ranges in order, stopping at the first one
+    // that fails.  Leave that one empty, and carry on after it.
+    size_t i = 0;
+    for (; i < count && static_cast<size_t>(bytes) >= reads[next + i].size;
+         i++)
+      bytes -= reads[next + i].size;
+    if (i < count)
+      *reads[next + i++].result_size = 0;
+    next += i;
+  }
+
+  for (; next < reads.size(); next++) {
+    if (mem_fd_ == -1)
+      *reads[next].result_size = 0;
+    else
+      *reads[next].result_size = ReadMemoryFromFile(reads[next]);
+  }
+}
+
+size_t ProcessSnapshot::ReadMemoryFromFile(const Read &read) {
+  size_t done = 0;
+  while (done < read.size) {
+    ssize_t bytes = HANDLE_EINTR(pread64(mem_fd_, &memory_[read.offset + done],
+                                         read.size - done,
+                                         read.address + done));
+    if (bytes <= 0)
+      break;
+    done += bytes;
+  }
+  return done;
+}
+
+bool ProcessSnapshot::WriteMinidump(MinidumpFileWriter *writer) const {
+  TypedMDRVA<MDRawHeader> header(writer);
+  TypedMDRVA<MDRawDirectory> dir(writer);
+  const int kStreamCount = 4;
+
+  if (!header.Allocate() || !dir.AllocateArray(kStreamCount))
+    return false;
+
+  MDRawHeader *header_ptr = header.get();
+  header_ptr->signature = MD_HEADER_SIGNATURE;
+  header_ptr->version = MD_HEADER_VERSION;
+  header_ptr->time_date_stamp = static_cast<u_int32_t>(time(NULL));
+  header_ptr->stream_count = kStreamCount;
+  header_ptr->stream_directory_rva = dir.position();
+
+  std::vector<MDMemoryDescriptor> descriptors;
+  MDRawDirectory entries[kStreamCount];
+  if (!WriteMemory(writer, &descriptors) ||
+      !WriteThreadList(writer, descriptors, &entries[0]) ||
+      !WriteMemoryList(writer, descriptors, &entries[1]) ||
+      !WriteModuleList(writer, &entries[2]) ||
+      !WriteSystemInfo(writer, &entries[3]))
+    return false;
+
+  for (int i = 0; i < kStreamCount; i++) {
+    if (!dir.CopyIndex(i, &entries[i]))
+      return false;
+  }
+  return true;
+}
+
+bool ProcessSnapshot::WriteMemory(
+    MinidumpFileWriter *writer,
+    std::vector<MDMemoryDescriptor> *descriptors) const {
+  std::vector<Region> captured;
+  for (size_t i = 0; i < threads_.size(); i++)
+    captured.push_back(threads_[i].stack);
+  captured.insert(captured.end(), regions_.begin(), regions_.end());
+
+  descriptors->resize(captured.size());
+  for (size_t i = 0; i < captured.size(); i++) {
+    const Region &region = captured[i];
+    MDMemoryDescriptor *descriptor = &(*descriptors)[i];
+    memset(descriptor, 0, sizeof(*descriptor));
+    descriptor->start_of_memory_range = region.address;
+    if (!region.size)
+      continue;
+
+    UntypedMDRVA memory(writer);
+    if (!memory.Allocate(region.size) ||
+        !memory.Copy(&memory_[region.offset], region.size))
+      return false;
+    descriptor->memory = memory.location();
+  }
+  return true;
+}
+
+bool ProcessSnapshot::WriteContext(MinidumpFileWriter *writer,
+                                   const Thread &thread,
+                                   MDLocationDescriptor *location) const {
+#if defined(__x86_64__)
+  TypedMDRVA<MDRawContextAMD64> context(writer);
+  if (!context.Allocate())
+    return false;
+  *location = context.location();
+  MDRawContextAMD64 *context_ptr = context.get();
+  const user_regs_struct &regs = thread.regs;
+
+  context_ptr->context_flags = MD_CONTEXT_AMD64_FULL |
+                               MD_CONTEXT_AMD64_SEGMENTS;
+  context_ptr->cs = regs.cs;
+  context_ptr->ds = regs.ds;
+  context_ptr->es = regs.es;
+  context_ptr->fs = regs.fs;
+  context_ptr->gs = regs.gs;
+  context_ptr->ss = regs.ss;
+  context_ptr->eflags = static_cast<u_int32_t>(regs.eflags);
+
+  context_ptr->rax = regs.rax;
+  context_ptr->rcx = regs.rcx;
+  context_ptr->rdx = regs.rdx;
+  context_ptr->rbx = regs.rbx;
+  context_ptr->rsp = regs.rsp;
+  context_ptr->rbp = regs.rbp;
+  context_ptr->rsi = regs.rsi;
+  context_ptr->rdi = regs.rdi;
+  context_ptr->r8 = regs.r8;
+  context_ptr->r9 = regs.r9;
+  context_ptr->r10 = regs.r10;
+  context_ptr->r11 = regs.r11;
+  context_ptr->r12 = regs.r12;
+  context_ptr->r13 = regs.r13;
+  context_ptr->r14 = regs.r14;
+  context_ptr->r15 = regs.r15;
+  context_ptr->rip = regs.rip;
+
+  // user_fpregs_struct is the FXSAVE layout, as is flt_save.
+  context_ptr->mx_csr = thread.fpregs.mxcsr;
+  memcpy(&context_ptr->flt_save, &thread.fpregs,
+         std::min(sizeof(context_ptr->flt_save), sizeof(thread.fpregs)));
+#elif defined(__i386__)
+  TypedMDRVA<MDRawContextX86> context(writer);
+  if (!context.Allocate())
+    return false;
+  *location = context.location();
+  MDRawContextX86 *context_ptr = context.get();
+  const user_regs_struct &regs = thread.regs;
+
+  context_ptr->context_flags = MD_CONTEXT_X86_FULL |
+                               MD_CONTEXT_X86_FLOATING_POINT |
+                               MD_CONTEXT_X86_EXTENDED_REGISTERS;
+  context_ptr->gs = regs.xgs;
+  context_ptr->fs = regs.xfs;
+  context_ptr->es = regs.xes;
+  context_ptr->ds = regs.xds;
+  context_ptr->edi = regs.edi;
+  context_ptr->esi = regs.esi;
+  context_ptr->ebx = regs.ebx;
+  context_ptr->edx = regs.edx;
+  context_ptr->ecx = regs.ecx;
+  context_ptr->eax = regs.eax;
+  context_ptr->ebp = regs.ebp;
+  context_ptr->eip = regs.eip;
+  context_ptr->cs = regs.xcs;
+  context_ptr->eflags = regs.eflags;
+  context_ptr->esp = regs.esp;
+  context_ptr->ss = regs.xss;
+
+  const user_fpregs_struct &fpregs = thread.fpregs;
+  context_ptr->float_save.control_word = fpregs.cwd;
+  context_ptr->float_save.status_word = fpregs.swd;
+  context_ptr->float_save.tag_word = fpregs.twd;
+  context_ptr->float_save.error_offset = fpregs.fip;
+  context_ptr->float_save.error_selector = fpregs.fcs;
+  context_ptr->float_save.data_offset = fpregs.foo;
+  context_ptr->float_save.data_selector = fpregs.fos;
+  memcpy(context_ptr->float_save.register_area, fpregs.st_space,
+         sizeof(context_ptr->float_save.register_area));
+  memcpy(context_ptr->extended_registers, &thread.fpxregs,
+         std::min(sizeof(context_ptr->extended_registers),
+                  sizeof(thread.fpxregs)));
+#endif
+
+  return true;
+}
+
+bool ProcessSnapshot::WriteThreadList(
+    MinidumpFileWriter *writer,
+    const std::vector<MDMemoryDescriptor> &descriptors,
+    MDRawDirectory *directory_entry) const {
+  TypedMDRVA<MDRawThreadList> list(writer);
+  if (!list.AllocateObjectAndArray(threads_.size(), sizeof(MDRawThread)))
+    return false;
+
+  directory_entry->stream_type = MD_THREAD_LIST_STREAM;
+  directory_entry->location = list.location();
+  list.get()->number_of_threads = threads_.size();
+
+  for (size_t i = 0; i < threads_.size(); i++) {
+    MDRawThread thread;
+    memset(&thread, 0, sizeof(thread));
+    thread.thread_id = threads_[i].tid;
+    thread.stack = descriptors[i];
+    if (!WriteContext(writer, threads_[i], &thread.thread_context) ||
+        !list.CopyIndexAfterObject(i, &thread, sizeof(thread)))
+      return false;
+  }
+  return true;
+}
+
+bool ProcessSnapshot::WriteMemoryList(
+    MinidumpFileWriter *writer,
+    const std::vector<MDMemoryDescriptor> &descriptors,
+    MDRawDirectory *directory_entry) const {
+  // Ranges that couldn't be read have nothing to list.
+  std::vector<MDMemoryDescriptor> listed;
+  for (size_t i = 0; i < descriptors.size(); i++) {
+    if (descriptors[i].memory.data_size)
+      listed.push_back(descriptors[i]);
+  }
+
+  TypedMDRVA<MDRawMemoryList> list(writer);
+  if (!list.AllocateObjectAndArray(listed.size(),
+                                   sizeof(MDMemoryDescriptor)))
+    return false;
+
+  directory_entry->stream_type = MD_MEMORY_LIST_STREAM;
+  directory_entry->location = list.location();
+  list.get()->number_of_memory_ranges = listed.size();
+
+  for (size_t i = 0; i < listed.size(); i++) {
+    if (!list.CopyIndexAfterObject(i, &listed[i], sizeof(listed[i])))
+      return false;
+  }
+  return true;
+}
+
+bool ProcessSnapshot::WriteModuleList(MinidumpFileWriter *writer,
+                                      MDRawDirectory *directory_entry) const {
+  // A module is a run of mappings of the same file, starting with one that
+  // maps it from the beginning, at least one of which is executable.
+  std::vector<std::pair<size_t, size_t> > modules;  // [first, last) mappings
+  for (size_t i = 0; i < mappings_.size(); ) {
+    const Mapping &first = mappings_[i];
+    size_t last = i + 1;
+    while (last < mappings_.size() && mappings_[last].path == first.path)
+      last++;
+
+    bool executable = false;
+    for (size_t j = i; j < last; j++)
+      executable = executable || mappings_[j].executable;
+    if (executable && first.offset == 0 && !first.path.empty() &&
+        first.path[0] == '/')
+      modules.push_back(std::make_pair(i, last));
+    i = last;
+  }
+
+  TypedMDRVA<MDRawModuleList> list(writer);
+  if (!list.AllocateObjectAndArray(modules.size(), MD_MODULE_SIZE))
+    return false;
+
+  directory_entry->stream_type = MD_MODULE_LIST_STREAM;
+  directory_entry->location = list.location();
+  list.get()->number_of_modules = modules.size();
+
+  for (size_t i = 0; i < modules.size(); i++) {
+    const Mapping &first = mappings_[modules[i].first];
+    const Mapping &last = mappings_[modules[i].second - 1];
+
+    MDRawModule module;
+    memset(&module, 0, sizeof(module));
+    module.base_of_image = first.start;
+    module.size_of_image = static_cast<u_int32_t>(last.end - first.start);
+
+    MDLocationDescriptor name;
+    if (!writer->WriteString(first.path.c_str(), 0, &name) ||
+        !WriteCVRecord(writer, first.path, &module))
+      return false;
+    module.module_name_rva = name.rva;
+
+    if (!list.CopyIndexAfterObject(i, &module, MD_MODULE_SIZE))
+      return false;
+  }
+  return true;
+}
+
+bool ProcessSnapshot::WriteCVRecord(MinidumpFileWriter *writer,
+                                    const std::string &path,
+                                    MDRawModule *module) const {
+  TypedMDRVA<MDCVInfoPDB70> cv(writer);
+
+  // Only record the last path component, as dump_syms does.
+  std::string name = path.substr(path.rfind('/') + 1);
+  if (!cv.AllocateObjectAndArray(name.size() + 1, sizeof(u_int8_t)) ||
+      !cv.CopyIndexAfterObject(0, name.c_str(), name.size() + 1))
+    return false;
+
+  module->cv_record = cv.location();
+  MDCVInfoPDB70 *cv_ptr = cv.get();
+  cv_ptr->cv_signature = MD_CVINFOPDB70_SIGNATURE;
+  cv_ptr->age = 0;
+
+  // The process has been let go by now, so take the identifier from the
+  // file on disk.  FileID's bytes are laid out as the GUID's in memory.
+  FileID file_id(path.c_str());
+  uint8_t identifier[kMDGUIDSize];
+  if (file_id.ElfFileIdentifier(identifier))
+    memcpy(&cv_ptr->signature, identifier, sizeof(cv_ptr->signature));
+
+  return true;
+}
+
+bool ProcessSnapshot::WriteSystemInfo(MinidumpFileWriter *writer,
+                                      MDRawDirectory *directory_entry) const {
+  TypedMDRVA<MDRawSystemInfo> info(writer);
+  if (!info.Allocate())
+    return false;
+
+  directory_entry->stream_type = MD_SYSTEM_INFO_STREAM;
+  directory_entry->location = info.location();
+
+  MDRawSystemInfo *info_ptr = info.get();
+#if defined(__x86_64__)
+  info_ptr->processor_architecture = MD_CPU_ARCHITECTURE_AMD64;
+#elif defined(__i386__)
+  info_ptr->processor_architecture = MD_CPU_ARCHITECTURE_X86;
+#endif
+  long processors = sysconf(_SC_NPROCESSORS_CONF);
+  info_ptr->number_of_processors =
+      static_cast<u_int8_t>(std::min(std::max(processors, 1L), 255L));
+  info_ptr->platform_id = MD_OS_LINUX;
+
+  // The CSD version holds the output of uname -srvm.
+  struct utsname uts;
+  if (uname(&uts) == 0) {
+    sscanf(uts.release, "%u.%u.%u", &info_ptr->major_version,
+           &info_ptr->minor_version, &info_ptr->build_number);
+    std::string version = std::string(uts.sysname) + " " + uts.release + " " +
+                          uts.version + " " + uts.machine;
+    MDLocationDescriptor location;
+    if (!writer->WriteString(version.c_str(), 0, &location))
+      return false;
+    info_ptr->csd_version_rva = location.rva;
+  }
+
+  return true;
+}
+
+}  // namespace google_breakpad
@@ -0,0 +1,189 @@
+// Copyright (c) 2011, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// process_snapshot.h: Capture a minidump of a running Linux process from
+// outside it.
+//
+// ProcessSnapshot stops every thread of the process with ptrace, reads
+// its memory mappings from /proc/<pid>/maps, fetches each thread's
+// registers, and copies the thread stacks and any other requested memory
+// with as few process_vm_readv calls as possible.  It then lets the
+// process run again.  Everything that needs only the files on disk, such
+// as module identifiers, is computed afterwards, while writing the
+// minidump.
+
+#ifndef CLIENT_LINUX_MINIDUMP_WRITER_PROCESS_SNAPSHOT_H_
+#define CLIENT_LINUX_MINIDUMP_WRITER_PROCESS_SNAPSHOT_H_
+
+#include <sys/types.h>
+#include <sys/user.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "google_breakpad/common/minidump_format.h"
+
+namespace google_breakpad {
+
+class MinidumpFileWriter;
+
+class ProcessSnapshot {
+ public:
+  // A mapping of the process's address space, as listed in
+  // /proc/<pid>/maps.
+  struct Mapping {
+    u_int64_t start, end;
+    u_int64_t offset;     // Offset of |start| within the mapped file
+    bool readable;
+    bool executable;
+    std::string path;     // Empty for anonymous mappings
+  };
+
+  // A captured range of the process's memory.  Its bytes are
+  // memory()[offset] through memory()[offset + size - 1].
+  struct Region {
+    u_int64_t address;
+    size_t offset;
+    size_t size;
+  };
+
+  // A stopped thread of the process.
+  struct Thread {
+    pid_t tid;
+    user_regs_struct regs;
+    user_fpregs_struct fpregs;
+#if defined(__i386__)
+    user_fpxregs_struct fpxregs;
+#endif
+    Region stack;
+  };
+
+  explicit ProcessSnapshot(pid_t pid);
+  ~ProcessSnapshot();
+
+  // The number of bytes of each thread's stack to capture, starting just
+  // below its stack pointer.  The default is kDefaultMaxStackSize.
+  static const size_t kDefaultMaxStackSize;
+  void set_max_stack_size(size_t size) { max_stack_size_ = size; }
+
+  // Include the |size| bytes at |address| in the process in the snapshot,
+  // in addition to the thread stacks.  Must be called before Capture().
+  // Any part of the range that cannot be read is left out.
+  void AddMemoryRegion(u_int64_t address, size_t size);
+
+  // Stop all threads of the process, capture their state, and let them run
+  // again.  Return true on success, or false if the process could not be
+  // stopped or examined.
+  bool Capture();
+
+  // Write the captured snapshot as a minidump to |writer|, whose
+  // destination has already been set.  Return true on success, or false
+  // on failure.
+  bool WriteMinidump(MinidumpFileWriter *writer) const;
+
+  pid_t pid() const { return pid_; }
+  const std::vector<Mapping> &mappings() const { return mappings_; }
+  const std::vector<Thread> &threads() const { return threads_; }
+  const std::vector<Region> &regions() const { return regions_; }
+  const std::vector<u_int8_t> &memory() const { return memory_; }
+
+  // How long Capture() kept the process stopped, in microseconds.
+  u_int64_t stopped_microseconds() const { return stopped_microseconds_; }
+
+ private:
+  // A range of memory to read from the process into memory_.
+  struct Read {
+    u_int64_t address;
+    size_t offset;
+    size_t size;
+    size_t *result_size;  // Set to the number of bytes actually read
+  };
+
+  // Stop every thread of the process, adding them to threads_.
+  bool AttachThreads();
+
+  // Let every thread in threads_ run again.
+  void DetachThreads();
+
+  // Read and parse /proc/<pid>/maps into mappings_.
+  bool ReadMappings();
+
+  // Return how many of the |size| bytes at |address| can be read: the
+  // number up to the first byte that isn't in a readable mapping.
+  size_t ReadableSize(u_int64_t address, size_t size) const;
+
+  // Perform |reads|, in as few system calls as possible.  A range that
+  // can't be read is left empty.
+  void ReadMemory(const std::vector<Read> &reads);
+
+  // Read one range with /proc/<pid>/mem, for kernels without
+  // process_vm_readv.  Return the number of bytes read.
+  size_t ReadMemoryFromFile(const Read &read);
+
+  // Helpers for WriteMinidump.  WriteMemory writes the contents of every
+  // thread stack and then every region, setting |descriptors| to where
+  // they went; the others write one stream each, and fill in its
+  // directory entry.
+  bool WriteMemory(MinidumpFileWriter *writer,
+                   std::vector<MDMemoryDescriptor> *descriptors) const;
+  bool WriteContext(MinidumpFileWriter *writer, const Thread &thread,
+                    MDLocationDescriptor *location) const;
+  bool WriteThreadList(MinidumpFileWriter *writer,
+                       const std::vector<MDMemoryDescriptor> &descriptors,
+                       MDRawDirectory *directory_entry) const;
+  bool WriteMemoryList(MinidumpFileWriter *writer,
+                       const std::vector<MDMemoryDescriptor> &descriptors,
+                       MDRawDirectory *directory_entry) const;
+  bool WriteModuleList(MinidumpFileWriter *writer,
+                       MDRawDirectory *directory_entry) const;
+  bool WriteCVRecord(MinidumpFileWriter *writer, const std::string &path,
+                     MDRawModule *module) const;
+  bool WriteSystemInfo(MinidumpFileWriter *writer,
+                       MDRawDirectory *directory_entry) const;
+
+  pid_t pid_;
+  size_t max_stack_size_;
+
+  // The ranges requested with AddMemoryRegion()
+  std::vector<std::pair<u_int64_t, size_t> > requested_regions_;
+
+  std::vector<Mapping> mappings_;
+  std::vector<Thread> threads_;
+  std::vector<Region> regions_;
+  std::vector<u_int8_t> memory_;
+  u_int64_t stopped_microseconds_;
+
+  // The file descriptor for /proc/<pid>/mem, if it had to be opened.
+  int mem_fd_;
+};
+
+}  // namespace google_breakpad
+
+#endif  // CLIENT_LINUX_MINIDUMP_WRITER_PROCESS_SNAPSHOT_H_
@@ -0,0 +1,230 @@
+// Copyright (c) 2011, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// process_snapshot_unittest.cc: Unit tests for ProcessSnapshot, which
+// capture a child process started for each test.
+
+#include <limits.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "breakpad_googletest_includes.h"
+#include "client/linux/minidump_writer/process_snapshot.h"
+#include "client/minidump_file_writer.h"
+#include "google_breakpad/processor/minidump.h"
+
+namespace {
+
+using google_breakpad::Minidump;
+using google_breakpad::MinidumpFileWriter;
+using google_breakpad::MinidumpMemoryList;
+using google_breakpad::MinidumpMemoryRegion;
+using google_breakpad::MinidumpModuleList;
+using google_breakpad::MinidumpSystemInfo;
+using google_breakpad::MinidumpThread;
+using google_breakpad::MinidumpThreadList;
+using google_breakpad::ProcessSnapshot;
+using std::istringstream;
+using std::string;
+using std::vector;
+
+const char kStackMarker[] = "ProcessSnapshot stack marker";
+const size_t kHeapSize = 3000;
+const u_int8_t kHeapByte = 0xab;
+
+// Block until a byte arrives on the pipe |arg| points to; none ever does.
+void *BlockingThread(void *arg) {
+  int fd = *static_cast<int *>(arg);
+  char byte;
+  read(fd, &byte, 1);
+  return NULL;
+}
+
+// The body of the child process.  Put a marker on the stack and a known
+// pattern on the heap, start a second thread, send the heap address to
+// |ready_fd|, and wait to be killed.
+void RunChild(int ready_fd) {
+  volatile char stack_marker[sizeof(kStackMarker)];
+  for (size_t i = 0; i < sizeof(kStackMarker); i++)
+    stack_marker[i] = kStackMarker[i];
+
+  u_int8_t *heap = static_cast<u_int8_t *>(malloc(kHeapSize));
+  memset(heap, kHeapByte, kHeapSize);
+
+  int block[2];
+  pthread_t thread;
+  if (pipe(block) != 0 ||
+      pthread_create(&thread, NULL, BlockingThread, &block[0]) != 0)
+    _exit(1);
+
+  u_int64_t heap_address = reinterpret_cast<uintptr_t>(heap);
+  write(ready_fd, &heap_address, sizeof(heap_address));
+  BlockingThread(&block[0]);
+  _exit(stack_marker[0]);
+}
+
+class ProcessSnapshotTest : public ::testing::Test {
+ public:
+  void SetUp() {
+    int ready[2];
+    ASSERT_EQ(0, pipe(ready));
+    child_ = fork();
+    if (child_ == 0) {
+      close(ready[0]);
+      RunChild(ready[1]);
+    }
+    close(ready[1]);
+    ASSERT_NE(-1, child_);
+    ASSERT_EQ(static_cast<ssize_t>(sizeof(heap_address_)),
+              read(ready[0], &heap_address_, sizeof(heap_address_)));
+    close(ready[0]);
+  }
+
+  void TearDown() {
+    if (child_ > 0) {
+      kill(child_, SIGKILL);
+      waitpid(child_, NULL, 0);
+    }
+  }
+
+  // Return true if |region| of |snapshot| contains |bytes|.
+  static bool Contains(const ProcessSnapshot &snapshot,
+                       const ProcessSnapshot::Region &region,
+                       const string &bytes) {
+    const char *start =
+        reinterpret_cast<const char *>(&snapshot.memory()[0]) + region.offset;
+    const char *end = start + region.size;
+    return std::search(start, end, bytes.begin(), bytes.end()) != end;
+  }
+
+  pid_t child_;
+  u_int64_t heap_address_;
+};
+
+TEST_F(ProcessSnapshotTest, Threads) {
+  ProcessSnapshot snapshot(child_);
+  ASSERT_TRUE(snapshot.Capture());
+
+  const vector<ProcessSnapshot::Thread> &threads = snapshot.threads();
+  ASSERT_EQ(2U, threads.size());
+  EXPECT_EQ(child_, threads[0].tid);
+  EXPECT_NE(child_, threads[1].tid);
+  for (size_t i = 0; i < threads.size(); i++) {
+    EXPECT_LT(0U, threads[i].stack.size);
+    EXPECT_GE(ProcessSnapshot::kDefaultMaxStackSize, threads[i].stack.size);
+  }
+  EXPECT_TRUE(Contains(snapshot, threads[0].stack, kStackMarker));
+  EXPECT_FALSE(Contains(snapshot, threads[1].stack, kStackMarker));
+}
+
+TEST_F(ProcessSnapshotTest, Regions) {
+  ProcessSnapshot snapshot(child_);
+  snapshot.AddMemoryRegion(heap_address_, kHeapSize);
+  // Nothing is ever mapped at address zero.
+  snapshot.AddMemoryRegion(0, 4096);
+  snapshot.set_max_stack_size(8192);
+  ASSERT_TRUE(snapshot.Capture());
+
+  const vector<ProcessSnapshot::Region> &regions = snapshot.regions();
+  ASSERT_EQ(2U, regions.size());
+  EXPECT_EQ(heap_address_, regions[0].address);
+  ASSERT_EQ(kHeapSize, regions[0].size);
+  EXPECT_TRUE(Contains(snapshot, regions[0], string(kHeapSize, kHeapByte)));
+  EXPECT_EQ(0U, regions[1].size);
+  EXPECT_GE(8192U, snapshot.threads()[0].stack.size);
+}
+
+TEST_F(ProcessSnapshotTest, Minidump) {
+  ProcessSnapshot snapshot(child_);
+  snapshot.AddMemoryRegion(heap_address_, kHeapSize);
+  ASSERT_TRUE(snapshot.Capture());
+
+  vector<char> buffer(4 * 1024 * 1024);
+  MinidumpFileWriter writer;
+  writer.SetBuffer(&buffer[0], buffer.size());
+  ASSERT_TRUE(snapshot.WriteMinidump(&writer));
+  ASSERT_TRUE(writer.Close());
+
+  istringstream minidump_stream(string(&buffer[0], writer.position()));
+  Minidump minidump(minidump_stream);
+  ASSERT_TRUE(minidump.Read());
+
+  MinidumpThreadList *thread_list = minidump.GetThreadList();
+  ASSERT_TRUE(thread_list != NULL);
+  ASSERT_EQ(2U, thread_list->thread_count());
+  MinidumpThread *thread = thread_list->GetThreadAtIndex(0);
+  u_int32_t thread_id;
+  ASSERT_TRUE(thread->GetThreadID(&thread_id));
+  EXPECT_EQ(static_cast<u_int32_t>(child_), thread_id);
+  ASSERT_TRUE(thread->GetContext() != NULL);
+  MinidumpMemoryRegion *stack = thread->GetMemory();
+  ASSERT_TRUE(stack != NULL);
+  EXPECT_EQ(snapshot.threads()[0].stack.address, stack->GetBase());
+  EXPECT_EQ(snapshot.threads()[0].stack.size, stack->GetSize());
+
+  MinidumpMemoryList *memory_list = minidump.GetMemoryList();
+  ASSERT_TRUE(memory_list != NULL);
+  ASSERT_EQ(3U, memory_list->region_count());
+  MinidumpMemoryRegion *heap =
+      memory_list->GetMemoryRegionForAddress(heap_address_);
+  ASSERT_TRUE(heap != NULL);
+  EXPECT_EQ(heap_address_, heap->GetBase());
+  EXPECT_EQ(kHeapSize, heap->GetSize());
+  EXPECT_EQ(kHeapByte, heap->GetMemory()[kHeapSize - 1]);
+
+  // The child runs this very executable.
+  char exe_path[PATH_MAX];
+  ssize_t exe_path_length = readlink("/proc/self/exe", exe_path,
+                                     sizeof(exe_path) - 1);
+  ASSERT_NE(-1, exe_path_length);
+  exe_path[exe_path_length] = '\0';
+  MinidumpModuleList *module_list = minidump.GetModuleList();
+  ASSERT_TRUE(module_list != NULL);
+  bool found_exe = false;
+  for (unsigned int i = 0; i < module_list->module_count(); i++) {
+    if (module_list->GetModuleAtIndex(i)->code_file() == exe_path)
+      found_exe = true;
+  }
+  EXPECT_TRUE(found_exe);
+
+  MinidumpSystemInfo *system_info = minidump.GetSystemInfo();
+  ASSERT_TRUE(system_info != NULL);
+  EXPECT_EQ("linux", system_info->GetOS());
+}
+
+}  // namespace
@@ -62,6 +62,9 @@ namespace google_breakpad {
 #define LC_SEGMENT_ARCH LC_SEGMENT
 #endif
 
+// Size of the buffer the minidump is staged in before being written out
+static const size_t kWriteBufferSize = 1024 * 1024;
+
 // constructor when generating from within the crashed process
 MinidumpGenerator::MinidumpGenerator()
     : writer_(),
@@ -200,8 +203,11 @@ bool MinidumpGenerator::Write(const char *path) {
 
   // If opening was successful, create the header, directory, and call each
   // writer.  The destructor for the TypedMDRVAs will cause the data to be
-  // flushed.  The destructor for the MinidumpFileWriter will close the file.
+  // flushed.  The file is closed once everything has been written.
   if (writer_.Open(path)) {
+    // Write in large pieces if we can get a buffer, or directly otherwise.
+    writer_.EnableWriteBuffer(kWriteBufferSize);
+
     TypedMDRVA<MDRawHeader> header(&writer_);
     TypedMDRVA<MDRawDirectory> dir(&writer_);
 
@@ -235,6 +241,11 @@ bool MinidumpGenerator::Write(const char *path) {
         dir.CopyIndex(i, &local_dir);
     }
   }
+
+  // Write out anything still buffered, so that the minidump is complete
+  // before any callback sees it.
+  if (result)
+    result = writer_.Close();
   return result;
 }
 
@@ -35,10 +35,14 @@
 #include <limits.h>
 #include <stdio.h>
 #include <string.h>
+#include <sys/mman.h>
 #include <unistd.h>
 
+#include <algorithm>
+
 #include "client/minidump_file_writer-inl.h"
 #include "common/linux/linux_libc_support.h"
+#include "common/minidump_container.h"
 #include "common/string_conversion.h"
 #if __linux__
 #include "third_party/lss/linux_syscall_support.h"
@@ -48,7 +52,19 @@ namespace google_breakpad {
 
 const MDRVA MinidumpFileWriter::kInvalidMDRVA = static_cast<MDRVA>(-1);
 
-MinidumpFileWriter::MinidumpFileWriter() : file_(-1), position_(0), size_(0) {
+MinidumpFileWriter::MinidumpFileWriter()
+    : file_(-1),
+      close_file_(false),
+      seekable_(true),
+      file_position_(0),
+      position_(0),
+      size_(0),
+      buffer_(NULL),
+      buffer_owned_(false),
+      buffer_capacity_(0),
+      buffer_position_(0),
+      buffer_used_(0),
+      compression_block_size_(0) {
 }
 
 MinidumpFileWriter::~MinidumpFileWriter() {
@@ -57,33 +73,126 @@ MinidumpFileWriter::~MinidumpFileWriter() {
 
 bool MinidumpFileWriter::Open(const char *path) {
   assert(file_ == -1);
+  assert(!buffer_);
 #if __linux__
-  file_ = sys_open(path, O_WRONLY | O_CREAT | O_EXCL, 0600);
+  file_ = sys_open(path, O_RDWR | O_CREAT | O_EXCL, 0600);
 #else
-  file_ = open(path, O_WRONLY | O_CREAT | O_EXCL, 0600);
+  file_ = open(path, O_RDWR | O_CREAT | O_EXCL, 0600);
 #endif
+  close_file_ = true;
+  seekable_ = true;
 
   return file_ != -1;
 }
 
+void MinidumpFileWriter::SetFile(int file) {
+  assert(file_ == -1);
+  assert(!buffer_);
+  assert(file != -1);
+  file_ = file;
+  close_file_ = false;
+#if __linux__
+  seekable_ = sys_lseek(file_, 0, SEEK_CUR) != -1;
+#else
+  seekable_ = lseek(file_, 0, SEEK_CUR) != -1;
+#endif
+  file_position_ = 0;
+}
+
+void MinidumpFileWriter::SetBuffer(void *buffer, size_t size) {
+  assert(file_ == -1);
+  assert(!buffer_);
+  assert(buffer);
+  assert(position_ == 0);
+  buffer_ = static_cast<u_int8_t *>(buffer);
+  buffer_owned_ = false;
+  buffer_capacity_ = size;
+  buffer_position_ = 0;
+  buffer_used_ = 0;
+}
+
 bool MinidumpFileWriter::Close() {
   bool result = true;
 
-  if (file_ != -1) {
-    if (-1 == ftruncate(file_, position_)) {
-       return false;
+  // Whatever fails, the buffer is still unmapped and the file still
+  // closed, so that a failed Close() leaks neither.
+  if (buffer_ && file_ != -1 && !FlushWriteBuffer())
+    result = false;
+
+  if (compression_block_size_) {
+    // A minidump that didn't reach the file whole isn't worth
+    // compressing.
+    if (!result || !Compress())
+      result = false;
+    compression_block_size_ = 0;
+  }
+
+  if (buffer_) {
+    if (buffer_owned_) {
+#if __linux__
+      sys_munmap(buffer_, buffer_capacity_);
+#else
+      munmap(buffer_, buffer_capacity_);
+#endif
     }
+    buffer_ = NULL;
+  }
+
+  if (file_ != -1) {
+    // A file that can't seek can't be truncated either, but then again it
+    // has only ever been written in order.
+    if (seekable_ && -1 == ftruncate(file_, position_))
+      result = false;
+    if (close_file_) {
 #if __linux__
-    result = (sys_close(file_) == 0);
+      if (sys_close(file_) != 0)
+        result = false;
 #else
-    result = (close(file_) == 0);
+      if (close(file_) != 0)
+        result = false;
 #endif
+    }
     file_ = -1;
   }
 
   return result;
 }
 
+bool MinidumpFileWriter::EnableWriteBuffer(size_t size) {
+  assert(file_ != -1);
+  assert(!buffer_);
+  assert(position_ == 0);
+  if (!size)
+    return false;
+
+#if __linux__
+  void *buffer = sys_mmap(NULL, size, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+#else
+  void *buffer = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANON, -1, 0);
+#endif
+  if (buffer == MAP_FAILED)
+    return false;
+
+  buffer_ = static_cast<u_int8_t *>(buffer);
+  buffer_owned_ = true;
+  buffer_capacity_ = size;
+  buffer_position_ = position_;
+  buffer_used_ = 0;
+  return true;
+}
+
+bool MinidumpFileWriter::EnableCompression(size_t block_size) {
+  assert(file_ != -1 || buffer_);
+  if (!block_size || block_size > kMaxMinidumpContainerBlockSize ||
+      (file_ != -1 && !seekable_))
+    return false;
+
+  compression_block_size_ = block_size;
+  return true;
+}
+
 bool MinidumpFileWriter::CopyStringToMDString(const wchar_t *str,
                                               unsigned int length,
                                               TypedMDRVA<MDString> *mdstring) {
@@ -208,9 +317,38 @@ bool MinidumpFileWriter::WriteMemory(const void *src, size_t size,
 
 MDRVA MinidumpFileWriter::Allocate(size_t size) {
   assert(size);
-  assert(file_ != -1);
+  assert(file_ != -1 || buffer_);
   size_t aligned_size = (size + 7) & ~7;  // 64-bit alignment
 
+  if (buffer_) {
+    // Without a file, there is nowhere to flush the buffer to, and a file
+    // that can't seek must not be written until the header is filled in.
+    if (buffer_used_ + aligned_size > buffer_capacity_ &&
+        (file_ == -1 || !seekable_ || !FlushWriteBuffer()))
+      return kInvalidMDRVA;
+
+    MDRVA current_position = position_;
+    position_ += static_cast<MDRVA>(aligned_size);
+    size_ = position_;
+
+    if (aligned_size > buffer_capacity_) {
+      // Too large to stage; Copy() writes it straight to the file, and the
+      // buffer restarts after it.
+      buffer_position_ = position_;
+    } else {
+      // Clear the new bytes, as growing the file would have done.
+      memset(buffer_ + buffer_used_, 0, aligned_size);
+      buffer_used_ += aligned_size;
+    }
+
+    return current_position;
+  }
+
+  // A file that can't seek can only be written through a write buffer
+  // holding the whole minidump; see SetFile().
+  if (!seekable_)
+    return kInvalidMDRVA;
+
   if (position_ + aligned_size > size_) {
     size_t growth = aligned_size;
     size_t minimal_growth = getpagesize();
@@ -235,19 +373,56 @@ MDRVA MinidumpFileWriter::Allocate(size_t size) {
 bool MinidumpFileWriter::Copy(MDRVA position, const void *src, ssize_t size) {
   assert(src);
   assert(size);
-  assert(file_ != -1);
+  assert(file_ != -1 || buffer_);
 
   // Ensure that the data will fit in the allocated space
   if (static_cast<size_t>(size + position) > size_)
     return false;
 
+  if (buffer_) {
+    size_t start = position;
+    size_t end = start + size;
+    size_t buffer_end = buffer_position_ + buffer_used_;
+
+    // Stage the data if it falls within the buffer.
+    if (start >= buffer_position_ && end <= buffer_end) {
+      memcpy(buffer_ + (start - buffer_position_), src, size);
+      return true;
+    }
+
+    // Don't let a later flush overwrite data that straddles the buffer.
+    if (start < buffer_end && end > buffer_position_ && !FlushWriteBuffer())
+      return false;
+  }
+
+  if (file_ == -1)
+    return false;
+
+  return WriteToFile(position, src, size);
+}
+
+bool MinidumpFileWriter::WriteToFile(MDRVA position, const void *src,
+                                     size_t size) {
+  if (!seekable_) {
+    if (position != file_position_)
+      return false;
+#if __linux__
+    if (sys_write(file_, src, size) != static_cast<ssize_t>(size))
+#else
+    if (write(file_, src, size) != static_cast<ssize_t>(size))
+#endif
+      return false;
+    file_position_ += static_cast<MDRVA>(size);
+    return true;
+  }
+
   // Seek and write the data
 #if __linux__
   if (sys_lseek(file_, position, SEEK_SET) == static_cast<off_t>(position)) {
-    if (sys_write(file_, src, size) == size) {
+    if (sys_write(file_, src, size) == static_cast<ssize_t>(size)) {
 #else
   if (lseek(file_, position, SEEK_SET) == static_cast<off_t>(position)) {
-    if (write(file_, src, size) == size) {
+    if (write(file_, src, size) == static_cast<ssize_t>(size)) {
 #endif
       return true;
     }
@@ -256,6 +431,103 @@ bool MinidumpFileWriter::Copy(MDRVA position, const void *src, ssize_t size) {
   return false;
 }
 
+bool MinidumpFileWriter::FlushWriteBuffer() {
+  if (buffer_used_ && !WriteToFile(buffer_position_, buffer_, buffer_used_))
+    return false;
+
+  buffer_position_ = position_;
+  buffer_used_ = 0;
+  return true;
+}
+
+bool MinidumpFileWriter::ReadFromFile(MDRVA position, void *dest,
+                                      size_t size) {
+#if __linux__
+  if (sys_lseek(file_, position, SEEK_SET) != static_cast<off_t>(position))
+    return false;
+#else
+  if (lseek(file_, position, SEEK_SET) != static_cast<off_t>(position))
+    return false;
+#endif
+
+  u_int8_t *bytes = static_cast<u_int8_t *>(dest);
+  while (size > 0) {
+#if __linux__
+    ssize_t count = sys_read(file_, bytes, size);
+#else
+    ssize_t count = read(file_, bytes, size);
+#endif
+    if (count <= 0)
+      return false;
+    bytes += count;
+    size -= count;
+  }
+  return true;
+}
+
+bool MinidumpFileWriter::WriteFinished(MDRVA position, const void *src,
+                                       size_t size) {
+  if (file_ != -1)
+    return WriteToFile(position, src, size);
+
+  if (position > buffer_capacity_ || size > buffer_capacity_ - position)
+    return false;
+  memcpy(buffer_ + position, src, size);
+  return true;
+}
+
+bool MinidumpFileWriter::Compress() {
+  MinidumpContainerEncoder encoder(position_, compression_block_size_);
+  compression_block_size_ = 0;
+
+  // Padding after the last write may not have reached the file yet.
+  if (file_ != -1 && ftruncate(file_, position_) != 0)
+    return false;
+
+  // The container is written over the minidump as it is read.  Each block
+  // is read before the data that replaces it is written, and no block's
+  // data is larger than the block, so only the header and at most one
+  // block's data ever need to wait for the minidump beneath them to be
+  // read.
+  std::string pending;
+  std::string block;
+  size_t write_end = 0;
+  encoder.StartContainer(&pending);
+  for (size_t i = 0; i < encoder.BlockCount(); i++) {
+    size_t offset = encoder.BlockOffset(i);
+    size_t size = encoder.BlockSize(i);
+    const char *data;
+    if (file_ == -1) {
+      data = reinterpret_cast<const char *>(buffer_) + offset;
+    } else {
+      block.resize(size);
+      if (!ReadFromFile(offset, &block[0], size))
+        return false;
+      data = block.data();
+    }
+    encoder.AddBlock(data, size, &pending);
+
+    size_t length = std::min(pending.size(), offset + size - write_end);
+    if (length && !WriteFinished(write_end, pending.data(), length))
+      return false;
+    pending.erase(0, length);
+    write_end += length;
+  }
+
+  std::string index, header;
+  encoder.Finish(&index, &header);
+  pending.append(index);
+  if (!pending.empty() &&
+      !WriteFinished(write_end, pending.data(), pending.size()))
+    return false;
+  write_end += pending.size();
+  if (!WriteFinished(0, header.data(), header.size()))
+    return false;
+
+  position_ = static_cast<MDRVA>(write_end);
+  return true;
+}
+
 bool UntypedMDRVA::Allocate(size_t size) {
   assert(size_ == 0);
   size_ = size;
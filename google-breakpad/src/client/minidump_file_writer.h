@@ -69,10 +69,57 @@ public:
   // Return true on success, or false on failure
   bool Open(const char *path);
 
-  // Close the current file
+  // Use the open file descriptor |file| as the destination of the minidump
+  // data, as an alternative to Open().  The minidump is written from the
+  // start of the file, and |file| remains the caller's: Close() does not
+  // close it, but does truncate it to the size of the minidump, discarding
+  // anything that was in the file beyond that.
+  //
+  // If |file| cannot seek, as with a pipe or a socket, the data must be
+  // written strictly in order, and since the header is only filled in at
+  // the end, nothing can be written until the minidump is complete.  Such
+  // a file therefore requires EnableWriteBuffer() with a buffer that can
+  // hold the entire minidump; without one, every allocation fails, and
+  // with one, an allocation that would overflow it fails.
+  void SetFile(int file);
+
+  // Use the |size| bytes at |buffer| as the destination of the minidump
+  // data, as an alternative to Open().  Allocations that would not fit in
+  // |buffer| fail.  Once everything has been written, the first position()
+  // bytes of |buffer| hold the minidump.  |buffer| remains the caller's.
+  void SetBuffer(void *buffer, size_t size);
+
+  // Close the current file, first writing out any buffered data.  The file
+  // is then truncated to the size of the minidump, which for a descriptor
+  // given to SetFile() means that any of the caller's data past that point
+  // is lost.  Only files opened by Open() are closed.  Even if writing
+  // fails, the write buffer is released and such a file is closed.
   // Return true on success, or false on failure
   bool Close();
 
+  // Stage allocations in a |size| byte buffer and write them to the file
+  // in large sequential writes, rather than seeking and writing for every
+  // Copy().  The buffer is mapped directly from the system rather than
+  // taken from the heap.  Must be called after Open() and before anything
+  // has been allocated.  The resulting file is identical to an unbuffered
+  // one.
+  // Return true on success, or false on failure
+  bool EnableWriteBuffer(size_t size);
+
+  // Compress the minidump into a minidump container, as described in
+  // common/minidump_container.h, with blocks of |block_size| bytes, when
+  // Close() is called.  The container replaces the minidump in place, in
+  // the file or buffer it was written to; a file given to SetFile() must
+  // therefore be open for reading as well as writing, and be able to
+  // seek.  Unlike everything else here, compression takes working memory
+  // from the heap, so it is meant for writing minidumps of other
+  // processes, not of a crashed one.  |block_size| may be no larger than
+  // kMaxMinidumpContainerBlockSize.  Must be called after Open(),
+  // SetFile() or SetBuffer().  After Close(), position() is the size of
+  // the container.
+  // Return true on success, or false on failure
+  bool EnableCompression(size_t block_size);
+
   // Copy the contents of |str| to a MDString and write it to the file.
   // |str| is expected to be either UTF-16 or UTF-32 depending on the size
   // of wchar_t.
@@ -106,15 +153,67 @@ public:
   // unable to allocate the bytes.
   MDRVA Allocate(size_t size);
 
+  // Writes |size| bytes from |src| to the file at |position|.  If the file
+  // cannot seek, |position| must be where the previous write ended.
+  // Return true on success, or false on failure
+  bool WriteToFile(MDRVA position, const void *src, size_t size);
+
+  // Writes out the contents of the write buffer, and restarts it at the
+  // current position.
+  // Return true on success, or false on failure
+  bool FlushWriteBuffer();
+
+  // Reads |size| bytes at |position| back from the file.
+  // Return true on success, or false on failure
+  bool ReadFromFile(MDRVA position, void *dest, size_t size);
+
+  // Writes |size| bytes from |src| at |position| of the finished minidump,
+  // in the file or, if there is none, the buffer.
+  // Return true on success, or false on failure
+  bool WriteFinished(MDRVA position, const void *src, size_t size);
+
+  // Replaces the finished minidump, in the file or the buffer, with a
+  // minidump container holding it, and sets position_ to its size.
+  // Return true on success, or false on failure
+  bool Compress();
+
   // The file descriptor for the output file
   int file_;
 
+  // True if Close() should close file_
+  bool close_file_;
+
+  // True if file_ can seek.  If not, file_position_ is the position the
+  // next write to it must start at.
+  bool seekable_;
+  MDRVA file_position_;
+
   // Current position in buffer
   MDRVA position_;
 
   // Current allocated size
   size_t size_;
 
+  // The write buffer, or NULL if writes go straight to the file.  If there
+  // is no file, this is the caller's buffer and holds the entire minidump.
+  u_int8_t *buffer_;
+
+  // True if buffer_ was mapped by EnableWriteBuffer()
+  bool buffer_owned_;
+
+  // Size of the write buffer
+  size_t buffer_capacity_;
+
+  // File position of the first byte of the write buffer
+  MDRVA buffer_position_;
+
+  // Number of bytes allocated within the write buffer
+  size_t buffer_used_;
+
+  // Block size for compressing the minidump on Close(), or zero if it is
+  // left as is
+  size_t compression_block_size_;
+
   // Copy |length| characters from |str| to |mdstring|.  These are distinct
   // because the underlying MDString is a UTF-16 based string.  The wchar_t
   // variant may need to create a MDString that has more characters than the
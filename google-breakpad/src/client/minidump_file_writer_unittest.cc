@@ -32,16 +32,24 @@
 /*
  g++ -I../ ../common/convert_UTF.c \
  ../common/string_conversion.cc \
+ ../common/block_compression.cc \
+ ../common/minidump_container.cc \
  minidump_file_writer.cc \
  minidump_file_writer_unittest.cc \
  -o minidump_file_writer_unittest
  */
 
 #include <fcntl.h>
+#include <string.h>
 #include <unistd.h>
 
+#include <sstream>
+#include <string>
+
 #include "minidump_file_writer-inl.h"
+#include "common/minidump_container.h"
 
+using google_breakpad::MinidumpContainerReader;
 using google_breakpad::MinidumpFileWriter;
 
 #define ASSERT_TRUE(cond) \
@@ -70,44 +78,55 @@ typedef struct {
   ArrayStructure array[0];
 } ObjectAndArrayStructure;
 
-static bool WriteFile(const char *path) {
-  MinidumpFileWriter writer;
-  if (writer.Open(path)) {
-    // Test a single structure
-    google_breakpad::TypedMDRVA<StringStructure> strings(&writer);
-    ASSERT_TRUE(strings.Allocate());
-    strings.get()->integer_value = 0xBEEF;
-    const char *first = "First String";
-    ASSERT_TRUE(writer.WriteString(first, 0, &strings.get()->first_string));
-    const wchar_t *second = L"Second String";
-    ASSERT_TRUE(writer.WriteString(second, 0, &strings.get()->second_string));
-
-    // Test an array structure
-    google_breakpad::TypedMDRVA<ArrayStructure> array(&writer);
-    unsigned int count = 10;
-    ASSERT_TRUE(array.AllocateArray(count));
-    for (unsigned int i = 0; i < count; ++i) {
-      ArrayStructure local;
-      local.char_value = i;
-      local.short_value = i + 1;
-      local.long_value = i + 2;
-      ASSERT_TRUE(array.CopyIndex(i, &local));
-    }
-
-    // Test an object followed by an array
-    google_breakpad::TypedMDRVA<ObjectAndArrayStructure> obj_array(&writer);
-    ASSERT_TRUE(obj_array.AllocateObjectAndArray(count,
-                                                 sizeof(ArrayStructure)));
-    obj_array.get()->count = count;
-    for (unsigned int i = 0; i < count; ++i) {
-      ArrayStructure local;
-      local.char_value = i;
-      local.short_value = i + 1;
-      local.long_value = i + 2;
-      ASSERT_TRUE(obj_array.CopyIndexAfterObject(i, &local, sizeof(local)));
-    }
+// Write the test data with |writer|, whose destination has been set.
+static bool WriteContents(MinidumpFileWriter *writer) {
+  // Test a single structure
+  google_breakpad::TypedMDRVA<StringStructure> strings(writer);
+  ASSERT_TRUE(strings.Allocate());
+  strings.get()->integer_value = 0xBEEF;
+  const char *first = "First String";
+  ASSERT_TRUE(writer->WriteString(first, 0, &strings.get()->first_string));
+  const wchar_t *second = L"Second String";
+  ASSERT_TRUE(writer->WriteString(second, 0, &strings.get()->second_string));
+
+  // Test an array structure
+  google_breakpad::TypedMDRVA<ArrayStructure> array(writer);
+  unsigned int count = 10;
+  ASSERT_TRUE(array.AllocateArray(count));
+  for (unsigned int i = 0; i < count; ++i) {
+    ArrayStructure local;
+    memset(&local, 0, sizeof(local));
+    local.char_value = i;
+    local.short_value = i + 1;
+    local.long_value = i + 2;
+    ASSERT_TRUE(array.CopyIndex(i, &local));
   }
 
+  // Test an object followed by an array
+  google_breakpad::TypedMDRVA<ObjectAndArrayStructure> obj_array(writer);
+  ASSERT_TRUE(obj_array.AllocateObjectAndArray(count,
+                                               sizeof(ArrayStructure)));
+  obj_array.get()->count = count;
+  for (unsigned int i = 0; i < count; ++i) {
+    ArrayStructure local;
+    memset(&local, 0, sizeof(local));
+    local.char_value = i;
+    local.short_value = i + 1;
+    local.long_value = i + 2;
+    ASSERT_TRUE(obj_array.CopyIndexAfterObject(i, &local, sizeof(local)));
+  }
+
+  return true;
+}
+
+// Write the test file to |path|.  If |buffer_size| is non-zero, stage the
+// writes in a buffer of that size.
+static bool WriteFile(const char *path, size_t buffer_size) {
+  MinidumpFileWriter writer;
+  ASSERT_TRUE(writer.Open(path));
+  if (buffer_size)
+    ASSERT_TRUE(writer.EnableWriteBuffer(buffer_size));
+  ASSERT_TRUE(WriteContents(&writer));
   return writer.Close();
 }
 
@@ -131,17 +150,17 @@ static bool CompareFile(const char *path) {
     0x00730072, 0x00200074, 0x00740053, 0x00690072,
     0x0067006e, 0x00000000, 0x0000001a, 0x00650053,
     0x006f0063, 0x0064006e, 0x00530020, 0x00720074,
-    0x006e0069, 0x00000067, 0x00011e00, 0x00000002,
-    0x00021e01, 0x00000003, 0x00031e02, 0x00000004,
-    0x00041e03, 0x00000005, 0x00051e04, 0x00000006,
-    0x00061e05, 0x00000007, 0x00071e06, 0x00000008,
-    0x00081e07, 0x00000009, 0x00091e08, 0x0000000a,
-    0x000a1e09, 0x0000000b, 0x0000000a, 0x00011c00,
-    0x00000002, 0x00021c01, 0x00000003, 0x00031c02,
-    0x00000004, 0x00041c03, 0x00000005, 0x00051c04,
-    0x00000006, 0x00061c05, 0x00000007, 0x00071c06,
-    0x00000008, 0x00081c07, 0x00000009, 0x00091c08,
-    0x0000000a, 0x000a1c09, 0x0000000b, 0x00000000,
+    0x006e0069, 0x00000067, 0x00010000, 0x00000002,
+    0x00020001, 0x00000003, 0x00030002, 0x00000004,
+    0x00040003, 0x00000005, 0x00050004, 0x00000006,
+    0x00060005, 0x00000007, 0x00070006, 0x00000008,
+    0x00080007, 0x00000009, 0x00090008, 0x0000000a,
+    0x000a0009, 0x0000000b, 0x0000000a, 0x00010000,
+    0x00000002, 0x00020001, 0x00000003, 0x00030002,
+    0x00000004, 0x00040003, 0x00000005, 0x00050004,
+    0x00000006, 0x00060005, 0x00000007, 0x00070006,
+    0x00000008, 0x00080007, 0x00000009, 0x00090008,
+    0x0000000a, 0x000a0009, 0x0000000b, 0x00000000,
 #endif
   };
   size_t expected_byte_count = sizeof(expected);
@@ -166,10 +185,168 @@ static bool CompareFile(const char *path) {
   return true;
 }
 
+// Read everything from |fd| into |buffer|, which holds |capacity| bytes,
+// and set |size| to the number of bytes read.
+static bool ReadAll(int fd, char *buffer, size_t capacity, size_t *size) {
+  ssize_t count;
+  *size = 0;
+  do {
+    ASSERT_TRUE(*size < capacity);
+    count = read(fd, buffer + *size, capacity - *size);
+    ASSERT_TRUE(count >= 0);
+    *size += count;
+  } while (count > 0);
+  return true;
+}
+
+// Compare the file at |path| byte for byte with the |size| bytes at |data|.
+static bool CompareFileWithBytes(const char *path, const char *data,
+                                 size_t size) {
+  int fd = open(path, O_RDONLY, 0600);
+  ASSERT_NE(fd, -1);
+  char contents[4096];
+  size_t contents_size;
+  ASSERT_TRUE(ReadAll(fd, contents, sizeof(contents), &contents_size));
+  close(fd);
+  ASSERT_EQ(contents_size, size);
+  ASSERT_EQ(memcmp(contents, data, size), 0);
+  return true;
+}
+
+// Compare the files at |path1| and |path2| byte for byte.
+static bool CompareFiles(const char *path1, const char *path2) {
+  int fd = open(path2, O_RDONLY, 0600);
+  ASSERT_NE(fd, -1);
+  char contents[4096];
+  size_t contents_size;
+  ASSERT_TRUE(ReadAll(fd, contents, sizeof(contents), &contents_size));
+  close(fd);
+  return CompareFileWithBytes(path1, contents, contents_size);
+}
+
+// Write the test data into memory, and compare it with the file at |path|.
+static bool CompareMemoryWithFile(const char *path) {
+  char buffer[4096];
+  MinidumpFileWriter writer;
+  writer.SetBuffer(buffer, sizeof(buffer));
+  ASSERT_TRUE(WriteContents(&writer));
+  ASSERT_TRUE(writer.Close());
+  ASSERT_TRUE(CompareFileWithBytes(path, buffer, writer.position()));
+
+  // Allocations that don't fit in the buffer fail.
+  MinidumpFileWriter small_writer;
+  small_writer.SetBuffer(buffer, 64);
+  google_breakpad::UntypedMDRVA fits(&small_writer);
+  ASSERT_TRUE(fits.Allocate(60));
+  google_breakpad::UntypedMDRVA overflows(&small_writer);
+  ASSERT_TRUE(!overflows.Allocate(1));
+  return true;
+}
+
+// Write the test data into a pipe, and compare it with the file at |path|.
+static bool ComparePipeWithFile(const char *path) {
+  int fds[2];
+  ASSERT_EQ(pipe(fds), 0);
+  {
+    // The pipe can't seek, so the whole minidump must be buffered.
+    MinidumpFileWriter writer;
+    writer.SetFile(fds[1]);
+    ASSERT_TRUE(writer.EnableWriteBuffer(4096));
+    // Nor can it be compressed in place.
+    ASSERT_TRUE(!writer.EnableCompression(4096));
+    ASSERT_TRUE(WriteContents(&writer));
+    ASSERT_TRUE(writer.Close());
+  }
+  {
+    // Without a write buffer, nothing can be allocated at all.
+    int other_fds[2];
+    ASSERT_EQ(pipe(other_fds), 0);
+    MinidumpFileWriter writer;
+    writer.SetFile(other_fds[1]);
+    google_breakpad::UntypedMDRVA unbuffered(&writer);
+    ASSERT_TRUE(!unbuffered.Allocate(8));
+
+    // Nor can the buffer be flushed to make room before Close().
+    MinidumpFileWriter small_writer;
+    small_writer.SetFile(other_fds[1]);
+    ASSERT_TRUE(small_writer.EnableWriteBuffer(64));
+    google_breakpad::UntypedMDRVA fits(&small_writer);
+    ASSERT_TRUE(fits.Allocate(60));
+    google_breakpad::UntypedMDRVA overflows(&small_writer);
+    ASSERT_TRUE(!overflows.Allocate(8));
+    ASSERT_TRUE(small_writer.Close());
+    close(other_fds[0]);
+    close(other_fds[1]);
+  }
+  close(fds[1]);
+
+  char contents[4096];
+  size_t contents_size;
+  ASSERT_TRUE(ReadAll(fds[0], contents, sizeof(contents), &contents_size));
+  close(fds[0]);
+  return CompareFileWithBytes(path, contents, contents_size);
+}
+
+// Write the test data into memory as a minidump container, and compare
+// what it decompresses to with the file at |path|.
+static bool CompareCompressedWithFile(const char *path) {
+  char buffer[4096];
+  MinidumpFileWriter writer;
+  writer.SetBuffer(buffer, sizeof(buffer));
+  // Blocks larger than any reader accepts are refused.
+  ASSERT_TRUE(!writer.EnableCompression(
+      google_breakpad::kMaxMinidumpContainerBlockSize + 1));
+  // Small blocks, so that the data spans several.
+  ASSERT_TRUE(writer.EnableCompression(64));
+  ASSERT_TRUE(WriteContents(&writer));
+  ASSERT_TRUE(writer.Close());
+
+  std::istringstream stream(std::string(buffer, writer.position()));
+  MinidumpContainerReader reader(&stream);
+  ASSERT_TRUE(reader.ReadIndex());
+  char contents[4096];
+  ASSERT_TRUE(reader.size() <= sizeof(contents));
+  ASSERT_TRUE(reader.Read(0, contents, reader.size()));
+  return CompareFileWithBytes(path, contents, reader.size());
+}
+
+// Check that a Close() that fails to write still releases the writer's
+// buffer and file, rather than failing the same way again later.
+static bool CloseAfterFailedWrite(const char *path) {
+  int fd = open(path, O_RDONLY);
+  ASSERT_TRUE(fd != -1);
+  MinidumpFileWriter writer;
+  writer.SetFile(fd);
+  ASSERT_TRUE(writer.EnableWriteBuffer(4096));
+  google_breakpad::UntypedMDRVA data(&writer);
+  ASSERT_TRUE(data.Allocate(8));
+  ASSERT_TRUE(!writer.Close());
+  ASSERT_TRUE(writer.Close());
+  close(fd);
+  return true;
+}
+
 static bool RunTests() {
   const char *path = "/tmp/minidump_file_writer_unittest.dmp";
-  ASSERT_TRUE(WriteFile(path));
+  const char *buffered_path = "/tmp/minidump_file_writer_unittest_b.dmp";
+  ASSERT_TRUE(WriteFile(path, 0));
   ASSERT_TRUE(CompareFile(path));
+
+  // A buffered writer must produce the same file, whether everything fits
+  // in the buffer, the buffer has to be flushed along the way, or some
+  // allocations are too large to be staged at all.
+  size_t buffer_sizes[] = { 65536, 64, 8 };
+  for (size_t i = 0; i < sizeof(buffer_sizes) / sizeof(buffer_sizes[0]); ++i) {
+    ASSERT_TRUE(WriteFile(buffered_path, buffer_sizes[i]));
+    ASSERT_TRUE(CompareFiles(path, buffered_path));
+    unlink(buffered_path);
+  }
+
+  ASSERT_TRUE(CompareMemoryWithFile(path));
+  ASSERT_TRUE(ComparePipeWithFile(path));
+  ASSERT_TRUE(CompareCompressedWithFile(path));
+  ASSERT_TRUE(CloseAfterFailedWrite(path));
+
   unlink(path);
   return true;
 }
@@ -0,0 +1,211 @@
+// Copyright (c) 2010, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// block_compression.cc: Implementation of CompressBlock and
+// DecompressBlock. See block_compression.h for details.
+
+#include "common/block_compression.h"
+
+#include <string.h>
+
+#include <vector>
+
+#include "google_breakpad/common/breakpad_types.h"
+
+namespace google_breakpad {
+
+namespace {
+
+// Matches shorter than this aren't worth a sequence of their own.
+const size_t kMinMatch = 4;
+
+// Match offsets are stored in two bytes.
+const size_t kMaxOffset = 0xffff;
+
+// The compressor finds candidate matches through a hash table of this
+// many bits, indexed by the next kMinMatch bytes.
+const int kHashBits = 14;
+
+// The largest length that fits in half of a token byte. Longer
+// lengths continue in a series of extra bytes.
+const size_t kTokenLengthLimit = 15;
+
+inline u_int32_t Fetch32(const unsigned char *p) {
+  u_int32_t value;
+  memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+inline size_t Hash(u_int32_t value) {
+  return (value * 2654435761U) >> (32 - kHashBits);
+}
+
+// Append the portion of LENGTH that doesn't fit in a token byte: a
+// run of 255 bytes, terminated by a byte less than 255.
+void AppendExtraLength(size_t length, string *out) {
+  while (length >= 255) {
+    out->push_back(static_cast<char>(255));
+    length -= 255;
+  }
+  out->push_back(static_cast<char>(length));
+}
+
+// Append a sequence copying LITERAL_LENGTH bytes from LITERALS,
+// followed by MATCH_LENGTH bytes from OFFSET bytes back in the output.
+// If MATCH_LENGTH is zero, this is the final sequence of the block,
+// which carries only literals.
+void AppendSequence(const unsigned char *literals, size_t literal_length,
+                    size_t offset, size_t match_length, string *out) {
+  size_t match_code = match_length ? match_length - kMinMatch : 0;
+  unsigned char token =
+      ((literal_length < kTokenLengthLimit ? literal_length
+                                           : kTokenLengthLimit) << 4) |
+      (match_code < kTokenLengthLimit ? match_code : kTokenLengthLimit);
+  out->push_back(static_cast<char>(token));
+  if (literal_length >= kTokenLengthLimit)
+    AppendExtraLength(literal_length - kTokenLengthLimit, out);
+  out->append(reinterpret_cast<const char *>(literals), literal_length);
+  if (match_length) {
+    out->push_back(static_cast<char>(offset & 0xff));
+    out->push_back(static_cast<char>(offset >> 8));
+    if (match_code >= kTokenLengthLimit)
+      AppendExtraLength(match_code - kTokenLengthLimit, out);
+  }
+}
+
+// Add to *LENGTH the extra length bytes at *CURSOR, advancing *CURSOR
+// past them. Return false if they run past END.
+bool ReadExtraLength(const unsigned char **cursor, const unsigned char *end,
+                     size_t *length) {
+  unsigned char byte;
+  do {
+    if (*cursor == end)
+      return false;
+    byte = *(*cursor)++;
+    *length += byte;
+  } while (byte == 255);
+  return true;
+}
+
+}  // namespace
+
+void CompressBlock(const char *data, size_t size, string *compressed) {
+  compressed->clear();
+  compressed->reserve(size / 2 + 16);
+
+  const unsigned char *bytes = reinterpret_cast<const unsigned char *>(data);
+
+  // The most recent position at which each hash value was seen. Since
+  // every candidate is checked against the actual data, stale or
+  // colliding entries merely cost us a match.
+  std::vector<size_t> table(1 << kHashBits, 0);
+
+  size_t anchor = 0;  // start of the pending literals
+  size_t position = 0;
+  while (position + kMinMatch <= size) {
+    u_int32_t next = Fetch32(bytes + position);
+    size_t &slot = table[Hash(next)];
+    size_t candidate = slot;
+    slot = position;
+    if (candidate < position && position - candidate <= kMaxOffset &&
+        Fetch32(bytes + candidate) == next) {
+      size_t length = kMinMatch;
+      while (position + length < size &&
+             bytes[candidate + length] == bytes[position + length])
+        length++;
+      AppendSequence(bytes + anchor, position - anchor,
+                     position - candidate, length, compressed);
+      position += length;
+      anchor = position;
+    } else {
+      position++;
+    }
+  }
+  AppendSequence(bytes + anchor, size - anchor, 0, 0, compressed);
+}
+
+bool DecompressBlock(const char *compressed, size_t compressed_size,
+                     size_t size, string *data) {
+  data->clear();
+  // Check SIZE against what COMPRESSED could possibly produce before
+  // allocating space for it; it usually comes from an untrusted index.
+  if (size / kMaxBlockExpansion > compressed_size)
+    return false;
+  data->resize(size);
+  if (size == 0 && compressed_size == 0)
+    return true;
+
+  const unsigned char *cursor =
+      reinterpret_cast<const unsigned char *>(compressed);
+  const unsigned char *end = cursor + compressed_size;
+  char *out = size ? &(*data)[0] : NULL;
+  size_t written = 0;
+
+  while (cursor < end) {
+    unsigned char token = *cursor++;
+
+    size_t literal_length = token >> 4;
+    if (literal_length == kTokenLengthLimit &&
+        !ReadExtraLength(&cursor, end, &literal_length))
+      return false;
+    if (literal_length > size_t(end - cursor) ||
+        literal_length > size - written)
+      return false;
+    memcpy(out + written, cursor, literal_length);
+    cursor += literal_length;
+    written += literal_length;
+
+    // The final sequence carries only literals.
+    if (cursor == end)
+      break;
+
+    if (end - cursor < 2)
+      return false;
+    size_t offset = cursor[0] | (cursor[1] << 8);
+    cursor += 2;
+    size_t match_length = token & 0xf;
+    if (match_length == kTokenLengthLimit &&
+        !ReadExtraLength(&cursor, end, &match_length))
+      return false;
+    match_length += kMinMatch;
+    if (offset == 0 || offset > written || match_length > size - written)
+      return false;
+
+    // The source and destination may overlap, when the match repeats
+    // a short run; copy byte by byte.
+    const char *from = out + written - offset;
+    for (size_t i = 0; i < match_length; i++)
+      out[written + i] = from[i];
+    written += match_length;
+  }
+
+  return written == size;
+}
+
+}  // namespace google_breakpad
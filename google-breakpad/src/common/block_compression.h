@@ -0,0 +1,74 @@
+// -*- mode: c++ -*-
+
+// Copyright (c) 2010, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// block_compression.h: A small LZ77-style compressor for blocks of
+// symbol data.
+//
+// CompressBlock and DecompressBlock implement a byte-oriented LZ77
+// variant in the style of LZ4: each sequence is a token byte holding
+// a literal length and a match length, followed by the literals and a
+// two-byte backwards offset. It trades compression ratio for speed,
+// and needs no library beyond the standard one, so symbol files can be
+// compressed and decompressed wherever Breakpad itself builds.
+
+#ifndef COMMON_BLOCK_COMPRESSION_H_
+#define COMMON_BLOCK_COMPRESSION_H_
+
+#include <stddef.h>
+
+#include <string>
+
+namespace google_breakpad {
+
+using std::string;
+
+// No byte of compressed data expands to more than this many bytes of
+// decompressed data, so a block claiming to be larger than this many
+// times its compressed size is malformed.
+const size_t kMaxBlockExpansion = 255;
+
+// Compress the SIZE bytes at DATA, and store the result in
+// *COMPRESSED, replacing its prior contents.
+void CompressBlock(const char *data, size_t size, string *compressed);
+
+// Decompress the COMPRESSED_SIZE bytes at COMPRESSED, which
+// CompressBlock produced from SIZE bytes of data, and store the
+// result in *DATA, replacing its prior contents. Return false if the
+// compressed data is malformed or does not expand to exactly SIZE
+// bytes; this never reads or writes outside the given buffers. SIZE
+// is checked against kMaxBlockExpansion before any space is allocated
+// for it, so a corrupt SIZE can't force a huge allocation.
+bool DecompressBlock(const char *compressed, size_t compressed_size,
+                     size_t size, string *data);
+
+}  // namespace google_breakpad
+
+#endif  // COMMON_BLOCK_COMPRESSION_H_
@@ -72,6 +72,25 @@ struct ByteBuffer {
   const uint8_t *start, *end;
 };
 
+// Return the SIZE-byte unsigned integer at P, which is big-endian if
+// BIG_ENDIAN is true, or little-endian otherwise. This does no bounds
+// checking; it's meant for loops that decode whole arrays of
+// fixed-size records, and have checked the array's size up front.
+// Since BIG_ENDIAN and SIZE are constants, the compiler can reduce each
+// call to a load and perhaps a byte swap.
+template<bool big_endian, size_t size>
+inline uint64_t ReadUnalignedUnsigned(const uint8_t *p) {
+  uint64_t result = 0;
+  if (big_endian) {
+    for (size_t i = 0; i < size; i++)
+      result = (result << 8) | p[i];
+  } else {
+    for (size_t i = size; i > 0; i--)
+      result = (result << 8) | p[i - 1];
+  }
+  return result;
+}
+
 // A cursor pointing into a ByteBuffer that can parse numbers of various
 // widths and representations, strings, and data blocks, advancing through
 // the buffer as it goes. All ByteCursor operations check that accesses
@@ -836,11 +836,17 @@ void LineInfo::ReadLines() {
   // The LineInfoHandler interface expects each line's length along
   // with its address, but DWARF only provides addresses (sans
   // length), and an end-of-sequence address; one infers the length
-  // from the next address. So we report a line only when we get the
+  // from the next address. So we record a line only when we get the
   // next line's address, or the end-of-sequence address.
+  //
+  // Rather than calling the handler once per row, we collect the rows
+  // of each sequence in rows_ and hand them over all at once when the
+  // sequence ends.
   bool have_pending_line = false;
-  uint64 pending_address = 0;
-  uint32 pending_file_num = 0, pending_line_num = 0, pending_column_num = 0;
+  LineInfoRow pending;
+  pending.address = 0;
+  pending.length = 0;
+  pending.file_num = pending.line_num = pending.column_num = 0;
 
   while (lineptr < lengthstart + header_.total_length) {
     size_t oplength;
@@ -848,27 +854,39 @@ void LineInfo::ReadLines() {
                                     lineptr, &lsm, &oplength, (uintptr)-1,
                                     NULL);
     if (add_row) {
-      if (have_pending_line)
-        handler_->AddLine(pending_address, lsm.address - pending_address,
-                          pending_file_num, pending_line_num,
-                          pending_column_num);
+      if (have_pending_line) {
+        pending.length = lsm.address - pending.address;
+        rows_.push_back(pending);
+      }
       if (lsm.end_sequence) {
         lsm.Reset(header_.default_is_stmt);      
         have_pending_line = false;
+        FlushRows();
       } else {
-        pending_address = lsm.address;
-        pending_file_num = lsm.file_num;
-        pending_line_num = lsm.line_num;
-        pending_column_num = lsm.column_num;
+        pending.address = lsm.address;
+        pending.file_num = lsm.file_num;
+        pending.line_num = lsm.line_num;
+        pending.column_num = lsm.column_num;
         have_pending_line = true;
       }
     }
     lineptr += oplength;
   }
 
+  // Deliver the rows of any final sequence that lacked an
+  // end-of-sequence opcode.
+  FlushRows();
+
   after_header_ = lengthstart + header_.total_length;
 }
 
+void LineInfo::FlushRows() {
+  if (rows_.empty())
+    return;
+  handler_->AddLines(&rows_[0], rows_.size());
+  rows_.clear();
+}
+
 // A DWARF rule for recovering the address or value of a register, or
 // computing the canonical frame address. There is one subclass of this for
 // each '*Rule' member function in CallFrameInfo::Handler.
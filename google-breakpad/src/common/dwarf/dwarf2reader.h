@@ -78,6 +78,17 @@ struct LineInfoHeader {
   vector<unsigned char> *std_opcode_lengths;
 };
 
+// A single row of a line number program's matrix, with its length
+// inferred from the address of the following row. LineInfo hands
+// these to LineInfoHandler::AddLines in batches.
+struct LineInfoRow {
+  uint64 address;
+  uint64 length;
+  uint32 file_num;
+  uint32 line_num;
+  uint32 column_num;
+};
+
 class LineInfo {
  public:
 
@@ -124,6 +135,9 @@ class LineInfo {
   // Reads the DWARF2/3 line information
   void ReadLines();
 
+  // Pass the rows accumulated in rows_ to the handler, and clear rows_.
+  void FlushRows();
+
   // The associated handler to call processing functions in
   LineInfoHandler* handler_;
 
@@ -142,6 +156,11 @@ class LineInfo {
   const char* buffer_;
   uint64 buffer_length_;
   const char* after_header_;
+
+  // The rows of the sequence we are currently reading, not yet passed
+  // to the handler. We keep this around between sequences so that its
+  // storage is reused.
+  vector<LineInfoRow> rows_;
 };
 
 // This class is the main interface between the line info reader and
@@ -178,6 +197,25 @@ class LineInfoHandler {
   // if we know it (0 otherwise).
   virtual void AddLine(uint64 address, uint64 length,
                        uint32 file_num, uint32 line_num, uint32 column_num) { }
+
+  // Called when the line info reader has a batch of COUNT lines ready
+  // for us, starting at ROWS, in the order the line number program
+  // produced them. The reader calls this once per sequence, rather
+  // than calling AddLine once per row; handlers that care about speed
+  // should override this. The rows are only valid until this returns.
+  //
+  // Since a line number program can only refer to files it has already
+  // defined, and DW_LNE_define_file only ever adds new file numbers,
+  // the file numbers in ROWS mean the same thing here that they did at
+  // the point the rows were produced, even if DefineFile has been
+  // called since.
+  //
+  // The default implementation simply calls AddLine for each row.
+  virtual void AddLines(const LineInfoRow *rows, size_t count) {
+    for (size_t i = 0; i < count; i++)
+      AddLine(rows[i].address, rows[i].length,
+              rows[i].file_num, rows[i].line_num, rows[i].column_num);
+  }
 };
 
 // The base of DWARF2/3 debug info is a DIE (Debugging Information
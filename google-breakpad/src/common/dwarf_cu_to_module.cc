@@ -693,11 +693,18 @@ inline bool within(const T &item, Module::Address address) {
   // start of ITEM, or if it falls after ITEM's end.
   return address - item.address < item.size;
 }
+
+// Return true if LINES is in order by address.
+bool SortedByAddress(const vector<Module::Line> &lines) {
+  for (size_t i = 1; i < lines.size(); i++)
+    if (Module::Line::CompareByAddress(lines[i], lines[i - 1]))
+      return false;
+  return true;
+}
 }
 
 void DwarfCUToModule::AssignLinesToFunctions() {
   vector<Module::Function *> *functions = &cu_context_->functions;
-  WarningReporter *reporter = cu_context_->reporter;
 
   // This would be simpler if we assumed that source line entries
   // don't cross function boundaries.  However, there's no real reason
@@ -710,10 +717,38 @@ void DwarfCUToModule::AssignLinesToFunctions() {
   // the hair here is a constant factor for performance; the
   // complexity from here on out is linear.
 
-  // Put both our functions and lines in order by address.
+  // Put both our functions and lines in order by address. The line
+  // number program usually produces its sequences in address order
+  // already, so check before paying for a sort of what may be a very
+  // large vector.
   sort(functions->begin(), functions->end(),
        Module::Function::CompareByAddress);
-  sort(lines_.begin(), lines_.end(), Module::Line::CompareByAddress);
+  if (!SortedByAddress(lines_))
+    sort(lines_.begin(), lines_.end(), Module::Line::CompareByAddress);
+
+  // With heavy inlining, a single compilation unit can have millions
+  // of lines. Rather than letting each function's line vector grow one
+  // push_back at a time, count how many lines each function will get,
+  // size the vectors exactly, and then hand out the lines.
+  vector<size_t> counts(functions->size(), 0);
+  PairFunctionsAndLines(&counts);
+  for (size_t i = 0; i < functions->size(); i++) {
+    vector<Module::Line> *lines = &(*functions)[i]->lines;
+    lines->reserve(lines->size() + counts[i]);
+  }
+  PairFunctionsAndLines(NULL);
+
+  // Every line has now been copied to the function it belongs to, so
+  // free our own copies now, rather than when we're destroyed. Note
+  // that both copies are live during the second pass; what the exact
+  // sizing saves is the slack push_back leaves in each function's
+  // vector, not the CU's own copy.
+  vector<Module::Line>().swap(lines_);
+}
+
+void DwarfCUToModule::PairFunctionsAndLines(vector<size_t> *counts) {
+  vector<Module::Function *> *functions = &cu_context_->functions;
+  WarningReporter *reporter = cu_context_->reporter;
 
   // The last line that we used any piece of.  We use this only for
   // generating warnings.
@@ -801,14 +836,18 @@ void DwarfCUToModule::AssignLinesToFunctions() {
         Module::Address line_left = line->size - (current - line->address);
         // This may overflow, but things work out.
         next_transition = current + std::min(func_left, line_left);
-        Module::Line l = *line;
-        l.address = current;
-        l.size = next_transition - current;
-        func->lines.push_back(l);
+        if (counts) {
+          (*counts)[func_it - functions->begin()]++;
+        } else {
+          Module::Line l = *line;
+          l.address = current;
+          l.size = next_transition - current;
+          func->lines.push_back(l);
+        }
         last_line_used = line;
       } else {
         // Covered by a function, but no line.
-        if (func != last_function_cited) {
+        if (!counts && func != last_function_cited) {
           reporter->UncoveredFunction(*func);
           last_function_cited = func;
         }
@@ -831,7 +870,8 @@ void DwarfCUToModule::AssignLinesToFunctions() {
         // some of the line we're about to skip, and it ends at the
         // start of the next function, then assume this is what
         // happened, and don't warn.
-        if (line != last_line_cited
+        if (!counts
+            && line != last_line_cited
             && !(func
                  && line == last_line_used
                  && func->address - line->address == line->size)) {
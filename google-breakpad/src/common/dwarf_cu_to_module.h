@@ -242,6 +242,15 @@ class DwarfCUToModule: public dwarf2reader::RootDIEHandler {
   // lines belong to which functions, beyond their addresses.)
   void AssignLinesToFunctions();
 
+  // Make a single pass over the sorted functions and lines, doling out
+  // pieces of lines to the functions whose address ranges they
+  // overlap. If COUNTS is non-NULL, it must have one element per
+  // function; rather than assigning anything, just add to each
+  // function's element the number of lines it would receive. If
+  // COUNTS is NULL, append the lines to the functions' line vectors,
+  // and report uncovered functions and lines.
+  void PairFunctionsAndLines(vector<size_t> *counts);
+
   // The only reason cu_context_ and child_context_ are pointers is
   // that we want to keep their definitions private to
   // dwarf_cu_to_module.cc, instead of listing them all here. They are
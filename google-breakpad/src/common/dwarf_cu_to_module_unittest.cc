@@ -1038,6 +1038,31 @@ TEST_F(FuncLinePairing, WarnOnceLine) {
   TestLine(1, 0, 13, 1, "filename1", 118581871);
 }
 
+TEST_F(FuncLinePairing, LinesOutOfOrder) {
+  // Lines arrive in the order the line number program's sequences
+  // produce them, which need not be address order.
+  PushLine(30, 10, "filename1", 244325135);
+  PushLine(10, 5,  "filename1", 177521463);
+  PushLine(15, 5,  "filename1", 139457331);
+  PushLine(20, 10, "filename1", 165732417);
+
+  StartCU();
+  DefineFunction(&root_handler_, "function1", 10, 12);
+  DefineFunction(&root_handler_, "function2", 22, 18);
+  root_handler_.Finish();
+
+  TestFunctionCount(2);
+  TestFunction(0, "function1", 10, 12);
+  TestLineCount(0, 3);
+  TestLine(0, 0, 10, 5,  "filename1", 177521463);
+  TestLine(0, 1, 15, 5,  "filename1", 139457331);
+  TestLine(0, 2, 20, 2,  "filename1", 165732417);
+  TestFunction(1, "function2", 22, 18);
+  TestLineCount(1, 2);
+  TestLine(1, 0, 22, 8,  "filename1", 165732417);
+  TestLine(1, 1, 30, 10, "filename1", 244325135);
+}
+
 class CXXQualifiedNames: public CUFixtureBase,
                          public TestWithParam<DwarfTag> { };
 
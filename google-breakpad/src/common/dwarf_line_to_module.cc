@@ -36,6 +36,8 @@
 
 #include <stdio.h>
 
+#include <algorithm>
+
 // Trying to support Windows paths in a reasonable way adds a lot of
 // variations to test; it would be better to just put off dealing with
 // it until we actually have to deal with DWARF on Windows.
@@ -91,12 +93,19 @@ void DwarfLineToModule::DefineFile(const string &name, int32 file_num,
 
   // Find a Module::File object of the given name, and add it to the
   // file table.
-  files_[file_num] = module_->FindFile(full_name);
+  Module::File *file = module_->FindFile(full_name);
+  uint32 index = file_num;
+  if (index < kDenseFileLimit) {
+    if (index >= dense_files_.size())
+      dense_files_.resize(index + 1, NULL);
+    dense_files_[index] = file;
+  } else {
+    sparse_files_[index] = file;
+  }
 }
 
-void DwarfLineToModule::AddLine(uint64 address, uint64 length,
-                                uint32 file_num, uint32 line_num,
-                                uint32 column_num) {
+inline void DwarfLineToModule::RecordLine(uint64 address, uint64 length,
+                                          uint32 file_num, uint32 line_num) {
   if (length == 0)
     return;
 
@@ -113,7 +122,7 @@ void DwarfLineToModule::AddLine(uint64 address, uint64 length,
   }
 
   // Find the source file being referred to.
-  Module::File *file = files_[file_num];
+  Module::File *file = LookupFile(file_num);
   if (!file) {
     if (!warned_bad_file_number_) {
       fprintf(stderr, "warning: DWARF line number data refers to "
@@ -131,4 +140,24 @@ void DwarfLineToModule::AddLine(uint64 address, uint64 length,
   lines_->push_back(line);
 }
 
+void DwarfLineToModule::AddLine(uint64 address, uint64 length,
+                                uint32 file_num, uint32 line_num,
+                                uint32 column_num) {
+  RecordLine(address, length, file_num, line_num);
+}
+
+void DwarfLineToModule::AddLines(const dwarf2reader::LineInfoRow *rows,
+                                 size_t count) {
+  // Make room for the whole batch up front, but keep growing
+  // geometrically: reserving exactly what each sequence needs would
+  // make the total copying quadratic in the number of sequences.
+  size_t needed = lines_->size() + count;
+  if (needed > lines_->capacity())
+    lines_->reserve(std::max(needed, 2 * lines_->capacity()));
+
+  for (const dwarf2reader::LineInfoRow *row = rows, *end = rows + count;
+       row != end; ++row)
+    RecordLine(row->address, row->length, row->file_num, row->line_num);
+}
+
 } // namespace google_breakpad
@@ -133,12 +133,34 @@ class DwarfLineToModule: public dwarf2reader::LineInfoHandler {
                   uint64 length);
   void AddLine(uint64 address, uint64 length,
                uint32 file_num, uint32 line_num, uint32 column_num);
+  void AddLines(const dwarf2reader::LineInfoRow *rows, size_t count);
 
  private:
 
   typedef std::map<uint32, std::string> DirectoryTable;
   typedef std::map<uint32, Module::File *> FileTable;
 
+  // File numbers below this limit are kept in dense_files_; any others
+  // go in sparse_files_. Real line number programs number their files
+  // consecutively from one, so in practice the sparse table is empty.
+  static const uint32 kDenseFileLimit = 1 << 16;
+
+  // Return the Module::File for FILE_NUM, or NULL if it hasn't been
+  // defined.
+  Module::File *LookupFile(uint32 file_num) const {
+    if (file_num < dense_files_.size())
+      return dense_files_[file_num];
+    if (sparse_files_.empty())
+      return NULL;
+    FileTable::const_iterator it = sparse_files_.find(file_num);
+    return it == sparse_files_.end() ? NULL : it->second;
+  }
+
+  // Append a line to lines_, applying the filtering described in
+  // the comments for AddLine and omitted_line_end_.
+  inline void RecordLine(uint64 address, uint64 length,
+                         uint32 file_num, uint32 line_num);
+
   // The module we're contributing debugging info to. Owned by our
   // client.
   Module *module_;
@@ -157,8 +179,11 @@ class DwarfLineToModule: public dwarf2reader::LineInfoHandler {
   // A table mapping directory numbers to paths.
   DirectoryTable directories_;
 
-  // A table mapping file numbers to Module::File pointers.
-  FileTable files_;
+  // Tables mapping file numbers to Module::File pointers: a vector
+  // indexed directly by file number, for the usual small, densely
+  // allocated numbers, and a map for anything else.
+  vector<Module::File *> dense_files_;
+  FileTable sparse_files_;
 
   // The highest file number we've seen so far, or -1 if we've seen
   // none.  Used for dynamically defined file numbers.
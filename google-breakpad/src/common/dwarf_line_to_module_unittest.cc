@@ -34,9 +34,12 @@
 #include "breakpad_googletest_includes.h"
 #include "common/dwarf_line_to_module.h"
 
+using dwarf2reader::LineInfoRow;
 using google_breakpad::DwarfLineToModule;
 using google_breakpad::Module;
 using google_breakpad::Module;
+using ::testing::InSequence;
+using ::testing::Return;
 
 TEST(SimpleModule, One) {
   Module m("name", "os", "architecture", "id");
@@ -337,3 +340,85 @@ TEST(Omitted, Mix2) {
   EXPECT_EQ(67355743, lines[0].number);
   EXPECT_EQ(23365776, lines[1].number);
 }
+
+TEST(Batched, Rows) {
+  Module m("name", "os", "architecture", "id");
+  vector<Module::Line> lines;
+  DwarfLineToModule h(&m, &lines);
+
+  h.DefineFile("filename1", 1, 0, 0, 0);
+  h.DefineFile("filename2", 2, 0, 0, 0);
+  const LineInfoRow rows[] = {
+    { 0x2b4a5c10, 0x10, 1, 23616411, 0 },
+    { 0x2b4a5c20, 0,    1, 85410208, 0 },  // empty; should be omitted
+    { 0x2b4a5c20, 0x08, 2, 30548119, 0 },
+    { 0x2b4a5c28, 0x04, 3, 47129043, 0 },  // bad file number
+    { 0x2b4a5c2c, 0x14, 1, 17932845, 0 }
+  };
+  h.AddLines(rows, sizeof(rows) / sizeof(rows[0]));
+
+  vector<Module::File *> files;
+  m.GetFiles(&files);
+  ASSERT_EQ(2U, files.size());
+
+  ASSERT_EQ(3U, lines.size());
+  EXPECT_EQ(0x2b4a5c10U, lines[0].address);
+  EXPECT_EQ(0x10U, lines[0].size);
+  EXPECT_TRUE(lines[0].file == files[0]);
+  EXPECT_EQ(23616411, lines[0].number);
+  EXPECT_EQ(0x2b4a5c20U, lines[1].address);
+  EXPECT_EQ(0x08U, lines[1].size);
+  EXPECT_TRUE(lines[1].file == files[1]);
+  EXPECT_EQ(30548119, lines[1].number);
+  EXPECT_EQ(0x2b4a5c2cU, lines[2].address);
+  EXPECT_EQ(0x14U, lines[2].size);
+  EXPECT_TRUE(lines[2].file == files[0]);
+  EXPECT_EQ(17932845, lines[2].number);
+}
+
+TEST(Batched, OmittedAcrossBatches) {
+  Module m("name", "os", "architecture", "id");
+  vector<Module::Line> lines;
+  DwarfLineToModule h(&m, &lines);
+
+  h.DefineFile("filename1", 1, 0, 0, 0);
+  const LineInfoRow first[] = {
+    { 0x5f0f1e2a, 10,   1, 31415926, 0 },   // should be recorded
+    { 0,          0x40, 1, 27182818, 0 }    // should be omitted
+  };
+  const LineInfoRow second[] = {
+    { 0x40,       0x20, 1, 16180339, 0 },   // should be omitted
+    { 0x6b3cd07e, 10,   1, 14142135, 0 }    // should be recorded
+  };
+  h.AddLines(first, 2);
+  h.AddLines(second, 2);
+
+  ASSERT_EQ(2U, lines.size());
+  EXPECT_EQ(31415926, lines[0].number);
+  EXPECT_EQ(14142135, lines[1].number);
+}
+
+// The default LineInfoHandler::AddLines should pass each row to
+// AddLine, in order.
+class MockLineHandler: public dwarf2reader::LineInfoHandler {
+ public:
+  MOCK_METHOD5(AddLine, void(uint64 address, uint64 length,
+                             uint32 file_num, uint32 line_num,
+                             uint32 column_num));
+};
+
+TEST(Batched, DefaultHandler) {
+  MockLineHandler handler;
+  const LineInfoRow rows[] = {
+    { 0x1d9a5e18, 0x0c, 0x1a, 0x3a63, 0x05 },
+    { 0x1d9a5e24, 0x1e, 0x1b, 0x3a64, 0x09 }
+  };
+  {
+    InSequence s;
+    EXPECT_CALL(handler, AddLine(0x1d9a5e18, 0x0c, 0x1a, 0x3a63, 0x05))
+        .WillOnce(Return());
+    EXPECT_CALL(handler, AddLine(0x1d9a5e24, 0x1e, 0x1b, 0x3a64, 0x09))
+        .WillOnce(Return());
+  }
+  handler.AddLines(rows, 2);
+}
@@ -48,6 +48,7 @@
 
 #include <iostream>
 #include <set>
+#include <sstream>
 #include <string>
 #include <utility>
 #include <vector>
@@ -62,6 +63,7 @@
 #include "common/module.h"
 #include "common/stabs_reader.h"
 #include "common/stabs_to_module.h"
+#include "common/symbol_container.h"
 
 // This namespace contains helper functions.
 namespace {
@@ -729,6 +731,7 @@ bool WriteSymbolFileInternal(uint8_t* obj_file,
                              const std::string &obj_filename,
                              const std::string &debug_dir,
                              bool cfi,
+                             bool compact_cfi,
                              std::ostream &sym_stream) {
   ElfW(Ehdr) *elf_header = reinterpret_cast<ElfW(Ehdr) *>(obj_file);
 
@@ -804,6 +807,7 @@ bool WriteSymbolFileInternal(uint8_t* obj_file,
       return false;
     }
   }
+  module.SetCompactCFI(compact_cfi);
   if (!module.Write(sym_stream, cfi))
     return false;
 
@@ -813,6 +817,7 @@ bool WriteSymbolFileInternal(uint8_t* obj_file,
 bool WriteSymbolFile(const std::string &obj_file,
                      const std::string &debug_dir,
                      bool cfi,
+                     bool compact_cfi,
                      std::ostream &sym_stream) {
   MmapWrapper map_wrapper;
   ElfW(Ehdr) *elf_header = NULL;
@@ -820,7 +825,20 @@ bool WriteSymbolFile(const std::string &obj_file,
     return false;
 
   return WriteSymbolFileInternal(reinterpret_cast<uint8_t*>(elf_header),
-                                 obj_file, debug_dir, cfi, sym_stream);
+                                 obj_file, debug_dir, cfi, compact_cfi,
+                                 sym_stream);
+}
+
+bool WriteCompressedSymbolFile(const std::string &obj_file,
+                               const std::string &debug_dir,
+                               bool cfi,
+                               bool compact_cfi,
+                               std::ostream &sym_stream) {
+  std::ostringstream symbols;
+  if (!WriteSymbolFile(obj_file, debug_dir, cfi, compact_cfi, symbols))
+    return false;
+  return WriteSymbolContainer(symbols.str(), kDefaultSymbolContainerBlockSize,
+                              sym_stream);
 }
 
 }  // namespace google_breakpad
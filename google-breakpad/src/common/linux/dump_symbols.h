@@ -46,11 +46,24 @@ namespace google_breakpad {
 // If OBJ_FILE has been stripped but contains a .gnu_debuglink section,
 // then look for the debug file in DEBUG_DIR.
 // If CFI is set to false, then omit the CFI section.
+// If COMPACT_CFI is set, write CFI rule sets that many STACK CFI records
+// share only once (see Module::SetCompactCFI). Older symbol file readers
+// don't understand the result.
 bool WriteSymbolFile(const std::string &obj_file,
                      const std::string &debug_dir,
                      bool cfi,
+                     bool compact_cfi,
                      std::ostream &sym_stream);
 
+// Like WriteSymbolFile, but write a block-compressed symbol container
+// (see common/symbol_container.h) to SYM_STREAM instead of a text
+// symbol file.
+bool WriteCompressedSymbolFile(const std::string &obj_file,
+                               const std::string &debug_dir,
+                               bool cfi,
+                               bool compact_cfi,
+                               std::ostream &sym_stream);
+
 }  // namespace google_breakpad
 
 #endif  // COMMON_LINUX_DUMP_SYMBOLS_H__
@@ -0,0 +1,644 @@
+// Copyright (c) 2010, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// dump_symbols_benchmark.cc: Time the stages of dump_syms on generated
+// ELF files.
+//
+// The input is built in memory with test_assembler, synth_elf and
+// cfi_assembler, so every run with the same options sees the same bytes:
+// a number of DWARF compilation units, each with a number of functions
+// nested a given depth of DW_TAG_inlined_subroutine DIEs deep, a line
+// number program with a given number of rows per function, a .debug_frame
+// section with a given number of FDEs, and a .dynsym symbol table.  Each
+// stage runs on its own, as dump_symbols.cc would run it, and then the
+// whole ELF file goes through WriteSymbolFileInternal.  The results are
+// written to stdout as a JSON object, so that builds can be compared
+// mechanically.  They include the process's peak resident set size after
+// each stage; since all the stages run in one process, that is the peak
+// over every stage run so far, not the stage's own.
+
+#include <elf.h>
+#include <link.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "common/dwarf/bytereader-inl.h"
+#include "common/dwarf/cfi_assembler.h"
+#include "common/dwarf/dwarf2diehandler.h"
+#include "common/dwarf/dwarf2reader.h"
+#include "common/dwarf_cfi_to_module.h"
+#include "common/dwarf_cu_to_module.h"
+#include "common/dwarf_line_to_module.h"
+#include "common/linux/elf_symbols_to_module.h"
+#include "common/linux/synth_elf.h"
+#include "common/module.h"
+#include "common/test_assembler.h"
+
+namespace google_breakpad {
+bool WriteSymbolFileInternal(uint8_t* obj_file,
+                             const std::string &obj_filename,
+                             const std::string &debug_dir,
+                             bool cfi,
+                             bool compact_cfi,
+                             std::ostream &sym_stream);
+}
+
+namespace {
+
+using google_breakpad::CFISection;
+using google_breakpad::DwarfCFIToModule;
+using google_breakpad::DwarfCUToModule;
+using google_breakpad::DwarfLineToModule;
+using google_breakpad::ELFSymbolsToModule;
+using google_breakpad::Module;
+using google_breakpad::WriteSymbolFileInternal;
+using google_breakpad::synth_elf::BuildIDNote;
+using google_breakpad::synth_elf::ELF;
+using google_breakpad::synth_elf::StringTable;
+using google_breakpad::synth_elf::SymbolTable;
+using google_breakpad::test_assembler::Label;
+using google_breakpad::test_assembler::Section;
+using google_breakpad::test_assembler::kLittleEndian;
+using std::string;
+using std::vector;
+
+// dump_symbols.cc can only read ELF files of the host's word size.
+#if __ELF_NATIVE_CLASS == 32
+const uint16_t kMachine = EM_386;
+const uint8_t kFileClass = ELFCLASS32;
+const unsigned kStackPointerRegister = 4;     // %esp
+const unsigned kFramePointerRegister = 5;     // %ebp
+const unsigned kReturnAddressRegister = 8;    // %eip
+#else
+const uint16_t kMachine = EM_X86_64;
+const uint8_t kFileClass = ELFCLASS64;
+const unsigned kStackPointerRegister = 7;     // %rsp
+const unsigned kFramePointerRegister = 6;     // %rbp
+const unsigned kReturnAddressRegister = 16;   // %rip
+#endif
+const size_t kAddressSize = sizeof(ElfW(Addr));
+
+// Functions are laid out kFunctionSize bytes apart from kTextBase.
+const uint64_t kTextBase = 0x10000;
+const uint64_t kFunctionSize = 0x40;
+
+// The abbreviation codes of the generated .debug_info DIEs.
+enum {
+  kCompileUnitAbbrev = 1,
+  kSubprogramAbbrev,
+  kInlinedSubroutineAbbrev
+};
+
+struct Options {
+  int compilation_units;   // compilation units in .debug_info
+  int functions;           // functions per compilation unit
+  int inline_depth;        // inlined subroutine DIEs nested in each function
+  int lines;               // line number rows per function
+  int fdes;                // FDEs in .debug_frame
+  int iterations;          // timed runs of each stage
+};
+
+// The sections of the generated file.
+struct Sections {
+  string debug_abbrev;
+  string debug_info;
+  string debug_line;
+  string debug_frame;
+  string dynsym;
+  string dynstr;
+  vector<uint8_t> elf;
+};
+
+// The timings of one stage.
+struct Result {
+  Result(const string &name, uint64_t bytes)
+      : name(name), bytes(bytes), iterations(0),
+        min_us(0), max_us(0), total_us(0), cumulative_peak_rss_kb(0) { }
+
+  string name;
+  uint64_t bytes;         // bytes of input per iteration
+  int iterations;
+  uint64_t min_us, max_us, total_us;
+  long cumulative_peak_rss_kb;  // the process's peak RSS so far
+};
+
+uint64_t NowMicroseconds() {
+  struct timeval now;
+  gettimeofday(&now, NULL);
+  return static_cast<uint64_t>(now.tv_sec) * 1000000 + now.tv_usec;
+}
+
+// Records the time since start as one iteration of result, along with
+// the process's peak RSS so far.
+void RecordIteration(uint64_t start, Result *result) {
+  uint64_t elapsed = NowMicroseconds() - start;
+  if (result->iterations == 0 || elapsed < result->min_us)
+    result->min_us = elapsed;
+  if (elapsed > result->max_us)
+    result->max_us = elapsed;
+  result->total_us += elapsed;
+  result->iterations++;
+
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) == 0)
+    result->cumulative_peak_rss_kb = usage.ru_maxrss;
+}
+
+uint64_t FunctionAddress(int function) {
+  return kTextBase + function * kFunctionSize;
+}
+
+void GenerateAbbrevs(Section *abbrev) {
+  abbrev->ULEB128(kCompileUnitAbbrev)
+      .ULEB128(dwarf2reader::DW_TAG_compile_unit)
+      .D8(dwarf2reader::DW_children_yes)
+      .ULEB128(dwarf2reader::DW_AT_name)
+      .ULEB128(dwarf2reader::DW_FORM_string)
+      .ULEB128(dwarf2reader::DW_AT_language)
+      .ULEB128(dwarf2reader::DW_FORM_data1)
+      .ULEB128(dwarf2reader::DW_AT_low_pc)
+      .ULEB128(dwarf2reader::DW_FORM_addr)
+      .ULEB128(dwarf2reader::DW_AT_high_pc)
+      .ULEB128(dwarf2reader::DW_FORM_addr)
+      .ULEB128(dwarf2reader::DW_AT_stmt_list)
+      .ULEB128(dwarf2reader::DW_FORM_data4)
+      .ULEB128(0).ULEB128(0);
+  abbrev->ULEB128(kSubprogramAbbrev)
+      .ULEB128(dwarf2reader::DW_TAG_subprogram)
+      .D8(dwarf2reader::DW_children_yes)
+      .ULEB128(dwarf2reader::DW_AT_name)
+      .ULEB128(dwarf2reader::DW_FORM_string)
+      .ULEB128(dwarf2reader::DW_AT_low_pc)
+      .ULEB128(dwarf2reader::DW_FORM_addr)
+      .ULEB128(dwarf2reader::DW_AT_high_pc)
+      .ULEB128(dwarf2reader::DW_FORM_addr)
+      .ULEB128(0).ULEB128(0);
+  abbrev->ULEB128(kInlinedSubroutineAbbrev)
+      .ULEB128(dwarf2reader::DW_TAG_inlined_subroutine)
+      .D8(dwarf2reader::DW_children_yes)
+      .ULEB128(dwarf2reader::DW_AT_low_pc)
+      .ULEB128(dwarf2reader::DW_FORM_addr)
+      .ULEB128(dwarf2reader::DW_AT_high_pc)
+      .ULEB128(dwarf2reader::DW_FORM_addr)
+      .ULEB128(dwarf2reader::DW_AT_call_line)
+      .ULEB128(dwarf2reader::DW_FORM_data4)
+      .ULEB128(0).ULEB128(0);
+  abbrev->ULEB128(0);
+}
+
+// Appends to line a DWARF 2 line number program for the compilation unit
+// whose functions begin with first_function, named file_name.
+void GenerateLineProgram(const Options &options, int first_function,
+                         const string &file_name, Section *line) {
+  Label unit_length, header_length, unit_start, header_start, program_start;
+  line->D32(unit_length);
+  line->Mark(&unit_start);
+  line->D16(2);                         // version
+  line->D32(header_length);
+  line->Mark(&header_start);
+  line->D8(1);                          // minimum_instruction_length
+  line->D8(1);                          // default_is_stmt
+  line->D8(static_cast<uint8_t>(-5));   // line_base
+  line->D8(14);                         // line_range
+  line->D8(10);                         // opcode_base
+  // standard_opcode_lengths, for opcodes 1 through 9.
+  line->D8(0).D8(1).D8(1).D8(1).D8(1).D8(0).D8(0).D8(0).D8(1);
+  line->D8(0);                          // no include_directories
+  line->AppendCString(file_name).ULEB128(0).ULEB128(0).ULEB128(0);
+  line->D8(0);                          // end of file_names
+  line->Mark(&program_start);
+
+  uint64_t step = kFunctionSize / options.lines;
+  for (int i = 0; i < options.functions; i++) {
+    int function = first_function + i;
+    line->D8(0).ULEB128(1 + kAddressSize)
+        .D8(dwarf2reader::DW_LNE_set_address);
+    line->Append(kLittleEndian, kAddressSize, FunctionAddress(function));
+    line->D8(dwarf2reader::DW_LNS_advance_line).LEB128(i * options.lines);
+    for (int row = 0; row < options.lines; row++) {
+      line->D8(dwarf2reader::DW_LNS_copy);
+      line->D8(dwarf2reader::DW_LNS_advance_line).LEB128(1);
+      line->D8(dwarf2reader::DW_LNS_advance_pc).ULEB128(step);
+    }
+    line->D8(dwarf2reader::DW_LNS_advance_pc)
+        .ULEB128(kFunctionSize - step * options.lines);
+    line->D8(0).ULEB128(1).D8(dwarf2reader::DW_LNE_end_sequence);
+    // The next sequence starts again at line 1.
+    line->D8(dwarf2reader::DW_LNS_advance_line)
+        .LEB128(-(i * options.lines + options.lines));
+  }
+
+  unit_length = line->Here() - unit_start;
+  header_length = program_start - header_start;
+}
+
+// Generates the DWARF sections: options.compilation_units compilation
+// units in .debug_info, each of options.functions functions, and their
+// line number programs.
+void GenerateDwarf(const Options &options, Sections *sections) {
+  Section abbrev(kLittleEndian), info(kLittleEndian), line(kLittleEndian);
+  abbrev.start() = 0;
+  info.start() = 0;
+  line.start() = 0;
+  GenerateAbbrevs(&abbrev);
+
+  for (int unit = 0; unit < options.compilation_units; unit++) {
+    int first_function = unit * options.functions;
+    std::ostringstream file_name;
+    file_name << "src/unit" << unit << ".cc";
+    uint64_t line_offset = line.Size();
+    GenerateLineProgram(options, first_function, file_name.str(), &line);
+
+    Label unit_length, unit_start;
+    info.D32(unit_length);
+    info.Mark(&unit_start);
+    info.D16(2);                        // version
+    info.D32(0);                        // offset of the abbreviations
+    info.D8(kAddressSize);
+
+    info.ULEB128(kCompileUnitAbbrev)
+        .AppendCString(file_name.str())
+        .D8(dwarf2reader::DW_LANG_C_plus_plus);
+    info.Append(kLittleEndian, kAddressSize, FunctionAddress(first_function));
+    info.Append(kLittleEndian, kAddressSize,
+                FunctionAddress(first_function + options.functions));
+    info.D32(line_offset);
+
+    for (int i = 0; i < options.functions; i++) {
+      int function = first_function + i;
+      std::ostringstream name;
+      name << "unit" << unit << "::Function" << i;
+      info.ULEB128(kSubprogramAbbrev).AppendCString(name.str());
+      info.Append(kLittleEndian, kAddressSize, FunctionAddress(function));
+      info.Append(kLittleEndian, kAddressSize,
+                  FunctionAddress(function) + kFunctionSize);
+      for (int depth = 0; depth < options.inline_depth; depth++) {
+        info.ULEB128(kInlinedSubroutineAbbrev);
+        info.Append(kLittleEndian, kAddressSize,
+                    FunctionAddress(function) + depth);
+        info.Append(kLittleEndian, kAddressSize,
+                    FunctionAddress(function) + kFunctionSize - depth);
+        info.D32(i * options.lines + depth);
+      }
+      // End the inlined subroutines' children, and then the function's.
+      for (int depth = 0; depth <= options.inline_depth; depth++)
+        info.ULEB128(0);
+    }
+    info.ULEB128(0);                    // end of the compilation unit's DIEs
+    unit_length = info.Here() - unit_start;
+  }
+
+  abbrev.GetContents(&sections->debug_abbrev);
+  info.GetContents(&sections->debug_info);
+  line.GetContents(&sections->debug_line);
+}
+
+// Generates a .debug_frame section with options.fdes FDEs, each
+// describing a function that pushes the frame pointer and then allocates
+// some stack.
+void GenerateCFI(const Options &options, Sections *sections) {
+  CFISection cfi(kLittleEndian, kAddressSize);
+  int data_alignment = -static_cast<int>(kAddressSize);
+  Label cie;
+  cfi.Mark(&cie)
+      .CIEHeader(1, data_alignment, kReturnAddressRegister)
+      .D8(dwarf2reader::DW_CFA_def_cfa)
+      .ULEB128(kStackPointerRegister).ULEB128(kAddressSize)
+      .D8(dwarf2reader::DW_CFA_offset | kReturnAddressRegister).ULEB128(1)
+      .FinishEntry();
+  for (int i = 0; i < options.fdes; i++) {
+    cfi.FDEHeader(cie, FunctionAddress(i), kFunctionSize)
+        .D8(dwarf2reader::DW_CFA_advance_loc | 1)
+        .D8(dwarf2reader::DW_CFA_def_cfa_offset).ULEB128(2 * kAddressSize)
+        .D8(dwarf2reader::DW_CFA_offset | kFramePointerRegister).ULEB128(2)
+        .D8(dwarf2reader::DW_CFA_advance_loc | 3)
+        .D8(dwarf2reader::DW_CFA_def_cfa_register)
+        .ULEB128(kFramePointerRegister)
+        .D8(dwarf2reader::DW_CFA_advance_loc | 0x30)
+        .D8(dwarf2reader::DW_CFA_def_cfa)
+        .ULEB128(kStackPointerRegister).ULEB128(kAddressSize)
+        .FinishEntry();
+  }
+  cfi.GetContents(&sections->debug_frame);
+}
+
+// Generates a .dynsym and .dynstr section with a symbol for every
+// function.
+void GenerateSymbols(const Options &options, Sections *sections) {
+  StringTable table(kLittleEndian);
+  SymbolTable symbols(kLittleEndian, kAddressSize, table);
+  int functions = options.compilation_units * options.functions;
+  for (int function = 0; function < functions; function++) {
+    std::ostringstream name;
+    name << "exported_function_" << function;
+#if __ELF_NATIVE_CLASS == 32
+    symbols.AddSymbol(name.str(),
+                      static_cast<uint32_t>(FunctionAddress(function)),
+                      static_cast<uint32_t>(kFunctionSize),
+                      ELF32_ST_INFO(STB_GLOBAL, STT_FUNC), SHN_UNDEF + 1);
+#else
+    symbols.AddSymbol(name.str(), FunctionAddress(function), kFunctionSize,
+                      ELF64_ST_INFO(STB_GLOBAL, STT_FUNC), SHN_UNDEF + 1);
+#endif
+  }
+  symbols.GetContents(&sections->dynsym);
+  table.GetContents(&sections->dynstr);
+}
+
+// Generates an ELF file holding all of the other sections.  (dump_symbols
+// reads .dynsym only from files without DWARF, so it is included for
+// realism rather than parsed by the write_symbol_file stage.)
+void GenerateELF(Sections *sections) {
+  ELF elf(kMachine, kFileClass, kLittleEndian);
+  const uint8_t build_id[] = { 0x0b, 0xad, 0xc0, 0xde, 0x0b, 0xad, 0xc0, 0xde,
+                               0x0b, 0xad, 0xc0, 0xde, 0x0b, 0xad, 0xc0, 0xde };
+  BuildIDNote::AppendSection(elf, build_id, sizeof(build_id));
+
+  Section abbrev(kLittleEndian), info(kLittleEndian), line(kLittleEndian),
+      frame(kLittleEndian), dynsym(kLittleEndian), dynstr(kLittleEndian);
+  abbrev.Append(sections->debug_abbrev);
+  info.Append(sections->debug_info);
+  line.Append(sections->debug_line);
+  frame.Append(sections->debug_frame);
+  dynsym.Append(sections->dynsym);
+  dynstr.Append(sections->dynstr);
+  elf.AddSection(".debug_abbrev", abbrev, SHT_PROGBITS);
+  elf.AddSection(".debug_info", info, SHT_PROGBITS);
+  elf.AddSection(".debug_line", line, SHT_PROGBITS);
+  elf.AddSection(".debug_frame", frame, SHT_PROGBITS);
+  int dynstr_index = elf.AddSection(".dynstr", dynstr, SHT_STRTAB);
+  elf.AddSection(".dynsym", dynsym, SHT_DYNSYM, SHF_ALLOC, 0, dynstr_index,
+                 sizeof(ElfW(Sym)));
+  elf.Finish();
+
+  string contents;
+  elf.GetContents(&contents);
+  sections->elf.assign(contents.begin(), contents.end());
+}
+
+// A line-to-module loader, as dump_symbols.cc uses.
+class LineToModule: public DwarfCUToModule::LineToModuleFunctor {
+ public:
+  explicit LineToModule(dwarf2reader::ByteReader *byte_reader)
+      : byte_reader_(byte_reader) { }
+  void operator()(const char *program, uint64 length,
+                  Module *module, vector<Module::Line> *lines) {
+    DwarfLineToModule handler(module, lines);
+    dwarf2reader::LineInfo parser(program, length, byte_reader_, &handler);
+    parser.Start();
+  }
+ private:
+  dwarf2reader::ByteReader *byte_reader_;
+};
+
+// Loads the DWARF compilation units into module, as dump_symbols.cc's
+// LoadDwarf does.
+void LoadDwarf(const Sections &sections, Module *module) {
+  dwarf2reader::ByteReader byte_reader(dwarf2reader::ENDIANNESS_LITTLE);
+  DwarfCUToModule::FileContext file_context("benchmark", module);
+  file_context.section_map[".debug_abbrev"] =
+      std::make_pair(sections.debug_abbrev.data(),
+                     static_cast<uint64>(sections.debug_abbrev.size()));
+  file_context.section_map[".debug_info"] =
+      std::make_pair(sections.debug_info.data(),
+                     static_cast<uint64>(sections.debug_info.size()));
+  file_context.section_map[".debug_line"] =
+      std::make_pair(sections.debug_line.data(),
+                     static_cast<uint64>(sections.debug_line.size()));
+
+  LineToModule line_to_module(&byte_reader);
+  for (uint64 offset = 0; offset < sections.debug_info.size();) {
+    DwarfCUToModule::WarningReporter reporter("benchmark", offset);
+    DwarfCUToModule root_handler(&file_context, &line_to_module, &reporter);
+    dwarf2reader::DIEDispatcher die_dispatcher(&root_handler);
+    dwarf2reader::CompilationUnit reader(file_context.section_map, offset,
+                                         &byte_reader, &die_dispatcher);
+    offset += reader.Start();
+  }
+}
+
+// Loads the .debug_frame section into module, as dump_symbols.cc's
+// LoadDwarfCFI does.
+void LoadDwarfCFI(const Sections &sections, Module *module) {
+#if __ELF_NATIVE_CLASS == 32
+  vector<string> register_names = DwarfCFIToModule::RegisterNames::I386();
+#else
+  vector<string> register_names = DwarfCFIToModule::RegisterNames::X86_64();
+#endif
+  DwarfCFIToModule::Reporter module_reporter("benchmark", ".debug_frame");
+  DwarfCFIToModule handler(module, register_names, &module_reporter);
+  dwarf2reader::ByteReader byte_reader(dwarf2reader::ENDIANNESS_LITTLE);
+  byte_reader.SetAddressSize(kAddressSize);
+  dwarf2reader::CallFrameInfo::Reporter dwarf_reporter("benchmark",
+                                                       ".debug_frame");
+  dwarf2reader::CallFrameInfo parser(sections.debug_frame.data(),
+                                     sections.debug_frame.size(),
+                                     &byte_reader, &handler, &dwarf_reporter,
+                                     false);
+  parser.Start();
+}
+
+Module *NewModule() {
+  return new Module("benchmark", "Linux", kMachine == EM_386 ? "x86" : "x86_64",
+                    "000102030405060708090A0B0C0D0E0F0");
+}
+
+void PrintResults(const Options &options, const vector<Result> &results) {
+  printf("{\n"
+         "  \"options\": {\"compilation_units\": %d, \"functions\": %d, "
+         "\"inline_depth\": %d, \"lines\": %d, \"fdes\": %d, "
+         "\"iterations\": %d},\n"
+         "  \"stages\": [\n",
+         options.compilation_units, options.functions, options.inline_depth,
+         options.lines, options.fdes, options.iterations);
+  for (size_t i = 0; i < results.size(); i++) {
+    const Result &result = results[i];
+    uint64_t mean_us = result.iterations ?
+                       result.total_us / result.iterations : 0;
+    printf("    {\"name\": \"%s\", \"iterations\": %d, \"min_us\": %llu, "
+           "\"mean_us\": %llu, \"max_us\": %llu, \"bytes\": %llu, "
+           "\"cumulative_peak_rss_kb\": %ld}%s\n",
+           result.name.c_str(), result.iterations,
+           static_cast<unsigned long long>(result.min_us),
+           static_cast<unsigned long long>(mean_us),
+           static_cast<unsigned long long>(result.max_us),
+           static_cast<unsigned long long>(result.bytes),
+           result.cumulative_peak_rss_kb,
+           i + 1 < results.size() ? "," : "");
+  }
+  printf("  ]\n"
+         "}\n");
+}
+
+bool RunBenchmarks(const Options &options) {
+  Sections sections;
+  GenerateDwarf(options, &sections);
+  GenerateCFI(options, &sections);
+  GenerateSymbols(options, &sections);
+  GenerateELF(&sections);
+
+  vector<Result> results;
+  Result dwarf("load_dwarf",
+               sections.debug_info.size() + sections.debug_line.size());
+  Result cfi("load_dwarf_cfi", sections.debug_frame.size());
+  Result symbols("elf_symbols_to_module", sections.dynsym.size());
+  Result write("module_write", 0);
+  Result whole("write_symbol_file", sections.elf.size());
+  size_t expected_functions = static_cast<size_t>(options.compilation_units) *
+                              options.functions;
+  for (int i = 0; i < options.iterations; i++) {
+    // Time only the stages themselves, not tearing down their results.
+    Module *module = NewModule();
+    uint64_t start = NowMicroseconds();
+    LoadDwarf(sections, module);
+    RecordIteration(start, &dwarf);
+
+    start = NowMicroseconds();
+    LoadDwarfCFI(sections, module);
+    RecordIteration(start, &cfi);
+
+    std::ostringstream stream;
+    start = NowMicroseconds();
+    if (!module->Write(stream, true)) {
+      fprintf(stderr, "module_write: could not write the module\n");
+      return false;
+    }
+    RecordIteration(start, &write);
+    write.bytes = stream.str().size();
+
+    vector<Module::Function *> functions;
+    module->GetFunctions(&functions, functions.end());
+    delete module;
+    if (functions.size() != expected_functions) {
+      fprintf(stderr, "load_dwarf: found %llu functions, expected %llu\n",
+              static_cast<unsigned long long>(functions.size()),
+              static_cast<unsigned long long>(expected_functions));
+      return false;
+    }
+
+    module = NewModule();
+    start = NowMicroseconds();
+    if (!ELFSymbolsToModule(
+            reinterpret_cast<const uint8_t *>(sections.dynsym.data()),
+            sections.dynsym.size(),
+            reinterpret_cast<const uint8_t *>(sections.dynstr.data()),
+            sections.dynstr.size(), false, kAddressSize, module)) {
+      fprintf(stderr, "elf_symbols_to_module: could not read symbols\n");
+      return false;
+    }
+    RecordIteration(start, &symbols);
+    delete module;
+
+    // WriteSymbolFileInternal modifies the ELF headers, so give it a copy.
+    vector<uint8_t> elf(sections.elf);
+    std::ostringstream whole_stream;
+    start = NowMicroseconds();
+    if (!WriteSymbolFileInternal(&elf[0], "benchmark", "", true, false,
+                                 whole_stream)) {
+      fprintf(stderr, "write_symbol_file: could not dump symbols\n");
+      return false;
+    }
+    RecordIteration(start, &whole);
+  }
+  results.push_back(dwarf);
+  results.push_back(cfi);
+  results.push_back(write);
+  results.push_back(symbols);
+  results.push_back(whole);
+
+  PrintResults(options, results);
+  return true;
+}
+
+void usage(const char *program_name) {
+  fprintf(stderr, "usage: %s [-u units] [-f functions] [-n inline-depth] "
+          "[-l lines] [-e fdes] [-i iterations]\n"
+          "    -u : DWARF compilation units (default 100)\n"
+          "    -f : Functions per compilation unit (default 100)\n"
+          "    -n : Inlined subroutine DIEs nested in each function "
+          "(default 2)\n"
+          "    -l : Line number rows per function, up to 64 (default 8)\n"
+          "    -e : FDEs in .debug_frame (default 10000)\n"
+          "    -i : Timed iterations of each stage (default 5)\n",
+          program_name);
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  Options options;
+  options.compilation_units = 100;
+  options.functions = 100;
+  options.inline_depth = 2;
+  options.lines = 8;
+  options.fdes = 10000;
+  options.iterations = 5;
+
+  for (int argi = 1; argi < argc; argi += 2) {
+    int *value = NULL;
+    if (strcmp(argv[argi], "-u") == 0) {
+      value = &options.compilation_units;
+    } else if (strcmp(argv[argi], "-f") == 0) {
+      value = &options.functions;
+    } else if (strcmp(argv[argi], "-n") == 0) {
+      value = &options.inline_depth;
+    } else if (strcmp(argv[argi], "-l") == 0) {
+      value = &options.lines;
+    } else if (strcmp(argv[argi], "-e") == 0) {
+      value = &options.fdes;
+    } else if (strcmp(argv[argi], "-i") == 0) {
+      value = &options.iterations;
+    }
+    if (!value || argi + 1 >= argc) {
+      usage(argv[0]);
+      return 1;
+    }
+    *value = atoi(argv[argi + 1]);
+  }
+
+  // Each line number row must cover at least one byte, and each inlined
+  // subroutine must be nested within its parent.
+  if (options.compilation_units < 1 || options.functions < 1 ||
+      options.inline_depth < 0 ||
+      options.inline_depth >= static_cast<int>(kFunctionSize) / 2 ||
+      options.lines < 1 || options.lines > static_cast<int>(kFunctionSize) ||
+      options.fdes < 0 || options.iterations < 1) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  return RunBenchmarks(options) ? 0 : 1;
+}
@@ -48,6 +48,7 @@ bool WriteSymbolFileInternal(uint8_t* obj_file,
                              const std::string &obj_filename,
                              const std::string &debug_dir,
                              bool cfi,
+                             bool compact_cfi,
                              std::ostream &sym_stream);
 }
 
@@ -86,6 +87,7 @@ TEST_F(DumpSymbols, Invalid) {
                                        "foo",
                                        "",
                                        true,
+                                       false,
                                        s));
 }
 
@@ -121,6 +123,7 @@ TEST_F(DumpSymbols, SimplePublic32) {
                                       "foo",
                                       "",
                                       true,
+                                      false,
                                       s));
   EXPECT_EQ("MODULE Linux x86 000000000000000000000000000000000 foo\n"
             "PUBLIC 1000 0 superfunc\n",
@@ -158,6 +161,7 @@ TEST_F(DumpSymbols, SimplePublic64) {
                                       "foo",
                                       "",
                                       true,
+                                      false,
                                       s));
   EXPECT_EQ("MODULE Linux x86_64 000000000000000000000000000000000 foo\n"
             "PUBLIC 1000 0 superfunc\n",
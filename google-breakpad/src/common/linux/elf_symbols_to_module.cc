@@ -32,107 +32,80 @@
 
 #include "common/linux/elf_symbols_to_module.h"
 
+#include <assert.h>
 #include <elf.h>
 #include <string.h>
 
+#include <algorithm>
+#include <vector>
+
 #include "common/byte_cursor.h"
 #include "common/module.h"
 
 namespace google_breakpad {
 
-class ELFSymbolIterator {
-public:
-  // The contents of an ELF symbol, adjusted for the host's endianness,
-  // word size, and so on. Corresponds to the data in Elf32_Sym / Elf64_Sym.
-  struct Symbol {
-    // True if this iterator has reached the end of the symbol array. When
-    // this is set, the other members of this structure are not valid.
-    bool at_end;
-
-    // The number of this symbol within the list.
-    size_t index;
-
-    // The current symbol's name offset. This is the offset within the
-    // string table.
-    size_t name_offset;
-
-    // The current symbol's value, size, info and shndx fields.
-    uint64_t value;
-    uint64_t size;
-    unsigned char info;
-    uint16_t shndx;
-  };
-
-  // Create an ELFSymbolIterator walking the symbols in BUFFER. Treat the
-  // symbols as big-endian if BIG_ENDIAN is true, as little-endian
-  // otherwise. Assume each symbol has a 'value' field whose size is
-  // VALUE_SIZE.
-  //
-  ELFSymbolIterator(const ByteBuffer *buffer, bool big_endian,
-                    size_t value_size)
-    : value_size_(value_size), cursor_(buffer, big_endian) {
-    // Actually, weird sizes could be handled just fine, but they're
-    // probably mistakes --- expressed in bits, say.
-    assert(value_size == 4 || value_size == 8);
-    symbol_.index = 0;
-    Fetch();
-  }
+using std::vector;
 
-  // Move to the next symbol. This function's behavior is undefined if
-  // at_end() is true when it is called.
-  ELFSymbolIterator &operator++() { Fetch(); symbol_.index++; return *this; }
-
-  // Dereferencing this iterator produces a reference to an Symbol structure
-  // that holds the current symbol's values. The symbol is owned by this
-  // SymbolIterator, and will be invalidated at the next call to operator++.
-  const Symbol &operator*() const { return symbol_; }
-  const Symbol *operator->() const { return &symbol_; }
-
-private:
-  // Read the symbol at cursor_, and set symbol_ appropriately.
-  void Fetch() {
-    // Elf32_Sym and Elf64_Sym have different layouts.
-    unsigned char other;
-    if (value_size_ == 4) {
-      // Elf32_Sym
-      cursor_
-        .Read(4, false, &symbol_.name_offset)
-        .Read(4, false, &symbol_.value)
-        .Read(4, false, &symbol_.size)
-        .Read(1, false, &symbol_.info)
-        .Read(1, false, &other)
-        .Read(2, false, &symbol_.shndx);
-    } else {
-      // Elf64_Sym
-      cursor_
-        .Read(4, false, &symbol_.name_offset)
-        .Read(1, false, &symbol_.info)
-        .Read(1, false, &other)
-        .Read(2, false, &symbol_.shndx)
-        .Read(8, false, &symbol_.value)
-        .Read(8, false, &symbol_.size);
-    }
-    symbol_.at_end = !cursor_;
-  }
+namespace {
 
-  // The size of symbols' value field, in bytes.
-  size_t value_size_;
+// A function symbol found in the symbol table, with its name still in
+// the string section.
+struct FunctionSymbol {
+  uint64_t address;
+  const char *name;
+};
 
-  // A byte cursor traversing buffer_.
-  ByteCursor cursor_;
+bool CompareFunctionSymbolsByAddress(const FunctionSymbol &a,
+                                     const FunctionSymbol &b) {
+  return a.address < b.address;
+}
 
-  // Values for the symbol this iterator refers to.
-  Symbol symbol_;
-};
+bool FunctionSymbolAddressesEqual(const FunctionSymbol &a,
+                                  const FunctionSymbol &b) {
+  return a.address == b.address;
+}
 
-const char *SymbolString(ptrdiff_t offset, ByteBuffer& strings) {
-  if (offset < 0 || (size_t) offset >= strings.Size()) {
+const char *SymbolString(uint64_t offset, const ByteBuffer &strings) {
+  if (offset >= strings.Size()) {
     // Return the null string.
     offset = 0;
   }
   return reinterpret_cast<const char *>(strings.start + offset);
 }
 
+// Append the defined function symbols in SYMBOLS to FUNCTIONS, with
+// their names taken from STRINGS. Treat the symbols as big-endian if
+// BIG_ENDIAN is true, as little-endian otherwise. If VALUE_SIZE is 4,
+// the symbols are Elf32_Sym structures; if it is 8, they are Elf64_Sym
+// structures. Ignore any partial symbol at the end of SYMBOLS.
+template<bool big_endian, size_t value_size>
+void FindFunctionSymbols(const ByteBuffer &symbols, const ByteBuffer &strings,
+                         vector<FunctionSymbol> *functions) {
+  // Elf32_Sym and Elf64_Sym have different layouts. Get the offsets of
+  // the fields we care about.
+  const size_t symbol_size = value_size == 4 ? 16 : 24;
+  const size_t value_offset = value_size == 4 ? 4 : 8;
+  const size_t info_offset = value_size == 4 ? 12 : 4;
+  const size_t shndx_offset = value_size == 4 ? 14 : 6;
+
+  const size_t count = symbols.Size() / symbol_size;
+  const uint8_t *symbol = symbols.start;
+  for (size_t i = 0; i < count; i++, symbol += symbol_size) {
+    if (ELF32_ST_TYPE(symbol[info_offset]) != STT_FUNC ||
+        ReadUnalignedUnsigned<big_endian, 2>(symbol + shndx_offset)
+        == SHN_UNDEF)
+      continue;
+    FunctionSymbol function;
+    function.address =
+        ReadUnalignedUnsigned<big_endian, value_size>(symbol + value_offset);
+    function.name =
+        SymbolString(ReadUnalignedUnsigned<big_endian, 4>(symbol), strings);
+    functions->push_back(function);
+  }
+}
+
+}  // namespace
+
 bool ELFSymbolsToModule(const uint8_t *symtab_section,
                         size_t symtab_size,
                         const uint8_t *string_section,
@@ -140,6 +113,10 @@ bool ELFSymbolsToModule(const uint8_t *symtab_section,
                         const bool big_endian,
                         size_t value_size,
                         Module *module) {
+  // Actually, weird sizes could be handled just fine, but they're
+  // probably mistakes --- expressed in bits, say.
+  assert(value_size == 4 || value_size == 8);
+
   ByteBuffer symbols(symtab_section, symtab_size);
   // Ensure that the string section is null-terminated.
   if (string_section[string_size - 1] != '\0') {
@@ -149,19 +126,41 @@ bool ELFSymbolsToModule(const uint8_t *symtab_section,
   }
   ByteBuffer strings(string_section, string_size);
 
-  // The iterator walking the symbol table.
-  ELFSymbolIterator iterator(&symbols, big_endian, value_size);
-
-  while(!iterator->at_end) {
-    if (ELF32_ST_TYPE(iterator->info) == STT_FUNC &&
-        iterator->shndx != SHN_UNDEF) {
-      Module::Extern *ext = new Module::Extern;
-      ext->name = SymbolString(iterator->name_offset, strings);
-      ext->address = iterator->value;
-      module->AddExtern(ext);
-    }
-    ++iterator;
+  // Gather up the function symbols in a single pass over the table,
+  // leaving their names in the string section for now.
+  vector<FunctionSymbol> functions;
+  if (big_endian) {
+    if (value_size == 4)
+      FindFunctionSymbols<true, 4>(symbols, strings, &functions);
+    else
+      FindFunctionSymbols<true, 8>(symbols, strings, &functions);
+  } else {
+    if (value_size == 4)
+      FindFunctionSymbols<false, 4>(symbols, strings, &functions);
+    else
+      FindFunctionSymbols<false, 8>(symbols, strings, &functions);
+  }
+
+  // The module keeps only the first extern it sees at a given address.
+  // Do the same here, so that we only copy the names we'll keep: a
+  // stable sort leaves the first symbol at each address at the front of
+  // its run of duplicates, where 'unique' will keep it.
+  std::stable_sort(functions.begin(), functions.end(),
+                   CompareFunctionSymbolsByAddress);
+  functions.erase(std::unique(functions.begin(), functions.end(),
+                              FunctionSymbolAddressesEqual),
+                  functions.end());
+
+  vector<Module::Extern *> externs;
+  externs.reserve(functions.size());
+  for (vector<FunctionSymbol>::const_iterator it = functions.begin();
+       it != functions.end(); ++it) {
+    Module::Extern *ext = new Module::Extern;
+    ext->name = it->name;
+    ext->address = it->address;
+    externs.push_back(ext);
   }
+  module->AddExterns(externs.begin(), externs.end());
   return true;
 }
 
@@ -0,0 +1,109 @@
+// Copyright (c) 2010, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// arch_utilities.cc: Implementation of the architecture lookup functions
+// declared in arch_utilities.h.
+
+#include "common/mac/arch_utilities.h"
+
+#include <string.h>
+
+namespace google_breakpad {
+
+namespace {
+
+// The architectures we know about. For each CPU type, the first entry is
+// the general architecture, used for subtypes not listed here.
+const ArchInfo kArchInfo[] = {
+  { "i386",   CPU_TYPE_I386,      CPU_SUBTYPE_I386_ALL },
+  { "x86_64", CPU_TYPE_X86_64,    CPU_SUBTYPE_X86_64_ALL },
+  { "ppc",    CPU_TYPE_POWERPC,   CPU_SUBTYPE_POWERPC_ALL },
+  { "ppc64",  CPU_TYPE_POWERPC64, CPU_SUBTYPE_POWERPC_ALL },
+  { "arm",    CPU_TYPE_ARM,       CPU_SUBTYPE_ARM_ALL },
+  { "armv6",  CPU_TYPE_ARM,       CPU_SUBTYPE_ARM_V6 },
+  { "armv7",  CPU_TYPE_ARM,       CPU_SUBTYPE_ARM_V7 },
+};
+
+const size_t kArchInfoCount = sizeof(kArchInfo) / sizeof(kArchInfo[0]);
+
+}  // namespace
+
+const ArchInfo *GetArchInfoFromName(const char *name) {
+  for (size_t i = 0; i < kArchInfoCount; i++) {
+    if (strcmp(kArchInfo[i].name, name) == 0)
+      return &kArchInfo[i];
+  }
+  return NULL;
+}
+
+const ArchInfo *GetArchInfoFromCpuType(cpu_type_t cpu_type,
+                                       cpu_subtype_t cpu_subtype) {
+  // The high bits of a subtype are feature flags, not part of the
+  // architecture proper.
+  cpu_subtype &= ~CPU_SUBTYPE_MASK;
+  const ArchInfo *general = NULL;
+  for (size_t i = 0; i < kArchInfoCount; i++) {
+    if (kArchInfo[i].cpu_type != cpu_type)
+      continue;
+    if (kArchInfo[i].cpu_subtype == cpu_subtype)
+      return &kArchInfo[i];
+    if (!general)
+      general = &kArchInfo[i];
+  }
+  return general;
+}
+
+const char *GetModuleArchitectureName(cpu_type_t cpu_type,
+                                      cpu_subtype_t cpu_subtype) {
+  const ArchInfo *arch = GetArchInfoFromCpuType(cpu_type, cpu_subtype);
+  if (!arch)
+    return NULL;
+  if (arch->cpu_type == CPU_TYPE_I386)
+    return "x86";
+  return arch->name;
+}
+
+const struct fat_arch *FindBestFatArch(cpu_type_t cpu_type,
+                                       cpu_subtype_t cpu_subtype,
+                                       const struct fat_arch *object_files,
+                                       size_t count) {
+  const struct fat_arch *best = NULL;
+  for (size_t i = 0; i < count; i++) {
+    if (object_files[i].cputype != cpu_type)
+      continue;
+    if ((object_files[i].cpusubtype & ~CPU_SUBTYPE_MASK) ==
+        (cpu_subtype & ~CPU_SUBTYPE_MASK))
+      return &object_files[i];
+    if (!best)
+      best = &object_files[i];
+  }
+  return best;
+}
+
+}  // namespace google_breakpad
@@ -0,0 +1,83 @@
+// -*- mode: C++ -*-
+
+// Copyright (c) 2010, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// arch_utilities.h: Map between Mach-O CPU types and the architecture
+// names dump_syms uses ("i386", "x86_64", "ppc", "armv7", and so on).
+// These stand in for the NXArchInfo functions from <mach-o/arch.h>,
+// which are only available on Mac OS X.
+
+#ifndef BREAKPAD_COMMON_MAC_ARCH_UTILITIES_H_
+#define BREAKPAD_COMMON_MAC_ARCH_UTILITIES_H_
+
+#include <stddef.h>
+
+#include "common/mac/macho_headers.h"
+
+namespace google_breakpad {
+
+// A Mach-O architecture: its conventional name, and the CPU type and
+// subtype that identify it in Mach-O headers.
+struct ArchInfo {
+  const char *name;
+  cpu_type_t cpu_type;
+  cpu_subtype_t cpu_subtype;
+};
+
+// Return the architecture named |name|, or NULL if we don't know of one.
+const ArchInfo *GetArchInfoFromName(const char *name);
+
+// Return the architecture for |cpu_type| and |cpu_subtype|. If we don't
+// know that particular subtype, return the general architecture for
+// |cpu_type|. If we don't recognize |cpu_type| at all, return NULL.
+const ArchInfo *GetArchInfoFromCpuType(cpu_type_t cpu_type,
+                                       cpu_subtype_t cpu_subtype);
+
+// Return the name that should appear in the MODULE record of a Breakpad
+// symbol file for |cpu_type| and |cpu_subtype|, or NULL if we don't
+// recognize |cpu_type|. This is the architecture's name, except that
+// Breakpad calls i386 "x86".
+const char *GetModuleArchitectureName(cpu_type_t cpu_type,
+                                      cpu_subtype_t cpu_subtype);
+
+// Return the element of |object_files| (an array of |count| 'struct
+// fat_arch' structures) that best matches |cpu_type| and |cpu_subtype|,
+// or NULL if none has the requested CPU type. An object file whose
+// subtype matches exactly is preferred; otherwise, the first object file
+// of the right CPU type is used. This is a portable replacement for
+// NXFindBestFatArch.
+const struct fat_arch *FindBestFatArch(cpu_type_t cpu_type,
+                                       cpu_subtype_t cpu_subtype,
+                                       const struct fat_arch *object_files,
+                                       size_t count);
+
+}  // namespace google_breakpad
+
+#endif  // BREAKPAD_COMMON_MAC_ARCH_UTILITIES_H_
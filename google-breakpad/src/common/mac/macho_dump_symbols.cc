@@ -0,0 +1,727 @@
+// Copyright (c) 2010, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// macho_dump_symbols.cc: Implement google_breakpad::MachoDumpSymbols.
+// See macho_dump_symbols.h for details.
+
+#include "common/mac/macho_dump_symbols.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/byte_cursor.h"
+#include "common/dwarf/bytereader-inl.h"
+#include "common/dwarf/dwarf2reader.h"
+#include "common/dwarf_cfi_to_module.h"
+#include "common/dwarf_cu_to_module.h"
+#include "common/dwarf_line_to_module.h"
+#include "common/mac/arch_utilities.h"
+#include "common/md5.h"
+#include "common/stabs_reader.h"
+#include "common/stabs_to_module.h"
+
+namespace google_breakpad {
+
+using dwarf2reader::ByteReader;
+using std::make_pair;
+
+namespace {
+
+// Return true if |path| names a regular file.
+bool IsRegularFile(const string &path) {
+  struct stat st;
+  return stat(path.c_str(), &st) == 0 && S_ISREG(st.st_mode);
+}
+
+// Return true if |path| names a directory.
+bool IsDirectory(const string &path) {
+  struct stat st;
+  return stat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+// Return the final component of |path|, ignoring any trailing slashes.
+string BaseName(const string &path) {
+  size_t end = path.find_last_not_of('/');
+  if (end == string::npos)
+    return path;
+  size_t slash = path.rfind('/', end);
+  size_t start = (slash == string::npos) ? 0 : slash + 1;
+  return path.substr(start, end + 1 - start);
+}
+
+// If |bundle| is a dSYM bundle, set |*dwarf_file| to the name of the file
+// within it that holds the DWARF data, and return true. Otherwise, return
+// false.
+bool FindDwarfResource(const string &bundle, string *dwarf_file) {
+  // Filenames referring to bundles usually have names of the form
+  // "<basename>.dSYM"; however, if the user has specified a wrapper
+  // suffix (the WRAPPER_SUFFIX and WRAPPER_EXTENSION build settings),
+  // then the name may have the form "<basename>.<extension>.dSYM". In
+  // either case, the file containing the DWARF info within the bundle is
+  // Contents/Resources/DWARF/<basename>.
+  //
+  // Since there's no way to tell how much to strip off, remove one
+  // extension at a time, and use the first name that exists.
+  const string dwarf_directory = bundle + "/Contents/Resources/DWARF/";
+  string base_name = BaseName(bundle);
+  for (;;) {
+    size_t dot = base_name.rfind('.');
+    if (dot == string::npos || dot == 0)
+      return false;
+    base_name.erase(dot);
+    if (IsRegularFile(dwarf_directory + base_name)) {
+      *dwarf_file = dwarf_directory + base_name;
+      return true;
+    }
+  }
+}
+
+// A LoadCommandHandler that looks for a Mach-O file's LC_UUID load
+// command.
+class UUIDFinder: public mach_o::Reader::LoadCommandHandler {
+ public:
+  explicit UUIDFinder(bool big_endian)
+      : big_endian_(big_endian), found_(false) { }
+
+  bool UnknownCommand(mach_o::LoadCommandType type,
+                      const ByteBuffer &contents) {
+    if (type != LC_UUID)
+      return true;
+    // The UUID follows the command type and size fields.
+    ByteCursor cursor(&contents, big_endian_);
+    cursor.Skip(8).Read(uuid_, sizeof(uuid_));
+    found_ = cursor;
+    return true;
+  }
+
+  bool found() const { return found_; }
+  const uint8_t *uuid() const { return uuid_; }
+
+ private:
+  bool big_endian_;
+  bool found_;
+  uint8_t uuid_[16];
+};
+
+// A LoadCommandHandler that computes an MD5 hash of the contents of every
+// section in a Mach-O file that has contents. This covers the same bytes
+// as MacFileUtilities::MachoID::MD5, so files with no LC_UUID command get
+// the same identifier the Mac dumper would give them.
+class SectionHasher: public mach_o::Reader::LoadCommandHandler,
+                     public mach_o::Reader::SectionHandler {
+ public:
+  // Create a hasher for the sections of the Mach-O file that |reader|
+  // has parsed, which starts at |file_start|.
+  SectionHasher(const mach_o::Reader &reader, const uint8_t *file_start)
+      : reader_(reader), file_start_(file_start) {
+    MD5Init(&md5_);
+  }
+
+  bool SegmentCommand(const mach_o::Segment &segment) {
+    return reader_.WalkSegmentSections(segment, this);
+  }
+
+  bool HandleSection(const mach_o::Section &section) {
+    // Zero-fill sections, and the sections of segments whose contents
+    // have been stripped (as in dSYM files), have no contents. MachoID
+    // also skips sections whose file offset is zero.
+    if (!section.contents.start || section.contents.start == file_start_)
+      return true;
+    const uint8_t *data = section.contents.start;
+    size_t size = section.contents.Size();
+    // MD5Update takes an 'unsigned' length.
+    while (size > 0) {
+      unsigned chunk = size > 0x40000000 ? 0x40000000 : unsigned(size);
+      MD5Update(&md5_, data, chunk);
+      data += chunk;
+      size -= chunk;
+    }
+    return true;
+  }
+
+  void Final(uint8_t digest[16]) { MD5Final(digest, &md5_); }
+
+ private:
+  const mach_o::Reader &reader_;
+  const uint8_t *file_start_;
+  MD5Context md5_;
+};
+
+// The work one thread does for MachoDumpSymbols::WriteSymbolFiles.
+struct DumpJob {
+  const MachoDumpSymbols *dumper;
+  const struct fat_arch *object_file;
+  std::ostream *stream;
+  bool cfi;
+  bool result;
+
+  void Run() {
+    result = dumper->WriteSymbolFile(*object_file, cfi, *stream);
+  }
+};
+
+// The work one thread does for MachoDumpSymbols::Identifiers.
+struct IdentifierJob {
+  const MachoDumpSymbols *dumper;
+  const struct fat_arch *object_file;
+  string *identifier;
+  bool result;
+
+  void Run() {
+    result = dumper->Identifier(*object_file, identifier);
+  }
+};
+
+// A pthread start routine that runs the Job its argument points to.
+template<typename Job>
+void *RunJob(void *arg) {
+  static_cast<Job *>(arg)->Run();
+  return NULL;
+}
+
+// Run each element of |jobs| on its own thread, and wait for them all to
+// finish. Each architecture is an independent Mach-O file within the
+// mapping, with its own reader, so they can all be processed at once.
+// The last job, and any we can't start a thread for, run on the calling
+// thread. Return true if every job's 'result' member is true.
+template<typename Job>
+bool RunJobs(vector<Job> *jobs) {
+  vector<pthread_t> threads(jobs->size());
+  vector<bool> started(jobs->size(), false);
+  for (size_t i = 0; i + 1 < jobs->size(); i++) {
+    if (pthread_create(&threads[i], NULL, RunJob<Job>, &(*jobs)[i]) == 0)
+      started[i] = true;
+  }
+  for (size_t i = 0; i < jobs->size(); i++) {
+    if (!started[i])
+      (*jobs)[i].Run();
+  }
+
+  bool result = true;
+  for (size_t i = 0; i < jobs->size(); i++) {
+    if (started[i])
+      pthread_join(threads[i], NULL);
+    result = result && (*jobs)[i].result;
+  }
+  return result;
+}
+
+}  // namespace
+
+MachoDumpSymbols::~MachoDumpSymbols() {
+  if (contents_)
+    munmap(const_cast<uint8_t *>(contents_), contents_size_);
+}
+
+bool MachoDumpSymbols::Read(const string &filename) {
+  // Let go of any file read before.
+  if (contents_)
+    munmap(const_cast<uint8_t *>(contents_), contents_size_);
+  contents_ = NULL;
+  contents_size_ = 0;
+  object_files_.clear();
+  selected_object_file_ = NULL;
+
+  input_pathname_ = filename;
+
+  // Does this filename refer to a dSYM bundle?
+  if (IsDirectory(input_pathname_)) {
+    if (!FindDwarfResource(input_pathname_, &object_filename_)) {
+      fprintf(stderr, "Unable to find DWARF-bearing file in bundle: %s\n",
+              input_pathname_.c_str());
+      return false;
+    }
+  } else {
+    object_filename_ = input_pathname_;
+  }
+
+  // Map the file's contents into memory. Each architecture's reader
+  // refers directly to the mapped bytes, so nothing is copied.
+  int fd = open(object_filename_.c_str(), O_RDONLY);
+  if (fd < 0) {
+    fprintf(stderr, "Error opening object file: %s: %s\n",
+            object_filename_.c_str(), strerror(errno));
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    fprintf(stderr, "Error reading object file: %s: %s\n",
+            object_filename_.c_str(), strerror(errno));
+    close(fd);
+    return false;
+  }
+  if (st.st_size == 0) {
+    fprintf(stderr, "Object file is empty: %s\n", object_filename_.c_str());
+    close(fd);
+    return false;
+  }
+  void *contents = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (contents == MAP_FAILED) {
+    fprintf(stderr, "Error mapping object file: %s: %s\n",
+            object_filename_.c_str(), strerror(errno));
+    return false;
+  }
+  contents_ = static_cast<const uint8_t *>(contents);
+  contents_size_ = st.st_size;
+
+  // Get the list of object files present in the file.
+  mach_o::FatReader::Reporter fat_reporter(object_filename_);
+  mach_o::FatReader fat_reader(&fat_reporter);
+  if (!fat_reader.Read(contents_, contents_size_))
+    return false;
+
+  // Get our own copy of fat_reader's object file list.
+  size_t object_files_count;
+  const struct fat_arch *object_files =
+    fat_reader.object_files(&object_files_count);
+  if (object_files_count == 0) {
+    fprintf(stderr, "Fat binary file contains *no* architectures: %s\n",
+            object_filename_.c_str());
+    return false;
+  }
+  object_files_.assign(object_files, object_files + object_files_count);
+
+  return true;
+}
+
+const struct fat_arch *MachoDumpSymbols::FindObjectFile(
+    cpu_type_t cpu_type, cpu_subtype_t cpu_subtype) const {
+  if (object_files_.empty())
+    return NULL;
+  return FindBestFatArch(cpu_type, cpu_subtype, &object_files_[0],
+                         object_files_.size());
+}
+
+bool MachoDumpSymbols::SetArchitecture(cpu_type_t cpu_type,
+                                       cpu_subtype_t cpu_subtype) {
+  // Find the best match for the architecture the user requested.
+  const struct fat_arch *best_match = FindObjectFile(cpu_type, cpu_subtype);
+  if (!best_match) return false;
+
+  // Record the selected object file.
+  selected_object_file_ = best_match;
+  return true;
+}
+
+bool MachoDumpSymbols::SetArchitecture(const string &arch_name) {
+  const ArchInfo *arch_info = GetArchInfoFromName(arch_name.c_str());
+  if (!arch_info)
+    return false;
+  return SetArchitecture(arch_info->cpu_type, arch_info->cpu_subtype);
+}
+
+string MachoDumpSymbols::ObjectName(const char *arch_name) const {
+  string object_name = object_filename_;
+  if (object_files_.size() > 1) {
+    object_name += ", architecture ";
+    object_name += arch_name;
+  }
+  return object_name;
+}
+
+bool MachoDumpSymbols::ReaderIdentifier(const mach_o::Reader &reader,
+                                        const uint8_t *object_start,
+                                        const string &object_name,
+                                        string *identifier) const {
+  uint8_t identifier_bytes[16];
+
+  // Prefer the UUID the linker recorded in the file.
+  UUIDFinder uuid_finder(reader.big_endian());
+  if (!reader.WalkLoadCommands(&uuid_finder))
+    return false;
+  if (uuid_finder.found()) {
+    memcpy(identifier_bytes, uuid_finder.uuid(), sizeof(identifier_bytes));
+  } else {
+    // Older files have no UUID; hash their sections' contents instead.
+    SectionHasher hasher(reader, object_start);
+    if (!reader.WalkLoadCommands(&hasher)) {
+      fprintf(stderr, "Unable to calculate UUID of mach-o binary %s!\n",
+              object_name.c_str());
+      return false;
+    }
+    hasher.Final(identifier_bytes);
+  }
+
+  char identifier_string[33];
+  for (size_t i = 0; i < sizeof(identifier_bytes); i++)
+    snprintf(identifier_string + 2 * i, 3, "%02X", identifier_bytes[i]);
+  *identifier = identifier_string;
+  return true;
+}
+
+// A line-to-module loader that accepts line number info parsed by
+// dwarf2reader::LineInfo and populates a Module and a line vector
+// with the results.
+class MachoDumpSymbols::DumperLineToModule:
+      public DwarfCUToModule::LineToModuleFunctor {
+ public:
+  // Create a line-to-module converter using BYTE_READER.
+  DumperLineToModule(dwarf2reader::ByteReader *byte_reader)
+      : byte_reader_(byte_reader) { }
+  void operator()(const char *program, uint64 length,
+                  Module *module, vector<Module::Line> *lines) {
+    DwarfLineToModule handler(module, lines);
+    dwarf2reader::LineInfo parser(program, length, byte_reader_, &handler);
+    parser.Start();
+  }
+ private:
+  dwarf2reader::ByteReader *byte_reader_;  // WEAK
+};
+
+bool MachoDumpSymbols::ReadDwarf(Module *module,
+                                 const mach_o::Reader &macho_reader,
+                                 const mach_o::SectionMap &dwarf_sections,
+                                 const string &object_name) const {
+  // Build a byte reader of the appropriate endianness.
+  ByteReader byte_reader(macho_reader.big_endian()
+                         ? dwarf2reader::ENDIANNESS_BIG
+                         : dwarf2reader::ENDIANNESS_LITTLE);
+
+  // Construct a context for this file.
+  DwarfCUToModule::FileContext file_context(object_name, module);
+
+  // Build a dwarf2reader::SectionMap from our mach_o::SectionMap.
+  for (mach_o::SectionMap::const_iterator it = dwarf_sections.begin();
+       it != dwarf_sections.end(); it++) {
+    file_context.section_map[it->first] =
+      make_pair(reinterpret_cast<const char *>(it->second.contents.start),
+                it->second.contents.Size());
+  }
+
+  // Find the __debug_info section.
+  std::pair<const char *, uint64> debug_info_section
+      = file_context.section_map["__debug_info"];
+  // There had better be a __debug_info section!
+  if (!debug_info_section.first) {
+    fprintf(stderr, "%s: __DWARF segment of file has no __debug_info section\n",
+            object_name.c_str());
+    return false;
+  }
+
+  // Build a line-to-module loader for the root handler to use.
+  DumperLineToModule line_to_module(&byte_reader);
+
+  // Walk the __debug_info section, one compilation unit at a time.
+  uint64 debug_info_length = debug_info_section.second;
+  for (uint64 offset = 0; offset < debug_info_length;) {
+    // Make a handler for the root DIE that populates MODULE with the
+    // debug info.
+    DwarfCUToModule::WarningReporter reporter(object_name, offset);
+    DwarfCUToModule root_handler(&file_context, &line_to_module, &reporter);
+    // Make a Dwarf2Handler that drives our DIEHandler.
+    dwarf2reader::DIEDispatcher die_dispatcher(&root_handler);
+    // Make a DWARF parser for the compilation unit at OFFSET.
+    dwarf2reader::CompilationUnit dwarf_reader(file_context.section_map,
+                                               offset,
+                                               &byte_reader,
+                                               &die_dispatcher);
+    // Process the entire compilation unit; get the offset of the next.
+    offset += dwarf_reader.Start();
+  }
+
+  return true;
+}
+
+bool MachoDumpSymbols::ReadCFI(Module *module,
+                               const mach_o::Reader &macho_reader,
+                               const mach_o::Section &section,
+                               bool eh_frame,
+                               const string &object_name) const {
+  // Find the appropriate set of register names for this file's
+  // architecture.
+  vector<string> register_names;
+  switch (macho_reader.cpu_type()) {
+    case CPU_TYPE_X86:
+      register_names = DwarfCFIToModule::RegisterNames::I386();
+      break;
+    case CPU_TYPE_X86_64:
+      register_names = DwarfCFIToModule::RegisterNames::X86_64();
+      break;
+    case CPU_TYPE_ARM:
+      register_names = DwarfCFIToModule::RegisterNames::ARM();
+      break;
+    default: {
+      const ArchInfo *arch =
+          GetArchInfoFromCpuType(macho_reader.cpu_type(),
+                                 macho_reader.cpu_subtype());
+      fprintf(stderr, "%s: cannot convert DWARF call frame information for ",
+              object_name.c_str());
+      if (arch)
+        fprintf(stderr, "architecture '%s'", arch->name);
+      else
+        fprintf(stderr, "architecture %d,%d",
+                macho_reader.cpu_type(), macho_reader.cpu_subtype());
+      fprintf(stderr, " to Breakpad symbol file: no register name table\n");
+      return false;
+    }
+  }
+
+  // Find the call frame information and its size.
+  const char *cfi = reinterpret_cast<const char *>(section.contents.start);
+  size_t cfi_size = section.contents.Size();
+
+  // Plug together the parser, handler, and their entourages.
+  DwarfCFIToModule::Reporter module_reporter(object_name,
+                                             section.section_name);
+  DwarfCFIToModule handler(module, register_names, &module_reporter);
+  dwarf2reader::ByteReader byte_reader(macho_reader.big_endian() ?
+                                       dwarf2reader::ENDIANNESS_BIG :
+                                       dwarf2reader::ENDIANNESS_LITTLE);
+  byte_reader.SetAddressSize(macho_reader.bits_64() ? 8 : 4);
+  // At the moment, according to folks at Apple and some cursory
+  // investigation, Mac OS X only uses DW_EH_PE_pcrel-based pointers, so
+  // this is the only base address the CFI parser will need.
+  byte_reader.SetCFIDataBase(section.address, cfi);
+
+  dwarf2reader::CallFrameInfo::Reporter dwarf_reporter(object_name,
+                                                       section.section_name);
+  dwarf2reader::CallFrameInfo parser(cfi, cfi_size,
+                                     &byte_reader, &handler, &dwarf_reporter,
+                                     eh_frame);
+  parser.Start();
+  return true;
+}
+
+// A LoadCommandHandler that loads whatever debugging data it finds into a
+// Module.
+class MachoDumpSymbols::LoadCommandDumper:
+      public mach_o::Reader::LoadCommandHandler {
+ public:
+  // Create a load command dumper handling load commands from READER's
+  // file, and adding data to MODULE. Use OBJECT_NAME in error messages.
+  LoadCommandDumper(const MachoDumpSymbols &dumper,
+                    Module *module,
+                    const mach_o::Reader &reader,
+                    const string &object_name)
+      : dumper_(dumper), module_(module), reader_(reader),
+        object_name_(object_name) { }
+
+  bool SegmentCommand(const mach_o::Segment &segment);
+  bool SymtabCommand(const ByteBuffer &entries, const ByteBuffer &strings);
+
+ private:
+  const MachoDumpSymbols &dumper_;
+  Module *module_;  // WEAK
+  const mach_o::Reader &reader_;
+  const string &object_name_;
+};
+
+bool MachoDumpSymbols::LoadCommandDumper::SegmentCommand(
+    const mach_o::Segment &segment) {
+  mach_o::SectionMap section_map;
+  if (!reader_.MapSegmentSections(segment, &section_map))
+    return false;
+
+  if (segment.name == "__TEXT") {
+    module_->SetLoadAddress(segment.vmaddr);
+    mach_o::SectionMap::const_iterator eh_frame =
+        section_map.find("__eh_frame");
+    if (eh_frame != section_map.end()) {
+      // If there is a problem reading this, don't treat it as a fatal error.
+      dumper_.ReadCFI(module_, reader_, eh_frame->second, true, object_name_);
+    }
+    return true;
+  }
+
+  if (segment.name == "__DWARF") {
+    if (!dumper_.ReadDwarf(module_, reader_, section_map, object_name_))
+      return false;
+    mach_o::SectionMap::const_iterator debug_frame
+        = section_map.find("__debug_frame");
+    if (debug_frame != section_map.end()) {
+      // If there is a problem reading this, don't treat it as a fatal error.
+      dumper_.ReadCFI(module_, reader_, debug_frame->second, false,
+                      object_name_);
+    }
+  }
+
+  return true;
+}
+
+bool MachoDumpSymbols::LoadCommandDumper::SymtabCommand(
+    const ByteBuffer &entries, const ByteBuffer &strings) {
+  StabsToModule stabs_to_module(module_);
+  // Mac OS X STABS are never "unitized", and the size of the 'value' field
+  // matches the address size of the executable.
+  StabsReader stabs_reader(entries.start, entries.Size(),
+                           strings.start, strings.Size(),
+                           reader_.big_endian(),
+                           reader_.bits_64() ? 8 : 4,
+                           true,
+                           &stabs_to_module);
+  if (!stabs_reader.Process())
+    return false;
+  stabs_to_module.Finalize();
+  return true;
+}
+
+bool MachoDumpSymbols::WriteSymbolFile(std::ostream &stream, bool cfi) const {
+  // Use the object file SetArchitecture selected; if it hasn't been
+  // called, and there's only one architecture, that's the one.
+  const struct fat_arch *object_file = selected_object_file_;
+  if (!object_file) {
+    if (object_files_.size() != 1) {
+      fprintf(stderr, "%s: object file contains more than one"
+              " architecture; specify an architecture explicitly"
+              " with '-a ARCH' to resolve the ambiguity\n",
+              object_filename_.c_str());
+      return false;
+    }
+    object_file = &object_files_[0];
+  }
+
+  return WriteSymbolFile(*object_file, cfi, stream);
+}
+
+bool MachoDumpSymbols::WriteSymbolFile(const struct fat_arch &object_file,
+                                       bool cfi,
+                                       std::ostream &stream) const {
+  assert(contents_);
+
+  // Find the name of the object file's architecture, to appear in the
+  // MODULE record and in error messages.
+  const char *arch_name = GetModuleArchitectureName(object_file.cputype,
+                                                    object_file.cpusubtype);
+  if (!arch_name) {
+    fprintf(stderr, "%s: unrecognized cpu type 0x%x, subtype 0x%x\n",
+            object_filename_.c_str(),
+            object_file.cputype, object_file.cpusubtype);
+    return false;
+  }
+
+  string object_name = ObjectName(arch_name);
+
+  // Parse the object file.
+  mach_o::Reader::Reporter reporter(object_name);
+  mach_o::Reader reader(&reporter);
+  if (!reader.Read(contents_ + object_file.offset,
+                   object_file.size,
+                   object_file.cputype,
+                   object_file.cpusubtype))
+    return false;
+
+  // Choose an identifier string, to appear in the MODULE record.
+  string identifier;
+  if (!ReaderIdentifier(reader, contents_ + object_file.offset, object_name,
+                        &identifier))
+    return false;
+  identifier += "0";
+
+  // Create a module to hold the debugging information.
+  Module module(BaseName(object_filename_), "mac", arch_name, identifier);
+
+  // Walk the load commands, and deal with whatever is there.
+  LoadCommandDumper load_command_dumper(*this, &module, reader, object_name);
+  if (!reader.WalkLoadCommands(&load_command_dumper))
+    return false;
+
+  return module.Write(stream, cfi);
+}
+
+bool MachoDumpSymbols::WriteSymbolFiles(
+    const vector<const struct fat_arch *> &object_files,
+    const vector<std::ostream *> &streams,
+    bool cfi) const {
+  assert(streams.size() == object_files.size());
+  vector<DumpJob> jobs(object_files.size());
+  for (size_t i = 0; i < jobs.size(); i++) {
+    jobs[i].dumper = this;
+    jobs[i].object_file = object_files[i];
+    jobs[i].stream = streams[i];
+    jobs[i].cfi = cfi;
+    jobs[i].result = false;
+  }
+  return RunJobs(&jobs);
+}
+
+bool MachoDumpSymbols::WriteSymbolFiles(const vector<std::ostream *> &streams,
+                                        bool cfi) const {
+  vector<const struct fat_arch *> object_files;
+  for (size_t i = 0; i < object_files_.size(); i++)
+    object_files.push_back(&object_files_[i]);
+  return WriteSymbolFiles(object_files, streams, cfi);
+}
+
+bool MachoDumpSymbols::Identifier(const struct fat_arch &object_file,
+                                  string *identifier) const {
+  assert(contents_);
+
+  const char *arch_name = GetModuleArchitectureName(object_file.cputype,
+                                                    object_file.cpusubtype);
+  if (!arch_name) {
+    fprintf(stderr, "%s: unrecognized cpu type 0x%x, subtype 0x%x\n",
+            object_filename_.c_str(),
+            object_file.cputype, object_file.cpusubtype);
+    return false;
+  }
+  string object_name = ObjectName(arch_name);
+
+  mach_o::Reader::Reporter reporter(object_name);
+  mach_o::Reader reader(&reporter);
+  if (!reader.Read(contents_ + object_file.offset,
+                   object_file.size,
+                   object_file.cputype,
+                   object_file.cpusubtype))
+    return false;
+
+  if (!ReaderIdentifier(reader, contents_ + object_file.offset, object_name,
+                        identifier))
+    return false;
+  *identifier += "0";
+  return true;
+}
+
+bool MachoDumpSymbols::Identifiers(
+    const vector<const struct fat_arch *> &object_files,
+    vector<string> *identifiers) const {
+  identifiers->assign(object_files.size(), string());
+  vector<IdentifierJob> jobs(object_files.size());
+  for (size_t i = 0; i < jobs.size(); i++) {
+    jobs[i].dumper = this;
+    jobs[i].object_file = object_files[i];
+    jobs[i].identifier = &(*identifiers)[i];
+    jobs[i].result = false;
+  }
+  return RunJobs(&jobs);
+}
+
+}  // namespace google_breakpad
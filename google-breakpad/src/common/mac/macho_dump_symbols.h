@@ -0,0 +1,231 @@
+// -*- mode: C++ -*-
+
+// Copyright (c) 2010, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// macho_dump_symbols.h: Declaration of google_breakpad::MachoDumpSymbols,
+// a class for reading debugging information from Mach-O files and writing
+// it out as Breakpad symbol files.
+//
+// Unlike google_breakpad::DumpSymbols (common/mac/dump_syms.h), this class
+// uses no Mac OS X frameworks: it maps the file into memory with mmap,
+// parses it with mach_o::FatReader and mach_o::Reader, and reads the
+// DWARF, DWARF CFI, and STABS data with the same portable readers the
+// Linux dumper uses. It builds and runs on Linux as well as Mac OS X.
+
+#ifndef BREAKPAD_COMMON_MAC_MACHO_DUMP_SYMBOLS_H_
+#define BREAKPAD_COMMON_MAC_MACHO_DUMP_SYMBOLS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "common/mac/macho_headers.h"
+#include "common/mac/macho_reader.h"
+#include "common/module.h"
+
+namespace google_breakpad {
+
+using std::string;
+using std::vector;
+
+class MachoDumpSymbols {
+ public:
+  MachoDumpSymbols()
+      : contents_(NULL),
+        contents_size_(0),
+        selected_object_file_(NULL) { }
+  ~MachoDumpSymbols();
+
+  // Prepare to read debugging information from |filename|. |filename| may
+  // be the name of a universal binary, a Mach-O file, or a dSYM bundle
+  // containing either of the above. The file is mapped into memory, not
+  // copied. On success, return true; if there is a problem reading
+  // |filename|, report it and return false.
+  //
+  // Calling this again releases the file read before, and any
+  // architecture selected in it, before reading |filename|.
+  bool Read(const string &filename);
+
+  // Return the name of the file this dumper is actually reading debugging
+  // information from. This is the name passed to Read, unless that names
+  // a dSYM bundle, in which case it is the DWARF file within the bundle.
+  const string &object_filename() const { return object_filename_; }
+
+  // Return the object files present in the file passed to Read. For a
+  // universal binary this has one element per architecture; for a plain
+  // Mach-O file it has exactly one element.
+  const vector<struct fat_arch> &object_files() const { return object_files_; }
+
+  // If this dumper's file includes an object file for |cpu_type| and
+  // |cpu_subtype|, then select that object file for dumping, and return
+  // true. Otherwise, return false, and leave this dumper's selected
+  // architecture unchanged.
+  //
+  // By default, if this dumper's file contains only one object file, the
+  // dumper will dump that; if it contains more than one, WriteSymbolFile
+  // fails unless an architecture has been selected.
+  bool SetArchitecture(cpu_type_t cpu_type, cpu_subtype_t cpu_subtype);
+
+  // Like SetArchitecture, above, but take an architecture name like "i386"
+  // or "ppc".
+  bool SetArchitecture(const string &arch_name);
+
+  // Return the element of object_files() that best matches |cpu_type| and
+  // |cpu_subtype|, or NULL if this dumper's file has no object file for
+  // that CPU type.
+  const struct fat_arch *FindObjectFile(cpu_type_t cpu_type,
+                                        cpu_subtype_t cpu_subtype) const;
+
+  // Read the selected object file's debugging information, and write it
+  // out to |stream|. Write the CFI section if |cfi| is true. Return true
+  // on success; if an error occurs, report it and return false.
+  bool WriteSymbolFile(std::ostream &stream, bool cfi) const;
+
+  // Read the debugging information for |object_file|, which must be an
+  // element of object_files(), and write it out to |stream|. Write the
+  // CFI section if |cfi| is true. Return true on success; if an error
+  // occurs, report it and return false.
+  //
+  // This function doesn't modify the dumper, so it is safe to call it
+  // from several threads at once, as long as each has its own |stream|.
+  bool WriteSymbolFile(const struct fat_arch &object_file, bool cfi,
+                       std::ostream &stream) const;
+
+  // Write a symbol file for each of |object_files|, which must all be
+  // elements of object_files(), dumping each architecture on its own
+  // thread. Write the symbols for |object_files|[i] to *|streams|[i];
+  // the two vectors must be the same length. Write CFI sections if |cfi|
+  // is true. Return true if every object file was dumped successfully;
+  // otherwise, report the problems and return false.
+  //
+  // The file is mapped and its fat header parsed only once, by Read, no
+  // matter how many architectures are dumped.
+  bool WriteSymbolFiles(const vector<const struct fat_arch *> &object_files,
+                        const vector<std::ostream *> &streams,
+                        bool cfi) const;
+
+  // Like WriteSymbolFiles, above, but dump every object file in this
+  // dumper's file, writing the symbols for object_files()[i] to
+  // *|streams|[i].
+  bool WriteSymbolFiles(const vector<std::ostream *> &streams, bool cfi) const;
+
+  // Set |*identifier| to the identifier string WriteSymbolFile would
+  // place in |object_file|'s MODULE record: the object file's LC_UUID
+  // load command if it has one, or else an MD5 hash of its sections'
+  // contents, followed by the age. |object_file| must be an element of
+  // object_files(). Return true on success; on failure, report the
+  // problem and return false.
+  //
+  // This reads only the load commands and, for files with no LC_UUID,
+  // the section contents, directly from the mapped file; it is much
+  // cheaper than dumping the object file's symbols. Like WriteSymbolFile,
+  // it is safe to call from several threads at once.
+  bool Identifier(const struct fat_arch &object_file,
+                  string *identifier) const;
+
+  // Compute the identifiers of all of |object_files|, which must be
+  // elements of object_files(), each on its own thread, and set
+  // (*|identifiers|)[i] to the identifier of |object_files|[i]. Return
+  // true if every identifier was computed successfully; otherwise,
+  // report the problems, and return false, leaving the identifiers that
+  // couldn't be computed empty.
+  bool Identifiers(const vector<const struct fat_arch *> &object_files,
+                   vector<string> *identifiers) const;
+
+ private:
+  // Used internally.
+  class DumperLineToModule;
+  class LoadCommandDumper;
+
+  // Return the name to use in error messages for the object file in this
+  // dumper's file whose architecture is |arch_name|: the filename, and
+  // the architecture too if the file holds more than one.
+  string ObjectName(const char *arch_name) const;
+
+  // Set |*identifier| to the identifier string of the object file
+  // |reader| has parsed from the bytes at |object_start|, without the
+  // trailing age: the file's LC_UUID load command if it has one, or else
+  // an MD5 hash of its section contents. Use |object_name| in error
+  // messages. Return true on success; on failure, report the problem and
+  // return false.
+  bool ReaderIdentifier(const mach_o::Reader &reader,
+                        const uint8_t *object_start,
+                        const string &object_name,
+                        string *identifier) const;
+
+  // Read debugging information from |dwarf_sections|, which was taken from
+  // |macho_reader|, and add it to |module|. Use |object_name| in error
+  // messages. On success, return true; on failure, report the problem and
+  // return false.
+  bool ReadDwarf(Module *module,
+                 const mach_o::Reader &macho_reader,
+                 const mach_o::SectionMap &dwarf_sections,
+                 const string &object_name) const;
+
+  // Read DWARF CFI or .eh_frame data from |section|, belonging to
+  // |macho_reader|, and record it in |module|. If |eh_frame| is true,
+  // then the data is .eh_frame-format data; otherwise, it is standard
+  // DWARF .debug_frame data. Use |object_name| in error messages. On
+  // success, return true; on failure, report the problem and return false.
+  bool ReadCFI(Module *module,
+               const mach_o::Reader &macho_reader,
+               const mach_o::Section &section,
+               bool eh_frame,
+               const string &object_name) const;
+
+  // The name of the file or bundle passed to Read.
+  string input_pathname_;
+
+  // The name of the file we actually read debugging information from.
+  // See object_filename(), above.
+  string object_filename_;
+
+  // The contents of object_filename_, mapped into memory, and their size.
+  const uint8_t *contents_;
+  size_t contents_size_;
+
+  // The object files object_filename_ contains.
+  vector<struct fat_arch> object_files_;
+
+  // The object file in object_files_ selected to dump, or NULL if
+  // SetArchitecture hasn't been called yet.
+  const struct fat_arch *selected_object_file_;
+
+  // A MachoDumpSymbols owns its memory mapping, so it can't be copied.
+  MachoDumpSymbols(const MachoDumpSymbols &);
+  MachoDumpSymbols &operator=(const MachoDumpSymbols &);
+};
+
+}  // namespace google_breakpad
+
+#endif  // BREAKPAD_COMMON_MAC_MACHO_DUMP_SYMBOLS_H_
@@ -0,0 +1,483 @@
+// Copyright (c) 2010, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// macho_dump_symbols_unittest.cc: Unit tests for
+// google_breakpad::MachoDumpSymbols.
+
+#include <stab.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "breakpad_googletest_includes.h"
+#include "common/mac/macho_dump_symbols.h"
+#include "common/md5.h"
+#include "common/test_assembler.h"
+
+namespace {
+
+using google_breakpad::MachoDumpSymbols;
+using google_breakpad::test_assembler::Endianness;
+using google_breakpad::test_assembler::Label;
+using google_breakpad::test_assembler::Section;
+using google_breakpad::test_assembler::kBigEndian;
+using google_breakpad::test_assembler::kLittleEndian;
+using std::ostringstream;
+using std::string;
+using std::vector;
+
+const uint8_t kUUID[16] = {
+  0x3c, 0x7e, 0x1a, 0x55, 0x02, 0xb8, 0x4f, 0x91,
+  0xa6, 0x0d, 0xe3, 0x47, 0x28, 0xc4, 0x9b, 0x6f
+};
+
+// Return the contents of a 32-bit Mach-O executable for |cpu_type| and
+// |cpu_subtype|, with the given |endianness|. Its __TEXT segment is
+// loaded at 0x1000 and holds a __text section containing |text|, and its
+// symbol table has STABS entries describing a function 'fn' covering all
+// of |text|, from line 42 of file.c. If |uuid| is non-NULL, the file has
+// an LC_UUID load command holding those sixteen bytes.
+string MachOFile(Endianness endianness, cpu_type_t cpu_type,
+                 cpu_subtype_t cpu_subtype, const uint8_t *uuid,
+                 const string &text) {
+  Section file(endianness);
+  file.start() = 0;
+  Label commands_start, commands_end, commands_size, text_start,
+      symbols_start, strings_start, strings_end, strings_size;
+  const int command_count = uuid ? 3 : 2;
+
+  file
+      .D32(0xfeedface)                      // magic number
+      .D32(cpu_type)
+      .D32(cpu_subtype)
+      .D32(MH_EXECUTE)                      // file type
+      .D32(command_count)
+      .D32(commands_size)                   // size of load commands
+      .D32(MH_NOUNDEFS)                     // flags
+      .Mark(&commands_start);
+  if (uuid) {
+    file.D32(LC_UUID).D32(24).Append(uuid, 16);
+  }
+  file
+      .D32(LC_SEGMENT).D32(56 + 68)         // command, size
+      .AppendCString("__TEXT", 16)
+      .D32(0x1000)                          // vmaddr
+      .D32(text.size())                     // vmsize
+      .D32(text_start)                      // file offset
+      .D32(text.size())                     // file size
+      .D32(5).D32(5)                        // maxprot, initprot
+      .D32(1)                               // section count
+      .D32(0)                               // flags
+      .AppendCString("__text", 16)
+      .AppendCString("__TEXT", 16)
+      .D32(0x1000)                          // address
+      .D32(text.size())                     // size
+      .D32(text_start)                      // file offset
+      .D32(2)                               // alignment
+      .D32(0).D32(0)                        // relocations
+      .D32(0)                               // flags
+      .D32(0).D32(0)                        // reserved
+      .D32(LC_SYMTAB).D32(24)               // command, size
+      .D32(symbols_start)
+      .D32(5)                               // symbol count
+      .D32(strings_start)
+      .D32(strings_size)                    // string table size
+      .Mark(&commands_end)
+      .Mark(&text_start)
+      .Append(text)
+      .Align(4);
+
+  // Each STABS entry is a string offset, type, 'other' byte, descriptor,
+  // and value. The string table starts with the empty string.
+  file
+      .Mark(&symbols_start)
+      .D32(1).D8(N_SO).D8(0).D16(0).D32(0x1000)
+      .D32(8).D8(N_FUN).D8(1).D16(0).D32(0x1000)
+      .D32(0).D8(N_SLINE).D8(1).D16(42).D32(0)
+      .D32(0).D8(N_FUN).D8(0).D16(0).D32(text.size())
+      .D32(0).D8(N_SO).D8(1).D16(0).D32(0x1000 + text.size())
+      .Mark(&strings_start)
+      .AppendCString("")
+      .AppendCString("file.c")
+      .AppendCString("fn:F(0,1)")
+      .Mark(&strings_end);
+  commands_size = commands_end - commands_start;
+  strings_size = strings_end - strings_start;
+
+  string contents;
+  EXPECT_TRUE(file.GetContents(&contents));
+  return contents;
+}
+
+// Return the contents of a universal binary holding |object_files|, for
+// the CPU types and subtypes given by |cpu_types| and |cpu_subtypes|.
+string FatFile(const vector<string> &object_files,
+               const vector<cpu_type_t> &cpu_types,
+               const vector<cpu_subtype_t> &cpu_subtypes) {
+  Section file(kBigEndian);
+  file.start() = 0;
+  vector<Label> offsets(object_files.size());
+  file.D32(FAT_MAGIC).D32(object_files.size());
+  for (size_t i = 0; i < object_files.size(); i++) {
+    file
+        .D32(cpu_types[i])
+        .D32(cpu_subtypes[i])
+        .D32(offsets[i])
+        .D32(object_files[i].size())
+        .D32(12);                           // alignment
+  }
+  for (size_t i = 0; i < object_files.size(); i++) {
+    file.Align(4096).Mark(&offsets[i]).Append(object_files[i]);
+  }
+  string contents;
+  EXPECT_TRUE(file.GetContents(&contents));
+  return contents;
+}
+
+class MachoDumpSymbolsTest: public testing::Test {
+ public:
+  void SetUp() {
+    char directory[] = "/tmp/macho-dump-symbols-unittest-XXXXXX";
+    ASSERT_TRUE(mkdtemp(directory) != NULL);
+    directory_ = directory;
+  }
+
+  void TearDown() {
+    for (size_t i = files_.size(); i > 0; i--)
+      remove(files_[i - 1].c_str());
+    rmdir(directory_.c_str());
+  }
+
+  // Write |contents| to a file named |name| in our temporary directory,
+  // and return its full path.
+  string WriteFile(const string &name, const string &contents) {
+    string path = directory_ + "/" + name;
+    FILE *file = fopen(path.c_str(), "w");
+    EXPECT_TRUE(file != NULL);
+    if (file) {
+      EXPECT_EQ(contents.size(),
+                fwrite(contents.data(), 1, contents.size(), file));
+      fclose(file);
+    }
+    files_.push_back(path);
+    return path;
+  }
+
+  // Create a directory named |name| in our temporary directory, and
+  // return its full path.
+  string MakeDirectory(const string &name) {
+    string path = directory_ + "/" + name;
+    EXPECT_EQ(0, mkdir(path.c_str(), 0700));
+    files_.push_back(path);
+    return path;
+  }
+
+  string directory_;
+  // Files and directories we've created, in order of creation.
+  vector<string> files_;
+};
+
+TEST_F(MachoDumpSymbolsTest, ThinFile) {
+  string path = WriteFile("thin", MachOFile(kLittleEndian, CPU_TYPE_I386,
+                                            CPU_SUBTYPE_I386_ALL, kUUID,
+                                            string(16, '\x90')));
+  MachoDumpSymbols dumper;
+  ASSERT_TRUE(dumper.Read(path));
+  EXPECT_EQ(path, dumper.object_filename());
+  EXPECT_EQ(1U, dumper.object_files().size());
+
+  ostringstream symbols;
+  ASSERT_TRUE(dumper.WriteSymbolFile(symbols, true));
+  EXPECT_EQ("MODULE mac x86 3C7E1A5502B84F91A60DE34728C49B6F0 thin\n"
+            "FILE 0 file.c\n"
+            "FUNC 0 10 0 fn\n"
+            "0 10 42 0\n",
+            symbols.str());
+}
+
+TEST_F(MachoDumpSymbolsTest, HashIdentifier) {
+  // A file with no LC_UUID command is identified by a hash of its
+  // sections' contents.
+  const string text = "distinctive section contents";
+  string path = WriteFile("nouuid", MachOFile(kBigEndian, CPU_TYPE_POWERPC,
+                                              CPU_SUBTYPE_POWERPC_ALL, NULL,
+                                              text));
+  MD5Context md5;
+  MD5Init(&md5);
+  MD5Update(&md5, reinterpret_cast<const unsigned char *>(text.data()),
+            text.size());
+  unsigned char digest[16];
+  MD5Final(digest, &md5);
+  char expected[33];
+  for (int i = 0; i < 16; i++)
+    sprintf(expected + 2 * i, "%02X", digest[i]);
+
+  MachoDumpSymbols dumper;
+  ASSERT_TRUE(dumper.Read(path));
+  ostringstream symbols;
+  ASSERT_TRUE(dumper.WriteSymbolFile(symbols, true));
+  EXPECT_EQ("MODULE mac ppc " + string(expected) + "0 nouuid\n",
+            symbols.str().substr(0, symbols.str().find('\n') + 1));
+}
+
+TEST_F(MachoDumpSymbolsTest, FatFileSelectArchitecture) {
+  vector<string> object_files;
+  object_files.push_back(MachOFile(kBigEndian, CPU_TYPE_POWERPC,
+                                   CPU_SUBTYPE_POWERPC_ALL, kUUID,
+                                   string(8, '\0')));
+  object_files.push_back(MachOFile(kLittleEndian, CPU_TYPE_I386,
+                                   CPU_SUBTYPE_I386_ALL, kUUID,
+                                   string(12, '\x90')));
+  vector<cpu_type_t> cpu_types;
+  cpu_types.push_back(CPU_TYPE_POWERPC);
+  cpu_types.push_back(CPU_TYPE_I386);
+  vector<cpu_subtype_t> cpu_subtypes;
+  cpu_subtypes.push_back(CPU_SUBTYPE_POWERPC_ALL);
+  cpu_subtypes.push_back(CPU_SUBTYPE_I386_ALL);
+  string path = WriteFile("fat", FatFile(object_files, cpu_types,
+                                         cpu_subtypes));
+
+  MachoDumpSymbols dumper;
+  ASSERT_TRUE(dumper.Read(path));
+  ASSERT_EQ(2U, dumper.object_files().size());
+
+  // With more than one architecture present, the caller must choose.
+  ostringstream ambiguous;
+  EXPECT_FALSE(dumper.WriteSymbolFile(ambiguous, true));
+
+  EXPECT_FALSE(dumper.SetArchitecture("x86_64"));
+  ASSERT_TRUE(dumper.SetArchitecture("i386"));
+  ostringstream symbols;
+  ASSERT_TRUE(dumper.WriteSymbolFile(symbols, true));
+  EXPECT_EQ("MODULE mac x86 3C7E1A5502B84F91A60DE34728C49B6F0 fat\n"
+            "FILE 0 file.c\n"
+            "FUNC 0 c 0 fn\n"
+            "0 c 42 0\n",
+            symbols.str());
+}
+
+TEST_F(MachoDumpSymbolsTest, ReadAgain) {
+  vector<string> object_files;
+  object_files.push_back(MachOFile(kBigEndian, CPU_TYPE_POWERPC,
+                                   CPU_SUBTYPE_POWERPC_ALL, kUUID,
+                                   string(8, '\0')));
+  object_files.push_back(MachOFile(kLittleEndian, CPU_TYPE_I386,
+                                   CPU_SUBTYPE_I386_ALL, kUUID,
+                                   string(12, '\x90')));
+  vector<cpu_type_t> cpu_types;
+  cpu_types.push_back(CPU_TYPE_POWERPC);
+  cpu_types.push_back(CPU_TYPE_I386);
+  vector<cpu_subtype_t> cpu_subtypes;
+  cpu_subtypes.push_back(CPU_SUBTYPE_POWERPC_ALL);
+  cpu_subtypes.push_back(CPU_SUBTYPE_I386_ALL);
+  string fat_path = WriteFile("fat", FatFile(object_files, cpu_types,
+                                             cpu_subtypes));
+  string thin_path = WriteFile("thin", MachOFile(kLittleEndian, CPU_TYPE_I386,
+                                                 CPU_SUBTYPE_I386_ALL, kUUID,
+                                                 string(16, '\x90')));
+
+  // Reading a second file replaces the first, along with the
+  // architecture selected in it.
+  MachoDumpSymbols dumper;
+  ASSERT_TRUE(dumper.Read(fat_path));
+  ASSERT_TRUE(dumper.SetArchitecture("i386"));
+  ASSERT_TRUE(dumper.Read(thin_path));
+  EXPECT_EQ(thin_path, dumper.object_filename());
+  EXPECT_EQ(1U, dumper.object_files().size());
+
+  ostringstream symbols;
+  ASSERT_TRUE(dumper.WriteSymbolFile(symbols, true));
+  EXPECT_EQ("MODULE mac x86 3C7E1A5502B84F91A60DE34728C49B6F0 thin\n"
+            "FILE 0 file.c\n"
+            "FUNC 0 10 0 fn\n"
+            "0 10 42 0\n",
+            symbols.str());
+}
+
+TEST_F(MachoDumpSymbolsTest, WriteSymbolFiles) {
+  vector<string> object_files;
+  vector<cpu_type_t> cpu_types;
+  vector<cpu_subtype_t> cpu_subtypes;
+  for (int i = 0; i < 4; i++) {
+    bool ppc = (i % 2) == 0;
+    object_files.push_back(MachOFile(ppc ? kBigEndian : kLittleEndian,
+                                     ppc ? CPU_TYPE_POWERPC : CPU_TYPE_I386,
+                                     ppc ? CPU_SUBTYPE_POWERPC_ALL
+                                         : CPU_SUBTYPE_I386_ALL,
+                                     NULL, string(4 + 4 * i, 'a' + i)));
+    cpu_types.push_back(ppc ? CPU_TYPE_POWERPC : CPU_TYPE_I386);
+    cpu_subtypes.push_back(ppc ? CPU_SUBTYPE_POWERPC_ALL
+                               : CPU_SUBTYPE_I386_ALL);
+  }
+  string path = WriteFile("fat4", FatFile(object_files, cpu_types,
+                                          cpu_subtypes));
+
+  MachoDumpSymbols dumper;
+  ASSERT_TRUE(dumper.Read(path));
+  ASSERT_EQ(4U, dumper.object_files().size());
+
+  // Dumping every architecture at once should produce the same output as
+  // dumping them one at a time.
+  vector<ostringstream *> parallel(4);
+  vector<std::ostream *> streams(4);
+  for (size_t i = 0; i < 4; i++)
+    streams[i] = parallel[i] = new ostringstream;
+  EXPECT_TRUE(dumper.WriteSymbolFiles(streams, true));
+
+  for (size_t i = 0; i < 4; i++) {
+    ostringstream serial;
+    EXPECT_TRUE(dumper.WriteSymbolFile(dumper.object_files()[i], true,
+                                       serial));
+    EXPECT_EQ(serial.str(), parallel[i]->str());
+    EXPECT_EQ(0U, parallel[i]->str().find(i % 2 ? "MODULE mac x86 "
+                                                : "MODULE mac ppc "));
+    delete parallel[i];
+  }
+}
+
+TEST_F(MachoDumpSymbolsTest, WriteSymbolFilesSubset) {
+  vector<string> object_files;
+  vector<cpu_type_t> cpu_types;
+  vector<cpu_subtype_t> cpu_subtypes;
+  object_files.push_back(MachOFile(kBigEndian, CPU_TYPE_POWERPC,
+                                   CPU_SUBTYPE_POWERPC_ALL, NULL,
+                                   string(8, 'p')));
+  cpu_types.push_back(CPU_TYPE_POWERPC);
+  cpu_subtypes.push_back(CPU_SUBTYPE_POWERPC_ALL);
+  object_files.push_back(MachOFile(kLittleEndian, CPU_TYPE_I386,
+                                   CPU_SUBTYPE_I386_ALL, kUUID,
+                                   string(16, 'i')));
+  cpu_types.push_back(CPU_TYPE_I386);
+  cpu_subtypes.push_back(CPU_SUBTYPE_I386_ALL);
+  string path = WriteFile("fat2", FatFile(object_files, cpu_types,
+                                          cpu_subtypes));
+
+  MachoDumpSymbols dumper;
+  ASSERT_TRUE(dumper.Read(path));
+  ASSERT_EQ(2U, dumper.object_files().size());
+  EXPECT_TRUE(dumper.FindObjectFile(CPU_TYPE_X86_64,
+                                    CPU_SUBTYPE_X86_64_ALL) == NULL);
+
+  // Dump only the x86 object file.
+  vector<const struct fat_arch *> selected;
+  selected.push_back(dumper.FindObjectFile(CPU_TYPE_I386,
+                                           CPU_SUBTYPE_I386_ALL));
+  ASSERT_TRUE(selected[0] == &dumper.object_files()[1]);
+  ostringstream x86;
+  vector<std::ostream *> streams(1, &x86);
+  EXPECT_TRUE(dumper.WriteSymbolFiles(selected, streams, false));
+  EXPECT_EQ("MODULE mac x86 3C7E1A5502B84F91A60DE34728C49B6F0 fat2\n"
+            "FILE 0 file.c\n"
+            "FUNC 0 10 0 fn\n"
+            "0 10 42 0\n",
+            x86.str());
+
+  // Dump both, in the opposite order from the file's.
+  selected.push_back(dumper.FindObjectFile(CPU_TYPE_POWERPC,
+                                           CPU_SUBTYPE_POWERPC_ALL));
+  ostringstream both_x86, both_ppc;
+  streams[0] = &both_x86;
+  streams.push_back(&both_ppc);
+  EXPECT_TRUE(dumper.WriteSymbolFiles(selected, streams, false));
+  EXPECT_EQ(x86.str(), both_x86.str());
+  EXPECT_EQ(0U, both_ppc.str().find("MODULE mac ppc "));
+}
+
+TEST_F(MachoDumpSymbolsTest, Identifiers) {
+  vector<string> object_files;
+  vector<cpu_type_t> cpu_types;
+  vector<cpu_subtype_t> cpu_subtypes;
+  object_files.push_back(MachOFile(kBigEndian, CPU_TYPE_POWERPC,
+                                   CPU_SUBTYPE_POWERPC_ALL, NULL,
+                                   string(8, 'p')));
+  cpu_types.push_back(CPU_TYPE_POWERPC);
+  cpu_subtypes.push_back(CPU_SUBTYPE_POWERPC_ALL);
+  object_files.push_back(MachOFile(kLittleEndian, CPU_TYPE_I386,
+                                   CPU_SUBTYPE_I386_ALL, kUUID,
+                                   string(16, 'i')));
+  cpu_types.push_back(CPU_TYPE_I386);
+  cpu_subtypes.push_back(CPU_SUBTYPE_I386_ALL);
+  string path = WriteFile("ids", FatFile(object_files, cpu_types,
+                                         cpu_subtypes));
+
+  MachoDumpSymbols dumper;
+  ASSERT_TRUE(dumper.Read(path));
+  ASSERT_EQ(2U, dumper.object_files().size());
+
+  vector<const struct fat_arch *> selected;
+  selected.push_back(&dumper.object_files()[0]);
+  selected.push_back(&dumper.object_files()[1]);
+  vector<string> identifiers;
+  ASSERT_TRUE(dumper.Identifiers(selected, &identifiers));
+  ASSERT_EQ(2U, identifiers.size());
+  EXPECT_EQ("3C7E1A5502B84F91A60DE34728C49B6F0", identifiers[1]);
+
+  // Each identifier should match the one in the object file's symbols.
+  for (size_t i = 0; i < selected.size(); i++) {
+    string identifier;
+    EXPECT_TRUE(dumper.Identifier(*selected[i], &identifier));
+    EXPECT_EQ(identifiers[i], identifier);
+    ostringstream symbols;
+    EXPECT_TRUE(dumper.WriteSymbolFile(*selected[i], false, symbols));
+    EXPECT_NE(string::npos, symbols.str().find(" " + identifier + " ids\n"));
+  }
+}
+
+TEST_F(MachoDumpSymbolsTest, DSYMBundle) {
+  string bundle = MakeDirectory("Thing.framework.dSYM");
+  MakeDirectory("Thing.framework.dSYM/Contents");
+  MakeDirectory("Thing.framework.dSYM/Contents/Resources");
+  MakeDirectory("Thing.framework.dSYM/Contents/Resources/DWARF");
+  string dwarf_file =
+      WriteFile("Thing.framework.dSYM/Contents/Resources/DWARF/Thing",
+                MachOFile(kLittleEndian, CPU_TYPE_I386, CPU_SUBTYPE_I386_ALL,
+                          kUUID, string(16, '\x90')));
+
+  MachoDumpSymbols dumper;
+  ASSERT_TRUE(dumper.Read(bundle + "/"));
+  EXPECT_EQ(bundle + "//Contents/Resources/DWARF/Thing",
+            dumper.object_filename());
+  ostringstream symbols;
+  ASSERT_TRUE(dumper.WriteSymbolFile(symbols, true));
+  EXPECT_EQ(0U, symbols.str().find("MODULE mac x86 "
+                                   "3C7E1A5502B84F91A60DE34728C49B6F0 Thing\n"));
+}
+
+TEST_F(MachoDumpSymbolsTest, EmptyBundle) {
+  string bundle = MakeDirectory("Empty.dSYM");
+  MachoDumpSymbols dumper;
+  EXPECT_FALSE(dumper.Read(bundle));
+}
+
+}  // namespace
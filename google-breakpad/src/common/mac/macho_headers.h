@@ -0,0 +1,147 @@
+// -*- mode: C++ -*-
+
+// Copyright (c) 2010, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// macho_headers.h: The parts of the Mac OS X <mach/machine.h>,
+// <mach-o/fat.h>, and <mach-o/loader.h> headers that the portable Mach-O
+// readers use. On Mac OS X this simply includes the system headers; on
+// other hosts it supplies equivalent definitions, so that the Mach-O
+// reader and the symbol dumper built on it can run on any build machine.
+//
+// The values here are fixed by the Mach-O file format, and must match
+// Apple's definitions exactly.
+
+#ifndef BREAKPAD_COMMON_MAC_MACHO_HEADERS_H_
+#define BREAKPAD_COMMON_MAC_MACHO_HEADERS_H_
+
+#include <stdint.h>
+
+#ifdef __APPLE__
+
+#include <mach/machine.h>
+#include <mach-o/fat.h>
+#include <mach-o/loader.h>
+
+#else  // __APPLE__
+
+typedef int32_t cpu_type_t;
+typedef int32_t cpu_subtype_t;
+
+// Mask for architecture bits, and the bit marking 64-bit ABIs.
+#define CPU_ARCH_MASK  0xff000000
+#define CPU_ARCH_ABI64 0x01000000
+
+#define CPU_TYPE_ANY       (static_cast<cpu_type_t>(-1))
+#define CPU_TYPE_X86       (static_cast<cpu_type_t>(7))
+#define CPU_TYPE_I386      CPU_TYPE_X86
+#define CPU_TYPE_X86_64    (CPU_TYPE_X86 | CPU_ARCH_ABI64)
+#define CPU_TYPE_HPPA      (static_cast<cpu_type_t>(11))
+#define CPU_TYPE_ARM       (static_cast<cpu_type_t>(12))
+#define CPU_TYPE_POWERPC   (static_cast<cpu_type_t>(18))
+#define CPU_TYPE_POWERPC64 (CPU_TYPE_POWERPC | CPU_ARCH_ABI64)
+
+// Mask for the feature bits of a CPU subtype.
+#define CPU_SUBTYPE_MASK 0xff000000
+
+#define CPU_SUBTYPE_I386_ALL    (static_cast<cpu_subtype_t>(3))
+#define CPU_SUBTYPE_X86_ALL     (static_cast<cpu_subtype_t>(3))
+#define CPU_SUBTYPE_X86_64_ALL  (static_cast<cpu_subtype_t>(3))
+#define CPU_SUBTYPE_POWERPC_ALL (static_cast<cpu_subtype_t>(0))
+#define CPU_SUBTYPE_ARM_ALL     (static_cast<cpu_subtype_t>(0))
+#define CPU_SUBTYPE_ARM_V6      (static_cast<cpu_subtype_t>(6))
+#define CPU_SUBTYPE_ARM_V7      (static_cast<cpu_subtype_t>(9))
+
+// Universal ("fat") binary headers. These are always big-endian.
+#define FAT_MAGIC 0xcafebabe
+#define FAT_CIGAM 0xbebafeca
+
+struct fat_header {
+  uint32_t magic;
+  uint32_t nfat_arch;
+};
+
+struct fat_arch {
+  cpu_type_t cputype;
+  cpu_subtype_t cpusubtype;
+  uint32_t offset;
+  uint32_t size;
+  uint32_t align;
+};
+
+// Mach-O header magic numbers.
+#define MH_MAGIC    0xfeedface
+#define MH_CIGAM    0xcefaedfe
+#define MH_MAGIC_64 0xfeedfacf
+#define MH_CIGAM_64 0xcffaedfe
+
+// Mach-O file types.
+#define MH_OBJECT  0x1
+#define MH_EXECUTE 0x2
+#define MH_DYLIB   0x6
+#define MH_BUNDLE  0x8
+#define MH_DSYM    0xa
+
+// Mach-O header flags.
+#define MH_NOUNDEFS 0x1
+#define MH_DYLDLINK 0x4
+#define MH_TWOLEVEL 0x80
+
+// Load command types.
+#define LC_SEGMENT    0x1
+#define LC_SYMTAB     0x2
+#define LC_DYSYMTAB   0xb
+#define LC_ID_DYLIB   0xd
+#define LC_SEGMENT_64 0x19
+#define LC_UUID       0x1b
+
+// Section types, stored in the low bits of a section's flags.
+#define SECTION_TYPE 0x000000ff
+#define S_ZEROFILL   0x1
+
+#endif  // __APPLE__
+
+// Older Mac OS X SDKs lack some of these definitions.
+#ifndef LC_UUID
+#define LC_UUID 0x1b
+#endif
+#ifndef CPU_TYPE_ARM
+#define CPU_TYPE_ARM (static_cast<cpu_type_t>(12))
+#endif
+#ifndef CPU_SUBTYPE_ARM_ALL
+#define CPU_SUBTYPE_ARM_ALL (static_cast<cpu_subtype_t>(0))
+#endif
+#ifndef CPU_SUBTYPE_ARM_V6
+#define CPU_SUBTYPE_ARM_V6 (static_cast<cpu_subtype_t>(6))
+#endif
+#ifndef CPU_SUBTYPE_ARM_V7
+#define CPU_SUBTYPE_ARM_V7 (static_cast<cpu_subtype_t>(9))
+#endif
+
+#endif  // BREAKPAD_COMMON_MAC_MACHO_HEADERS_H_
@@ -40,6 +40,8 @@ extern "C" {  // necessary for Leopard
   #include <stdio.h>
   #include <stdlib.h>
   #include <string.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
   #include <sys/time.h>
   #include <sys/types.h>
   #include <unistd.h>
@@ -53,6 +55,8 @@ namespace MacFileUtilities {
 
 MachoID::MachoID(const char *path)
    : file_(0), 
+     mapped_contents_(NULL),
+     mapped_size_(0),
      crc_(0), 
      md5_context_(), 
      update_function_(NULL) {
@@ -61,6 +65,8 @@ MachoID::MachoID(const char *path)
 }
 
 MachoID::~MachoID() {
+  if (mapped_contents_)
+    munmap(mapped_contents_, mapped_size_);
   if (file_ != -1)
     close(file_);
 }
@@ -114,13 +120,43 @@ void MachoID::UpdateCRC(unsigned char *bytes, size_t size) {
 }
 
 void MachoID::UpdateMD5(unsigned char *bytes, size_t size) {
-  MD5Update(&md5_context_, bytes, size);
+  // MD5Update takes an 'unsigned' length.
+  while (size > 0) {
+    unsigned chunk = size > 0x40000000 ? 0x40000000 : (unsigned)size;
+    MD5Update(&md5_context_, bytes, chunk);
+    bytes += chunk;
+    size -= chunk;
+  }
+}
+
+void MachoID::MapFile() {
+  if (mapped_contents_)
+    return;
+
+  // Map the whole file, so that hashing a segment is a single pass over
+  // memory rather than a long series of small reads. If this fails, we
+  // fall back to reading through the MachoWalker.
+  struct stat st;
+  if (file_ != -1 && fstat(file_, &st) == 0 && st.st_size > 0) {
+    void *contents = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, file_, 0);
+    if (contents != MAP_FAILED) {
+      mapped_contents_ = static_cast<unsigned char *>(contents);
+      mapped_size_ = st.st_size;
+    }
+  }
 }
 
 void MachoID::Update(MachoWalker *walker, off_t offset, size_t size) {
   if (!update_function_ || !size)
     return;
 
+  // If the whole range lies within the mapped file, hash it in place.
+  if (mapped_contents_ && offset >= 0 && (size_t)offset <= mapped_size_ &&
+      size <= mapped_size_ - (size_t)offset) {
+    (this->*update_function_)(mapped_contents_ + offset, size);
+    return;
+  }
+
   // Read up to 4k bytes at a time
   unsigned char buffer[4096];
   size_t buffer_size;
@@ -207,6 +243,7 @@ uint32_t MachoID::Adler32(int cpu_type) {
   MachoWalker walker(path_, WalkerCB, this);
   update_function_ = &MachoID::UpdateCRC;
   crc_ = 0;
+  MapFile();
 
   if (!walker.WalkHeader(cpu_type))
     return 0;
@@ -217,6 +254,7 @@ uint32_t MachoID::Adler32(int cpu_type) {
 bool MachoID::MD5(int cpu_type, unsigned char identifier[16]) {
   MachoWalker walker(path_, WalkerCB, this);
   update_function_ = &MachoID::UpdateMD5;
+  MapFile();
 
   MD5Init(&md5_context_);
 
@@ -77,7 +77,16 @@ class MachoID {
   // to each byte.
   void UpdateMD5(unsigned char *bytes, size_t size);
 
-  // Bottleneck for update routines
+  // Map the file into memory, if it isn't already, for hashing its
+  // segments. Only the CRC and MD5 paths need this; the UUID and
+  // LC_ID_DYLIB lookups read just the headers, so that identifying a
+  // module, as a crashing process does for each of its modules, maps
+  // nothing.
+  void MapFile();
+
+  // Bottleneck for update routines. Pass the |size| bytes at |offset| in
+  // the file to update_function_: directly from the file's mapping, if
+  // we have one, or else by reading them through |walker|.
   void Update(MachoWalker *walker, off_t offset, size_t size);
 
   // The callback from the MachoWalker for CRC and MD5
@@ -98,6 +107,12 @@ class MachoID {
   // File descriptor
   int file_;
 
+  // The file's contents, mapped read-only into memory by MapFile, and
+  // their size. Until then, or if the file couldn't be mapped,
+  // mapped_contents_ is NULL.
+  unsigned char *mapped_contents_;
+  size_t mapped_size_;
+
   // The current crc value
   uint32_t crc_;
 
@@ -36,8 +36,6 @@
 #ifndef BREAKPAD_COMMON_MAC_MACHO_READER_H_
 #define BREAKPAD_COMMON_MAC_MACHO_READER_H_
 
-#include <mach-o/loader.h>
-#include <mach-o/fat.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <unistd.h>
@@ -47,6 +45,7 @@
 #include <vector>
 
 #include "common/byte_cursor.h"
+#include "common/mac/macho_headers.h"
 
 namespace google_breakpad {
 namespace mach_o {
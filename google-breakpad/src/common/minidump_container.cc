@@ -0,0 +1,227 @@
+// Copyright (c) 2011, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// minidump_container.cc: Implementation of MinidumpContainerEncoder and
+// MinidumpContainerReader. See minidump_container.h for details.
+
+#include "common/minidump_container.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "common/block_compression.h"
+#include "common/byte_cursor.h"
+
+namespace google_breakpad {
+
+namespace {
+
+const char kMagic[] = "BPMDMPZ1";
+const size_t kMagicSize = 8;
+const size_t kIndexEntrySize = 8 + 4;
+
+void AppendLittleEndian(u_int64_t value, size_t size, string *out) {
+  for (size_t i = 0; i < size; i++)
+    out->push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+}
+
+}  // namespace
+
+MinidumpContainerEncoder::MinidumpContainerEncoder(u_int64_t size,
+                                                   size_t block_size)
+    : size_(size),
+      block_size_(block_size),
+      block_count_((size + block_size - 1) / block_size),
+      offset_(kMinidumpContainerHeaderSize) {
+  index_.reserve(block_count_ * kIndexEntrySize);
+}
+
+u_int64_t MinidumpContainerEncoder::BlockOffset(size_t index) const {
+  return u_int64_t(index) * block_size_;
+}
+
+size_t MinidumpContainerEncoder::BlockSize(size_t index) const {
+  return std::min(u_int64_t(block_size_), size_ - BlockOffset(index));
+}
+
+void MinidumpContainerEncoder::StartContainer(string *out) const {
+  out->append(kMinidumpContainerHeaderSize, '\0');
+}
+
+void MinidumpContainerEncoder::AddBlock(const char *data, size_t size,
+                                        string *out) {
+  string compressed;
+  CompressBlock(data, size, &compressed);
+  if (compressed.size() < size)
+    out->append(compressed);
+  else
+    out->append(data, size);
+
+  u_int32_t stored_size = std::min(compressed.size(), size);
+  AppendLittleEndian(offset_, 8, &index_);
+  AppendLittleEndian(stored_size, 4, &index_);
+  offset_ += stored_size;
+}
+
+void MinidumpContainerEncoder::Finish(string *index, string *header) const {
+  *index = index_;
+  header->assign(kMagic, kMagicSize);
+  AppendLittleEndian(block_size_, 4, header);
+  AppendLittleEndian(block_count_, 4, header);
+  AppendLittleEndian(size_, 8, header);
+  AppendLittleEndian(offset_, 8, header);
+}
+
+MinidumpContainerReader::MinidumpContainerReader(std::istream *stream)
+    : stream_(stream),
+      block_size_(0),
+      size_(0),
+      next_cache_entry_(0),
+      blocks_decompressed_(0) {
+}
+
+bool MinidumpContainerReader::IsContainer(const char *data, size_t size) {
+  return size >= kMagicSize && memcmp(data, kMagic, kMagicSize) == 0;
+}
+
+bool MinidumpContainerReader::ReadIndex() {
+  blocks_.clear();
+  for (size_t i = 0; i < kCachedBlocks; i++)
+    cache_[i] = CachedBlock();
+
+  // Find the stream's length, to check the index against it before
+  // trusting the block count enough to allocate space for it.
+  stream_->clear();
+  stream_->seekg(0, std::ios::end);
+  std::streamoff length = stream_->tellg();
+  stream_->seekg(0, std::ios::beg);
+  uint8_t header_bytes[kMinidumpContainerHeaderSize];
+  if (length < std::streamoff(sizeof(header_bytes)) ||
+      !stream_->read(reinterpret_cast<char *>(header_bytes),
+                     sizeof(header_bytes)) ||
+      !IsContainer(reinterpret_cast<char *>(header_bytes),
+                   sizeof(header_bytes)))
+    return false;
+
+  ByteBuffer header(header_bytes, sizeof(header_bytes));
+  ByteCursor header_cursor(&header);
+  u_int32_t block_size, count;
+  u_int64_t index_offset;
+  header_cursor.Skip(kMagicSize) >> block_size >> count >> size_
+                                 >> index_offset;
+  if (!header_cursor || block_size == 0 ||
+      block_size > kMaxMinidumpContainerBlockSize ||
+      count != (size_ + block_size - 1) / block_size ||
+      index_offset < kMinidumpContainerHeaderSize ||
+      index_offset > u_int64_t(length) ||
+      u_int64_t(count) * kIndexEntrySize > u_int64_t(length) - index_offset)
+    return false;
+  block_size_ = block_size;
+
+  string index_bytes(count * kIndexEntrySize, '\0');
+  stream_->seekg(index_offset, std::ios::beg);
+  if (count && !stream_->read(&index_bytes[0], index_bytes.size()))
+    return false;
+
+  ByteBuffer index(reinterpret_cast<const uint8_t *>(index_bytes.data()),
+                   index_bytes.size());
+  ByteCursor cursor(&index);
+  blocks_.resize(count);
+  for (size_t i = 0; i < count; i++) {
+    Block &block = blocks_[i];
+    cursor >> block.offset >> block.stored_size;
+    u_int64_t size = std::min(u_int64_t(block_size_),
+                              size_ - u_int64_t(i) * block_size_);
+    if (!cursor ||
+        block.offset < kMinidumpContainerHeaderSize ||
+        block.offset > index_offset ||
+        block.stored_size > index_offset - block.offset ||
+        block.stored_size > size) {
+      blocks_.clear();
+      return false;
+    }
+  }
+  return true;
+}
+
+bool MinidumpContainerReader::Read(u_int64_t offset, void *bytes,
+                                   size_t count) {
+  if (offset > size_ || count > size_ - offset)
+    return false;
+
+  char *out = static_cast<char *>(bytes);
+  while (count > 0) {
+    size_t index = offset / block_size_;
+    size_t within = offset % block_size_;
+    const string *block = GetBlock(index);
+    if (!block)
+      return false;
+    size_t length = std::min(count, block->size() - within);
+    memcpy(out, block->data() + within, length);
+    out += length;
+    offset += length;
+    count -= length;
+  }
+  return true;
+}
+
+const string *MinidumpContainerReader::GetBlock(size_t index) {
+  if (index >= blocks_.size())
+    return NULL;
+  for (size_t i = 0; i < kCachedBlocks; i++) {
+    if (cache_[i].index == index)
+      return &cache_[i].data;
+  }
+
+  const Block &block = blocks_[index];
+  size_t size = std::min(u_int64_t(block_size_),
+                         size_ - u_int64_t(index) * block_size_);
+  string stored(block.stored_size, '\0');
+  stream_->clear();
+  stream_->seekg(block.offset, std::ios::beg);
+  if (block.stored_size &&
+      !stream_->read(&stored[0], block.stored_size))
+    return NULL;
+
+  CachedBlock &entry = cache_[next_cache_entry_];
+  next_cache_entry_ = (next_cache_entry_ + 1) % kCachedBlocks;
+  entry.index = ~size_t(0);
+  if (block.stored_size == size) {
+    entry.data.swap(stored);
+  } else if (!DecompressBlock(stored.data(), stored.size(), size,
+                              &entry.data)) {
+    return NULL;
+  }
+  entry.index = index;
+  blocks_decompressed_++;
+  return &entry.data;
+}
+
+}  // namespace google_breakpad
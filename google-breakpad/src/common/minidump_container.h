@@ -0,0 +1,193 @@
+// -*- mode: c++ -*-
+
+// Copyright (c) 2011, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// minidump_container.h: Block-compressed minidumps.
+//
+// A minidump container holds a minidump cut into fixed-size blocks
+// that are compressed independently, and an index at the end giving
+// where each block's compressed data lies. A reader that looks at only
+// a few streams or memory regions of a large minidump can decompress
+// just the blocks holding them.
+//
+// The layout is as follows; all integers are little-endian:
+//
+//   header: the eight bytes "BPMDMPZ1"
+//           32-bit size of each block once decompressed
+//           32-bit block count
+//           64-bit size of the minidump once decompressed
+//           64-bit offset of the index
+//   blocks: the minidump's bytes, each block compressed with
+//           CompressBlock; every block but the last is full-sized
+//   index:  one entry per block:
+//             64-bit offset of the block's data
+//             32-bit size of the block's data
+//
+// A block whose data is as large as its decompressed size is stored as
+// is, rather than compressed; this keeps every block's data no larger
+// than the block itself.
+
+#ifndef COMMON_MINIDUMP_CONTAINER_H_
+#define COMMON_MINIDUMP_CONTAINER_H_
+
+#include <stddef.h>
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "google_breakpad/common/breakpad_types.h"
+
+namespace google_breakpad {
+
+using std::string;
+using std::vector;
+
+// The size of a minidump container's header.
+const size_t kMinidumpContainerHeaderSize = 32;
+
+// The amount of minidump placed in each block, by default. Larger
+// blocks compress better; smaller ones mean less decompression for
+// each region a reader touches.
+const size_t kDefaultMinidumpContainerBlockSize = 64 * 1024;
+
+// The largest block size a container may use. Matches reach back no
+// more than 64k, so much larger blocks compress little better, and
+// readers reject anything larger rather than trust a corrupt header
+// with an allocation that size.
+const size_t kMaxMinidumpContainerBlockSize = 1024 * 1024;
+
+// A MinidumpContainerEncoder produces a minidump container one block
+// at a time, so that a minidump can be compressed without holding all
+// of it in memory.
+class MinidumpContainerEncoder {
+ public:
+  // Prepare to compress a minidump of SIZE bytes into blocks of
+  // BLOCK_SIZE bytes each. BLOCK_SIZE must be no larger than
+  // kMaxMinidumpContainerBlockSize.
+  MinidumpContainerEncoder(u_int64_t size, size_t block_size);
+
+  // Return the number of blocks the minidump is divided into.
+  size_t BlockCount() const { return block_count_; }
+
+  // Return the offset and size within the minidump of the INDEX'th
+  // block.
+  u_int64_t BlockOffset(size_t index) const;
+  size_t BlockSize(size_t index) const;
+
+  // Append the placeholder header that precedes the blocks to *OUT.
+  // The final header, written by Finish, has the same size.
+  void StartContainer(string *out) const;
+
+  // Append the data for the next block, whose SIZE bytes are at DATA,
+  // to *OUT. The blocks must be added in order.
+  void AddBlock(const char *data, size_t size, string *out);
+
+  // Once every block has been added, set *INDEX to the index that
+  // follows the blocks, and *HEADER to the final header.
+  void Finish(string *index, string *header) const;
+
+ private:
+  u_int64_t size_;
+  size_t block_size_;
+  size_t block_count_;
+
+  // The offset of the next block's data within the container.
+  u_int64_t offset_;
+
+  // The index entries for the blocks added so far.
+  string index_;
+};
+
+// A MinidumpContainerReader reads the minidump held in a container
+// from a stream, decompressing only the blocks that are read from.
+class MinidumpContainerReader {
+ public:
+  // Read from STREAM, which the caller continues to own.
+  explicit MinidumpContainerReader(std::istream *stream);
+
+  // Return true if DATA, which holds SIZE bytes, begins with a
+  // minidump container header.
+  static bool IsContainer(const char *data, size_t size);
+
+  // Read the container's header and index. Return false if they are
+  // malformed.
+  bool ReadIndex();
+
+  // Return the size of the minidump once decompressed.
+  u_int64_t size() const { return size_; }
+
+  // Copy the COUNT bytes at OFFSET in the decompressed minidump to
+  // BYTES. Return false if they extend past the end of the minidump, or
+  // if a block holding them cannot be read.
+  bool Read(u_int64_t offset, void *bytes, size_t count);
+
+  // Return the number of times a block has been decompressed.
+  size_t blocks_decompressed() const { return blocks_decompressed_; }
+
+ private:
+  // An entry in the container's index.
+  struct Block {
+    u_int64_t offset;
+    u_int32_t stored_size;
+  };
+
+  // A decompressed block, kept for later reads.
+  struct CachedBlock {
+    CachedBlock() : index(~size_t(0)) { }
+    size_t index;
+    string data;
+  };
+
+  // The number of decompressed blocks kept. Reads tend to come in runs
+  // within one region; a few entries let a stack walk go back and forth
+  // between a stack and the module list without decompressing either
+  // again.
+  static const size_t kCachedBlocks = 4;
+
+  // Return the INDEX'th block, decompressed, or NULL if it cannot be
+  // read.
+  const string *GetBlock(size_t index);
+
+  std::istream *stream_;
+  size_t block_size_;
+  u_int64_t size_;
+  vector<Block> blocks_;
+  CachedBlock cache_[kCachedBlocks];
+
+  // The cache entry to replace next.
+  size_t next_cache_entry_;
+
+  size_t blocks_decompressed_;
+};
+
+}  // namespace google_breakpad
+
+#endif  // COMMON_MINIDUMP_CONTAINER_H_
@@ -0,0 +1,190 @@
+// Copyright (c) 2011, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// minidump_container_unittest.cc: Unit tests for MinidumpContainerEncoder
+// and MinidumpContainerReader.
+
+#include <stdlib.h>
+
+#include <sstream>
+#include <string>
+
+#include "breakpad_googletest_includes.h"
+#include "common/minidump_container.h"
+
+using google_breakpad::MinidumpContainerEncoder;
+using google_breakpad::MinidumpContainerReader;
+using std::istringstream;
+using std::string;
+
+// Return a container holding DATA, in blocks of BLOCK_SIZE bytes.
+static string Encode(const string &data, size_t block_size) {
+  MinidumpContainerEncoder encoder(data.size(), block_size);
+  string container;
+  encoder.StartContainer(&container);
+  for (size_t i = 0; i < encoder.BlockCount(); i++) {
+    encoder.AddBlock(data.data() + encoder.BlockOffset(i),
+                     encoder.BlockSize(i), &container);
+  }
+  string index, header;
+  encoder.Finish(&index, &header);
+  container.append(index);
+  container.replace(0, header.size(), header);
+  return container;
+}
+
+// Return SIZE bytes that compress poorly.
+static string RandomBytes(size_t size) {
+  string data;
+  srand(0x5eed);
+  for (size_t i = 0; i < size; i++)
+    data.push_back(static_cast<char>(rand()));
+  return data;
+}
+
+TEST(MinidumpContainer, Empty) {
+  string container = Encode("", 1024);
+  istringstream stream(container);
+  MinidumpContainerReader reader(&stream);
+  ASSERT_TRUE(reader.ReadIndex());
+  EXPECT_EQ(0U, reader.size());
+  char byte;
+  EXPECT_TRUE(reader.Read(0, &byte, 0));
+  EXPECT_FALSE(reader.Read(0, &byte, 1));
+}
+
+TEST(MinidumpContainer, IsContainer) {
+  string container = Encode("MDMP", 1024);
+  EXPECT_TRUE(MinidumpContainerReader::IsContainer(container.data(),
+                                                   container.size()));
+  EXPECT_FALSE(MinidumpContainerReader::IsContainer(container.data(), 4));
+  EXPECT_FALSE(MinidumpContainerReader::IsContainer("MDMP\x93\xa7\0\0", 8));
+}
+
+TEST(MinidumpContainer, ReadAcrossBlocks) {
+  string data = string(10000, '\0') + RandomBytes(5000) + string(3333, 'x');
+  string container = Encode(data, 1024);
+  EXPECT_GT(data.size(), container.size());
+
+  istringstream stream(container);
+  MinidumpContainerReader reader(&stream);
+  ASSERT_TRUE(reader.ReadIndex());
+  ASSERT_EQ(data.size(), reader.size());
+
+  string all(data.size(), '\0');
+  ASSERT_TRUE(reader.Read(0, &all[0], all.size()));
+  EXPECT_TRUE(data == all);
+
+  // A range spanning compressed and stored blocks, ending in the short
+  // final block.
+  string tail(data.size() - 9000, '\0');
+  ASSERT_TRUE(reader.Read(9000, &tail[0], tail.size()));
+  EXPECT_TRUE(data.substr(9000) == tail);
+
+  char byte;
+  EXPECT_FALSE(reader.Read(data.size(), &byte, 1));
+  EXPECT_FALSE(reader.Read(data.size() - 1, &byte, 2));
+}
+
+TEST(MinidumpContainer, DecompressesOnlyTouchedBlocks) {
+  string data = RandomBytes(64 * 1024);
+  string container = Encode(data, 4096);
+  istringstream stream(container);
+  MinidumpContainerReader reader(&stream);
+  ASSERT_TRUE(reader.ReadIndex());
+  EXPECT_EQ(0U, reader.blocks_decompressed());
+
+  char bytes[16];
+  ASSERT_TRUE(reader.Read(5 * 4096 + 100, bytes, sizeof(bytes)));
+  EXPECT_EQ(0, data.compare(5 * 4096 + 100, sizeof(bytes),
+                            bytes, sizeof(bytes)));
+  EXPECT_EQ(1U, reader.blocks_decompressed());
+
+  // Reading the same block again uses the cached copy.
+  ASSERT_TRUE(reader.Read(5 * 4096, bytes, sizeof(bytes)));
+  EXPECT_EQ(1U, reader.blocks_decompressed());
+
+  // A read straddling two blocks needs both.
+  ASSERT_TRUE(reader.Read(9 * 4096 - 8, bytes, sizeof(bytes)));
+  EXPECT_EQ(0, data.compare(9 * 4096 - 8, sizeof(bytes),
+                            bytes, sizeof(bytes)));
+  EXPECT_EQ(3U, reader.blocks_decompressed());
+}
+
+TEST(MinidumpContainer, Malformed) {
+  string data = string(5000, 'a') + RandomBytes(3000);
+  string container = Encode(data, 1024);
+
+  // Not a container.
+  {
+    istringstream stream(data);
+    MinidumpContainerReader reader(&stream);
+    EXPECT_FALSE(reader.ReadIndex());
+  }
+
+  // Truncated, so the index runs past the end.
+  {
+    istringstream stream(container.substr(0, container.size() - 1));
+    MinidumpContainerReader reader(&stream);
+    EXPECT_FALSE(reader.ReadIndex());
+  }
+
+  // A block count that doesn't match the size.
+  {
+    string bad = container;
+    bad[12]++;
+    istringstream stream(bad);
+    MinidumpContainerReader reader(&stream);
+    EXPECT_FALSE(reader.ReadIndex());
+  }
+
+  // A block size larger than any encoder writes, even with a size and
+  // block count that agree with it.
+  {
+    string bad = Encode(RandomBytes(100), 1024);
+    for (int i = 8; i < 12; i++)
+      bad[i] = '\xff';
+    for (int i = 16; i < 20; i++)
+      bad[i] = '\xff';
+    istringstream stream(bad);
+    MinidumpContainerReader reader(&stream);
+    EXPECT_FALSE(reader.ReadIndex());
+  }
+
+  // Corrupt compressed data is caught when its block is read.
+  {
+    string bad = container;
+    bad[40] ^= 0x7f;
+    istringstream stream(bad);
+    MinidumpContainerReader reader(&stream);
+    ASSERT_TRUE(reader.ReadIndex());
+    string all(data.size(), '\0');
+    EXPECT_FALSE(reader.Read(0, &all[0], all.size()) && all == data);
+  }
+}
@@ -38,6 +38,7 @@
 #include <stdio.h>
 #include <string.h>
 
+#include <algorithm>
 #include <iostream>
 #include <utility>
 
@@ -54,7 +55,9 @@ Module::Module(const string &name, const string &os,
     os_(os),
     architecture_(architecture),
     id_(id),
-    load_address_(0) { }
+    load_address_(0),
+    compact_cfi_(false),
+    externs_sorted_(true) { }
 
 Module::~Module() {
   for (FileByNameMap::iterator it = files_.begin(); it != files_.end(); ++it)
@@ -67,7 +70,8 @@ Module::~Module() {
        it != stack_frame_entries_.end(); ++it) {
     delete *it;
   }
-  for (ExternSet::iterator it = externs_.begin(); it != externs_.end(); ++it)
+  for (vector<Extern *>::iterator it = externs_.begin();
+       it != externs_.end(); ++it)
     delete *it;
 }
 
@@ -75,6 +79,10 @@ void Module::SetLoadAddress(Address address) {
   load_address_ = address;
 }
 
+void Module::SetCompactCFI(bool compact_cfi) {
+  compact_cfi_ = compact_cfi;
+}
+
 void Module::AddFunction(Function *function) {
   // FUNC lines must not hold an empty name, so catch the problem early if
   // callers try to add one.
@@ -98,12 +106,36 @@ void Module::AddStackFrameEntry(StackFrameEntry *stack_frame_entry) {
 }
 
 void Module::AddExtern(Extern *ext) {
-  std::pair<ExternSet::iterator,bool> ret = externs_.insert(ext);
-  if (!ret.second) {
-    // Free the duplicate that was not inserted because this Module
-    // now owns it.
-    delete ext;
+  if (externs_sorted_ && !externs_.empty() &&
+      externs_.back()->address >= ext->address)
+    externs_sorted_ = false;
+  externs_.push_back(ext);
+}
+
+void Module::AddExterns(vector<Extern *>::iterator begin,
+                        vector<Extern *>::iterator end) {
+  externs_.reserve(externs_.size() + (end - begin));
+  for (vector<Extern *>::iterator it = begin; it != end; ++it)
+    AddExtern(*it);
+}
+
+void Module::SortExterns() {
+  if (externs_sorted_)
+    return;
+
+  // A stable sort leaves the first extern added at each address at the
+  // front of its run of duplicates.
+  std::stable_sort(externs_.begin(), externs_.end(), ExternCompare());
+  vector<Extern *>::iterator kept = externs_.begin();
+  for (vector<Extern *>::iterator it = externs_.begin();
+       it != externs_.end(); ++it) {
+    if (kept != externs_.begin() && (*(kept - 1))->address == (*it)->address)
+      delete *it;
+    else
+      *kept++ = *it;
   }
+  externs_.erase(kept, externs_.end());
+  externs_sorted_ = true;
 }
 
 void Module::GetFunctions(vector<Function *> *vec,
@@ -113,6 +145,7 @@ void Module::GetFunctions(vector<Function *> *vec,
 
 void Module::GetExterns(vector<Extern *> *vec,
                         vector<Extern *>::iterator i) {
+  SortExterns();
   vec->insert(i, externs_.begin(), externs_.end());
 }
 
@@ -204,6 +237,51 @@ bool Module::WriteRuleMap(const RuleMap &rule_map, std::ostream &stream) {
   return stream.good();
 }
 
+bool Module::WriteCFIRuleSets(std::ostream &stream, RuleMapIdMap *ids) {
+  // Count how many times each rule set appears. Most FDEs on a given
+  // architecture share a handful of rule sets, so this map stays small.
+  RuleMapIdMap counts;
+  for (vector<StackFrameEntry *>::const_iterator frame_it
+           = stack_frame_entries_.begin();
+       frame_it != stack_frame_entries_.end(); ++frame_it) {
+    StackFrameEntry *entry = *frame_it;
+    counts[&entry->initial_rules]++;
+    for (RuleChangeMap::const_iterator delta_it = entry->rule_changes.begin();
+         delta_it != entry->rule_changes.end(); ++delta_it)
+      counts[&delta_it->second]++;
+  }
+
+  // Number the repeated rule sets, and write them out. We number them
+  // in the map's order, so the output doesn't depend on the order in
+  // which the entries were added.
+  int next_id = 0;
+  for (RuleMapIdMap::const_iterator it = counts.begin();
+       it != counts.end(); ++it) {
+    // An empty rule set would produce a record with nothing after the
+    // number, which readers reject.
+    if (it->second < 2 || it->first->empty())
+      continue;
+    (*ids)[it->first] = next_id;
+    stream << "STACK CFI RULES " << hex << next_id << " " << dec;
+    if (!stream.good() || !WriteRuleMap(*it->first, stream))
+      return false;
+    stream << endl;
+    next_id++;
+  }
+
+  return stream.good();
+}
+
+bool Module::WriteRuleMapOrId(const RuleMap &rule_map,
+                              const RuleMapIdMap &ids,
+                              std::ostream &stream) {
+  RuleMapIdMap::const_iterator it = ids.find(&rule_map);
+  if (it == ids.end())
+    return WriteRuleMap(rule_map, stream);
+  stream << '@' << hex << it->second << dec;
+  return stream.good();
+}
+
 bool Module::Write(std::ostream &stream, bool cfi) {
   stream << "MODULE " << os_ << " " << architecture_ << " "
          << id_ << " " << name_ << endl;
@@ -249,7 +327,8 @@ bool Module::Write(std::ostream &stream, bool cfi) {
   }
 
   // Write out 'PUBLIC' records.
-  for (ExternSet::const_iterator extern_it = externs_.begin();
+  SortExterns();
+  for (vector<Extern *>::const_iterator extern_it = externs_.begin();
        extern_it != externs_.end(); ++extern_it) {
     Extern *ext = *extern_it;
     stream << "PUBLIC " << hex
@@ -260,6 +339,12 @@ bool Module::Write(std::ostream &stream, bool cfi) {
   }
 
   if (cfi) {
+    // If we've been asked to, write out the shared rule sets first, so
+    // that readers have seen them by the time they're referred to.
+    RuleMapIdMap rule_set_ids;
+    if (compact_cfi_ && !WriteCFIRuleSets(stream, &rule_set_ids))
+      return ReportError();
+
     // Write out 'STACK CFI INIT' and 'STACK CFI' records.
     vector<StackFrameEntry *>::const_iterator frame_it;
     for (frame_it = stack_frame_entries_.begin();
@@ -269,7 +354,7 @@ bool Module::Write(std::ostream &stream, bool cfi) {
              << (entry->address - load_address_) << " "
              << entry->size << " " << dec;
       if (!stream.good()
-          || !WriteRuleMap(entry->initial_rules, stream))
+          || !WriteRuleMapOrId(entry->initial_rules, rule_set_ids, stream))
         return ReportError();
 
       stream << endl;
@@ -280,7 +365,7 @@ bool Module::Write(std::ostream &stream, bool cfi) {
         stream << "STACK CFI " << hex
                << (delta_it->first - load_address_) << " " << dec;
         if (!stream.good()
-            || !WriteRuleMap(delta_it->second, stream))
+            || !WriteRuleMapOrId(delta_it->second, rule_set_ids, stream))
           return ReportError();
 
         stream << endl;
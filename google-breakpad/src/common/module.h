@@ -188,6 +188,14 @@ class Module {
   // Write is used.
   void SetLoadAddress(Address load_address);
 
+  // If COMPACT_CFI is true, have Write emit each set of CFI rules that
+  // appears more than once only once, as a numbered 'STACK CFI RULES'
+  // record, and have 'STACK CFI INIT' and 'STACK CFI' records refer to
+  // it by number, as '@<number>'. Otherwise, write every record's
+  // rules out in full. Construction initializes this to false, since
+  // older symbol file readers don't understand the compact form.
+  void SetCompactCFI(bool compact_cfi);
+
   // Add FUNCTION to the module. FUNCTION's name must not be empty.
   // This module owns all Function objects added with this function:
   // destroying the module destroys them as well.
@@ -209,6 +217,14 @@ class Module {
   // destroying the module destroys them as well.
   void AddExtern(Extern *ext);
 
+  // Add all the externs in [BEGIN,END) to the module. This module owns
+  // all Extern objects added with this function: destroying the module
+  // destroys them as well. Adding externs that are already sorted by
+  // address, and that follow those already present, saves the module
+  // from sorting them later.
+  void AddExterns(vector<Extern *>::iterator begin,
+                  vector<Extern *>::iterator end);
+
   // If this module has a file named NAME, return a pointer to it. If
   // it has none, then create one and return a pointer to the new
   // file. This module owns all File objects created using these
@@ -262,7 +278,8 @@ class Module {
   // - the source files added via FindFile,
   // - the functions added via AddFunctions, each with its lines,
   // - all public records,
-  // - and if CFI is true, all CFI records.
+  // - and if CFI is true, all CFI records, using the compact form
+  //   if SetCompactCFI has asked for it.
   // Addresses in the output are all relative to the load address
   // established by SetLoadAddress.
   bool Write(std::ostream &stream, bool cfi);
@@ -277,6 +294,34 @@ class Module {
   // if an error occurs, return false, and leave errno set.
   static bool WriteRuleMap(const RuleMap &rule_map, std::ostream &stream);
 
+  // Sort externs_ by address, and delete all but the first extern added
+  // at each address.
+  void SortExterns();
+
+  // Relation for maps whose keys are RuleMaps owned by some other
+  // structure.
+  struct CompareRuleMapPtrs {
+    bool operator()(const RuleMap *x, const RuleMap *y) const {
+      return *x < *y;
+    }
+  };
+
+  // A map from rule sets to the numbers of the 'STACK CFI RULES'
+  // records that define them.
+  typedef map<const RuleMap *, int, CompareRuleMapPtrs> RuleMapIdMap;
+
+  // Find the CFI rule sets that appear more than once in this module's
+  // stack frame entries, write a 'STACK CFI RULES' record for each one
+  // to STREAM, and record their numbers in IDS. Return true if all
+  // goes well; if an error occurs, return false, and leave errno set.
+  bool WriteCFIRuleSets(std::ostream &stream, RuleMapIdMap *ids);
+
+  // Write RULE_MAP to STREAM as WriteRuleMap does, unless IDS assigns
+  // it a number, in which case write a reference to that number.
+  static bool WriteRuleMapOrId(const RuleMap &rule_map,
+                               const RuleMapIdMap &ids,
+                               std::ostream &stream);
+
   // Module header entries.
   string name_, os_, architecture_, id_;
 
@@ -285,6 +330,9 @@ class Module {
   // address.
   Address load_address_;
 
+  // True if Write should use the compact 'STACK CFI RULES' encoding.
+  bool compact_cfi_;
+
   // Relation for maps whose keys are strings shared with some other
   // structure.
   struct CompareStringPtrs {
@@ -298,9 +346,6 @@ class Module {
   // A set containing Function structures, sorted by address.
   typedef set<Function *, FunctionCompare> FunctionSet;
 
-  // A set containing Extern structures, sorted by address.
-  typedef set<Extern *, ExternCompare> ExternSet;
-
   // The module owns all the files and functions that have been added
   // to it; destroying the module frees the Files and Functions these
   // point to.
@@ -312,8 +357,15 @@ class Module {
   vector<StackFrameEntry *> stack_frame_entries_;
 
   // The module owns all the externs that have been added to it;
-  // destroying the module frees the Externs these point to.
-  ExternSet externs_;
+  // destroying the module frees the Externs these point to. Rather than
+  // keeping them in a set, we simply append them here, and then sort
+  // them and discard duplicates when someone asks for them; see
+  // SortExterns. Symbol tables can hold millions of externs.
+  vector<Extern *> externs_;
+
+  // True if externs_ is known to be sorted by address, with no two
+  // externs at the same address.
+  bool externs_sorted_;
 };
 
 }  // namespace google_breakpad
@@ -255,6 +255,45 @@ TEST(Write, NoCFI) {
                contents.c_str());
 }
 
+TEST(Write, CompactCFI) {
+  stringstream s;
+  Module m(MODULE_NAME, MODULE_OS, MODULE_ARCH, MODULE_ID);
+
+  // Two entries that share their initial rules, and a rule change
+  // that appears in both.
+  Module::StackFrameEntry *entry1 = new Module::StackFrameEntry();
+  entry1->address = 0x1000;
+  entry1->size = 0x20;
+  entry1->initial_rules[".cfa"] = "$rsp 8 +";
+  entry1->initial_rules[".ra"] = ".cfa 8 - ^";
+  entry1->rule_changes[0x1001][".cfa"] = "$rsp 16 +";
+  entry1->rule_changes[0x1004][".cfa"] = "$rbp 16 +";
+  entry1->rule_changes[0x1004]["$rbp"] = ".cfa 16 - ^";
+  m.AddStackFrameEntry(entry1);
+
+  Module::StackFrameEntry *entry2 = new Module::StackFrameEntry();
+  entry2->address = 0x1020;
+  entry2->size = 0x30;
+  entry2->initial_rules[".cfa"] = "$rsp 8 +";
+  entry2->initial_rules[".ra"] = ".cfa 8 - ^";
+  entry2->rule_changes[0x1024][".cfa"] = "$rbp 16 +";
+  entry2->rule_changes[0x1024]["$rbp"] = ".cfa 16 - ^";
+  m.AddStackFrameEntry(entry2);
+
+  m.SetCompactCFI(true);
+  m.Write(s, true);
+  string contents = s.str();
+  EXPECT_STREQ("MODULE os-name architecture id-string name with spaces\n"
+               "STACK CFI RULES 0 $rbp: .cfa 16 - ^ .cfa: $rbp 16 +\n"
+               "STACK CFI RULES 1 .cfa: $rsp 8 + .ra: .cfa 8 - ^\n"
+               "STACK CFI INIT 1000 20 @1\n"
+               "STACK CFI 1001 .cfa: $rsp 16 +\n"
+               "STACK CFI 1004 @0\n"
+               "STACK CFI INIT 1020 30 @1\n"
+               "STACK CFI 1024 @0\n",
+               contents.c_str());
+}
+
 TEST(Construct, AddFunctions) {
   stringstream s;
   Module m(MODULE_NAME, MODULE_OS, MODULE_ARCH, MODULE_ID);
@@ -488,3 +527,40 @@ TEST(Construct, DuplicateExterns) {
                "PUBLIC ffff 0 _xyz\n",
                contents.c_str());
 }
+
+// Externs added in bulk should be merged with those already present,
+// keeping the first entry at each address.
+TEST(Construct, AddExterns) {
+  stringstream s;
+  Module m(MODULE_NAME, MODULE_OS, MODULE_ARCH, MODULE_ID);
+
+  Module::Extern *extern1 = new(Module::Extern);
+  extern1->address = 0xbbbb;
+  extern1->name = "_abc";
+  m.AddExtern(extern1);
+
+  vector<Module::Extern *> externs;
+  Module::Extern *extern2 = new(Module::Extern);
+  extern2->address = 0xaaaa;
+  extern2->name = "_def";
+  externs.push_back(extern2);
+  Module::Extern *extern3 = new(Module::Extern);
+  extern3->address = 0xbbbb;
+  extern3->name = "_ghi";
+  externs.push_back(extern3);
+  Module::Extern *extern4 = new(Module::Extern);
+  extern4->address = 0xcccc;
+  extern4->name = "_jkl";
+  externs.push_back(extern4);
+  m.AddExterns(externs.begin(), externs.end());
+
+  m.Write(s, true);
+  string contents = s.str();
+
+  EXPECT_STREQ("MODULE " MODULE_OS " " MODULE_ARCH " "
+               MODULE_ID " " MODULE_NAME "\n"
+               "PUBLIC aaaa 0 _def\n"
+               "PUBLIC bbbb 0 _abc\n"
+               "PUBLIC cccc 0 _jkl\n",
+               contents.c_str());
+}
@@ -41,57 +41,46 @@ using std::vector;
 
 namespace google_breakpad {
 
-StabsReader::EntryIterator::EntryIterator(const ByteBuffer *buffer,
-                                          bool big_endian, size_t value_size)
-    : value_size_(value_size), cursor_(buffer, big_endian) {
-  // Actually, we could handle weird sizes just fine, but they're
-  // probably mistakes --- expressed in bits, say.
-  assert(value_size == 4 || value_size == 8);
-  entry_.index = 0;
-  Fetch();
-}
-
-void StabsReader::EntryIterator::Fetch() {
-  cursor_
-      .Read(4, false, &entry_.name_offset)
-      .Read(1, false, &entry_.type)
-      .Read(1, false, &entry_.other)
-      .Read(2, false, &entry_.descriptor)
-      .Read(value_size_, false, &entry_.value);
-  entry_.at_end = !cursor_;
-}
-
 StabsReader::StabsReader(const uint8_t *stab,    size_t stab_size,
                          const uint8_t *stabstr, size_t stabstr_size,
                          bool big_endian, size_t value_size, bool unitized,
                          StabsHandler *handler)
-    : entries_(stab, stab_size),
+    : stab_(stab, stab_size),
       strings_(stabstr, stabstr_size),
-      iterator_(&entries_, big_endian, value_size),
+      big_endian_(big_endian),
+      value_size_(value_size),
+      symbol_(0),
       unitized_(unitized),
       handler_(handler),
-      string_offset_(0),
-      next_cu_string_offset_(0),
-      current_source_file_(NULL) { }
-
-const char *StabsReader::SymbolString() {
-  ptrdiff_t offset = string_offset_ + iterator_->name_offset;
-  if (offset < 0 || (size_t) offset >= strings_.Size()) {
-    handler_->Warning("symbol %d: name offset outside the string section\n",
-                      iterator_->index);
-    // Return our null string, to keep our promise about all names being
-    // taken from the string section.
-    offset = 0;
-  }
-  return reinterpret_cast<const char *>(strings_.start + offset);
+      current_source_file_(NULL) {
+  // Actually, we could handle weird sizes just fine, but they're
+  // probably mistakes --- expressed in bits, say.
+  assert(value_size == 4 || value_size == 8);
 }
 
-bool StabsReader::Process() {
-  while (!iterator_->at_end) {
-    if (iterator_->type == N_SO) {
-      if (! ProcessCompilationUnit())
-        return false;
-    } else if (iterator_->type == N_UNDF && unitized_) {
+template<bool big_endian, size_t value_size>
+void StabsReader::DecodeEntries() {
+  // Each entry is a four-byte name offset, a one-byte type, a one-byte
+  // 'other' field, a two-byte descriptor, and the value. Any partial
+  // entry at the end of the section is ignored.
+  const size_t entry_size = 4 + 1 + 1 + 2 + value_size;
+  const size_t count = stab_.Size() / entry_size;
+  entries_.name_offsets.resize(count);
+  entries_.types.resize(count);
+  entries_.descriptors.resize(count);
+  entries_.values.resize(count);
+
+  // The offset of the current compilation unit's strings within
+  // strings_, and the offset the next compilation unit's strings will
+  // have, as established by N_UNDF entries.
+  uint64_t string_offset = 0;
+  uint64_t next_cu_string_offset = 0;
+
+  const uint8_t *entry = stab_.start;
+  for (size_t i = 0; i < count; i++, entry += entry_size) {
+    unsigned char type = entry[4];
+    uint64_t value = ReadUnalignedUnsigned<big_endian, value_size>(entry + 8);
+    if (type == N_UNDF && unitized_) {
       // In unitized STABS (including Linux STABS, and pretty much anything
       // else that puts STABS data in sections), at the head of each
       // compilation unit's entries there is an N_UNDF stab giving the
@@ -104,28 +93,65 @@ bool StabsReader::Process() {
       // compilation units into one, with a single N_UNDF at the
       // beginning. However, other linkers, like Gold, do not perform
       // this optimization.
-      string_offset_ = next_cu_string_offset_;
-      next_cu_string_offset_ = iterator_->value;
-      ++iterator_;
+      string_offset = next_cu_string_offset;
+      next_cu_string_offset += value;
+    }
+    entries_.name_offsets[i] =
+        string_offset + ReadUnalignedUnsigned<big_endian, 4>(entry);
+    entries_.types[i] = type;
+    entries_.descriptors[i] = ReadUnalignedUnsigned<big_endian, 2>(entry + 6);
+    entries_.values[i] = value;
+  }
+}
+
+const char *StabsReader::SymbolString() {
+  uint64_t offset = entries_.name_offsets[symbol_];
+  if (offset >= strings_.Size()) {
+    handler_->Warning("symbol %d: name offset outside the string section\n",
+                      symbol_);
+    // Return our null string, to keep our promise about all names being
+    // taken from the string section.
+    offset = 0;
+  }
+  return reinterpret_cast<const char *>(strings_.start + offset);
+}
+
+bool StabsReader::Process() {
+  if (big_endian_) {
+    if (value_size_ == 4)
+      DecodeEntries<true, 4>();
+    else
+      DecodeEntries<true, 8>();
+  } else {
+    if (value_size_ == 4)
+      DecodeEntries<false, 4>();
+    else
+      DecodeEntries<false, 8>();
+  }
+
+  while (!AtEnd()) {
+    if (Type() == N_SO) {
+      if (! ProcessCompilationUnit())
+        return false;
     }
 #if defined(HAVE_MACH_O_NLIST_H)
     // Export symbols in Mach-O binaries look like this.
     // This is necessary in order to be able to dump symbols
     // from OS X system libraries.
-    else if ((iterator_->type & N_STAB) == 0 &&
-               (iterator_->type & N_TYPE) == N_SECT) {
+    else if ((Type() & N_STAB) == 0 &&
+               (Type() & N_TYPE) == N_SECT) {
       ProcessExtern();
     }
 #endif
     else {
-      ++iterator_;
+      ++symbol_;
     }
   }
   return true;
 }
 
 bool StabsReader::ProcessCompilationUnit() {
-  assert(!iterator_->at_end && iterator_->type == N_SO);
+  assert(!AtEnd() && Type() == N_SO);
 
   // There may be an N_SO entry whose name ends with a slash,
   // indicating the directory in which the compilation occurred.
@@ -135,32 +161,32 @@ bool StabsReader::ProcessCompilationUnit() {
     const char *name = SymbolString();
     if (name[0] && name[strlen(name) - 1] == '/') {
       build_directory = name;
-      ++iterator_;
+      ++symbol_;
     }
   }
       
   // We expect to see an N_SO entry with a filename next, indicating
   // the start of the compilation unit.
   {
-    if (iterator_->at_end || iterator_->type != N_SO)
+    if (AtEnd() || Type() != N_SO)
       return true;
     const char *name = SymbolString();
     if (name[0] == '\0') {
       // This seems to be a stray end-of-compilation-unit marker;
       // consume it, but don't report the end, since we didn't see a
       // beginning.
-      ++iterator_;
+      ++symbol_;
       return true;
     }
     current_source_file_ = name;
   }
 
   if (! handler_->StartCompilationUnit(current_source_file_,
-                                       iterator_->value,
+                                       Value(),
                                        build_directory))
     return false;
 
-  ++iterator_;
+  ++symbol_;
 
   // The STABS documentation says that some compilers may emit
   // additional N_SO entries with names immediately following the
@@ -168,41 +194,41 @@ bool StabsReader::ProcessCompilationUnit() {
   // Breakpad STABS reader doesn't ignore them, so we won't either.
 
   // Process the body of the compilation unit, up to the next N_SO.
-  while (!iterator_->at_end && iterator_->type != N_SO) {
-    if (iterator_->type == N_FUN) {
+  while (!AtEnd() && Type() != N_SO) {
+    if (Type() == N_FUN) {
       if (! ProcessFunction())
         return false;
-    } else if (iterator_->type == N_SLINE) {
+    } else if (Type() == N_SLINE) {
       // Mac OS X STABS place SLINE records before functions.
       Line line;
       // The value of an N_SLINE entry that appears outside a function is
       // the absolute address of the line.
-      line.address = iterator_->value;
+      line.address = Value();
       line.filename = current_source_file_;
       // The n_desc of a N_SLINE entry is the line number.  It's a
       // signed 16-bit field; line numbers from 32768 to 65535 are
       // stored as n-65536.
-      line.number = (uint16_t) iterator_->descriptor;
+      line.number = (uint16_t) entries_.descriptors[symbol_];
       queued_lines_.push_back(line);
-      ++iterator_;
-    } else if (iterator_->type == N_SOL) {
+      ++symbol_;
+    } else if (Type() == N_SOL) {
       current_source_file_ = SymbolString();
-      ++iterator_;
+      ++symbol_;
     } else {
       // Ignore anything else.
-      ++iterator_;
+      ++symbol_;
     }
   }
 
   // An N_SO with an empty name indicates the end of the compilation
   // unit.  Default to zero.
   uint64_t ending_address = 0;
-  if (!iterator_->at_end) {
-    assert(iterator_->type == N_SO);
+  if (!AtEnd()) {
+    assert(Type() == N_SO);
     const char *name = SymbolString();
     if (name[0] == '\0') {
-      ending_address = iterator_->value;
-      ++iterator_;
+      ending_address = Value();
+      ++symbol_;
     }
   }
 
@@ -215,9 +241,9 @@ bool StabsReader::ProcessCompilationUnit() {
 }          
 
 bool StabsReader::ProcessFunction() {
-  assert(!iterator_->at_end && iterator_->type == N_FUN);
+  assert(!AtEnd() && Type() == N_FUN);
 
-  uint64_t function_address = iterator_->value;
+  uint64_t function_address = Value();
   // The STABS string for an N_FUN entry is the name of the function,
   // followed by a colon, followed by type information for the
   // function.  We want to pass the name alone to StartFunction.
@@ -225,10 +251,10 @@ bool StabsReader::ProcessFunction() {
   const char *name_end = strchr(stab_string, ':');
   if (! name_end)
     name_end = stab_string + strlen(stab_string);
-  std::string name(stab_string, name_end - stab_string);
-  if (! handler_->StartFunction(name, function_address))
+  name_.assign(stab_string, name_end - stab_string);
+  if (! handler_->StartFunction(name_, function_address))
     return false;
-  ++iterator_;
+  ++symbol_;
 
   // If there were any SLINE records given before the function, report them now.
   for (vector<Line>::const_iterator it = queued_lines_.begin();
@@ -238,52 +264,52 @@ bool StabsReader::ProcessFunction() {
   }
   queued_lines_.clear();
   
-  while (!iterator_->at_end) {
-    if (iterator_->type == N_SO || iterator_->type == N_FUN)
+  while (!AtEnd()) {
+    if (Type() == N_SO || Type() == N_FUN)
       break;
-    else if (iterator_->type == N_SLINE) {
+    else if (Type() == N_SLINE) {
       // The value of an N_SLINE entry is the offset of the line from
       // the function's start address.
-      uint64_t line_address = function_address + iterator_->value;
+      uint64_t line_address = function_address + Value();
       // The n_desc of a N_SLINE entry is the line number.  It's a
       // signed 16-bit field; line numbers from 32768 to 65535 are
       // stored as n-65536.
-      uint16_t line_number = iterator_->descriptor;
+      uint16_t line_number = entries_.descriptors[symbol_];
       if (! handler_->Line(line_address, current_source_file_, line_number))
         return false;
-      ++iterator_;
-    } else if (iterator_->type == N_SOL) {
+      ++symbol_;
+    } else if (Type() == N_SOL) {
       current_source_file_ = SymbolString();
-      ++iterator_;
+      ++symbol_;
     } else
       // Ignore anything else.
-      ++iterator_;
+      ++symbol_;
   }
 
   // We've reached the end of the function. See if we can figure out its
   // ending address.
   uint64_t ending_address = 0;
-  if (!iterator_->at_end) {
-    assert(iterator_->type == N_SO || iterator_->type == N_FUN);
-    if (iterator_->type == N_FUN) {
+  if (!AtEnd()) {
+    assert(Type() == N_SO || Type() == N_FUN);
+    if (Type() == N_FUN) {
       const char *name = SymbolString();
       if (name[0] == '\0') {
         // An N_FUN entry with no name is a terminator for this function;
         // its value is the function's size.
-        ending_address = function_address + iterator_->value;
-        ++iterator_;
+        ending_address = function_address + Value();
+        ++symbol_;
       } else {
         // An N_FUN entry with a name is the next function, and we can take
         // its value as our ending address. Don't advance the iterator, as
         // we'll use this symbol to start the next function as well.
-        ending_address = iterator_->value;
+        ending_address = Value();
       }
     } else {
       // An N_SO entry could be an end-of-compilation-unit marker, or the
       // start of the next compilation unit, but in either case, its value
       // is our ending address. We don't advance the iterator;
       // ProcessCompilationUnit will decide what to do with this symbol.
-      ending_address = iterator_->value;
+      ending_address = Value();
     }
   }
 
@@ -295,16 +321,17 @@ bool StabsReader::ProcessFunction() {
 
 bool StabsReader::ProcessExtern() {
 #if defined(HAVE_MACH_O_NLIST_H)
-  assert(!iterator_->at_end &&
-         (iterator_->type & N_STAB) == 0 &&
-         (iterator_->type & N_TYPE) == N_SECT);
+  assert(!AtEnd() &&
+         (Type() & N_STAB) == 0 &&
+         (Type() & N_TYPE) == N_SECT);
 #endif
 
   // TODO(mark): only do symbols in the text section?
-  if (!handler_->Extern(SymbolString(), iterator_->value))
+  name_ = SymbolString();
+  if (!handler_->Extern(name_, Value()))
     return false;
 
-  ++iterator_;
+  ++symbol_;
   return true;
 }
 
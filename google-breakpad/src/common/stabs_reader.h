@@ -109,72 +109,42 @@ class StabsReader {
 
  private:
 
-  // An class for walking arrays of STABS entries. This isolates the main
-  // STABS reader from the exact format (size; endianness) of the entries
-  // themselves.
-  class EntryIterator {
-   public:
-    // The contents of a STABS entry, adjusted for the host's endianness,
-    // word size, 'struct nlist' layout, and so on.
-    struct Entry {
-      // True if this iterator has reached the end of the entry array. When
-      // this is set, the other members of this structure are not valid.
-      bool at_end;
-
-      // The number of this entry within the list.
-      size_t index;
-
-      // The current entry's name offset. This is the offset within the
-      // current compilation unit's strings, as establish by the N_UNDF entries.
-      size_t name_offset;
-
-      // The current entry's type, 'other' field, descriptor, and value.
-      unsigned char type;
-      unsigned char other;
-      short descriptor;
-      uint64_t value;
-    };
-
-    // Create a EntryIterator walking the entries in BUFFER. Treat the
-    // entries as big-endian if BIG_ENDIAN is true, as little-endian
-    // otherwise. Assume each entry has a 'value' field whose size is
-    // VALUE_SIZE.
-    //
-    // This would not be terribly clean to extend to other format variations,
-    // but it's enough to handle Linux and Mac, and we'd like STABS to die
-    // anyway.
-    //
-    // For the record: on Linux, STABS entry values are always 32 bits,
-    // regardless of the architecture address size (don't ask me why); on
-    // Mac, they are 32 or 64 bits long. Oddly, the section header's entry
-    // size for a Linux ELF .stab section varies according to the ELF class
-    // from 12 to 20 even as the actual entries remain unchanged.
-    EntryIterator(const ByteBuffer *buffer, bool big_endian, size_t value_size);
-
-    // Move to the next entry. This function's behavior is undefined if
-    // at_end() is true when it is called.
-    EntryIterator &operator++() { Fetch(); entry_.index++; return *this; }
-
-    // Dereferencing this iterator produces a reference to an Entry structure
-    // that holds the current entry's values. The entry is owned by this
-    // EntryIterator, and will be invalidated at the next call to operator++.
-    const Entry &operator*() const { return entry_; }
-    const Entry *operator->() const { return &entry_; }
-
-   private:
-    // Read the STABS entry at cursor_, and set entry_ appropriately.
-    void Fetch();
-
-    // The size of entries' value field, in bytes.
-    size_t value_size_;
-
-    // A byte cursor traversing buffer_.
-    ByteCursor cursor_;
-
-    // Values for the entry this iterator refers to.
-    Entry entry_;
+  // The STABS entries, decoded from the .stab section in a single pass
+  // by DecodeEntries. Rather than an array of 'struct nlist'-like
+  // records, we keep one array per field, all indexed by entry number;
+  // the loops that walk the entries mostly look only at the type, and
+  // this keeps the types packed together. The values are adjusted for
+  // the host's endianness and word size.
+  //
+  // For the record: on Linux, STABS entry values are always 32 bits,
+  // regardless of the architecture address size (don't ask me why); on
+  // Mac, they are 32 or 64 bits long. Oddly, the section header's entry
+  // size for a Linux ELF .stab section varies according to the ELF class
+  // from 12 to 20 even as the actual entries remain unchanged.
+  struct Entries {
+    // Each entry's name, as an offset within the entire string section.
+    // DecodeEntries has already added in the offset of the entry's
+    // compilation unit's strings, as established by N_UNDF entries, so
+    // these are ready to use as indices into strings_.
+    std::vector<uint64_t> name_offsets;
+
+    // Each entry's type, descriptor, and value. We don't use the 'other'
+    // field, so we don't keep it.
+    std::vector<unsigned char> types;
+    std::vector<short> descriptors;
+    std::vector<uint64_t> values;
   };
 
+  // Fill in entries_ from the raw .stab section contents in stab_.
+  template<bool big_endian, size_t value_size> void DecodeEntries();
+
+  // Return true if we have processed every entry.
+  bool AtEnd() const { return symbol_ >= entries_.types.size(); }
+
+  // Return the current entry's type and value.
+  unsigned char Type() const { return entries_.types[symbol_]; }
+  uint64_t Value() const { return entries_.values[symbol_]; }
+
   // A source line, saved to be reported later.
   struct Line {
     uint64_t address;
@@ -197,14 +167,22 @@ class StabsReader {
   // Return true to continue processing, or false to abort.
   bool ProcessExtern();
 
-  // The STABS entries being parsed.
-  ByteBuffer entries_;
+  // The raw contents of the .stab section.
+  ByteBuffer stab_;
 
   // The string section to which the entries refer.
   ByteBuffer strings_;
 
-  // The iterator walking the STABS entries.
-  EntryIterator iterator_;
+  // True if the entries in stab_ are big-endian, and the size of their
+  // 'value' field in bytes.
+  bool big_endian_;
+  size_t value_size_;
+
+  // The decoded STABS entries.
+  Entries entries_;
+
+  // The index of the entry we're currently processing.
+  size_t symbol_;
 
   // True if the data is "unitized"; see the explanation in the comment for
   // StabsReader::StabsReader.
@@ -212,13 +190,6 @@ class StabsReader {
 
   StabsHandler *handler_;
 
-  // The offset of the current compilation unit's strings within stabstr_.
-  size_t string_offset_;
-
-  // The value string_offset_ should have for the next compilation unit,
-  // as established by N_UNDF entries.
-  size_t next_cu_string_offset_;
-
   // The current source file name.
   const char *current_source_file_;
 
@@ -226,6 +197,11 @@ class StabsReader {
   // vector of these until we see the FUN record, and then report them
   // after the StartFunction call.
   std::vector<Line> queued_lines_;
+
+  // A buffer for the names we pass to StartFunction and Extern, reused
+  // from one call to the next so that we don't allocate a new string for
+  // each.
+  std::string name_;
 };
 
 // Consumer-provided callback structure for the STABS reader.  Clients
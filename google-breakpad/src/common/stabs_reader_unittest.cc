@@ -448,6 +448,48 @@ TEST_F(Stabs, Unitized) {
   ASSERT_TRUE(ApplyHandlerToMockStabsData());
 }
 
+// Each N_UNDF header gives the size of its own compilation unit's strings,
+// so the third unit's strings start after both of the first two units'.
+TEST_F(Stabs, UnitizedThreeUnits) {
+  stabs.set_endianness(kLittleEndian);
+  stabs.set_value_size(4);
+  stabs
+      .StartCU("bismuth")
+      .Stab(N_SO,   0, 0, 0x1000, "bismuth.c")
+      .Stab(N_SO,   0, 0, 0x1100, "")
+      .EndCU()
+      .StartCU("cobalt")
+      .Stab(N_SO,   0, 0, 0x2000, "cobalt-with-a-longer-name.c")
+      .Stab(N_SO,   0, 0, 0x2100, "")
+      .EndCU()
+      .StartCU("dysprosium")
+      .Stab(N_SO,   0, 0, 0x3000, "dysprosium.c")
+      .Stab(N_SO,   0, 0, 0x3100, "")
+      .EndCU();
+
+  {
+    InSequence s;
+    EXPECT_CALL(mock_handler,
+                StartCompilationUnit(StrEq("bismuth.c"), 0x1000, NULL))
+        .WillOnce(Return(true));
+    EXPECT_CALL(mock_handler, EndCompilationUnit(0x1100))
+        .WillOnce(Return(true));
+    EXPECT_CALL(mock_handler,
+                StartCompilationUnit(StrEq("cobalt-with-a-longer-name.c"),
+                                     0x2000, NULL))
+        .WillOnce(Return(true));
+    EXPECT_CALL(mock_handler, EndCompilationUnit(0x2100))
+        .WillOnce(Return(true));
+    EXPECT_CALL(mock_handler,
+                StartCompilationUnit(StrEq("dysprosium.c"), 0x3000, NULL))
+        .WillOnce(Return(true));
+    EXPECT_CALL(mock_handler, EndCompilationUnit(0x3100))
+        .WillOnce(Return(true));
+  }
+
+  ASSERT_TRUE(ApplyHandlerToMockStabsData());
+}
+
 // On systems that store STABS entries in the real symbol table, the N_UNDF
 // entries have no special meaning, and shouldn't mess up the string
 // indices.
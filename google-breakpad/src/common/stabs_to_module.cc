@@ -46,9 +46,9 @@ using std::string;
 
 // Demangle using abi call.
 // Older GCC may not support it.
-static string Demangle(const string &mangled) {
+static string Demangle(const char *mangled) {
   int status = 0;
-  char *demangled = abi::__cxa_demangle(mangled.c_str(), NULL, NULL, &status);
+  char *demangled = abi::__cxa_demangle(mangled, NULL, NULL, &status);
   if (status == 0 && demangled != NULL) {
     string str(demangled);
     free(demangled);
@@ -92,7 +92,7 @@ bool StabsToModule::StartFunction(const string &name,
                                   uint64_t address) {
   assert(!current_function_);
   Module::Function *f = new Module::Function;
-  f->name = Demangle(name);
+  f->name = Demangle(name.c_str());
   f->address = address;
   f->size = 0;           // We compute this in StabsToModule::Finalize().
   f->parameter_size = 0; // We don't provide this information.
@@ -138,9 +138,9 @@ bool StabsToModule::Extern(const string &name, uint64_t address) {
   // Older libstdc++ demangle implementations can crash on unexpected
   // input, so be careful about what gets passed in.
   if (name.compare(0, 3, "__Z") == 0) {
-    ext->name = Demangle(name.substr(1));
+    ext->name = Demangle(name.c_str() + 1);
   } else if (name[0] == '_') {
-    ext->name = name.substr(1);
+    ext->name.assign(name, 1, string::npos);
   } else {
     ext->name = name;
   }
@@ -0,0 +1,346 @@
+// Copyright (c) 2010, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// symbol_container.cc: Implementation of WriteSymbolContainer and
+// SymbolContainer. See symbol_container.h for details.
+
+#include "common/symbol_container.h"
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include "common/block_compression.h"
+#include "common/byte_cursor.h"
+
+namespace google_breakpad {
+
+namespace {
+
+const char kMagic[] = "BPSYMZ01";
+const size_t kMagicSize = 8;
+const size_t kHeaderSize = kMagicSize + 8;
+const size_t kIndexEntrySize = 8 + 4 + 4 + 8 + 8;
+
+// A block being assembled, before compression.
+struct PendingBlock {
+  explicit PendingBlock(int set_kind) : kind(set_kind), low(~0ULL), high(0) { }
+  int kind;  // a SymbolFileUnit::Kind, or -1 for block 0
+  u_int64_t low, high;
+  string text;
+};
+
+bool StartsWith(const char *line, const char *end, const char *prefix) {
+  size_t length = strlen(prefix);
+  return size_t(end - line) >= length && memcmp(line, prefix, length) == 0;
+}
+
+// Set *VALUE to the hexadecimal number in the INDEX'th space-separated
+// field of the line running from LINE to END, counting from zero.
+// Return false if there is no such field.
+bool HexField(const char *line, const char *end, int index,
+              u_int64_t *value) {
+  const char *field = line;
+  for (int i = 0; i < index; i++) {
+    field = static_cast<const char *>(memchr(field, ' ', end - field));
+    if (!field)
+      return false;
+    field++;
+  }
+  if (field >= end || !isxdigit(*field))
+    return false;
+  *value = strtoull(field, NULL, 16);
+  return true;
+}
+
+// Set UNIT's kind and address range from the line running from LINE
+// to END, the record beginning it. Return false if the line doesn't
+// begin a unit.
+bool StartUnit(const char *line, const char *end, SymbolFileUnit *unit) {
+  u_int64_t address, size;
+  if (StartsWith(line, end, "FUNC ")) {
+    if (!HexField(line, end, 1, &address) || !HexField(line, end, 2, &size))
+      return false;
+    unit->kind = SymbolFileUnit::FUNCTION;
+  } else if (StartsWith(line, end, "PUBLIC ")) {
+    if (!HexField(line, end, 1, &address))
+      return false;
+    size = 1;
+    unit->kind = SymbolFileUnit::PUBLIC;
+  } else if (StartsWith(line, end, "STACK WIN ")) {
+    if (!HexField(line, end, 3, &address) || !HexField(line, end, 4, &size))
+      return false;
+    unit->kind = SymbolFileUnit::STACK_WIN;
+  } else if (StartsWith(line, end, "STACK CFI INIT ")) {
+    if (!HexField(line, end, 3, &address) || !HexField(line, end, 4, &size))
+      return false;
+    unit->kind = SymbolFileUnit::STACK_CFI;
+  } else {
+    return false;
+  }
+  unit->low = address;
+  unit->high = address + size > address ? address + size : ~0ULL;
+  return true;
+}
+
+// Extend the range of each unit of the given KIND in UNITS, from
+// FIRST onwards, up to the start of the next unit of that kind, or to
+// the end of the address space if there is none.
+void ExtendNearestRanges(SymbolFileUnit::Kind kind, size_t first,
+                         vector<SymbolFileUnit> *units) {
+  vector<u_int64_t> starts;
+  for (size_t i = first; i < units->size(); i++)
+    if ((*units)[i].kind == kind)
+      starts.push_back((*units)[i].low);
+  std::sort(starts.begin(), starts.end());
+
+  for (size_t i = first; i < units->size(); i++) {
+    SymbolFileUnit &unit = (*units)[i];
+    if (unit.kind != kind)
+      continue;
+    vector<u_int64_t>::const_iterator next =
+        std::upper_bound(starts.begin(), starts.end(), unit.low);
+    u_int64_t limit = next == starts.end() ? ~0ULL : *next;
+    if (limit > unit.high)
+      unit.high = limit;
+  }
+}
+
+void AppendLittleEndian(u_int64_t value, size_t size, string *out) {
+  for (size_t i = 0; i < size; i++)
+    out->push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+}
+
+// Find the index of the container at the start of the LENGTH bytes at
+// DATA, setting *INDEX_OFFSET to its position and *COUNT to the number
+// of blocks. Return false if the header is malformed or the index
+// doesn't lie entirely within LENGTH bytes.
+bool FindIndex(const char *data, size_t length,
+               u_int64_t *index_offset, u_int32_t *count) {
+  if (length < kHeaderSize || !SymbolContainer::IsContainer(data, length))
+    return false;
+
+  const uint8_t *bytes = reinterpret_cast<const uint8_t *>(data);
+  ByteBuffer header(bytes, kHeaderSize);
+  ByteCursor header_cursor(&header);
+  header_cursor.Skip(kMagicSize).Read(8, false, index_offset);
+  if (!header_cursor || *index_offset < kHeaderSize ||
+      *index_offset > length || length - *index_offset < 4)
+    return false;
+
+  ByteBuffer count_buffer(bytes + *index_offset, 4);
+  ByteCursor count_cursor(&count_buffer);
+  if (!(count_cursor >> *count))
+    return false;
+  return u_int64_t(*count) * kIndexEntrySize <= length - *index_offset - 4;
+}
+
+}  // namespace
+
+void ScanSymbolFile(const char *symbols, size_t size,
+                    vector<SymbolFileUnit> *units, string *whole_module) {
+  size_t first_unit = units->size();
+  const char *end = symbols + size;
+  const char *line = symbols;
+  // The unit the current line belongs to, if any.
+  SymbolFileUnit *unit = NULL;
+  while (line < end) {
+    const char *line_end =
+        static_cast<const char *>(memchr(line, '\n', end - line));
+    line_end = line_end ? line_end + 1 : end;
+
+    SymbolFileUnit next;
+    if (StartUnit(line, line_end, &next)) {
+      next.offset = line - symbols;
+      next.size = line_end - line;
+      units->push_back(next);
+      unit = &units->back();
+    } else if (unit &&
+               ((unit->kind == SymbolFileUnit::FUNCTION &&
+                 !isupper(*line)) ||
+                (unit->kind == SymbolFileUnit::STACK_CFI &&
+                 StartsWith(line, line_end, "STACK CFI ") &&
+                 !StartsWith(line, line_end, "STACK CFI RULES ")))) {
+      // A line record or a CFI delta record.
+      unit->size += line_end - line;
+    } else {
+      whole_module->append(line, line_end);
+      if (line_end[-1] != '\n')
+        whole_module->push_back('\n');
+      unit = NULL;
+    }
+    line = line_end;
+  }
+
+  ExtendNearestRanges(SymbolFileUnit::FUNCTION, first_unit, units);
+  ExtendNearestRanges(SymbolFileUnit::PUBLIC, first_unit, units);
+}
+
+void AddressRangeIndex::Add(u_int64_t low, u_int64_t high, size_t id) {
+  Range range = { low, high, id };
+  ranges_.push_back(range);
+}
+
+void AddressRangeIndex::Finish() {
+  std::sort(ranges_.begin(), ranges_.end());
+  max_high_.resize(ranges_.size());
+  u_int64_t max_high = 0;
+  for (size_t i = 0; i < ranges_.size(); i++) {
+    max_high = std::max(max_high, ranges_[i].high);
+    max_high_[i] = max_high;
+  }
+}
+
+void AddressRangeIndex::Find(u_int64_t address, vector<size_t> *ids) const {
+  Range key = { address, ~0ULL, ~size_t(0) };
+  size_t i = std::upper_bound(ranges_.begin(), ranges_.end(), key)
+             - ranges_.begin();
+  size_t first = ids->size();
+  // No range before one whose predecessors all end at or below ADDRESS
+  // can contain it.
+  while (i > 0 && max_high_[i - 1] > address) {
+    i--;
+    if (address < ranges_[i].high)
+      ids->push_back(ranges_[i].id);
+  }
+  std::sort(ids->begin() + first, ids->end());
+}
+
+bool WriteSymbolContainer(const string &symbols, size_t block_size,
+                          std::ostream &stream) {
+  string whole_module;
+  vector<SymbolFileUnit> units;
+  ScanSymbolFile(symbols.data(), symbols.size(), &units, &whole_module);
+
+  // Gather the units into blocks, never mixing kinds.
+  vector<PendingBlock> blocks;
+  blocks.push_back(PendingBlock(-1));
+  blocks.back().low = blocks.back().high = 0;
+  blocks.back().text.swap(whole_module);
+  for (size_t i = 0; i < units.size(); i++) {
+    const SymbolFileUnit &unit = units[i];
+    if (blocks.size() == 1 || blocks.back().kind != unit.kind ||
+        blocks.back().text.size() >= block_size)
+      blocks.push_back(PendingBlock(unit.kind));
+    PendingBlock &block = blocks.back();
+    block.low = std::min(block.low, unit.low);
+    block.high = std::max(block.high, unit.high);
+    block.text.append(symbols, unit.offset, unit.size);
+    if (block.text[block.text.size() - 1] != '\n')
+      block.text.push_back('\n');
+  }
+
+  // Write the header, the blocks, and then the index.
+  string index;
+  AppendLittleEndian(blocks.size(), 4, &index);
+  u_int64_t offset = kHeaderSize;
+  string header(kMagic, kMagicSize);
+  vector<string> compressed_blocks(blocks.size());
+  for (size_t i = 0; i < blocks.size(); i++) {
+    CompressBlock(blocks[i].text.data(), blocks[i].text.size(),
+                  &compressed_blocks[i]);
+    AppendLittleEndian(offset, 8, &index);
+    AppendLittleEndian(compressed_blocks[i].size(), 4, &index);
+    AppendLittleEndian(blocks[i].text.size(), 4, &index);
+    AppendLittleEndian(blocks[i].low, 8, &index);
+    AppendLittleEndian(blocks[i].high, 8, &index);
+    offset += compressed_blocks[i].size();
+    string().swap(blocks[i].text);
+  }
+  AppendLittleEndian(offset, 8, &header);
+
+  stream.write(header.data(), header.size());
+  for (size_t i = 0; i < compressed_blocks.size(); i++)
+    stream.write(compressed_blocks[i].data(), compressed_blocks[i].size());
+  stream.write(index.data(), index.size());
+  return stream.good();
+}
+
+bool SymbolContainer::IsContainer(const char *data, size_t size) {
+  return size >= kMagicSize && memcmp(data, kMagic, kMagicSize) == 0;
+}
+
+u_int64_t SymbolContainer::Size(const char *data, size_t length) {
+  u_int64_t index_offset;
+  u_int32_t count;
+  if (!FindIndex(data, length, &index_offset, &count))
+    return 0;
+  return index_offset + 4 + u_int64_t(count) * kIndexEntrySize;
+}
+
+bool SymbolContainer::Read(const char *data, size_t length) {
+  data_.clear();
+  blocks_.clear();
+  index_ = AddressRangeIndex();
+
+  u_int64_t index_offset;
+  u_int32_t count;
+  if (!FindIndex(data, length, &index_offset, &count) || count == 0)
+    return false;
+
+  const uint8_t *bytes = reinterpret_cast<const uint8_t *>(data);
+  ByteBuffer index(bytes + index_offset + 4, count * kIndexEntrySize);
+  ByteCursor cursor(&index);
+  blocks_.resize(count);
+  for (size_t i = 0; i < count; i++) {
+    Block &block = blocks_[i];
+    cursor >> block.offset >> block.compressed_size >> block.size
+           >> block.low >> block.high;
+    if (!cursor ||
+        block.offset < kHeaderSize || block.offset > index_offset ||
+        block.compressed_size > index_offset - block.offset ||
+        block.size / kMaxBlockExpansion > block.compressed_size) {
+      blocks_.clear();
+      return false;
+    }
+    if (i > 0)
+      index_.Add(block.low, block.high, i);
+  }
+  index_.Finish();
+
+  data_.assign(data, index_offset);
+  return true;
+}
+
+void SymbolContainer::BlocksCovering(u_int64_t address,
+                                     vector<size_t> *blocks) const {
+  index_.Find(address, blocks);
+}
+
+bool SymbolContainer::ReadBlock(size_t index, string *text) const {
+  if (index >= blocks_.size())
+    return false;
+  const Block &block = blocks_[index];
+  return DecompressBlock(data_.data() + block.offset, block.compressed_size,
+                         block.size, text);
+}
+
+}  // namespace google_breakpad
@@ -0,0 +1,197 @@
+// -*- mode: c++ -*-
+
+// Copyright (c) 2010, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// symbol_container.h: Block-compressed Breakpad symbol files, and
+// tools for finding the records in a symbol file that cover a given
+// address.
+//
+// A symbol container holds the same records as a Breakpad text symbol
+// file, grouped into blocks that are compressed independently, and an
+// index at the end giving the range of addresses each block's records
+// cover. A reader that needs only a few addresses from a large module
+// can decompress just the blocks covering them.
+//
+// The layout is as follows; all integers are little-endian:
+//
+//   header: the eight bytes "BPSYMZ01", and a 64-bit offset of the index
+//   blocks: each compressed with CompressBlock
+//   index:  a 32-bit block count, followed by one entry per block:
+//             64-bit offset of the block's compressed data
+//             32-bit size of the compressed data
+//             32-bit size of the block's text once decompressed
+//             64-bit lowest address the block's records cover
+//             64-bit end of the addresses the block's records cover
+//
+// Block 0 holds the records that apply to the module as a whole:
+// MODULE, INFO, FILE, and STACK CFI RULES; a reader always needs it, and
+// its address range is empty. Every other block holds a run of units
+// (see SymbolFileUnit, below) of a single kind, in their original order.
+
+#ifndef COMMON_SYMBOL_CONTAINER_H_
+#define COMMON_SYMBOL_CONTAINER_H_
+
+#include <stddef.h>
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "google_breakpad/common/breakpad_types.h"
+
+namespace google_breakpad {
+
+using std::string;
+using std::vector;
+
+// A unit of a Breakpad text symbol file: a record that can be looked
+// up by address, together with the records that belong to it. Since a
+// lookup that finds no FUNC or PUBLIC record covering an address falls
+// back on the nearest one below it, those units are taken to cover
+// every address up to the next unit of the same kind.
+struct SymbolFileUnit {
+  enum Kind {
+    FUNCTION,   // a FUNC record and its line records
+    PUBLIC,     // a PUBLIC record
+    STACK_WIN,  // a STACK WIN record
+    STACK_CFI   // a STACK CFI INIT record and its STACK CFI records
+  };
+  Kind kind;
+
+  // The addresses this unit covers: [low, high).
+  u_int64_t low, high;
+
+  // The position and length of the unit's text in the symbol file.
+  size_t offset, size;
+};
+
+// Divide the SIZE bytes of symbol file text at SYMBOLS into units,
+// appending them to UNITS in the order they appear, and append the
+// records that apply to the whole module to WHOLE_MODULE.
+void ScanSymbolFile(const char *symbols, size_t size,
+                    vector<SymbolFileUnit> *units, string *whole_module);
+
+// An AddressRangeIndex finds which of a set of address ranges, which
+// may overlap, contain a given address.
+class AddressRangeIndex {
+ public:
+  // Add the range [LOW, HIGH), identified by ID. Once all the ranges
+  // have been added, call Finish before calling Find.
+  void Add(u_int64_t low, u_int64_t high, size_t id);
+  void Finish();
+
+  // Append to IDS the identifiers of the ranges containing ADDRESS,
+  // in increasing order.
+  void Find(u_int64_t address, vector<size_t> *ids) const;
+
+ private:
+  struct Range {
+    u_int64_t low, high;
+    size_t id;
+    bool operator<(const Range &that) const {
+      if (low != that.low) return low < that.low;
+      if (high != that.high) return high < that.high;
+      return id < that.id;
+    }
+  };
+
+  // The ranges, sorted by their starting addresses.
+  vector<Range> ranges_;
+
+  // max_high_[i] is the greatest end of ranges_[0] .. ranges_[i].
+  vector<u_int64_t> max_high_;
+};
+
+// The amount of symbol file text dump_syms places in each block, by
+// default. Larger blocks compress better; smaller ones mean less
+// decompression per lookup.
+const size_t kDefaultSymbolContainerBlockSize = 64 * 1024;
+
+// Write SYMBOLS, the text of a Breakpad symbol file, to STREAM as a
+// symbol container. Break the records into blocks of about BLOCK_SIZE
+// bytes of text each. Return true on success, or false if writing to
+// STREAM fails.
+bool WriteSymbolContainer(const string &symbols, size_t block_size,
+                          std::ostream &stream);
+
+// A SymbolContainer provides access to the blocks of a symbol
+// container held in memory.
+class SymbolContainer {
+ public:
+  SymbolContainer() { }
+
+  // Return true if the SIZE bytes at DATA begin with a symbol
+  // container header.
+  static bool IsContainer(const char *data, size_t size);
+
+  // Return the size in bytes of the symbol container at the start of
+  // the LENGTH bytes at DATA, index included, as given by its header
+  // and index. Return zero if DATA does not begin with a container
+  // header, or if the index does not fit within LENGTH bytes.
+  static u_int64_t Size(const char *data, size_t length);
+
+  // Read the symbol container at the start of the LENGTH bytes at DATA,
+  // copying it. Return false if the header or index is malformed, or
+  // if the index or any block lies beyond LENGTH bytes.
+  bool Read(const char *data, size_t length);
+
+  // Return the number of blocks in the container.
+  size_t BlockCount() const { return blocks_.size(); }
+
+  // Append to BLOCKS the indices of the blocks whose records cover
+  // ADDRESS, in increasing order. Block 0 is never included.
+  void BlocksCovering(u_int64_t address, vector<size_t> *blocks) const;
+
+  // Decompress the text of the INDEX'th block into *TEXT. Return false
+  // if the block's compressed data is malformed.
+  bool ReadBlock(size_t index, string *text) const;
+
+ private:
+  // An entry in the container's index.
+  struct Block {
+    u_int64_t offset;
+    u_int32_t compressed_size;
+    u_int32_t size;
+    u_int64_t low, high;
+  };
+
+  // A copy of the container's contents.
+  string data_;
+
+  // The container's index.
+  vector<Block> blocks_;
+
+  // The address ranges of blocks_, other than block 0.
+  AddressRangeIndex index_;
+};
+
+}  // namespace google_breakpad
+
+#endif  // COMMON_SYMBOL_CONTAINER_H_
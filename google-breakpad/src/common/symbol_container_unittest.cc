@@ -0,0 +1,377 @@
+// Copyright (c) 2010, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// symbol_container_unittest.cc: Unit tests for CompressBlock,
+// DecompressBlock, ScanSymbolFile, AddressRangeIndex,
+// WriteSymbolContainer, and SymbolContainer.
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "breakpad_googletest_includes.h"
+#include "common/block_compression.h"
+#include "common/symbol_container.h"
+
+using google_breakpad::AddressRangeIndex;
+using google_breakpad::CompressBlock;
+using google_breakpad::DecompressBlock;
+using google_breakpad::ScanSymbolFile;
+using google_breakpad::SymbolContainer;
+using google_breakpad::SymbolFileUnit;
+using google_breakpad::WriteSymbolContainer;
+using std::string;
+using std::vector;
+
+// Compress DATA, check that it decompresses back to DATA, and return
+// the compressed size.
+static size_t RoundTrip(const string &data) {
+  string compressed, decompressed;
+  CompressBlock(data.data(), data.size(), &compressed);
+  EXPECT_TRUE(DecompressBlock(compressed.data(), compressed.size(),
+                              data.size(), &decompressed));
+  EXPECT_TRUE(data == decompressed);
+  return compressed.size();
+}
+
+TEST(BlockCompression, Empty) {
+  RoundTrip("");
+}
+
+TEST(BlockCompression, Short) {
+  RoundTrip("a");
+  RoundTrip("abcd");
+  RoundTrip("abcdabcd");
+}
+
+TEST(BlockCompression, Runs) {
+  // Long runs produce overlapping matches and lengths that spill out
+  // of the token byte.
+  EXPECT_GT(100U, RoundTrip(string(10000, 'x')));
+  EXPECT_GT(100U, RoundTrip(string(300, 'y') + string(5000, 'z')));
+  // The longest runs come closest to kMaxBlockExpansion.
+  RoundTrip(string(1 << 20, 'w'));
+}
+
+TEST(BlockCompression, LongLiterals) {
+  string data;
+  srand(0x5eed);
+  for (int i = 0; i < 100000; i++)
+    data.push_back(static_cast<char>(rand()));
+  RoundTrip(data);
+  RoundTrip(data + data.substr(0, 70000) + data);
+}
+
+TEST(BlockCompression, SymbolText) {
+  std::ostringstream text;
+  for (int i = 0; i < 2000; i++) {
+    text << "FUNC " << std::hex << 0x1000 + i * 0x40 << " 40 0 "
+         << "google_breakpad::Function" << std::dec << i << "(int)\n";
+    for (int j = 0; j < 4; j++)
+      text << std::hex << 0x1000 + i * 0x40 + j * 0x10 << " 10 "
+           << std::dec << 100 + j << " " << i % 20 << "\n";
+  }
+  EXPECT_GT(text.str().size() / 2, RoundTrip(text.str()));
+}
+
+TEST(BlockCompression, Malformed) {
+  string compressed, decompressed;
+  CompressBlock("abcdefgh", 8, &compressed);
+
+  // The wrong size.
+  EXPECT_FALSE(DecompressBlock(compressed.data(), compressed.size(), 7,
+                               &decompressed));
+  EXPECT_FALSE(DecompressBlock(compressed.data(), compressed.size(), 9,
+                               &decompressed));
+
+  // Truncated literals.
+  EXPECT_FALSE(DecompressBlock(compressed.data(), compressed.size() - 1, 8,
+                               &decompressed));
+
+  // A match reaching back before the start of the block.
+  EXPECT_FALSE(DecompressBlock("\x10" "a" "\x05\x00" "\x00", 5, 5,
+                               &decompressed));
+
+  // A match with an offset of zero.
+  EXPECT_FALSE(DecompressBlock("\x10" "a" "\x00\x00" "\x00", 5, 5,
+                               &decompressed));
+
+  // A well-formed match, for comparison.
+  EXPECT_TRUE(DecompressBlock("\x10" "a" "\x01\x00" "\x00", 5, 5,
+                              &decompressed));
+  EXPECT_EQ("aaaaa", decompressed);
+
+  // An extended length that runs off the end.
+  EXPECT_FALSE(DecompressBlock("\xf0\xff", 2, 300, &decompressed));
+
+  // A size far larger than the data could expand to is rejected
+  // without allocating space for it.
+  EXPECT_FALSE(DecompressBlock("\x00", 1, 0xffffffffU, &decompressed));
+  EXPECT_GT(0x10000U, decompressed.capacity());
+}
+
+static const char kSymbols[] =
+  "MODULE Linux x86 0123456789ABCDEF0123456789ABCDEF0 module\n"
+  "FILE 0 foo.cc\n"
+  "FILE 1 bar.cc\n"
+  "FUNC 1000 100 0 f1\n"
+  "1000 80 10 0\n"
+  "1080 80 11 1\n"
+  "FUNC 1100 80 0 f2\n"
+  "1100 80 20 0\n"
+  "FUNC 2000 10 0 f3\n"
+  "2000 10 30 1\n"
+  "PUBLIC 1000 0 f1_public\n"
+  "PUBLIC 3000 0 p2\n"
+  "PUBLIC 4000 0 p3\n"
+  "STACK WIN 4 1000 100 1 0 0 0 0 0 1 $eip 4 + ^ = $esp $ebp 8 + =\n"
+  "STACK CFI RULES 0 .cfa: $esp 4 + .ra: .cfa 4 - ^\n"
+  "STACK CFI INIT 1000 100 @0\n"
+  "STACK CFI 1001 .cfa: $esp 8 +\n"
+  "STACK CFI INIT 2000 10 @0\n";
+
+// Return the lines of TEXT, sorted.
+static vector<string> SortedLines(const string &text) {
+  vector<string> lines;
+  std::istringstream stream(text);
+  string line;
+  while (std::getline(stream, line))
+    lines.push_back(line);
+  std::sort(lines.begin(), lines.end());
+  return lines;
+}
+
+// Return the concatenated text of the blocks of CONTAINER covering
+// ADDRESS.
+static string TextCovering(const SymbolContainer &container,
+                           u_int64_t address) {
+  vector<size_t> blocks;
+  container.BlocksCovering(address, &blocks);
+  string result, text;
+  for (size_t i = 0; i < blocks.size(); i++) {
+    EXPECT_TRUE(container.ReadBlock(blocks[i], &text));
+    result += text;
+  }
+  return result;
+}
+
+TEST(ScanSymbolFile, Units) {
+  vector<SymbolFileUnit> units;
+  string whole_module;
+  ScanSymbolFile(kSymbols, strlen(kSymbols), &units, &whole_module);
+
+  EXPECT_EQ("MODULE Linux x86 0123456789ABCDEF0123456789ABCDEF0 module\n"
+            "FILE 0 foo.cc\n"
+            "FILE 1 bar.cc\n"
+            "STACK CFI RULES 0 .cfa: $esp 4 + .ra: .cfa 4 - ^\n",
+            whole_module);
+
+  ASSERT_EQ(9U, units.size());
+  EXPECT_EQ(SymbolFileUnit::FUNCTION, units[0].kind);
+  EXPECT_EQ("FUNC 1000 100 0 f1\n1000 80 10 0\n1080 80 11 1\n",
+            string(kSymbols + units[0].offset, units[0].size));
+  EXPECT_EQ(0x1000U, units[0].low);
+  EXPECT_EQ(0x1100U, units[0].high);
+  // f2 is extended up to f3; f3 to the end of the address space.
+  EXPECT_EQ(0x2000U, units[1].high);
+  EXPECT_EQ(~0ULL, units[2].high);
+  EXPECT_EQ(SymbolFileUnit::PUBLIC, units[3].kind);
+  EXPECT_EQ(0x3000U, units[3].high);
+  EXPECT_EQ(SymbolFileUnit::STACK_WIN, units[6].kind);
+  EXPECT_EQ(0x1100U, units[6].high);
+  EXPECT_EQ(SymbolFileUnit::STACK_CFI, units[7].kind);
+  EXPECT_EQ("STACK CFI INIT 1000 100 @0\nSTACK CFI 1001 .cfa: $esp 8 +\n",
+            string(kSymbols + units[7].offset, units[7].size));
+  EXPECT_EQ("STACK CFI INIT 2000 10 @0\n",
+            string(kSymbols + units[8].offset, units[8].size));
+}
+
+TEST(AddressRangeIndex, Find) {
+  AddressRangeIndex index;
+  index.Add(0x1000, 0x2000, 0);
+  index.Add(0x1100, 0x1200, 1);  // nested in 0
+  index.Add(0x1f00, 0x3000, 2);  // overlaps 0
+  index.Add(0x5000, 0x5001, 3);
+  index.Add(0x1100, 0x1200, 4);  // same as 1
+  index.Finish();
+
+  vector<size_t> ids;
+  index.Find(0xfff, &ids);
+  EXPECT_TRUE(ids.empty());
+
+  index.Find(0x1150, &ids);
+  ASSERT_EQ(3U, ids.size());
+  EXPECT_EQ(0U, ids[0]);
+  EXPECT_EQ(1U, ids[1]);
+  EXPECT_EQ(4U, ids[2]);
+
+  ids.clear();
+  index.Find(0x1f80, &ids);
+  ASSERT_EQ(2U, ids.size());
+  EXPECT_EQ(0U, ids[0]);
+  EXPECT_EQ(2U, ids[1]);
+
+  ids.clear();
+  index.Find(0x2000, &ids);
+  ASSERT_EQ(1U, ids.size());
+  EXPECT_EQ(2U, ids[0]);
+
+  ids.clear();
+  index.Find(0x4000, &ids);
+  EXPECT_TRUE(ids.empty());
+  index.Find(0x5000, &ids);
+  ASSERT_EQ(1U, ids.size());
+  EXPECT_EQ(3U, ids[0]);
+}
+
+TEST(SymbolContainer, NotContainer) {
+  SymbolContainer container;
+  EXPECT_FALSE(SymbolContainer::IsContainer(kSymbols, strlen(kSymbols)));
+  EXPECT_FALSE(SymbolContainer::IsContainer("BPSYMZ01", 4));
+  EXPECT_FALSE(container.Read(kSymbols, strlen(kSymbols)));
+  EXPECT_EQ(0U, SymbolContainer::Size(kSymbols, strlen(kSymbols)));
+}
+
+TEST(SymbolContainer, RoundTrip) {
+  std::ostringstream stream;
+  ASSERT_TRUE(WriteSymbolContainer(kSymbols, 1, stream));
+  SymbolContainer container;
+  ASSERT_TRUE(SymbolContainer::IsContainer(stream.str().data(),
+                                           stream.str().size()));
+  ASSERT_TRUE(container.Read(stream.str().data(), stream.str().size()));
+
+  // With a block size of one byte, every unit gets its own block.
+  ASSERT_EQ(1U + 3 + 3 + 1 + 2, container.BlockCount());
+
+  string whole_module;
+  ASSERT_TRUE(container.ReadBlock(0, &whole_module));
+  EXPECT_EQ("MODULE Linux x86 0123456789ABCDEF0123456789ABCDEF0 module\n"
+            "FILE 0 foo.cc\n"
+            "FILE 1 bar.cc\n"
+            "STACK CFI RULES 0 .cfa: $esp 4 + .ra: .cfa 4 - ^\n",
+            whole_module);
+
+  string all, text;
+  for (size_t i = 0; i < container.BlockCount(); i++) {
+    ASSERT_TRUE(container.ReadBlock(i, &text));
+    all += text;
+  }
+  EXPECT_TRUE(SortedLines(kSymbols) == SortedLines(all));
+  EXPECT_FALSE(container.ReadBlock(container.BlockCount(), &text));
+  EXPECT_EQ(stream.str().size(),
+            SymbolContainer::Size(stream.str().data(), stream.str().size()));
+}
+
+TEST(SymbolContainer, Truncated) {
+  std::ostringstream stream;
+  ASSERT_TRUE(WriteSymbolContainer(kSymbols, 1, stream));
+  const string data = stream.str();
+  SymbolContainer container;
+
+  // A container cut off anywhere, even in its index, is rejected
+  // rather than read past its end.
+  for (size_t length = 0; length < data.size(); length++) {
+    string truncated(data, 0, length);
+    EXPECT_EQ(0U, SymbolContainer::Size(truncated.data(), length))
+        << "length " << length;
+    EXPECT_FALSE(container.Read(truncated.data(), length))
+        << "length " << length;
+  }
+
+  // So is one whose header puts the index beyond the end of the data.
+  string bad_offset(data);
+  bad_offset[8 + 7] = '\x7f';
+  EXPECT_EQ(0U, SymbolContainer::Size(bad_offset.data(), bad_offset.size()));
+  EXPECT_FALSE(container.Read(bad_offset.data(), bad_offset.size()));
+
+  // Or whose block count doesn't fit in the data. Each index entry
+  // is 32 bytes long.
+  ASSERT_TRUE(container.Read(data.data(), data.size()));
+  size_t index_offset = data.size() - 4 - container.BlockCount() * 32;
+  string bad_count(data);
+  bad_count[index_offset + 3] = '\x10';
+  EXPECT_EQ(0U, SymbolContainer::Size(bad_count.data(), bad_count.size()));
+  EXPECT_FALSE(container.Read(bad_count.data(), bad_count.size()));
+
+  // Or where a block claims to decompress to more than its data could
+  // possibly hold.
+  string bad_size(data);
+  bad_size[index_offset + 4 + 12 + 3] = '\x7f';
+  EXPECT_FALSE(container.Read(bad_size.data(), bad_size.size()));
+}
+
+TEST(SymbolContainer, BlocksCovering) {
+  std::ostringstream stream;
+  ASSERT_TRUE(WriteSymbolContainer(kSymbols, 1, stream));
+  SymbolContainer container;
+  ASSERT_TRUE(container.Read(stream.str().data(), stream.str().size()));
+
+  // Nothing covers addresses below every record.
+  EXPECT_EQ("", TextCovering(container, 0xfff));
+
+  EXPECT_EQ("FUNC 1000 100 0 f1\n"
+            "1000 80 10 0\n"
+            "1080 80 11 1\n"
+            "PUBLIC 1000 0 f1_public\n"
+            "STACK WIN 4 1000 100 1 0 0 0 0 0 1 $eip 4 + ^ = $esp $ebp 8 + =\n"
+            "STACK CFI INIT 1000 100 @0\n"
+            "STACK CFI 1001 .cfa: $esp 8 +\n",
+            TextCovering(container, 0x1010));
+
+  // FUNC and PUBLIC records cover addresses up to the next record of
+  // their kind, since lookups fall back on the nearest one below.
+  EXPECT_EQ("FUNC 1100 80 0 f2\n"
+            "1100 80 20 0\n"
+            "PUBLIC 1000 0 f1_public\n",
+            TextCovering(container, 0x1f00));
+  EXPECT_EQ("FUNC 2000 10 0 f3\n"
+            "2000 10 30 1\n"
+            "PUBLIC 4000 0 p3\n",
+            TextCovering(container, 0x5000));
+}
+
+TEST(SymbolContainer, LargeBlocks) {
+  std::ostringstream stream;
+  ASSERT_TRUE(WriteSymbolContainer(kSymbols, 1000, stream));
+  SymbolContainer container;
+  ASSERT_TRUE(container.Read(stream.str().data(), stream.str().size()));
+
+  // Each kind of record still gets blocks of its own.
+  ASSERT_EQ(5U, container.BlockCount());
+  string text;
+  ASSERT_TRUE(container.ReadBlock(2, &text));
+  EXPECT_EQ("PUBLIC 1000 0 f1_public\n"
+            "PUBLIC 3000 0 p2\n"
+            "PUBLIC 4000 0 p3\n",
+            text);
+}
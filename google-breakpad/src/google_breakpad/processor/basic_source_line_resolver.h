@@ -62,6 +62,16 @@ class BasicSourceLineResolver : public SourceLineResolverBase {
   using SourceLineResolverBase::FindWindowsFrameInfo;
   using SourceLineResolverBase::FindCFIFrameInfo;
 
+  // If lazy is true, modules loaded afterwards are loaded lazily: rather
+  // than parsing the whole symbol file up front, loading finds where the
+  // FUNC, PUBLIC and STACK records are, and each is parsed only when a
+  // lookup first needs it.  This makes resolving a few addresses in a
+  // large module much cheaper.  Since lazily loaded modules refer to the
+  // symbol file text, ShouldDeleteMemoryBufferAfterLoadModule returns
+  // false while lazy loading is on.  Errors in a record are reported
+  // when the record is first needed, rather than making the load fail.
+  void set_lazy_loading(bool lazy) { lazy_loading_ = lazy; }
+
  private:
   // friend declarations:
   friend class BasicModuleFactory;
@@ -60,6 +60,84 @@ class Exploitability {
   Exploitability(Minidump *dump,
                  ProcessState *process_state);
 
+  // How far from an interesting address another address may lie and
+  // still be taken for an offset from it.
+  static const u_int64_t kProbableNullOffset = 4096;
+  static const u_int64_t kProbableStackOffset = 8192;
+
+  // The total weights at which a crash earns each rating.
+  static const u_int32_t kHighCutoff        = 100;
+  static const u_int32_t kMediumCutoff      = 80;
+  static const u_int32_t kLowCutoff         = 50;
+  static const u_int32_t kInterestingCutoff = 25;
+
+  // Predefined incremental values for conditional weighting.
+  static const u_int32_t kTinyBump          = 5;
+  static const u_int32_t kSmallBump         = 20;
+  static const u_int32_t kMediumBump        = 50;
+  static const u_int32_t kLargeBump         = 70;
+  static const u_int32_t kHugeBump          = 90;
+
+  // The maximum number of bytes to disassemble past the program counter.
+  static const u_int32_t kDisassembleBytesBeyondPC = 2048;
+
+  // Returns true if |instruction_ptr| lies within kProbableStackOffset
+  // bytes of |stack_ptr|, suggesting that code is running from the stack.
+  static bool InstructionPointerNearStack(u_int64_t instruction_ptr,
+                                          u_int64_t stack_ptr);
+
+  // Returns the rating a crash of total weight |weight| earns.
+  static ExploitabilityRating RatingForWeight(u_int32_t weight);
+
+  // Returns the weight of what the crashing thread's context suggests,
+  // whatever the exception: code running from the stack, a stack pointer
+  // outside the thread's stack, code outside every loaded module, and an
+  // executable stack.
+  u_int32_t CrashContextWeight(u_int64_t instruction_ptr,
+                               u_int64_t stack_ptr);
+
+  // Returns the weight of an access fault at |address| by the code at
+  // |instruction_ptr|, for platforms whose exceptions don't say whether
+  // the access was a read, a write or an execution.  A fault near NULL
+  // weighs little; a fault at the instruction pointer, code in memory
+  // that isn't executable, what disassembling the faulting code finds,
+  // and an address made of ASCII characters all weigh more.
+  u_int32_t AccessFaultWeight(u_int64_t address, u_int64_t instruction_ptr);
+
+  // The following examine the crash using the indexes that the dump and
+  // the processed state already hold, so that platform engines need not
+  // build their own.
+
+  // Sets |instruction_ptr| and |stack_ptr| from the exception's context.
+  // Returns false if there is no exception context, or if its CPU is not
+  // supported.
+  bool GetCrashPointers(u_int64_t *instruction_ptr, u_int64_t *stack_ptr);
+
+  // Returns true if |stack_ptr| is known to lie outside the stack memory
+  // captured for the thread that requested the dump.  Returns false if it
+  // lies within it, or if the dump doesn't say.
+  bool StackPointerOutsideStack(u_int64_t stack_ptr);
+
+  // Returns true if |address| lies within a loaded module.
+  bool AddressIsInModule(u_int64_t address);
+
+  // Returns the dump's information about the mapping containing
+  // |address|, or NULL if the dump has none.
+  const MinidumpMemoryInfo *MemoryInfoForAddress(u_int64_t address);
+
+  // Disassembles the x86 code at |instruction_ptr| to the end of its
+  // block, treating the register that the faulting instruction
+  // dereferenced as holding a bad value.  Returns false if the exception
+  // context is not x86, the code is not in the dump, or the faulting
+  // instruction is not valid.  Otherwise,
+  // sets |control_flow| and |block_operation| to indicate whether the
+  // faulting instruction is a branch or a string operation, and |flags|
+  // to the DISX86_* flags found.
+  bool DisassembleFaultingCode(u_int64_t instruction_ptr,
+                               bool *control_flow,
+                               bool *block_operation,
+                               u_int16_t *flags);
+
   Minidump *dump_;
   ProcessState *process_state_;
   SystemInfo *system_info_;
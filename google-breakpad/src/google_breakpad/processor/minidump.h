@@ -103,6 +103,7 @@ using std::vector;
 
 
 class Minidump;
+class MinidumpContainerReader;
 template<typename AddressType, typename EntryType> class RangeMap;
 
 
@@ -264,10 +265,19 @@ class MinidumpMemoryRegion : public MinidumpObject,
   // Print a human-readable representation of the object to stdout.
   void Print();
 
+  // Print only the bytes of the region that fall within the |size| bytes
+  // at |address|.  Like Print, this reads the bytes from the minidump a
+  // piece at a time as they are printed, rather than caching the region.
+  void PrintRange(u_int64_t address, u_int64_t size);
+
  private:
   friend class MinidumpThread;
   friend class MinidumpMemoryList;
 
+  // The number of bytes Print and PrintRange read from the minidump at a
+  // time.
+  static const u_int32_t kPrintChunkSize = 64 * 1024;
+
   explicit MinidumpMemoryRegion(Minidump* minidump);
 
   // Identify the base address and size of the memory region, and the
@@ -575,6 +585,10 @@ class MinidumpMemoryList : public MinidumpStream {
   // Print a human-readable representation of the object to stdout.
   void Print();
 
+  // Print only the regions that overlap the |size| bytes at |address|,
+  // and only their bytes within that range.
+  void PrintRange(u_int64_t address, u_int64_t size);
+
  private:
   friend class Minidump;
 
@@ -587,6 +601,11 @@ class MinidumpMemoryList : public MinidumpStream {
 
   bool Read(u_int32_t expected_size);
 
+  // Print the region at |region_index|, limited to the |size| bytes at
+  // |address|.
+  void PrintRegion(unsigned int region_index, u_int64_t address,
+                   u_int64_t size);
+
   // The largest number of memory regions that will be read from a minidump.
   // The default is 256.
   static u_int32_t max_regions_;
@@ -960,6 +979,11 @@ class Minidump {
 
   bool swap() const { return valid_ ? swap_ : false; }
 
+  // True if the minidump is held in a block-compressed container (see
+  // common/minidump_container.h).  The I/O routines above then work on
+  // the decompressed minidump, decompressing only the blocks they touch.
+  bool compressed() const { return container_ != NULL; }
+
   // Print a human-readable representation of the object to stdout.
   void Print();
 
@@ -986,6 +1010,11 @@ class Minidump {
   // Opens the minidump file, or if already open, seeks to the beginning.
   bool Open();
 
+  // Checks whether the minidump is held in a container, and if so, reads
+  // the container's index.  Leaves the minidump positioned at the
+  // beginning of the header.
+  bool OpenContainer();
+
   // The largest number of top-level streams that will be read from a minidump.
   // Note that streams are only read (and only consume memory) as needed,
   // when directed by the caller.  The default is 128.
@@ -1013,6 +1042,12 @@ class Minidump {
   // Set based on the path in Open, or directly in the constructor.
   std::istream*             stream_;
 
+  // The reader for the container holding the minidump, or NULL if
+  // stream_ holds the minidump itself.  container_position_ is the
+  // current position within the decompressed minidump.
+  MinidumpContainerReader*  container_;
+  off_t                     container_position_;
+
   // swap_ is true if the minidump file should be byte-swapped.  If the
   // minidump was produced by a CPU that is other-endian than the CPU
   // processing the minidump, this will be true.  If the two CPUs are
@@ -90,6 +90,22 @@ enum ProcessResult {
 
 class MinidumpProcessor {
  public:
+  // Selects which threads Process walks.  Threads that are not walked
+  // still appear in the ProcessState, with an empty or truncated
+  // CallStack, so that thread indices match those of a full walk.
+  // Symbols are only loaded for modules that appear in walked frames.
+  enum ThreadPolicy {
+    // Walk every thread's stack completely.  This is the default.
+    PROCESS_ALL_THREADS,
+
+    // Walk only the requesting thread's stack.
+    PROCESS_REQUESTING_THREAD,
+
+    // Walk the requesting thread's stack completely, and only the
+    // innermost frames of the other threads' stacks.
+    PROCESS_REQUESTING_THREAD_AND_TOP_FRAMES
+  };
+
   // Initializes this MinidumpProcessor.  supplier should be an
   // implementation of the SymbolSupplier abstract base class.
   MinidumpProcessor(SymbolSupplier *supplier,
@@ -104,6 +120,32 @@ class MinidumpProcessor {
 
   ~MinidumpProcessor();
 
+  // Sets the thread policy used by subsequent calls to Process.
+  // other_thread_frames is the number of frames walked on threads other
+  // than the requesting thread under
+  // PROCESS_REQUESTING_THREAD_AND_TOP_FRAMES, and is ignored otherwise.
+  // If a minidump does not identify a requesting thread, every thread
+  // is treated as a non-requesting thread.
+  void SetThreadPolicy(ThreadPolicy policy, u_int32_t other_thread_frames) {
+    thread_policy_ = policy;
+    other_thread_frames_ = other_thread_frames;
+  }
+
+  // Limits the work each subsequent call to Process may do on one
+  // minidump: time_limit_ms milliseconds of wall-clock time,
+  // max_scan_words stack words examined while scanning for return
+  // addresses, and max_symbol_bytes bytes of symbol data loaded.  A limit
+  // of zero means no limit; all are zero by default.  When a limit is
+  // reached, the stack being walked is cut short, the remaining threads
+  // get empty stacks, and ProcessState::truncated() returns true.
+  void SetBudget(u_int32_t time_limit_ms,
+                 u_int64_t max_scan_words,
+                 u_int64_t max_symbol_bytes) {
+    time_limit_ms_ = time_limit_ms;
+    max_scan_words_ = max_scan_words;
+    max_symbol_bytes_ = max_symbol_bytes;
+  }
+
   // Processes the minidump file and fills process_state with the result.
   ProcessResult Process(const string &minidump_file,
                         ProcessState *process_state);
@@ -162,6 +204,16 @@ class MinidumpProcessor {
   // guess how likely it is that the crash represents an exploitable
   // memory corruption issue.
   bool enable_exploitability_;
+
+  // The threads to walk, and how many frames to walk on threads other
+  // than the requesting thread.  See SetThreadPolicy.
+  ThreadPolicy thread_policy_;
+  u_int32_t other_thread_frames_;
+
+  // The limits on the work done per minidump.  See SetBudget.
+  u_int32_t time_limit_ms_;
+  u_int64_t max_scan_words_;
+  u_int64_t max_symbol_bytes_;
 };
 
 }  // namespace google_breakpad
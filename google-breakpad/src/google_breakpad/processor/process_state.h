@@ -106,6 +106,7 @@ class ProcessState {
   const SystemInfo* system_info() const { return &system_info_; }
   const CodeModules* modules() const { return modules_; }
   ExploitabilityRating exploitability() const { return exploitability_; }
+  bool truncated() const { return truncated_; }
 
  private:
   // MinidumpProcessor is responsible for building ProcessState objects.
@@ -161,6 +162,11 @@ class ProcessState {
   // engine. When the exploitability engine is not enabled this
   // defaults to EXPLOITABILITY_NONE.
   ExploitabilityRating exploitability_;
+
+  // True if the MinidumpProcessor's processing budget ran out before every
+  // thread was walked completely.  The stacks in threads_ are then correct
+  // but may be incomplete, and some may be empty.
+  bool truncated_;
 };
 
 }  // namespace google_breakpad
@@ -60,9 +60,12 @@ class SourceLineResolverBase : public SourceLineResolverInterface {
   // Read the symbol_data from a file with given file_name.
   // The part of code was originally in BasicSourceLineResolver::Module's
   // LoadMap() method.
-  // Place dynamically allocated heap buffer in symbol_data. Caller has the
-  // ownership of the buffer, and should call delete [] to free the buffer.
-  static bool ReadSymbolFile(char **symbol_data, const string &file_name);
+  // Place dynamically allocated heap buffer in symbol_data, and its size,
+  // not counting the '\0' that follows the data, in symbol_data_size.
+  // Caller has the ownership of the buffer, and should call delete [] to
+  // free the buffer.
+  static bool ReadSymbolFile(char **symbol_data, size_t *symbol_data_size,
+                             const string &file_name);
 
  protected:
   // Users are not allowed create SourceLineResolverBase instance directly.
@@ -74,7 +77,8 @@ class SourceLineResolverBase : public SourceLineResolverInterface {
   virtual bool LoadModuleUsingMapBuffer(const CodeModule *module,
                                         const string &map_buffer);
   virtual bool LoadModuleUsingMemoryBuffer(const CodeModule *module,
-                                           char *memory_buffer);
+                                           char *memory_buffer,
+                                           size_t memory_buffer_size);
   virtual bool ShouldDeleteMemoryBufferAfterLoadModule();
   virtual void UnloadModule(const CodeModule *module);
   virtual bool HasModule(const CodeModule *module);
@@ -101,10 +105,40 @@ class SourceLineResolverBase : public SourceLineResolverInterface {
   typedef std::map<string, char*, CompareString> MemoryMap;
   MemoryMap *memory_buffers_;
 
+  // The symbols of modules loaded from block-compressed symbol files
+  // or loaded lazily that have yet to be added to the module: they are
+  // added as lookups need them.
+  struct PendingSymbols;
+  typedef std::map<string, PendingSymbols*, CompareString> PendingSymbolsMap;
+  PendingSymbolsMap *pending_symbols_;
+
   // Creates a concrete module at run-time.
   ModuleFactory *module_factory_;
 
+  // If true, modules loaded from text symbol files are loaded lazily:
+  // loading merely finds the records that can be looked up by address,
+  // and records are parsed and added to the module only once a lookup
+  // needs them. This requires support from the Module implementation.
+  bool lazy_loading_;
+
  private:
+  // Loads the block of the symbol container in the memory_buffer_size
+  // bytes at memory_buffer that applies to the whole module into module,
+  // and arranges for the rest to be loaded by LoadPendingSymbols.
+  bool LoadContainer(const CodeModule *code_module, Module *module,
+                     const char *memory_buffer, size_t memory_buffer_size);
+
+  // Loads the records in the symbol file text at memory_buffer that
+  // apply to the whole module into module, and arranges for the rest
+  // to be loaded by LoadPendingSymbols.  memory_buffer must outlive
+  // module.
+  bool LoadLazily(const CodeModule *code_module, Module *module,
+                  const char *memory_buffer);
+
+  // If frame's module has symbols pending, loads any records covering
+  // frame's instruction that haven't been loaded yet.
+  void LoadPendingSymbols(const StackFrame *frame);
+
   // ModuleFactory needs to have access to protected type Module.
   friend class ModuleFactory;
 
@@ -68,8 +68,12 @@ class SourceLineResolverInterface {
   // This is useful in the optimization design for avoiding unnecessary copying
   // of symbol data, in order to improve memory efficiency.
   // LoadModuleUsingMemoryBuffer() does NOT take ownership of memory_buffer.
+  // memory_buffer_size is the size of the data in memory_buffer, not
+  // counting the '\0' that must follow it; a symbol container may hold
+  // '\0' bytes of its own.
   virtual bool LoadModuleUsingMemoryBuffer(const CodeModule *module,
-                                           char *memory_buffer) = 0;
+                                           char *memory_buffer,
+                                           size_t memory_buffer_size) = 0;
 
   // Return true if the memory buffer should be deleted immediately after
   // LoadModuleUsingMemoryBuffer(). Return false if the memory buffer has to be
@@ -51,6 +51,7 @@ namespace google_breakpad {
 
 class CallStack;
 class MinidumpContext;
+class ProcessingBudget;
 class SourceLineResolverInterface;
 struct StackFrame;
 class SymbolSupplier;
@@ -82,6 +83,18 @@ class Stackwalker {
   static void set_max_frames(u_int32_t max_frames) { max_frames_ = max_frames; }
   static u_int32_t max_frames() { return max_frames_; }
 
+  // Stops this Stackwalker's walks after frame_limit frames, without
+  // treating the truncation as an error.  Unlike max_frames, which guards
+  // against runaway walks, this is for callers that only want the
+  // innermost frames of a stack.  Zero, the default, means no limit.
+  void set_frame_limit(u_int32_t frame_limit) { frame_limit_ = frame_limit; }
+
+  // Charges this Stackwalker's stack scanning and symbol loading to
+  // budget, and stops its walks, without reporting an error, once budget
+  // is exhausted.  budget is not owned, and may be shared by several
+  // Stackwalkers.  NULL, the default, means no budget.
+  void set_budget(ProcessingBudget *budget) { budget_ = budget; }
+
  protected:
   // system_info identifies the operating system, NULL or empty if unknown.
   // memory identifies a MemoryRegion that provides the stack memory
@@ -122,25 +135,40 @@ class Stackwalker {
                             InstructionType *location_found,
                             InstructionType *ip_found) {
     const int kRASearchWords = 30;
+    int words = 0;
     for (InstructionType location = location_start;
          location <= location_start + kRASearchWords * sizeof(InstructionType);
          location += sizeof(InstructionType)) {
+      if (ScanBudgetExhausted())
+        break;
+
       InstructionType ip;
       if (!memory_->GetMemoryAtAddress(location, &ip))
         break;
+      ++words;
 
       if (modules_ && modules_->GetModuleForAddress(ip) &&
           InstructionAddressSeemsValid(ip)) {
 
         *ip_found = ip;
         *location_found = location;
+        ChargeScanWords(words);
         return true;
       }
     }
     // nothing found
+    ChargeScanWords(words);
     return false;
   }
 
+  // Records the number of stack words a scan examined in the active
+  // ProcessorStats and in the budget, if there are any.
+  void ChargeScanWords(int words);
+
+  // Returns true if the budget has been exhausted.  Stack scans stop when
+  // this returns true.
+  bool ScanBudgetExhausted() const;
+
   // Information about the system that produced the minidump.  Subclasses
   // and the SymbolSupplier may find this information useful.
   const SystemInfo *system_info_;
@@ -185,6 +213,14 @@ class Stackwalker {
   // The maximum number of frames Stackwalker will walk through.
   // This defaults to 1024 to prevent infinite loops.
   static u_int32_t max_frames_;
+
+  // The number of frames after which Walk stops, or zero.  See
+  // set_frame_limit.
+  u_int32_t frame_limit_;
+
+  // The budget this Stackwalker charges its work to, or NULL.  See
+  // set_budget.
+  ProcessingBudget *budget_;
 };
 
 
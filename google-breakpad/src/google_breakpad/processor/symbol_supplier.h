@@ -84,10 +84,14 @@ class SymbolSupplier {
   // If symbol_data is not NULL, symbol supplier won't return FOUND unless it
   // returns a valid buffer in symbol_data, e.g., returns INTERRUPT on memory
   // allocation failure.
+  // symbol_data_size is set to the size of the data, not counting the
+  // terminating '\0'; the data may hold '\0' bytes of its own if it is a
+  // symbol container.
   virtual SymbolResult GetCStringSymbolData(const CodeModule *module,
                                             const SystemInfo *system_info,
                                             string *symbol_file,
-                                            char **symbol_data) = 0;
+                                            char **symbol_data,
+                                            size_t *symbol_data_size) = 0;
 
   // Frees the data buffer allocated for the module in GetCStringSymbolData.
   virtual void FreeSymbolData(const CodeModule *module) = 0;
@@ -61,6 +61,10 @@ BasicSourceLineResolver::BasicSourceLineResolver() :
     SourceLineResolverBase(new BasicModuleFactory) { }
 
 bool BasicSourceLineResolver::Module::LoadMapFromMemory(char *memory_buffer) {
+  return AddMapFromMemory(memory_buffer);
+}
+
+bool BasicSourceLineResolver::Module::AddMapFromMemory(char *memory_buffer) {
   linked_ptr<Function> cur_func;
   int line_number = 0;
   char *save_ptr;
@@ -143,6 +147,7 @@ bool BasicSourceLineResolver::Module::LoadMapFromMemory(char *memory_buffer) {
     }
     buffer = strtok_r(NULL, "\r\n", &save_ptr);
   }
+
   return true;
 }
 
@@ -251,7 +256,7 @@ CFIFrameInfo *BasicSourceLineResolver::Module::FindCFIFrameInfo(
   // Create a frame info structure, and populate it with the rules from
   // the STACK CFI INIT record.
   scoped_ptr<CFIFrameInfo> rules(new CFIFrameInfo());
-  if (!ParseCFIRuleSet(initial_rules, rules.get()))
+  if (!ParseCFIRuleSet(CFIRules(initial_rules), rules.get()))
     return NULL;
 
   // Find the first delta rule that falls within the initial rule's range.
@@ -260,7 +265,7 @@ CFIFrameInfo *BasicSourceLineResolver::Module::FindCFIFrameInfo(
 
   // Apply delta rules up to and including the frame's address.
   while (delta != cfi_delta_rules_.end() && delta->first <= address) {
-    ParseCFIRuleSet(delta->second, rules.get());
+    ParseCFIRuleSet(CFIRules(delta->second), rules.get());
     delta++;
   }
 
@@ -417,7 +422,7 @@ bool BasicSourceLineResolver::Module::ParseCFIFrameInfo(
     char *stack_info_line) {
   char *cursor;
 
-  // Is this an INIT record or a delta record?
+  // Is this an INIT record, a RULES record, or a delta record?
   char *init_or_address = strtok_r(stack_info_line, " \r\n", &cursor);
   if (!init_or_address)
     return false;
@@ -433,19 +438,58 @@ bool BasicSourceLineResolver::Module::ParseCFIFrameInfo(
     char *initial_rules = strtok_r(NULL, "\r\n", &cursor);
     if (!initial_rules) return false;
 
+    if (!IsValidCFIRules(initial_rules)) return false;
+
     MemAddr address = strtoul(address_field, NULL, 16);
     MemAddr size    = strtoul(size_field,    NULL, 16);
     cfi_initial_rules_.StoreRange(address, size, initial_rules);
     return true;
   }
 
+  if (strcmp(init_or_address, "RULES") == 0) {
+    // This record has the form "STACK CFI RULES <number> <rules...>".
+    // Rule sets are numbered consecutively from zero.
+    char *number_field = strtok_r(NULL, " \r\n", &cursor);
+    if (!number_field) return false;
+
+    char *rules = strtok_r(NULL, "\r\n", &cursor);
+    if (!rules) return false;
+
+    if (strtoul(number_field, NULL, 16) != cfi_rule_sets_.size())
+      return false;
+    cfi_rule_sets_.push_back(rules);
+    return true;
+  }
+
   // This record has the form "STACK <address> <rules...>".
   char *address_field = init_or_address;
   char *delta_rules = strtok_r(NULL, "\r\n", &cursor);
   if (!delta_rules) return false;
+
+  if (!IsValidCFIRules(delta_rules)) return false;
+
   MemAddr address = strtoul(address_field, NULL, 16);
   cfi_delta_rules_[address] = delta_rules;
   return true;
 }
 
+bool BasicSourceLineResolver::Module::IsValidCFIRules(const char *rules)
+    const {
+  if (rules[0] != '@')
+    return true;
+
+  char *end;
+  unsigned long number = strtoul(rules + 1, &end, 16);
+  return end != rules + 1 && number < cfi_rule_sets_.size();
+}
+
+const string &BasicSourceLineResolver::Module::CFIRules(
+    const string &rules) const {
+  if (rules.empty() || rules[0] != '@')
+    return rules;
+
+  // ParseCFIFrameInfo has checked that the reference is valid.
+  return cfi_rule_sets_[strtoul(rules.c_str() + 1, NULL, 16)];
+}
+
 }  // namespace google_breakpad
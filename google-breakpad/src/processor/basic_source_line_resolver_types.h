@@ -80,6 +80,9 @@ class BasicSourceLineResolver::Module : public SourceLineResolverBase::Module {
   // Does NOT have ownership of memory_buffer.
   virtual bool LoadMapFromMemory(char *memory_buffer);
 
+  // Adds the records in the given buffer to those already loaded.
+  virtual bool AddMapFromMemory(char *memory_buffer);
+
   // Looks up the given relative address, and fills the StackFrame struct
   // with the result.
   virtual void LookupAddress(StackFrame *frame) const;
@@ -125,6 +128,15 @@ class BasicSourceLineResolver::Module : public SourceLineResolverBase::Module {
   // Parses a STACK CFI record, storing it in cfi_frame_info_.
   bool ParseCFIFrameInfo(char *stack_info_line);
 
+  // Return false if RULES refers, in the form '@<number>', to a STACK
+  // CFI RULES record we haven't seen.
+  bool IsValidCFIRules(const char *rules) const;
+
+  // If RULES, a value from cfi_initial_rules_ or cfi_delta_rules_,
+  // refers to a STACK CFI RULES record, return that record's rules;
+  // otherwise, return RULES itself.
+  const string &CFIRules(const string &rules) const;
+
   string name_;
   FileMap files_;
   RangeMap< MemAddr, linked_ptr<Function> > functions_;
@@ -154,6 +166,13 @@ class BasicSourceLineResolver::Module : public SourceLineResolverBase::Module {
   // this map, or the end of the range as given by the cfi_initial_rules_
   // entry (which FindCFIFrameInfo looks up first).
   std::map<MemAddr, string> cfi_delta_rules_;
+
+  // STACK CFI RULES records: rule sets shared by many STACK CFI INIT
+  // and STACK CFI records, indexed by number. Records that use one keep
+  // their '@<number>' reference in the maps above, so each rule set is
+  // stored only once; FindCFIFrameInfo looks the rules up when it
+  // parses them.
+  std::vector<string> cfi_rule_sets_;
 };
 
 }  // namespace google_breakpad
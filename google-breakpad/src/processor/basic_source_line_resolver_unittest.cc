@@ -29,9 +29,13 @@
 
 #include <stdio.h>
 
+#include <fstream>
+#include <iterator>
+#include <sstream>
 #include <string>
 
 #include "breakpad_googletest_includes.h"
+#include "common/symbol_container.h"
 #include "google_breakpad/processor/basic_source_line_resolver.h"
 #include "google_breakpad/processor/code_module.h"
 #include "google_breakpad/processor/stack_frame.h"
@@ -50,6 +54,7 @@ using google_breakpad::CFIFrameInfo;
 using google_breakpad::CodeModule;
 using google_breakpad::MemoryRegion;
 using google_breakpad::StackFrame;
+using google_breakpad::WriteSymbolContainer;
 using google_breakpad::WindowsFrameInfo;
 using google_breakpad::linked_ptr;
 using google_breakpad::scoped_ptr;
@@ -399,6 +404,228 @@ TEST_F(TestBasicSourceLineResolver, TestUnload)
   ASSERT_TRUE(resolver.HasModule(&module1));
 }
 
+// A symbol file using STACK CFI RULES records to share rule sets
+// between STACK CFI INIT and STACK CFI records.
+static const char kCompactCFISymbols[] =
+  "MODULE Linux x86 B8CFDE93002D54DA1900A40AA1BD67690 compact\n"
+  "STACK CFI RULES 0 .cfa: $esp 4 + .ra: .cfa 4 - ^\n"
+  "STACK CFI RULES 1 .cfa: $ebp 8 + $ebp: .cfa 8 - ^\n"
+  "STACK CFI INIT 3d40 af @0\n"
+  "STACK CFI 3d41 .cfa: $esp 8 +\n"
+  "STACK CFI 3d43 @1\n"
+  "STACK CFI INIT 3df0 af @0\n"
+  "STACK CFI 3df3 @1\n";
+
+TEST_F(TestBasicSourceLineResolver, TestCompactCFI)
+{
+  TestCodeModule module("compact");
+  ASSERT_TRUE(resolver.LoadModuleUsingMapBuffer(&module, kCompactCFISymbols));
+
+  StackFrame frame;
+  frame.module = &module;
+  scoped_ptr<CFIFrameInfo> cfi_frame_info;
+
+  frame.instruction = 0x3d40;
+  cfi_frame_info.reset(resolver.FindCFIFrameInfo(&frame));
+  ASSERT_TRUE(cfi_frame_info.get());
+  EXPECT_EQ(".cfa: $esp 4 + .ra: .cfa 4 - ^", cfi_frame_info->Serialize());
+
+  frame.instruction = 0x3d42;
+  cfi_frame_info.reset(resolver.FindCFIFrameInfo(&frame));
+  ASSERT_TRUE(cfi_frame_info.get());
+  EXPECT_EQ(".cfa: $esp 8 + .ra: .cfa 4 - ^", cfi_frame_info->Serialize());
+
+  frame.instruction = 0x3d50;
+  cfi_frame_info.reset(resolver.FindCFIFrameInfo(&frame));
+  ASSERT_TRUE(cfi_frame_info.get());
+  EXPECT_EQ(".cfa: $ebp 8 + .ra: .cfa 4 - ^ $ebp: .cfa 8 - ^",
+            cfi_frame_info->Serialize());
+
+  frame.instruction = 0x3df0;
+  cfi_frame_info.reset(resolver.FindCFIFrameInfo(&frame));
+  ASSERT_TRUE(cfi_frame_info.get());
+  EXPECT_EQ(".cfa: $esp 4 + .ra: .cfa 4 - ^", cfi_frame_info->Serialize());
+
+  frame.instruction = 0x3df3;
+  cfi_frame_info.reset(resolver.FindCFIFrameInfo(&frame));
+  ASSERT_TRUE(cfi_frame_info.get());
+  EXPECT_EQ(".cfa: $ebp 8 + .ra: .cfa 4 - ^ $ebp: .cfa 8 - ^",
+            cfi_frame_info->Serialize());
+}
+
+TEST_F(TestBasicSourceLineResolver, TestCompactCFIErrors)
+{
+  // A reference to a rule set that hasn't been defined.
+  TestCodeModule module1("undefined");
+  ASSERT_FALSE(resolver.LoadModuleUsingMapBuffer(&module1,
+      "STACK CFI RULES 0 .cfa: $esp 4 + .ra: .cfa 4 - ^\n"
+      "STACK CFI INIT 3d40 af @1\n"));
+  ASSERT_FALSE(resolver.HasModule(&module1));
+
+  // Rule sets must be numbered consecutively from zero.
+  TestCodeModule module2("misnumbered");
+  ASSERT_FALSE(resolver.LoadModuleUsingMapBuffer(&module2,
+      "STACK CFI RULES 1 .cfa: $esp 4 + .ra: .cfa 4 - ^\n"));
+  ASSERT_FALSE(resolver.HasModule(&module2));
+
+  // A reference with no number.
+  TestCodeModule module3("no-number");
+  ASSERT_FALSE(resolver.LoadModuleUsingMapBuffer(&module3,
+      "STACK CFI RULES 0 .cfa: $esp 4 + .ra: .cfa 4 - ^\n"
+      "STACK CFI 3d41 @\n"));
+  ASSERT_FALSE(resolver.HasModule(&module3));
+}
+
+// Verify that looking up ADDRESS in MODULE gives the same results from
+// ACTUAL as from EXPECTED.
+static void CompareLookups(BasicSourceLineResolver *expected_resolver,
+                           BasicSourceLineResolver *actual_resolver,
+                           const CodeModule *module, u_int64_t address) {
+  StackFrame expected, actual;
+  expected.instruction = actual.instruction = address;
+  expected.module = actual.module = module;
+  expected_resolver->FillSourceLineInfo(&expected);
+  actual_resolver->FillSourceLineInfo(&actual);
+  EXPECT_EQ(expected.function_name, actual.function_name) << address;
+  EXPECT_EQ(expected.function_base, actual.function_base) << address;
+  EXPECT_EQ(expected.source_file_name, actual.source_file_name) << address;
+  EXPECT_EQ(expected.source_line, actual.source_line) << address;
+  EXPECT_EQ(expected.source_line_base, actual.source_line_base) << address;
+
+  scoped_ptr<WindowsFrameInfo> expected_windows(
+      expected_resolver->FindWindowsFrameInfo(&expected));
+  scoped_ptr<WindowsFrameInfo> actual_windows(
+      actual_resolver->FindWindowsFrameInfo(&actual));
+  ASSERT_EQ(!expected_windows.get(), !actual_windows.get()) << address;
+  if (expected_windows.get()) {
+    EXPECT_EQ(expected_windows->valid, actual_windows->valid) << address;
+    EXPECT_EQ(expected_windows->parameter_size,
+              actual_windows->parameter_size) << address;
+    EXPECT_EQ(expected_windows->program_string,
+              actual_windows->program_string) << address;
+  }
+
+  scoped_ptr<CFIFrameInfo> expected_cfi(
+      expected_resolver->FindCFIFrameInfo(&expected));
+  scoped_ptr<CFIFrameInfo> actual_cfi(
+      actual_resolver->FindCFIFrameInfo(&actual));
+  ASSERT_EQ(!expected_cfi.get(), !actual_cfi.get()) << address;
+  if (expected_cfi.get()) {
+    EXPECT_EQ(expected_cfi->Serialize(), actual_cfi->Serialize()) << address;
+  }
+}
+
+// Loading a module from a symbol container, which adds only the blocks
+// covering each address looked up, should give the same results as
+// loading the text symbol file.
+TEST_F(TestBasicSourceLineResolver, TestContainer)
+{
+  std::ifstream file((testdata_dir + "/module1.out").c_str());
+  string symbols((std::istreambuf_iterator<char>(file)),
+                 std::istreambuf_iterator<char>());
+  ASSERT_FALSE(symbols.empty());
+  std::ostringstream container;
+  ASSERT_TRUE(WriteSymbolContainer(symbols, 100, container));
+
+  TestCodeModule module1("module1");
+  ASSERT_TRUE(resolver.LoadModuleUsingMapBuffer(&module1, symbols));
+
+  for (u_int64_t address = 0; address < 0x4000; address += 0x8) {
+    // Use a fresh resolver for each address, so that it has only the
+    // blocks that address needs.
+    BasicSourceLineResolver container_resolver;
+    ASSERT_TRUE(container_resolver.LoadModuleUsingMapBuffer(&module1,
+                                                            container.str()));
+    CompareLookups(&resolver, &container_resolver, &module1, address);
+  }
+}
+
+// Likewise for a lazily loaded module, which parses only the records
+// covering each address looked up.
+TEST_F(TestBasicSourceLineResolver, TestLazyLoading)
+{
+  TestCodeModule module1("module1");
+  ASSERT_TRUE(resolver.LoadModule(&module1, testdata_dir + "/module1.out"));
+  TestCodeModule module2("module2");
+  ASSERT_TRUE(resolver.LoadModule(&module2, testdata_dir + "/module2.out"));
+
+  for (u_int64_t address = 0; address < 0x4000; address += 0x8) {
+    BasicSourceLineResolver lazy_resolver;
+    lazy_resolver.set_lazy_loading(true);
+    ASSERT_FALSE(lazy_resolver.ShouldDeleteMemoryBufferAfterLoadModule());
+    ASSERT_TRUE(lazy_resolver.LoadModule(&module1,
+                                         testdata_dir + "/module1.out"));
+    ASSERT_TRUE(lazy_resolver.LoadModule(&module2,
+                                         testdata_dir + "/module2.out"));
+    CompareLookups(&resolver, &lazy_resolver, &module1, address);
+    CompareLookups(&resolver, &lazy_resolver, &module2, address);
+  }
+
+  // Errors in the records that apply to the whole module are still
+  // caught when loading.
+  BasicSourceLineResolver lazy_resolver;
+  lazy_resolver.set_lazy_loading(true);
+  TestCodeModule module3("module3");
+  ASSERT_FALSE(lazy_resolver.LoadModule(&module3,
+                                        testdata_dir + "/module3_bad.out"));
+  ASSERT_FALSE(lazy_resolver.HasModule(&module3));
+  TestCodeModule module4("module4");
+  ASSERT_FALSE(lazy_resolver.LoadModule(&module4,
+                                        testdata_dir + "/module4_bad.out"));
+  ASSERT_FALSE(lazy_resolver.HasModule(&module4));
+
+  // Modules can be unloaded and reloaded as usual.
+  ASSERT_TRUE(lazy_resolver.LoadModule(&module1,
+                                       testdata_dir + "/module1.out"));
+  lazy_resolver.UnloadModule(&module1);
+  ASSERT_FALSE(lazy_resolver.HasModule(&module1));
+  ASSERT_TRUE(lazy_resolver.LoadModuleUsingMapBuffer(
+      &module1, "FUNC 1000 10 0 f\n1000 10 7 1\nFILE 1 f.cc\n"));
+  StackFrame frame;
+  frame.instruction = 0x1004;
+  frame.module = &module1;
+  lazy_resolver.FillSourceLineInfo(&frame);
+  EXPECT_EQ("f", frame.function_name);
+  EXPECT_EQ("f.cc", frame.source_file_name);
+  EXPECT_EQ(7, frame.source_line);
+}
+
+TEST_F(TestBasicSourceLineResolver, TestBadContainer)
+{
+  std::ostringstream stream;
+  ASSERT_TRUE(WriteSymbolContainer("MODULE Linux x86 0 bad\n"
+                                   "FUNC 1000 10 0 f\n", 100, stream));
+  const string container = stream.str();
+  // The index holds a count and two 32-byte entries.
+  const size_t index_offset = container.size() - 4 - 2 * 32;
+
+  // An index with no blocks.
+  TestCodeModule module1("no-blocks");
+  string no_blocks = container;
+  no_blocks.replace(index_offset, 4, 4, '\0');
+  ASSERT_FALSE(resolver.LoadModuleUsingMapBuffer(&module1, no_blocks));
+  ASSERT_FALSE(resolver.HasModule(&module1));
+
+  // A block that doesn't decompress to the size its index entry claims
+  // only matters once a lookup needs it.
+  TestCodeModule module2("bad-block");
+  string bad_block = container;
+  bad_block[index_offset + 4 + 32 + 12] ^= 0x7f;
+  ASSERT_TRUE(resolver.LoadModuleUsingMapBuffer(&module2, bad_block));
+  ASSERT_TRUE(resolver.HasModule(&module2));
+  StackFrame frame;
+  frame.instruction = 0x1000;
+  frame.module = &module2;
+  resolver.FillSourceLineInfo(&frame);
+  ASSERT_TRUE(VerifyEmpty(frame));
+
+  TestCodeModule module3("good");
+  ASSERT_TRUE(resolver.LoadModuleUsingMapBuffer(&module3, container));
+  frame.module = &module3;
+  resolver.FillSourceLineInfo(&frame);
+  ASSERT_EQ("f", frame.function_name);
+}
+
 }  // namespace
 
 int main(int argc, char *argv[]) {
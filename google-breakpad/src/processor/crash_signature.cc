@@ -0,0 +1,248 @@
+// Copyright (c) 2010, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// crash_signature.cc: Crash signatures and signature buckets.
+//
+// See crash_signature.h for documentation.
+
+#include "processor/crash_signature.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include "google_breakpad/processor/call_stack.h"
+#include "google_breakpad/processor/code_module.h"
+#include "google_breakpad/processor/process_state.h"
+#include "google_breakpad/processor/stack_frame.h"
+#include "processor/logging.h"
+#include "processor/pathname_stripper.h"
+
+namespace google_breakpad {
+
+namespace {
+
+// Orders buckets by decreasing count, then by increasing hash.
+bool BucketCountGreater(const CrashBucketTable::Bucket *a,
+                        const CrashBucketTable::Bucket *b) {
+  if (a->count != b->count)
+    return a->count > b->count;
+  return a->hash < b->hash;
+}
+
+// Returns true if C can appear in a C++ identifier.
+bool IsIdentifierChar(char c) {
+  return isalnum(static_cast<unsigned char>(c)) || c == '_';
+}
+
+}  // namespace
+
+CrashSignatureGenerator::CrashSignatureGenerator()
+    : max_frames_(kDefaultMaxFrames) {
+}
+
+void CrashSignatureGenerator::AddSkipPrefix(const string &prefix) {
+  skip_prefixes_.push_back(prefix);
+}
+
+bool CrashSignatureGenerator::Generate(const CallStack &stack,
+                                       string *signature) const {
+  return Generate(*stack.frames(), signature);
+}
+
+bool CrashSignatureGenerator::Generate(const vector<StackFrame *> &frames,
+                                       string *signature) const {
+  signature->clear();
+  size_t included = 0;
+  bool skipping = true;
+  for (size_t i = 0; i < frames.size() && included < max_frames_; ++i) {
+    const StackFrame *frame = frames[i];
+    string text = FrameText(*frame);
+    if (skipping) {
+      if (!frame->function_name.empty() && IsSkipped(text))
+        continue;
+      skipping = false;
+    }
+    if (included)
+      signature->append(" | ");
+    signature->append(text);
+    ++included;
+  }
+  return included != 0;
+}
+
+bool CrashSignatureGenerator::Generate(const ProcessState &state,
+                                       string *signature) const {
+  int requesting_thread = state.requesting_thread();
+  if (requesting_thread < 0 ||
+      static_cast<size_t>(requesting_thread) >= state.threads()->size()) {
+    BPLOG(INFO) << "No requesting thread to generate a signature from";
+    signature->clear();
+    return false;
+  }
+  return Generate(*state.threads()->at(requesting_thread), signature);
+}
+
+// static
+string CrashSignatureGenerator::NormalizeFunctionName(const string &name) {
+  static const char kOperator[] = "operator";
+  static const size_t kOperatorLength = sizeof(kOperator) - 1;
+  static const char kAnonymousNamespace[] = "(anonymous namespace)";
+  static const size_t kAnonymousNamespaceLength =
+      sizeof(kAnonymousNamespace) - 1;
+
+  string result;
+  result.reserve(name.size());
+  int template_depth = 0;
+  for (size_t i = 0; i < name.size(); ++i) {
+    char c = name[i];
+    // "operator" is the keyword only as a whole word, not as part of an
+    // identifier such as "cooperator" or "operator_count".
+    if (template_depth == 0 &&
+        name.compare(i, kOperatorLength, kOperator) == 0 &&
+        (i == 0 || !IsIdentifierChar(name[i - 1])) &&
+        (i + kOperatorLength == name.size() ||
+         !IsIdentifierChar(name[i + kOperatorLength]))) {
+      // Copy an operator name whole, so that the angle brackets and
+      // parentheses in names like "operator<<" and "operator()" are not
+      // taken for template or function arguments.
+      size_t end = i + kOperatorLength;
+      if (name.compare(end, 2, "()") == 0) {
+        end += 2;
+      } else {
+        while (end < name.size() && strchr("<>=!+-*/%&|^~[],", name[end]))
+          ++end;
+      }
+      result.append(name, i, end - i);
+      i = end - 1;
+    } else if (template_depth == 0 &&
+               name.compare(i, kAnonymousNamespaceLength,
+                            kAnonymousNamespace) == 0) {
+      result.append(kAnonymousNamespace);
+      i += kAnonymousNamespaceLength - 1;
+    } else if (c == '<') {
+      ++template_depth;
+    } else if (c == '>') {
+      if (template_depth > 0)
+        --template_depth;
+    } else if (template_depth == 0) {
+      // The argument list, and any qualifiers following it, end the name.
+      if (c == '(')
+        break;
+      result.push_back(c);
+    }
+  }
+
+  size_t end = result.find_last_not_of(' ');
+  result.erase(end == string::npos ? 0 : end + 1);
+  return result;
+}
+
+// static
+u_int64_t CrashSignatureGenerator::Hash(const string &signature) {
+  // 64-bit FNV-1a.
+  u_int64_t hash = 0xcbf29ce484222325ULL;
+  for (size_t i = 0; i < signature.size(); ++i) {
+    hash ^= static_cast<unsigned char>(signature[i]);
+    hash *= 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+// static
+string CrashSignatureGenerator::FrameText(const StackFrame &frame) {
+  if (!frame.function_name.empty())
+    return NormalizeFunctionName(frame.function_name);
+
+  // Without a function name, use the module and the offset into it, which
+  // unlike the instruction address does not depend on where the module
+  // was loaded.
+  char offset[32];
+  if (frame.module) {
+    snprintf(offset, sizeof(offset), "@0x%llx",
+             static_cast<unsigned long long>(
+                 frame.instruction - frame.module->base_address()));
+    return PathnameStripper::File(frame.module->code_file()) + offset;
+  }
+  snprintf(offset, sizeof(offset), "@0x%llx",
+           static_cast<unsigned long long>(frame.instruction));
+  return offset;
+}
+
+bool CrashSignatureGenerator::IsSkipped(const string &normalized_name) const {
+  for (vector<string>::const_iterator prefix = skip_prefixes_.begin();
+       prefix != skip_prefixes_.end(); ++prefix) {
+    if (normalized_name.compare(0, prefix->size(), *prefix) == 0)
+      return true;
+  }
+  return false;
+}
+
+u_int64_t CrashBucketTable::Add(const string &signature, bool *new_bucket) {
+  u_int64_t hash = CrashSignatureGenerator::Hash(signature);
+  ++crash_count_;
+
+  BucketMap::iterator iterator = buckets_.find(hash);
+  bool created = iterator == buckets_.end();
+  if (created) {
+    iterator = buckets_.insert(BucketMap::value_type(hash, Bucket())).first;
+    iterator->second.hash = hash;
+    iterator->second.signature = signature;
+  } else if (iterator->second.signature != signature) {
+    BPLOG(ERROR) << "Signatures \"" << iterator->second.signature <<
+                    "\" and \"" << signature << "\" have the same hash";
+  }
+  ++iterator->second.count;
+
+  if (new_bucket)
+    *new_bucket = created;
+  return hash;
+}
+
+const CrashBucketTable::Bucket *CrashBucketTable::Find(u_int64_t hash) const {
+  BucketMap::const_iterator iterator = buckets_.find(hash);
+  if (iterator == buckets_.end())
+    return NULL;
+  return &iterator->second;
+}
+
+void CrashBucketTable::GetBucketsByCount(
+    vector<const Bucket *> *buckets) const {
+  buckets->clear();
+  buckets->reserve(buckets_.size());
+  for (BucketMap::const_iterator iterator = buckets_.begin();
+       iterator != buckets_.end(); ++iterator) {
+    buckets->push_back(&iterator->second);
+  }
+  std::sort(buckets->begin(), buckets->end(), BucketCountGreater);
+}
+
+}  // namespace google_breakpad
@@ -0,0 +1,162 @@
+// -*- mode: c++ -*-
+
+// Copyright (c) 2010, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// crash_signature.h: Crash signatures and signature buckets.
+//
+// A crash signature is a short string built from the innermost frames of
+// a crashing thread's stack, such as "memcpy | CopyBuffer | main".  It is
+// meant to be equal for crashes that have the same cause, so it omits
+// anything that varies between builds or runs: function argument lists
+// and template arguments are removed, frames in uninteresting functions
+// such as allocators and abort wrappers are skipped, and frames without
+// symbols are identified by module name and offset rather than by
+// absolute address.
+//
+// CrashBucketTable groups crashes by the 64-bit hash of their signature,
+// so that a batch of minidumps can be deduplicated as it is processed.
+
+#ifndef PROCESSOR_CRASH_SIGNATURE_H__
+#define PROCESSOR_CRASH_SIGNATURE_H__
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "google_breakpad/common/breakpad_types.h"
+
+namespace google_breakpad {
+
+using std::map;
+using std::string;
+using std::vector;
+
+class CallStack;
+class ProcessState;
+struct StackFrame;
+
+class CrashSignatureGenerator {
+ public:
+  // The number of frames a signature includes unless set_max_frames
+  // is called.
+  static const size_t kDefaultMaxFrames = 3;
+
+  CrashSignatureGenerator();
+
+  // Skips frames whose normalized function name begins with prefix, if
+  // they are innermost on the stack.  Once a frame is not skipped, every
+  // following frame is included.  Typical prefixes are allocator entry
+  // points and abort wrappers, such as "malloc" or "abort".
+  void AddSkipPrefix(const string &prefix);
+
+  // Sets the number of frames a signature includes.
+  void set_max_frames(size_t max_frames) { max_frames_ = max_frames; }
+
+  // Sets *signature to the signature of stack.  Returns false if the
+  // stack has no frames that are not skipped.
+  bool Generate(const CallStack &stack, string *signature) const;
+
+  // Sets *signature to the signature of a stack consisting of frames,
+  // innermost first.
+  bool Generate(const vector<StackFrame *> &frames, string *signature) const;
+
+  // Sets *signature to the signature of the requesting thread's stack in
+  // state.  Returns false if state has no requesting thread, or if
+  // Generate fails for its stack.
+  bool Generate(const ProcessState &state, string *signature) const;
+
+  // Returns name with its template arguments, argument list and anything
+  // following the argument list (such as a "const" qualifier) removed,
+  // so "std::vector<int>::push_back(int const&)" becomes
+  // "std::vector::push_back".
+  static string NormalizeFunctionName(const string &name);
+
+  // Returns a stable 64-bit hash of signature.  The hash depends only on
+  // the signature's bytes, so it may be stored and compared across runs
+  // and machines.
+  static u_int64_t Hash(const string &signature);
+
+ private:
+  // Returns the text that identifies frame in a signature.
+  static string FrameText(const StackFrame &frame);
+
+  // Returns true if a frame with the given normalized function name is
+  // skipped when innermost.
+  bool IsSkipped(const string &normalized_name) const;
+
+  vector<string> skip_prefixes_;
+  size_t max_frames_;
+};
+
+class CrashBucketTable {
+ public:
+  struct Bucket {
+    Bucket() : hash(0), count(0) {}
+
+    // The hash of the signature, as returned by
+    // CrashSignatureGenerator::Hash.
+    u_int64_t hash;
+
+    // The signature of the first crash added to this bucket.
+    string signature;
+
+    // The number of crashes added to this bucket.
+    u_int64_t count;
+  };
+
+  CrashBucketTable() : crash_count_(0) {}
+
+  // Adds a crash with the given signature, creating a bucket for it if
+  // there is none.  Returns the bucket's hash.  If new_bucket is non-NULL,
+  // sets *new_bucket to true if a bucket was created.
+  u_int64_t Add(const string &signature, bool *new_bucket);
+
+  // Returns the bucket with the given hash, or NULL if there is none.
+  const Bucket *Find(u_int64_t hash) const;
+
+  // Sets *buckets to the table's buckets, ordered by decreasing count.
+  // Buckets with equal counts are ordered by hash.  The pointers remain
+  // valid until the table is modified.
+  void GetBucketsByCount(vector<const Bucket *> *buckets) const;
+
+  // Returns the number of buckets, and the number of crashes added.
+  size_t bucket_count() const { return buckets_.size(); }
+  u_int64_t crash_count() const { return crash_count_; }
+
+ private:
+  typedef map<u_int64_t, Bucket> BucketMap;
+
+  BucketMap buckets_;
+  u_int64_t crash_count_;
+};
+
+}  // namespace google_breakpad
+
+#endif  // PROCESSOR_CRASH_SIGNATURE_H__
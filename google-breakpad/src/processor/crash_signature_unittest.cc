@@ -0,0 +1,229 @@
+// Copyright (c) 2010, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// crash_signature_unittest.cc: Unit tests for CrashSignatureGenerator and
+// CrashBucketTable.
+
+#include <stdlib.h>
+
+#include <string>
+#include <vector>
+
+#include "breakpad_googletest_includes.h"
+#include "google_breakpad/processor/basic_source_line_resolver.h"
+#include "google_breakpad/processor/minidump_processor.h"
+#include "google_breakpad/processor/process_state.h"
+#include "google_breakpad/processor/stack_frame.h"
+#include "processor/basic_code_module.h"
+#include "processor/crash_signature.h"
+
+namespace {
+
+using google_breakpad::BasicCodeModule;
+using google_breakpad::BasicSourceLineResolver;
+using google_breakpad::CrashBucketTable;
+using google_breakpad::CrashSignatureGenerator;
+using google_breakpad::MinidumpProcessor;
+using google_breakpad::ProcessState;
+using google_breakpad::StackFrame;
+using std::string;
+using std::vector;
+
+class Frames {
+ public:
+  Frames() : module_(0x40000000, 0x10000, "c:\\app\\app.exe", "id",
+                     "app.pdb", "debug_id", "1.0") {}
+  ~Frames() {
+    for (size_t i = 0; i < frames_.size(); ++i)
+      delete frames_[i];
+  }
+
+  // Adds a frame in the given function, or a frame at the given address
+  // without a function name.
+  Frames &Function(const string &function_name) {
+    StackFrame *frame = new StackFrame();
+    frame->function_name = function_name;
+    frames_.push_back(frame);
+    return *this;
+  }
+  Frames &Address(u_int64_t instruction, bool in_module) {
+    StackFrame *frame = new StackFrame();
+    frame->instruction = instruction;
+    if (in_module)
+      frame->module = &module_;
+    frames_.push_back(frame);
+    return *this;
+  }
+
+  const vector<StackFrame *> &frames() const { return frames_; }
+
+ private:
+  BasicCodeModule module_;
+  vector<StackFrame *> frames_;
+};
+
+TEST(CrashSignatureGenerator, NormalizeFunctionName) {
+  EXPECT_EQ("main", CrashSignatureGenerator::NormalizeFunctionName("main"));
+  EXPECT_EQ("CrashFunction",
+            CrashSignatureGenerator::NormalizeFunctionName(
+                "CrashFunction(int, char **)"));
+  EXPECT_EQ("std::vector::push_back",
+            CrashSignatureGenerator::NormalizeFunctionName(
+                "std::vector<int, std::allocator<int> >::push_back"
+                "(int const&)"));
+  EXPECT_EQ("Foo::Get",
+            CrashSignatureGenerator::NormalizeFunctionName(
+                "Foo::Get<void (*)(int)>() const"));
+  EXPECT_EQ("(anonymous namespace)::Crash",
+            CrashSignatureGenerator::NormalizeFunctionName(
+                "(anonymous namespace)::Crash()"));
+  EXPECT_EQ("`anonymous namespace'::Crash",
+            CrashSignatureGenerator::NormalizeFunctionName(
+                "`anonymous namespace'::Crash"));
+  EXPECT_EQ("Stream::operator<<",
+            CrashSignatureGenerator::NormalizeFunctionName(
+                "Stream::operator<<(int)"));
+  EXPECT_EQ("Less::operator<",
+            CrashSignatureGenerator::NormalizeFunctionName(
+                "Less::operator<(Less const&) const"));
+  EXPECT_EQ("Callback::operator()",
+            CrashSignatureGenerator::NormalizeFunctionName(
+                "Callback<int>::operator()(int)"));
+  EXPECT_EQ("cooperator::run",
+            CrashSignatureGenerator::NormalizeFunctionName(
+                "cooperator<int>::run()"));
+  EXPECT_EQ("Pool::operator_count",
+            CrashSignatureGenerator::NormalizeFunctionName(
+                "Pool::operator_count<int>()"));
+  EXPECT_EQ("", CrashSignatureGenerator::NormalizeFunctionName(""));
+}
+
+TEST(CrashSignatureGenerator, Frames) {
+  Frames frames;
+  frames.Function("memcpy")
+        .Function("Buffer::Copy(char const*, unsigned long)")
+        .Address(0x40001234, true)
+        .Address(0x1234, false);
+  CrashSignatureGenerator generator;
+  string signature;
+  ASSERT_TRUE(generator.Generate(frames.frames(), &signature));
+  EXPECT_EQ("memcpy | Buffer::Copy | app.exe@0x1234", signature);
+
+  generator.set_max_frames(4);
+  ASSERT_TRUE(generator.Generate(frames.frames(), &signature));
+  EXPECT_EQ("memcpy | Buffer::Copy | app.exe@0x1234 | @0x1234", signature);
+
+  generator.set_max_frames(1);
+  ASSERT_TRUE(generator.Generate(frames.frames(), &signature));
+  EXPECT_EQ("memcpy", signature);
+}
+
+TEST(CrashSignatureGenerator, Skip) {
+  Frames frames;
+  frames.Function("abort")
+        .Function("__assert_fail")
+        .Function("malloc_consolidate")
+        .Function("Parse(char const*)")
+        .Function("abort")
+        .Function("main");
+  CrashSignatureGenerator generator;
+  generator.AddSkipPrefix("abort");
+  generator.AddSkipPrefix("__assert");
+  generator.AddSkipPrefix("malloc");
+  string signature;
+  ASSERT_TRUE(generator.Generate(frames.frames(), &signature));
+  // Only innermost frames are skipped.
+  EXPECT_EQ("Parse | abort | main", signature);
+
+  Frames all_skipped;
+  all_skipped.Function("abort").Function("malloc");
+  EXPECT_FALSE(generator.Generate(all_skipped.frames(), &signature));
+  EXPECT_EQ("", signature);
+
+  Frames empty;
+  EXPECT_FALSE(generator.Generate(empty.frames(), &signature));
+}
+
+TEST(CrashSignatureGenerator, ProcessState) {
+  BasicSourceLineResolver resolver;
+  MinidumpProcessor processor(NULL, &resolver);
+  string minidump_file = string(getenv("srcdir") ? getenv("srcdir") : ".") +
+                         "/src/processor/testdata/minidump2.dmp";
+  ProcessState state;
+  ASSERT_EQ(google_breakpad::PROCESS_OK,
+            processor.Process(minidump_file, &state));
+
+  CrashSignatureGenerator generator;
+  string signature;
+  ASSERT_TRUE(generator.Generate(state, &signature));
+  EXPECT_EQ("test_app.exe@0x429e | test_app.exe@0x41ff | "
+            "test_app.exe@0x53eb", signature);
+
+  ProcessState empty_state;
+  EXPECT_FALSE(generator.Generate(empty_state, &signature));
+}
+
+TEST(CrashSignatureGenerator, Hash) {
+  // Hashes must not change between releases, since they may be stored.
+  EXPECT_EQ(0xcbf29ce484222325ULL, CrashSignatureGenerator::Hash(""));
+  EXPECT_EQ(0xaf63dc4c8601ec8cULL, CrashSignatureGenerator::Hash("a"));
+  EXPECT_NE(CrashSignatureGenerator::Hash("main | start"),
+            CrashSignatureGenerator::Hash("start | main"));
+}
+
+TEST(CrashBucketTable, Add) {
+  CrashBucketTable table;
+  bool new_bucket = false;
+  u_int64_t parse = table.Add("Parse | main", &new_bucket);
+  EXPECT_TRUE(new_bucket);
+  u_int64_t copy = table.Add("Buffer::Copy | main", &new_bucket);
+  EXPECT_TRUE(new_bucket);
+  EXPECT_EQ(copy, table.Add("Buffer::Copy | main", &new_bucket));
+  EXPECT_FALSE(new_bucket);
+  table.Add("Buffer::Copy | main", NULL);
+  EXPECT_NE(parse, copy);
+  EXPECT_EQ(2U, table.bucket_count());
+  EXPECT_EQ(4U, table.crash_count());
+
+  const CrashBucketTable::Bucket *bucket = table.Find(copy);
+  ASSERT_TRUE(bucket);
+  EXPECT_EQ(copy, bucket->hash);
+  EXPECT_EQ("Buffer::Copy | main", bucket->signature);
+  EXPECT_EQ(3U, bucket->count);
+  EXPECT_FALSE(table.Find(parse + copy));
+
+  vector<const CrashBucketTable::Bucket *> buckets;
+  table.GetBucketsByCount(&buckets);
+  ASSERT_EQ(2U, buckets.size());
+  EXPECT_EQ(copy, buckets[0]->hash);
+  EXPECT_EQ(parse, buckets[1]->hash);
+  EXPECT_EQ(1U, buckets[1]->count);
+}
+
+}  // namespace
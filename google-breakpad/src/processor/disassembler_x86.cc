@@ -29,17 +29,50 @@
 #include <string.h>
 #include <unistd.h>
 
+#include "google_breakpad/processor/memory_region.h"
+
 namespace google_breakpad {
 
+// The length of the longest x86 instruction.
+static const u_int32_t kMaxInstructionSize = 15;
+
 DisassemblerX86::DisassemblerX86(const u_int8_t *bytecode,
                                  u_int32_t size,
                                  u_int32_t virtual_address) :
                                      bytecode_(bytecode),
+                                     memory_(NULL),
+                                     address_(virtual_address),
                                      size_(size),
                                      virtual_address_(virtual_address),
                                      current_byte_offset_(0),
                                      current_inst_offset_(0),
+                                     window_(bytecode),
+                                     window_offset_(0),
+                                     window_size_(size),
+                                     instr_valid_(false),
+                                     current_instr_(NULL),
+                                     register_valid_(false),
+                                     pushed_bad_value_(false),
+                                     end_of_block_(false),
+                                     flags_(0) {
+  libdis::x86_init(libdis::opt_none, NULL, NULL);
+}
+
+DisassemblerX86::DisassemblerX86(const MemoryRegion *memory,
+                                 u_int64_t address,
+                                 u_int32_t size) :
+                                     bytecode_(NULL),
+                                     memory_(memory),
+                                     address_(address),
+                                     size_(size),
+                                     virtual_address_(address),
+                                     current_byte_offset_(0),
+                                     current_inst_offset_(0),
+                                     window_(window_buffer_),
+                                     window_offset_(0),
+                                     window_size_(0),
                                      instr_valid_(false),
+                                     current_instr_(NULL),
                                      register_valid_(false),
                                      pushed_bad_value_(false),
                                      end_of_block_(false),
@@ -48,43 +81,102 @@ DisassemblerX86::DisassemblerX86(const u_int8_t *bytecode,
 }
 
 DisassemblerX86::~DisassemblerX86() {
+  for (size_t i = 0; i < instructions_.size(); i++) {
+    if (instructions_[i].size)
+      libdis::x86_oplist_free(&instructions_[i].instruction);
+  }
   libdis::x86_cleanup();
 }
 
+void DisassemblerX86::Rewind() {
+  current_byte_offset_ = 0;
+  current_inst_offset_ = 0;
+  instr_valid_ = false;
+  current_instr_ = NULL;
+  register_valid_ = false;
+  pushed_bad_value_ = false;
+  end_of_block_ = false;
+  flags_ = 0;
+}
+
+bool DisassemblerX86::FillWindow(u_int32_t offset) {
+  if (offset >= size_)
+    return false;
+  u_int32_t wanted = size_ - offset;
+  if (wanted > kMaxInstructionSize)
+    wanted = kMaxInstructionSize;
+  if (offset >= window_offset_ &&
+      offset + wanted <= window_offset_ + window_size_)
+    return true;
+  if (!memory_)
+    return false;
+
+  // Read a whole window's worth of bytes, so that the following
+  // instructions can be decoded without going back to memory_.
+  u_int32_t available = size_ - offset;
+  if (available > kWindowSize)
+    available = kWindowSize;
+  u_int32_t read = 0;
+  while (read < available &&
+         memory_->GetMemoryAtAddress(address_ + offset + read,
+                                     &window_buffer_[read]))
+    read++;
+  if (read < available) {
+    // The region ends here, so the code does too.
+    size_ = offset + read;
+  }
+  window_offset_ = offset;
+  window_size_ = read;
+  return read > 0;
+}
+
+void DisassemblerX86::DecodeInstruction(DecodedInstruction *decoded) {
+  memset(decoded, 0, sizeof(*decoded));
+  if (!FillWindow(current_byte_offset_))
+    return;
+  decoded->size = libdis::x86_disasm(const_cast<unsigned char *>(window_),
+                                     window_size_,
+                                     virtual_address_ + window_offset_,
+                                     current_byte_offset_ - window_offset_,
+                                     &decoded->instruction);
+}
+
 u_int32_t DisassemblerX86::NextInstruction() {
-  if (instr_valid_)
-    libdis::x86_oplist_free(&current_instr_);
+  instr_valid_ = false;
+  current_instr_ = NULL;
 
-  if (current_byte_offset_ >= size_) {
-    instr_valid_ = false;
+  if (current_byte_offset_ >= size_)
     return 0;
+
+  // Decode each instruction only once; later passes reuse it.  Decode it
+  // in place, since libdisasm's operands point back at their instruction.
+  if (current_inst_offset_ == instructions_.size()) {
+    instructions_.push_back(DecodedInstruction());
+    DecodeInstruction(&instructions_.back());
   }
-  u_int32_t instr_size = 0;
-  instr_size = libdis::x86_disasm((unsigned char *)bytecode_, size_,
-                          virtual_address_, current_byte_offset_,
-                          &current_instr_);
-  if (instr_size == 0) {
-    instr_valid_ = false;
+  DecodedInstruction &decoded = instructions_[current_inst_offset_];
+  u_int32_t instr_size = decoded.size;
+  if (instr_size == 0)
     return 0;
-  }
 
   current_byte_offset_ += instr_size;
   current_inst_offset_++;
-  instr_valid_ = libdis::x86_insn_is_valid(&current_instr_);
+  current_instr_ = &decoded.instruction;
+  instr_valid_ = libdis::x86_insn_is_valid(current_instr_);
   if (!instr_valid_)
     return 0;
 
-  if (current_instr_.type == libdis::insn_return)
+  if (current_instr_->type == libdis::insn_return)
     end_of_block_ = true;
-  libdis::x86_op_t *src = libdis::x86_get_src_operand(&current_instr_);
-  libdis::x86_op_t *dest = libdis::x86_get_dest_operand(&current_instr_);
+  libdis::x86_op_t *src = libdis::x86_get_src_operand(current_instr_);
+  libdis::x86_op_t *dest = libdis::x86_get_dest_operand(current_instr_);
 
   if (register_valid_) {
-    switch (current_instr_.group) {
+    switch (current_instr_->group) {
       // Flag branches based off of bad registers and calls that occur
       // after pushing bad values.
       case libdis::insn_controlflow:
-        switch (current_instr_.type) {
+        switch (current_instr_->type) {
           case libdis::insn_jmp:
           case libdis::insn_jcc:
           case libdis::insn_call:
@@ -101,8 +193,8 @@ u_int32_t DisassemblerX86::NextInstruction() {
                   break;
                 default:
                   if (pushed_bad_value_ &&
-                      (current_instr_.type == libdis::insn_call ||
-                      current_instr_.type == libdis::insn_callcc))
+                      (current_instr_->type == libdis::insn_call ||
+                      current_instr_->type == libdis::insn_callcc))
                     flags_ |= DISX86_BAD_ARGUMENT_PASSED;
                   break;
               }
@@ -151,7 +243,7 @@ u_int32_t DisassemblerX86::NextInstruction() {
 
   // When a register is marked as tainted check if it is pushed.
   // TODO(cdn): may also want to check for MOVs into EBP offsets.
-  if (register_valid_ && dest && current_instr_.type == libdis::insn_push) {
+  if (register_valid_ && dest && current_instr_->type == libdis::insn_push) {
     switch (dest->type) {
       case libdis::op_expression:
         if (dest->data.expression.base.id == bad_register_.id ||
@@ -171,7 +263,7 @@ u_int32_t DisassemblerX86::NextInstruction() {
   // For conditional MOVs and XCHGs assume that
   // there is a hit.
   if (register_valid_) {
-    switch (current_instr_.type) {
+    switch (current_instr_->type) {
       case libdis::insn_xor:
         if (src && src->type == libdis::op_register &&
             dest && dest->type == libdis::op_register &&
@@ -211,7 +303,7 @@ bool DisassemblerX86::setBadRead() {
   if (!instr_valid_)
     return false;
 
-  libdis::x86_op_t *operand = libdis::x86_get_src_operand(&current_instr_);
+  libdis::x86_op_t *operand = libdis::x86_get_src_operand(current_instr_);
   if (!operand || operand->type != libdis::op_expression)
     return false;
 
@@ -225,7 +317,7 @@ bool DisassemblerX86::setBadWrite() {
   if (!instr_valid_)
     return false;
 
-  libdis::x86_op_t *operand = libdis::x86_get_dest_operand(&current_instr_);
+  libdis::x86_op_t *operand = libdis::x86_get_dest_operand(current_instr_);
   if (!operand || operand->type != libdis::op_expression)
     return false;
 
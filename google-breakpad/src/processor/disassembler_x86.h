@@ -38,6 +38,8 @@
 
 #include <stddef.h>
 
+#include <deque>
+
 #include "google_breakpad/common/breakpad_types.h"
 
 namespace libdis {
@@ -46,6 +48,8 @@ namespace libdis {
 
 namespace google_breakpad {
 
+class MemoryRegion;
+
 enum {
   DISX86_NONE =                 0x0,
   DISX86_BAD_BRANCH_TARGET =    0x1,
@@ -59,10 +63,18 @@ enum {
 
 class DisassemblerX86 {
   public:
-    // TODO(cdn): Modify this class to take a MemoryRegion instead of just
-    // a raw buffer. This will make it easier to use this on arbitrary
-    // minidumps without first copying out the code segment.
-    DisassemblerX86(const u_int8_t *bytecode, u_int32_t, u_int32_t);
+    // Disassembles the |size| bytes at |bytecode|, which were loaded at
+    // |virtual_address| in the process.
+    DisassemblerX86(const u_int8_t *bytecode, u_int32_t size,
+                    u_int32_t virtual_address);
+
+    // Disassembles up to |size| bytes of |memory| starting at |address|.
+    // Bytes are read from |memory| only as instructions are decoded, so the
+    // cost is proportional to the number of instructions inspected rather
+    // than to |size|.  If |memory| cannot supply a byte, disassembly ends
+    // there.  |memory| must outlive the disassembler.
+    DisassemblerX86(const MemoryRegion *memory, u_int64_t address,
+                    u_int32_t size);
     ~DisassemblerX86();
 
     // This walks to the next instruction in the memory region and
@@ -72,18 +84,24 @@ class DisassemblerX86 {
     // disassemble until the end of a region.
     u_int32_t NextInstruction();
 
+    // Returns to the start of the code and clears the flags and any
+    // register marked bad, so that another analysis pass can be made.
+    // Instructions decoded by earlier passes are not decoded again.
+    void Rewind();
+
     // Indicates whether the current disassembled instruction was valid.
     bool currentInstructionValid() { return instr_valid_; }
 
     // Returns the current instruction as defined in libdis.h,
-    // or NULL if the current instruction is not valid.
+    // or NULL if the current instruction is not valid.  The instruction
+    // remains valid until the next call to NextInstruction().
     const libdis::x86_insn_t* currentInstruction() {
-      return instr_valid_ ? &current_instr_ : NULL;
+      return instr_valid_ ? current_instr_ : NULL;
     }
 
     // Returns the type of the current instruction as defined in libdis.h.
     libdis::x86_insn_group currentInstructionGroup() {
-      return current_instr_.group;
+      return current_instr_ ? current_instr_->group : libdis::insn_none;
     }
 
     // Indicates whether a return instruction has been encountered.
@@ -101,14 +119,49 @@ class DisassemblerX86 {
     bool setBadWrite();
 
   protected:
+    // An instruction decoded at some offset in the code, and its size
+    // in bytes, or 0 if it could not be decoded.
+    struct DecodedInstruction {
+      u_int32_t size;
+      libdis::x86_insn_t instruction;
+    };
+
+    // The number of bytes read from a MemoryRegion at a time.  This must
+    // be larger than the longest x86 instruction.
+    static const u_int32_t kWindowSize = 256;
+
+    // Decodes the instruction at current_byte_offset_ into |decoded|.
+    void DecodeInstruction(DecodedInstruction *decoded);
+
+    // Makes window_ cover at least the longest possible instruction at
+    // |offset|, or all of the code following it, reading from memory_ if
+    // necessary.  Returns false if no bytes are available at |offset|.
+    bool FillWindow(u_int32_t offset);
+
+    // The code, if it was supplied as a raw buffer.
     const u_int8_t *bytecode_;
+    // The code, if it was supplied as a MemoryRegion, and its address.
+    const MemoryRegion *memory_;
+    u_int64_t address_;
     u_int32_t size_;
     u_int32_t virtual_address_;
     u_int32_t current_byte_offset_;
     u_int32_t current_inst_offset_;
 
+    // The bytes currently available to the decoder, and their offset
+    // within the code.  For a raw buffer, this is the whole buffer.
+    const u_int8_t *window_;
+    u_int32_t window_offset_;
+    u_int32_t window_size_;
+    u_int8_t window_buffer_[kWindowSize];
+
+    // The instructions decoded so far, in order.  current_inst_offset_
+    // indexes this.  A deque never moves its elements, so pointers to
+    // them remain valid as it grows.
+    std::deque<DecodedInstruction> instructions_;
+
     bool instr_valid_;
-    libdis::x86_insn_t current_instr_;
+    libdis::x86_insn_t *current_instr_;
 
     // TODO(cdn): Maybe also track an expression's index register.
     // ex: mov eax, [ebx + ecx]; ebx is base, ecx is index.
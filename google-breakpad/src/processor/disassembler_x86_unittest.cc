@@ -40,12 +40,51 @@
 #include <unistd.h>
 
 #include "breakpad_googletest_includes.h"
+#include "google_breakpad/processor/memory_region.h"
 #include "processor/disassembler_x86.h"
 #include "third_party/libdisasm/libdis.h"
 
 namespace {
 
 using google_breakpad::DisassemblerX86;
+using google_breakpad::MemoryRegion;
+
+// A MemoryRegion over a buffer, which counts the bytes read from it.
+class BufferMemoryRegion : public MemoryRegion {
+ public:
+  BufferMemoryRegion(const unsigned char *buffer, u_int32_t size,
+                     u_int64_t base)
+      : buffer_(buffer), size_(size), base_(base), bytes_read_(0) { }
+
+  u_int64_t GetBase() const { return base_; }
+  u_int32_t GetSize() const { return size_; }
+
+  bool GetMemoryAtAddress(u_int64_t address, u_int8_t *value) const {
+    if (address < base_ || address - base_ >= size_)
+      return false;
+    *value = buffer_[address - base_];
+    bytes_read_++;
+    return true;
+  }
+  // The disassembler only reads single bytes.
+  bool GetMemoryAtAddress(u_int64_t address, u_int16_t *value) const {
+    return false;
+  }
+  bool GetMemoryAtAddress(u_int64_t address, u_int32_t *value) const {
+    return false;
+  }
+  bool GetMemoryAtAddress(u_int64_t address, u_int64_t *value) const {
+    return false;
+  }
+
+  u_int32_t bytes_read() const { return bytes_read_; }
+
+ private:
+  const unsigned char *buffer_;
+  u_int32_t size_;
+  u_int64_t base_;
+  mutable u_int32_t bytes_read_;
+};
 
 unsigned char just_return[] = "\xc3";  // retn
 
@@ -240,5 +279,62 @@ TEST(DisassemblerX86Test, BadReadThenCMP) {
   EXPECT_EQ(false, dis.endOfBlock());
   EXPECT_EQ(libdis::insn_controlflow, dis.currentInstructionGroup());
 }
+
+TEST(DisassemblerX86Test, MemoryRegionBadReadLeadsToBlockWrite) {
+  BufferMemoryRegion region(read_edi_stosb, sizeof(read_edi_stosb)-1,
+                            0x401000);
+  DisassemblerX86 dis(&region, 0x401000, sizeof(read_edi_stosb)-1);
+  EXPECT_EQ(2, dis.NextInstruction());
+  EXPECT_EQ(true, dis.currentInstructionValid());
+  EXPECT_EQ(0x401000U, dis.currentInstruction()->addr);
+  EXPECT_EQ(true, dis.setBadRead());
+  EXPECT_EQ(2, dis.NextInstruction());
+  EXPECT_EQ(0x401002U, dis.currentInstruction()->addr);
+  EXPECT_EQ(2, dis.NextInstruction());
+  EXPECT_EQ(google_breakpad::DISX86_BAD_BLOCK_WRITE, dis.flags());
+  EXPECT_EQ(libdis::insn_string, dis.currentInstructionGroup());
+  EXPECT_EQ(1, dis.NextInstruction());
+  EXPECT_EQ(true, dis.endOfBlock());
+  EXPECT_EQ(0, dis.NextInstruction());
+  EXPECT_EQ(false, dis.currentInstructionValid());
+}
+
+TEST(DisassemblerX86Test, MemoryRegionEndsCode) {
+  // Ask for more code than the region holds; disassembly stops at the
+  // end of the region.
+  BufferMemoryRegion region(read_cmp, sizeof(read_cmp)-1, 0x1000);
+  DisassemblerX86 dis(&region, 0x1002, 2048);
+  EXPECT_EQ(3, dis.NextInstruction());
+  EXPECT_EQ(libdis::insn_comparison, dis.currentInstructionGroup());
+  EXPECT_EQ(2, dis.NextInstruction());
+  EXPECT_EQ(1, dis.NextInstruction());
+  EXPECT_EQ(true, dis.endOfBlock());
+  EXPECT_EQ(0, dis.NextInstruction());
+  EXPECT_EQ(sizeof(read_cmp)-1-2, region.bytes_read());
+}
+
+TEST(DisassemblerX86Test, RewindReusesInstructions) {
+  BufferMemoryRegion region(read_eax_jmp_eax, sizeof(read_eax_jmp_eax)-1, 0);
+  DisassemblerX86 dis(&region, 0, sizeof(read_eax_jmp_eax)-1);
+  EXPECT_EQ(2, dis.NextInstruction());
+  EXPECT_EQ(true, dis.setBadRead());
+  while (dis.NextInstruction() && !dis.endOfBlock())
+    continue;
+  EXPECT_EQ(google_breakpad::DISX86_BAD_BRANCH_TARGET, dis.flags());
+  u_int32_t bytes_read = region.bytes_read();
+
+  // A second pass without marking a bad register finds nothing, and
+  // does not read the code again.
+  dis.Rewind();
+  EXPECT_EQ(0, dis.flags());
+  EXPECT_EQ(false, dis.endOfBlock());
+  EXPECT_EQ(2, dis.NextInstruction());
+  EXPECT_EQ(libdis::insn_move, dis.currentInstructionGroup());
+  while (dis.NextInstruction() && !dis.endOfBlock())
+    continue;
+  EXPECT_EQ(true, dis.endOfBlock());
+  EXPECT_EQ(0, dis.flags());
+  EXPECT_EQ(bytes_read, region.bytes_read());
+}
 }
 
@@ -39,12 +39,33 @@
 #include "google_breakpad/processor/exploitability.h"
 #include "google_breakpad/processor/minidump.h"
 #include "google_breakpad/processor/process_state.h"
+#include "processor/disassembler_x86.h"
+#include "processor/exploitability_linux.h"
+#include "processor/exploitability_mac.h"
 #include "processor/exploitability_win.h"
 #include "processor/logging.h"
 #include "processor/scoped_ptr.h"
 
 namespace google_breakpad {
 
+const u_int64_t Exploitability::kProbableNullOffset;
+const u_int64_t Exploitability::kProbableStackOffset;
+const u_int32_t Exploitability::kHighCutoff;
+const u_int32_t Exploitability::kMediumCutoff;
+const u_int32_t Exploitability::kLowCutoff;
+const u_int32_t Exploitability::kInterestingCutoff;
+const u_int32_t Exploitability::kTinyBump;
+const u_int32_t Exploitability::kSmallBump;
+const u_int32_t Exploitability::kMediumBump;
+const u_int32_t Exploitability::kLargeBump;
+const u_int32_t Exploitability::kHugeBump;
+const u_int32_t Exploitability::kDisassembleBytesBeyondPC;
+
+// How far below the captured stack memory the stack pointer may lie and
+// still be taken to be on the stack, to allow for red zones and for
+// clients that capture from slightly above the stack pointer.
+static const u_int64_t kStackSlack = 4096;
+
 Exploitability::Exploitability(Minidump *dump,
                                ProcessState *process_state)
     : dump_(dump),
@@ -74,8 +95,16 @@ Exploitability *Exploitability::ExploitabilityForPlatform(
                                                       process_state);
       break;
     }
-    case MD_OS_MAC_OS_X:
-    case MD_OS_LINUX:
+    case MD_OS_LINUX: {
+      platform_exploitability = new ExploitabilityLinux(dump,
+                                                        process_state);
+      break;
+    }
+    case MD_OS_MAC_OS_X: {
+      platform_exploitability = new ExploitabilityMac(dump,
+                                                      process_state);
+      break;
+    }
     case MD_OS_UNIX:
     case MD_OS_SOLARIS:
     default: {
@@ -90,6 +119,108 @@ Exploitability *Exploitability::ExploitabilityForPlatform(
   return platform_exploitability;
 }
 
+// static
+bool Exploitability::InstructionPointerNearStack(u_int64_t instruction_ptr,
+                                                 u_int64_t stack_ptr) {
+  // Compare the distance, so that a stack pointer near either end of the
+  // address space can't wrap around.
+  u_int64_t distance = instruction_ptr >= stack_ptr ?
+                       instruction_ptr - stack_ptr :
+                       stack_ptr - instruction_ptr;
+  return distance <= kProbableStackOffset;
+}
+
+// static
+ExploitabilityRating Exploitability::RatingForWeight(u_int32_t weight) {
+  BPLOG(INFO) << "Calculated exploitability weight: " << weight;
+  if (weight >= kHighCutoff)
+    return EXPLOITABILITY_HIGH;
+  if (weight >= kMediumCutoff)
+    return EXPLOITABLITY_MEDIUM;
+  if (weight >= kLowCutoff)
+    return EXPLOITABILITY_LOW;
+  if (weight >= kInterestingCutoff)
+    return EXPLOITABILITY_INTERESTING;
+  return EXPLOITABILITY_NONE;
+}
+
+u_int32_t Exploitability::CrashContextWeight(u_int64_t instruction_ptr,
+                                             u_int64_t stack_ptr) {
+  u_int32_t weight = 0;
+
+  // Check if we are executing on the stack.
+  if (InstructionPointerNearStack(instruction_ptr, stack_ptr))
+    weight += kHugeBump;
+
+  // A stack pointer outside the thread's stack suggests a stack pivot.
+  if (StackPointerOutsideStack(stack_ptr))
+    weight += kMediumBump;
+
+  // Code outside every loaded module is either generated or injected.
+  if (!AddressIsInModule(instruction_ptr))
+    weight += kSmallBump;
+
+  // An executable stack makes injected code easy to run.
+  const MinidumpMemoryInfo *stack_info = MemoryInfoForAddress(stack_ptr);
+  if (stack_info && stack_info->IsExecutable())
+    weight += kSmallBump;
+
+  return weight;
+}
+
+u_int32_t Exploitability::AccessFaultWeight(u_int64_t address,
+                                            u_int64_t instruction_ptr) {
+  u_int32_t weight = 0;
+
+  // The exception doesn't say whether the fault was a read or a write,
+  // but a fault at the instruction pointer is an attempt to execute.
+  bool near_null = (address <= kProbableNullOffset);
+  if (near_null)
+    weight += kSmallBump;
+  else if (address == instruction_ptr)
+    weight += kHugeBump;
+  else
+    weight += kMediumBump;
+
+  const MinidumpMemoryInfo *code_info = MemoryInfoForAddress(instruction_ptr);
+  if (code_info && !code_info->IsExecutable())
+    weight += kHugeBump;
+
+  // A near-NULL fault is most likely a plain NULL dereference, whatever
+  // the code around it does.
+  if (near_null)
+    return weight;
+
+  bool control_flow = false;
+  bool block_operation = false;
+  u_int16_t flags = 0;
+  if (DisassembleFaultingCode(instruction_ptr, &control_flow,
+                              &block_operation, &flags)) {
+    if (control_flow)
+      weight += kLargeBump;
+    if (block_operation)
+      weight += kHugeBump;
+    if (flags & DISX86_BAD_BRANCH_TARGET)
+      weight += kLargeBump;
+    if (flags & DISX86_BAD_ARGUMENT_PASSED)
+      weight += kTinyBump;
+    if (flags & DISX86_BAD_WRITE)
+      weight += kMediumBump;
+    if (flags & DISX86_BAD_BLOCK_WRITE)
+      weight += kMediumBump;
+    if (flags & DISX86_BAD_READ)
+      weight += kTinyBump;
+    if (flags & DISX86_BAD_BLOCK_READ)
+      weight += kTinyBump;
+    if (flags & DISX86_BAD_COMPARISON)
+      weight += kTinyBump;
+  }
+  if (AddressIsAscii(address))
+    weight += kMediumBump;
+
+  return weight;
+}
+
 bool Exploitability::AddressIsAscii(u_int64_t address) {
   for (int i = 0; i < 8; i++) {
     u_int8_t byte = (address >> (8*i)) & 0xff;
@@ -100,5 +231,112 @@ bool Exploitability::AddressIsAscii(u_int64_t address) {
   return true;
 }
 
+bool Exploitability::GetCrashPointers(u_int64_t *instruction_ptr,
+                                      u_int64_t *stack_ptr) {
+  MinidumpException *exception = dump_->GetException();
+  if (!exception)
+    return false;
+  const MinidumpContext *context = exception->GetContext();
+  if (!context)
+    return false;
+
+  switch (context->GetContextCPU()) {
+    case MD_CONTEXT_X86:
+      *instruction_ptr = context->GetContextX86()->eip;
+      *stack_ptr = context->GetContextX86()->esp;
+      return true;
+    case MD_CONTEXT_AMD64:
+      *instruction_ptr = context->GetContextAMD64()->rip;
+      *stack_ptr = context->GetContextAMD64()->rsp;
+      return true;
+    case MD_CONTEXT_ARM:
+      *instruction_ptr =
+          context->GetContextARM()->iregs[MD_CONTEXT_ARM_REG_PC];
+      *stack_ptr = context->GetContextARM()->iregs[MD_CONTEXT_ARM_REG_SP];
+      return true;
+    case MD_CONTEXT_PPC:
+      *instruction_ptr = context->GetContextPPC()->srr0;
+      *stack_ptr = context->GetContextPPC()->gpr[1];
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool Exploitability::StackPointerOutsideStack(u_int64_t stack_ptr) {
+  int requesting_thread = process_state_->requesting_thread();
+  const vector<MinidumpMemoryRegion*> *stacks =
+      process_state_->thread_memory_regions();
+  if (requesting_thread < 0 ||
+      static_cast<size_t>(requesting_thread) >= stacks->size())
+    return false;
+  const MinidumpMemoryRegion *stack = (*stacks)[requesting_thread];
+  if (!stack || stack->GetSize() == 0)
+    return false;
+
+  u_int64_t base = stack->GetBase();
+  u_int64_t low = base > kStackSlack ? base - kStackSlack : 0;
+  return stack_ptr < low ||
+         (stack_ptr >= base && stack_ptr - base >= stack->GetSize());
+}
+
+bool Exploitability::AddressIsInModule(u_int64_t address) {
+  const CodeModules *modules = process_state_->modules();
+  return modules && modules->GetModuleForAddress(address);
+}
+
+const MinidumpMemoryInfo *Exploitability::MemoryInfoForAddress(
+    u_int64_t address) {
+  MinidumpMemoryInfoList *memory_info_list = dump_->GetMemoryInfoList();
+  if (!memory_info_list)
+    return NULL;
+  return memory_info_list->GetMemoryInfoForAddress(address);
+}
+
+bool Exploitability::DisassembleFaultingCode(u_int64_t instruction_ptr,
+                                             bool *control_flow,
+                                             bool *block_operation,
+                                             u_int16_t *flags) {
+  MinidumpException *exception = dump_->GetException();
+  if (!exception || !exception->GetContext() ||
+      exception->GetContext()->GetContextCPU() != MD_CONTEXT_X86)
+    return false;
+  MinidumpMemoryList *memory_list = dump_->GetMemoryList();
+  if (!memory_list)
+    return false;
+  MinidumpMemoryRegion *instruction_region =
+      memory_list->GetMemoryRegionForAddress(instruction_ptr);
+  if (!instruction_region)
+    return false;
+
+  u_int64_t available_memory = instruction_region->GetBase() +
+                               instruction_region->GetSize() -
+                               instruction_ptr;
+  if (available_memory > kDisassembleBytesBeyondPC)
+    available_memory = kDisassembleBytesBeyondPC;
+  DisassemblerX86 disassembler(instruction_region, instruction_ptr,
+                               static_cast<u_int32_t>(available_memory));
+  disassembler.NextInstruction();
+  if (!disassembler.currentInstructionValid())
+    return false;
+
+  // The platform doesn't say whether the fault was a read or a write, so
+  // suspect the destination if the instruction stores through a register,
+  // and the source otherwise.
+  if (!disassembler.setBadWrite())
+    disassembler.setBadRead();
+  *control_flow =
+      disassembler.currentInstructionGroup() == libdis::insn_controlflow;
+  *block_operation =
+      disassembler.currentInstructionGroup() == libdis::insn_string;
+
+  while (disassembler.NextInstruction() &&
+         disassembler.currentInstructionValid() &&
+         !disassembler.endOfBlock())
+    continue;
+  *flags = disassembler.flags();
+  return true;
+}
+
 }  // namespace google_breakpad
 
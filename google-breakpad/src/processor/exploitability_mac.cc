@@ -0,0 +1,117 @@
+// Copyright (c) 2010 Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// exploitability_mac.cc: Mac OS X specific exploitability engine.
+//
+// Provides a guess at the exploitability of the crash for the Mac OS X
+// platform given a minidump and process_state.
+
+#include "processor/exploitability_mac.h"
+
+#include "google_breakpad/common/minidump_exception_mac.h"
+#include "google_breakpad/processor/minidump.h"
+#include "processor/logging.h"
+
+namespace google_breakpad {
+
+ExploitabilityMac::ExploitabilityMac(Minidump *dump,
+                                     ProcessState *process_state)
+    : Exploitability(dump, process_state) { }
+
+ExploitabilityRating ExploitabilityMac::CheckPlatformExploitability() {
+  MinidumpException *exception = dump_->GetException();
+  if (!exception) {
+    BPLOG(INFO) << "Minidump does not have exception record.";
+    return EXPLOITABILITY_ERR_PROCESSING;
+  }
+
+  const MDRawExceptionStream *raw_exception = exception->exception();
+  if (!raw_exception) {
+    BPLOG(INFO) << "Could not obtain raw exception info.";
+    return EXPLOITABILITY_ERR_PROCESSING;
+  }
+
+  u_int64_t instruction_ptr = 0;
+  u_int64_t stack_ptr = 0;
+  if (!GetCrashPointers(&instruction_ptr, &stack_ptr)) {
+    BPLOG(INFO) << "Unsupported architecture or missing exception context.";
+    return EXPLOITABILITY_ERR_PROCESSING;
+  }
+
+  u_int64_t address = process_state_->crash_address();
+  u_int32_t exception_code = raw_exception->exception_record.exception_code;
+
+  u_int32_t exploitability_weight =
+      CrashContextWeight(instruction_ptr, stack_ptr);
+
+  u_int32_t exception_flags = raw_exception->exception_record.exception_flags;
+  bool access_fault = false;
+  switch (exception_code) {
+    // These tend to be benign.
+    case MD_EXCEPTION_MAC_ARITHMETIC:
+    case MD_EXCEPTION_MAC_BREAKPOINT:
+    case MD_EXCEPTION_MAC_EMULATION:
+      exploitability_weight += kTinyBump;
+      break;
+
+    // Allocators abort when they find their structures corrupted.
+    case MD_EXCEPTION_MAC_SOFTWARE:
+      if (exception_flags == MD_EXCEPTION_CODE_MAC_ABORT)
+        exploitability_weight += kSmallBump;
+      break;
+
+    // This will typically mean that we have jumped where we shouldn't.
+    case MD_EXCEPTION_MAC_BAD_INSTRUCTION:
+      exploitability_weight += kLargeBump;
+      break;
+
+    case MD_EXCEPTION_MAC_BAD_ACCESS:
+      switch (exception_flags) {
+        // Hardware memory errors say nothing about the program.
+        case MD_EXCEPTION_CODE_MAC_MEMORY_FAILURE:
+        case MD_EXCEPTION_CODE_MAC_MEMORY_ERROR:
+          exploitability_weight += kTinyBump;
+          break;
+        default:
+          access_fault = true;
+          break;
+      }
+      break;
+
+    default:
+      break;
+  }
+
+  if (access_fault)
+    exploitability_weight += AccessFaultWeight(address, instruction_ptr);
+
+  return RatingForWeight(exploitability_weight);
+}
+
+}  // namespace google_breakpad
@@ -38,11 +38,15 @@
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 
+#include <sstream>
 #include <string>
 
 #include "breakpad_googletest_includes.h"
+#include "google_breakpad/common/minidump_exception_linux.h"
+#include "google_breakpad/common/minidump_exception_mac.h"
 #include "google_breakpad/processor/basic_source_line_resolver.h"
 #include "google_breakpad/processor/call_stack.h"
 #include "google_breakpad/processor/code_module.h"
@@ -52,6 +56,7 @@
 #include "google_breakpad/processor/process_state.h"
 #include "google_breakpad/processor/stack_frame.h"
 #include "google_breakpad/processor/symbol_supplier.h"
+#include "processor/synth_minidump.h"
 
 namespace google_breakpad {
 class MockMinidump : public Minidump {
@@ -71,6 +76,8 @@ namespace {
 using google_breakpad::BasicSourceLineResolver;
 using google_breakpad::CallStack;
 using google_breakpad::CodeModule;
+using google_breakpad::ExploitabilityRating;
+using google_breakpad::Minidump;
 using google_breakpad::MinidumpProcessor;
 using google_breakpad::MinidumpThreadList;
 using google_breakpad::MinidumpThread;
@@ -78,7 +85,10 @@ using google_breakpad::MockMinidump;
 using google_breakpad::ProcessState;
 using google_breakpad::SymbolSupplier;
 using google_breakpad::SystemInfo;
+using google_breakpad::test_assembler::kLittleEndian;
+using std::istringstream;
 using std::string;
+namespace SynthMinidump = google_breakpad::SynthMinidump;
 
 class TestSymbolSupplier : public SymbolSupplier {
  public:
@@ -96,7 +106,8 @@ class TestSymbolSupplier : public SymbolSupplier {
   virtual SymbolResult GetCStringSymbolData(const CodeModule *module,
                                             const SystemInfo *system_info,
                                             string *symbol_file,
-                                            char **symbol_data);
+                                            char **symbol_data,
+                                            size_t *symbol_data_size);
 
   virtual void FreeSymbolData(const CodeModule *module) { }
   // When set to true, causes the SymbolSupplier to return INTERRUPT
@@ -122,7 +133,8 @@ SymbolSupplier::SymbolResult TestSymbolSupplier::GetCStringSymbolData(
     const CodeModule *module,
     const SystemInfo *system_info,
     string *symbol_file,
-    char **symbol_data) {
+    char **symbol_data,
+    size_t *symbol_data_size) {
   return GetSymbolFile(module, system_info, symbol_file);
 }
 
@@ -252,4 +264,104 @@ TEST(ExploitabilityTest, TestWindowsEngine) {
   ASSERT_EQ(google_breakpad::EXPLOITABILITY_LOW,
             state.exploitability());
 }
+
+// The layout of the synthetic dumps below: a 16-byte stack, and a
+// module whose code is not in the dump.
+const u_int32_t kStackBase = 0x80000000;
+const u_int32_t kModuleBase = 0x10000000;
+const u_int32_t kModuleSize = 0x1000;
+
+// Processes a synthetic x86 minidump from the platform |platform_id|,
+// whose crashing thread has the given instruction and stack pointers and
+// exception, and returns the rating the exploitability engine gives it.
+ExploitabilityRating ProcessSyntheticDump(u_int32_t platform_id,
+                                          u_int32_t eip, u_int32_t esp,
+                                          u_int32_t exception_code,
+                                          u_int32_t exception_flags,
+                                          u_int64_t exception_address) {
+  SynthMinidump::Dump dump(0, kLittleEndian);
+
+  MDRawSystemInfo raw_system_info = SynthMinidump::SystemInfo::windows_x86;
+  raw_system_info.platform_id = platform_id;
+  SynthMinidump::String csd_version(dump, "");
+  SynthMinidump::SystemInfo system_info(dump, raw_system_info, csd_version);
+  dump.Add(&system_info);
+  dump.Add(&csd_version);
+
+  SynthMinidump::String module_name(dump, "module");
+  SynthMinidump::Module module(dump, kModuleBase, kModuleSize, module_name);
+  dump.Add(&module);
+  dump.Add(&module_name);
+
+  SynthMinidump::Memory stack(dump, kStackBase);
+  stack.D32(0).D32(0).D32(0).D32(0);
+  MDRawContextX86 raw_context;
+  memset(&raw_context, 0, sizeof(raw_context));
+  raw_context.context_flags = MD_CONTEXT_X86_INTEGER | MD_CONTEXT_X86_CONTROL;
+  raw_context.eip = eip;
+  raw_context.esp = esp;
+  SynthMinidump::Context context(dump, raw_context);
+  SynthMinidump::Thread thread(dump, 1, stack, context);
+  SynthMinidump::Exception exception(dump, context, 1, exception_code,
+                                     exception_flags, exception_address);
+  dump.Add(&stack);
+  dump.Add(&context);
+  dump.Add(&thread);
+  dump.Add(&exception);
+  dump.Finish();
+
+  string contents;
+  EXPECT_TRUE(dump.GetContents(&contents));
+  istringstream stream(contents);
+  Minidump minidump(stream);
+  EXPECT_TRUE(minidump.Read());
+
+  TestSymbolSupplier supplier;
+  BasicSourceLineResolver resolver;
+  MinidumpProcessor processor(&supplier, &resolver, true);
+  ProcessState state;
+  EXPECT_EQ(google_breakpad::PROCESS_OK,
+            processor.Process(&minidump, &state));
+  return state.exploitability();
+}
+
+TEST(ExploitabilityTest, TestLinuxEngine) {
+  // Executing on the stack, faulting at an ASCII address.
+  ASSERT_EQ(google_breakpad::EXPLOITABILITY_HIGH,
+            ProcessSyntheticDump(MD_OS_LINUX, kStackBase + 0x10, kStackBase,
+                                 MD_EXCEPTION_CODE_LIN_SIGSEGV, 0,
+                                 0x41414141));
+
+  // A near-null dereference in a module.
+  ASSERT_EQ(google_breakpad::EXPLOITABILITY_NONE,
+            ProcessSyntheticDump(MD_OS_LINUX, kModuleBase + 0x100, kStackBase,
+                                 MD_EXCEPTION_CODE_LIN_SIGSEGV, 0, 0x10));
+
+  // An illegal instruction in a module.
+  ASSERT_EQ(google_breakpad::EXPLOITABILITY_LOW,
+            ProcessSyntheticDump(MD_OS_LINUX, kModuleBase + 0x100, kStackBase,
+                                 MD_EXCEPTION_CODE_LIN_SIGILL, 0, 0));
+
+  // Executing just above a stack pointer near address zero, where the
+  // stack proximity check must not wrap around.
+  ASSERT_EQ(google_breakpad::EXPLOITABILITY_HIGH,
+            ProcessSyntheticDump(MD_OS_LINUX, 0x200, 0x100,
+                                 MD_EXCEPTION_CODE_LIN_SIGFPE, 0, 0));
+}
+
+TEST(ExploitabilityTest, TestMacEngine) {
+  // A bad access with the stack pointer outside the thread's stack.
+  ASSERT_EQ(google_breakpad::EXPLOITABILITY_HIGH,
+            ProcessSyntheticDump(MD_OS_MAC_OS_X, kModuleBase + 0x100,
+                                 kStackBase + 0x100000,
+                                 MD_EXCEPTION_MAC_BAD_ACCESS,
+                                 MD_EXCEPTION_CODE_MAC_INVALID_ADDRESS,
+                                 0x12345678));
+
+  // A breakpoint in a module.
+  ASSERT_EQ(google_breakpad::EXPLOITABILITY_NONE,
+            ProcessSyntheticDump(MD_OS_MAC_OS_X, kModuleBase + 0x100,
+                                 kStackBase, MD_EXCEPTION_MAC_BREAKPOINT, 0,
+                                 0));
+}
 }
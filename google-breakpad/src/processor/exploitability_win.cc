@@ -48,27 +48,6 @@
 
 namespace google_breakpad {
 
-// The cutoff that we use to judge if and address is likely an offset
-// from various interesting addresses.
-static const u_int64_t kProbableNullOffset = 4096;
-static const u_int64_t kProbableStackOffset = 8192;
-
-// The various cutoffs for the different ratings.
-static const size_t kHighCutoff        = 100;
-static const size_t kMediumCutoff      = 80;
-static const size_t kLowCutoff         = 50;
-static const size_t kInterestingCutoff = 25;
-
-// Predefined incremental values for conditional weighting.
-static const size_t kTinyBump          = 5;
-static const size_t kSmallBump         = 20;
-static const size_t kMediumBump        = 50;
-static const size_t kLargeBump         = 70;
-static const size_t kHugeBump          = 90;
-
-// The maximum number of bytes to disassemble past the program counter.
-static const size_t kDisassembleBytesBeyondPC = 2048;
-
 ExploitabilityWin::ExploitabilityWin(Minidump *dump,
                                      ProcessState *process_state)
     : Exploitability(dump, process_state) { }
@@ -124,8 +103,7 @@ ExploitabilityRating ExploitabilityWin::CheckPlatformExploitability() {
   }
 
   // Check if we are executing on the stack.
-  if (instruction_ptr <= (stack_ptr + kProbableStackOffset) &&
-      instruction_ptr >= (stack_ptr - kProbableStackOffset))
+  if (InstructionPointerNearStack(instruction_ptr, stack_ptr))
     exploitability_weight += kHugeBump;
 
   switch (exception_code) {
@@ -218,11 +196,9 @@ ExploitabilityRating ExploitabilityWin::CheckPlatformExploitability() {
           available_memory = available_memory > kDisassembleBytesBeyondPC ?
               kDisassembleBytesBeyondPC : available_memory;
           if (available_memory) {
-            const u_int8_t *raw_memory =
-                instruction_region->GetMemory() + memory_offset;
-            DisassemblerX86 disassembler(raw_memory,
-                                         available_memory,
-                                         instruction_ptr);
+            DisassemblerX86 disassembler(instruction_region,
+                                         instruction_ptr,
+                                         available_memory);
             disassembler.NextInstruction();
             if (bad_read)
               disassembler.setBadRead();
@@ -274,17 +250,7 @@ ExploitabilityRating ExploitabilityWin::CheckPlatformExploitability() {
   }
 
   // Based on the calculated weight we return a simplified classification.
-  BPLOG(INFO) << "Calculated exploitability weight: " << exploitability_weight;
-  if (exploitability_weight >= kHighCutoff)
-    return EXPLOITABILITY_HIGH;
-  if (exploitability_weight >= kMediumCutoff)
-    return EXPLOITABLITY_MEDIUM;
-  if (exploitability_weight >= kLowCutoff)
-    return EXPLOITABILITY_LOW;
-  if (exploitability_weight >= kInterestingCutoff)
-    return EXPLOITABILITY_INTERESTING;
-
-  return EXPLOITABILITY_NONE;
+  return RatingForWeight(exploitability_weight);
 }
 
 }  // namespace google_breakpad
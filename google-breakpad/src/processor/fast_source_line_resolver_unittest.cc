@@ -38,6 +38,7 @@
 // Author: Siyang Xie (lambxsy@google.com)
 
 #include <stdio.h>
+#include <string.h>
 
 #include <sstream>
 #include <string>
@@ -64,6 +65,7 @@ using google_breakpad::MemoryRegion;
 using google_breakpad::StackFrame;
 using google_breakpad::WindowsFrameInfo;
 using google_breakpad::linked_ptr;
+using google_breakpad::scoped_array;
 using google_breakpad::scoped_ptr;
 
 class TestCodeModule : public CodeModule {
@@ -454,6 +456,7 @@ TEST_F(TestFastSourceLineResolver, TestUnload) {
 
 TEST_F(TestFastSourceLineResolver, CompareModule) {
   char *symbol_data;
+  size_t symbol_data_size;
   string symbol_data_string;
   string filename;
 
@@ -462,13 +465,46 @@ TEST_F(TestFastSourceLineResolver, CompareModule) {
     ss << testdata_dir << "/module" << module_index << ".out";
     filename = ss.str();
     ASSERT_TRUE(SourceLineResolverBase::ReadSymbolFile(
-        &symbol_data, symbol_file(module_index)));
+        &symbol_data, &symbol_data_size, symbol_file(module_index)));
     symbol_data_string = symbol_data;
     delete [] symbol_data;
     ASSERT_TRUE(module_comparer.Compare(symbol_data_string));
   }
 }
 
+// Modules whose symbol files use STACK CFI RULES records should
+// convert to the same fast module as their fully spelled-out versions.
+TEST_F(TestFastSourceLineResolver, CompactCFI) {
+  const char *expanded =
+    "MODULE Linux x86 B8CFDE93002D54DA1900A40AA1BD67690 compact\n"
+    "STACK CFI INIT 3d40 af .cfa: $esp 4 + .ra: .cfa 4 - ^\n"
+    "STACK CFI 3d41 .cfa: $esp 8 +\n"
+    "STACK CFI 3d43 .cfa: $ebp 8 + $ebp: .cfa 8 - ^\n"
+    "STACK CFI INIT 3df0 af .cfa: $esp 4 + .ra: .cfa 4 - ^\n"
+    "STACK CFI 3df3 .cfa: $ebp 8 + $ebp: .cfa 8 - ^\n";
+  const char *compact =
+    "MODULE Linux x86 B8CFDE93002D54DA1900A40AA1BD67690 compact\n"
+    "STACK CFI RULES 0 .cfa: $esp 4 + .ra: .cfa 4 - ^\n"
+    "STACK CFI RULES 1 .cfa: $ebp 8 + $ebp: .cfa 8 - ^\n"
+    "STACK CFI INIT 3d40 af @0\n"
+    "STACK CFI 3d41 .cfa: $esp 8 +\n"
+    "STACK CFI 3d43 @1\n"
+    "STACK CFI INIT 3df0 af @0\n"
+    "STACK CFI 3df3 @1\n";
+
+  unsigned int expanded_size, compact_size;
+  scoped_array<char> expanded_data(
+      serializer.SerializeSymbolFileData(expanded, &expanded_size));
+  scoped_array<char> compact_data(
+      serializer.SerializeSymbolFileData(compact, &compact_size));
+  ASSERT_TRUE(expanded_data.get());
+  ASSERT_TRUE(compact_data.get());
+  ASSERT_EQ(expanded_size, compact_size);
+  EXPECT_EQ(0, memcmp(expanded_data.get(), compact_data.get(), compact_size));
+
+  ASSERT_TRUE(module_comparer.Compare(compact));
+}
+
 }  // namespace
 
 int main(int argc, char *argv[]) {
@@ -60,6 +60,7 @@ typedef SSIZE_T ssize_t;
 
 #include "processor/range_map-inl.h"
 
+#include "common/minidump_container.h"
 #include "processor/basic_code_module.h"
 #include "processor/basic_code_modules.h"
 #include "processor/logging.h"
@@ -248,6 +249,13 @@ static string* UTF16ToUTF8(const vector<u_int16_t>& in,
   return out.release();
 }
 
+// Return the end of the |size| bytes at |address|, limited to the top of
+// the address space.
+static u_int64_t RangeEnd(u_int64_t address, u_int64_t size) {
+  return size < numeric_limits<u_int64_t>::max() - address ?
+         address + size : numeric_limits<u_int64_t>::max();
+}
+
 // Return the smaller of the number of code units in the UTF-16 string,
 // not including the terminating null word, or maxlen.
 static size_t UTF16codeunits(const u_int16_t *string, size_t maxlen) {
@@ -1252,23 +1260,82 @@ bool MinidumpMemoryRegion::GetMemoryAtAddress(u_int64_t  address,
 
 
 void MinidumpMemoryRegion::Print() {
+  PrintRange(0, numeric_limits<u_int64_t>::max());
+}
+
+
+void MinidumpMemoryRegion::PrintRange(u_int64_t address, u_int64_t size) {
   if (!valid_) {
     BPLOG(ERROR) << "MinidumpMemoryRegion cannot print invalid data";
     return;
   }
 
-  const u_int8_t* memory = GetMemory();
-  if (memory) {
-    printf("0x");
-    for (unsigned int byte_index = 0;
-         byte_index < descriptor_->memory.data_size;
-         byte_index++) {
-      printf("%02x", memory[byte_index]);
-    }
-    printf("\n");
-  } else {
+  if (descriptor_->memory.data_size == 0) {
+    BPLOG(ERROR) << "MinidumpMemoryRegion is empty";
     printf("No memory\n");
+    return;
+  }
+
+  if (descriptor_->memory.data_size > max_bytes_) {
+    BPLOG(ERROR) << "MinidumpMemoryRegion size " <<
+                    descriptor_->memory.data_size << " exceeds maximum " <<
+                    max_bytes_;
+    printf("No memory\n");
+    return;
   }
+
+  // Clip the range to the region.
+  u_int64_t base = descriptor_->start_of_memory_range;
+  u_int64_t end = base + descriptor_->memory.data_size;
+  u_int64_t range_end = RangeEnd(address, size);
+  u_int64_t low = address > base ? address : base;
+  u_int64_t high = range_end < end ? range_end : end;
+  if (low >= high) {
+    printf("No memory\n");
+    return;
+  }
+  u_int32_t offset = static_cast<u_int32_t>(low - base);
+  u_int32_t remaining = static_cast<u_int32_t>(high - low);
+
+  // Print from the cached copy if there is one; otherwise, read the range
+  // a chunk at a time, so that printing a region never holds all of it.
+  const u_int8_t* memory = memory_ ? &(*memory_)[offset] : NULL;
+  vector<u_int8_t> chunk;
+  if (!memory) {
+    if (!minidump_->SeekSet(descriptor_->memory.rva + offset)) {
+      BPLOG(ERROR) << "MinidumpMemoryRegion could not seek to memory region";
+      printf("No memory\n");
+      return;
+    }
+    u_int32_t chunk_size = kPrintChunkSize;
+    chunk.resize(remaining < chunk_size ? remaining : chunk_size);
+  }
+
+  bool started = false;
+  while (remaining > 0) {
+    u_int32_t length = remaining;
+    if (!memory) {
+      if (length > chunk.size())
+        length = chunk.size();
+      if (!minidump_->ReadBytes(&chunk[0], length)) {
+        BPLOG(ERROR) << "MinidumpMemoryRegion could not read memory region";
+        printf(started ? "\n" : "No memory\n");
+        return;
+      }
+    }
+    if (!started)
+      printf("0x");
+    started = true;
+
+    const u_int8_t* bytes = memory ? memory : &chunk[0];
+    for (unsigned int byte_index = 0; byte_index < length; byte_index++) {
+      printf("%02x", bytes[byte_index]);
+    }
+    if (memory)
+      memory += length;
+    remaining -= length;
+  }
+  printf("\n");
 }
 
 
@@ -2734,28 +2801,59 @@ void MinidumpMemoryList::Print() {
   printf("  region_count = %d\n", region_count_);
   printf("\n");
 
+  for (unsigned int region_index = 0;
+       region_index < region_count_;
+       ++region_index) {
+    PrintRegion(region_index, 0, numeric_limits<u_int64_t>::max());
+  }
+}
+
+
+void MinidumpMemoryList::PrintRange(u_int64_t address, u_int64_t size) {
+  if (!valid_) {
+    BPLOG(ERROR) << "MinidumpMemoryList cannot print invalid data";
+    return;
+  }
+
+  printf("MinidumpMemoryList\n");
+  printf("  region_count = %d\n", region_count_);
+  printf("  range        = 0x%" PRIx64 "+0x%" PRIx64 "\n", address, size);
+  printf("\n");
+
+  u_int64_t range_end = RangeEnd(address, size);
   for (unsigned int region_index = 0;
        region_index < region_count_;
        ++region_index) {
     MDMemoryDescriptor* descriptor = &(*descriptors_)[region_index];
-    printf("region[%d]\n", region_index);
-    printf("MDMemoryDescriptor\n");
-    printf("  start_of_memory_range = 0x%" PRIx64 "\n",
-           descriptor->start_of_memory_range);
-    printf("  memory.data_size      = 0x%x\n", descriptor->memory.data_size);
-    printf("  memory.rva            = 0x%x\n", descriptor->memory.rva);
-    MinidumpMemoryRegion* region = GetMemoryRegionAtIndex(region_index);
-    if (region) {
-      printf("Memory\n");
-      region->Print();
-    } else {
-      printf("No memory\n");
+    u_int64_t base = descriptor->start_of_memory_range;
+    if (base < range_end &&
+        address < base + descriptor->memory.data_size) {
+      PrintRegion(region_index, address, size);
     }
-    printf("\n");
   }
 }
 
 
+void MinidumpMemoryList::PrintRegion(unsigned int region_index,
+                                     u_int64_t address, u_int64_t size) {
+  MDMemoryDescriptor* descriptor = &(*descriptors_)[region_index];
+  printf("region[%d]\n", region_index);
+  printf("MDMemoryDescriptor\n");
+  printf("  start_of_memory_range = 0x%" PRIx64 "\n",
+         descriptor->start_of_memory_range);
+  printf("  memory.data_size      = 0x%x\n", descriptor->memory.data_size);
+  printf("  memory.rva            = 0x%x\n", descriptor->memory.rva);
+  MinidumpMemoryRegion* region = GetMemoryRegionAtIndex(region_index);
+  if (region) {
+    printf("Memory\n");
+    region->PrintRange(address, size);
+  } else {
+    printf("No memory\n");
+  }
+  printf("\n");
+}
+
+
 //
 // MinidumpException
 //
@@ -3723,6 +3821,8 @@ Minidump::Minidump(const string& path)
       stream_map_(new MinidumpStreamMap()),
       path_(path),
       stream_(NULL),
+      container_(NULL),
+      container_position_(0),
       swap_(false),
       valid_(false) {
 }
@@ -3733,6 +3833,8 @@ Minidump::Minidump(istream& stream)
       stream_map_(new MinidumpStreamMap()),
       path_(),
       stream_(&stream),
+      container_(NULL),
+      container_position_(0),
       swap_(false),
       valid_(false) {
 }
@@ -3741,6 +3843,7 @@ Minidump::~Minidump() {
   if (stream_) {
     BPLOG(INFO) << "Minidump closing minidump";
   }
+  delete container_;
   if (!path_.empty()) {
     delete stream_;
   }
@@ -3772,6 +3875,36 @@ bool Minidump::Open() {
 }
 
 
+bool Minidump::OpenContainer() {
+  delete container_;
+  container_ = NULL;
+  container_position_ = 0;
+
+  char magic[8];
+  if (!SeekSet(0))
+    return false;
+  stream_->read(magic, sizeof(magic));
+  bool is_container = stream_->gcount() == sizeof(magic) &&
+                      MinidumpContainerReader::IsContainer(magic,
+                                                           sizeof(magic));
+  stream_->clear();
+  if (!is_container)
+    return SeekSet(0);
+
+  scoped_ptr<MinidumpContainerReader> container(
+      new MinidumpContainerReader(stream_));
+  if (!container->ReadIndex()) {
+    BPLOG(ERROR) << "Minidump could not read container index";
+    return false;
+  }
+  container_ = container.release();
+
+  BPLOG(INFO) << "Minidump reading compressed minidump, " <<
+                 container_->size() << " bytes decompressed";
+  return true;
+}
+
+
 bool Minidump::Read() {
   // Invalidate cached data.
   delete directory_;
@@ -3785,6 +3918,11 @@ bool Minidump::Read() {
     return false;
   }
 
+  if (!OpenContainer()) {
+    BPLOG(ERROR) << "Minidump cannot open minidump container";
+    return false;
+  }
+
   if (!ReadBytes(&header_, sizeof(MDRawHeader))) {
     BPLOG(ERROR) << "Minidump cannot read header";
     return false;
@@ -4030,6 +4168,16 @@ bool Minidump::ReadBytes(void* bytes, size_t count) {
   if (!stream_) {
     return false;
   }
+  if (container_) {
+    if (!container_->Read(container_position_, bytes, count)) {
+      BPLOG(ERROR) << "ReadBytes: could not read " << count <<
+                      " bytes at " << container_position_ <<
+                      " from compressed minidump";
+      return false;
+    }
+    container_position_ += count;
+    return true;
+  }
   stream_->read(static_cast<char*>(bytes), count);
   size_t bytes_read = stream_->gcount();
   if (bytes_read != count) {
@@ -4052,6 +4200,14 @@ bool Minidump::SeekSet(off_t offset) {
   if (!stream_) {
     return false;
   }
+  if (container_) {
+    if (offset < 0) {
+      BPLOG(ERROR) << "SeekSet: negative offset " << offset;
+      return false;
+    }
+    container_position_ = offset;
+    return true;
+  }
   stream_->seekg(offset, std::ios_base::beg);
   if (!stream_->good()) {
     string error_string;
@@ -4067,6 +4223,8 @@ off_t Minidump::Tell() {
     return (off_t)-1;
   }
 
+  if (container_)
+    return container_position_;
   return stream_->tellg();
 }
 
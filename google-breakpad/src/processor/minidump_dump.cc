@@ -33,7 +33,15 @@
 // Author: Mark Mentovai
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "client/linux/minidump_writer/minidump_extension_linux.h"
 #include "google_breakpad/processor/minidump.h"
@@ -52,6 +60,184 @@ using google_breakpad::MinidumpAssertion;
 using google_breakpad::MinidumpSystemInfo;
 using google_breakpad::MinidumpMiscInfo;
 using google_breakpad::MinidumpBreakpadInfo;
+using std::pair;
+using std::set;
+using std::string;
+using std::vector;
+
+// The parts of a minidump that can be chosen with -t, in the order
+// they are printed.
+static const char *const kSelectors[] = {
+  "header",
+  "threads",
+  "modules",
+  "memory",
+  "exception",
+  "assertion",
+  "system_info",
+  "misc_info",
+  "breakpad_info",
+  "memory_info",
+  "cmd_line",
+  "environ",
+  "lsb_release",
+  "proc_status",
+  "cpu_info",
+  "maps"
+};
+
+// Names for the stream types that -s knows about.
+static const struct {
+  u_int32_t type;
+  const char *name;
+} kStreamNames[] = {
+  { MD_UNUSED_STREAM,                "MD_UNUSED_STREAM" },
+  { MD_THREAD_LIST_STREAM,           "MD_THREAD_LIST_STREAM" },
+  { MD_MODULE_LIST_STREAM,           "MD_MODULE_LIST_STREAM" },
+  { MD_MEMORY_LIST_STREAM,           "MD_MEMORY_LIST_STREAM" },
+  { MD_EXCEPTION_STREAM,             "MD_EXCEPTION_STREAM" },
+  { MD_SYSTEM_INFO_STREAM,           "MD_SYSTEM_INFO_STREAM" },
+  { MD_THREAD_EX_LIST_STREAM,        "MD_THREAD_EX_LIST_STREAM" },
+  { MD_MEMORY_64_LIST_STREAM,        "MD_MEMORY_64_LIST_STREAM" },
+  { MD_HANDLE_DATA_STREAM,           "MD_HANDLE_DATA_STREAM" },
+  { MD_FUNCTION_TABLE_STREAM,        "MD_FUNCTION_TABLE_STREAM" },
+  { MD_UNLOADED_MODULE_LIST_STREAM,  "MD_UNLOADED_MODULE_LIST_STREAM" },
+  { MD_MISC_INFO_STREAM,             "MD_MISC_INFO_STREAM" },
+  { MD_MEMORY_INFO_LIST_STREAM,      "MD_MEMORY_INFO_LIST_STREAM" },
+  { MD_THREAD_INFO_LIST_STREAM,      "MD_THREAD_INFO_LIST_STREAM" },
+  { MD_HANDLE_OPERATION_LIST_STREAM, "MD_HANDLE_OPERATION_LIST_STREAM" },
+  { MD_BREAKPAD_INFO_STREAM,         "MD_BREAKPAD_INFO_STREAM" },
+  { MD_ASSERTION_INFO_STREAM,        "MD_ASSERTION_INFO_STREAM" },
+  { MD_LINUX_CPU_INFO,               "MD_LINUX_CPU_INFO" },
+  { MD_LINUX_PROC_STATUS,            "MD_LINUX_PROC_STATUS" },
+  { MD_LINUX_LSB_RELEASE,            "MD_LINUX_LSB_RELEASE" },
+  { MD_LINUX_CMD_LINE,               "MD_LINUX_CMD_LINE" },
+  { MD_LINUX_ENVIRON,                "MD_LINUX_ENVIRON" },
+  { MD_LINUX_AUXV,                   "MD_LINUX_AUXV" },
+  { MD_LINUX_MAPS,                   "MD_LINUX_MAPS" },
+  { MD_LINUX_DSO_DEBUG,              "MD_LINUX_DSO_DEBUG" }
+};
+
+struct Options {
+  Options() : summary(false) { }
+
+  // True if only the header and stream directory should be printed.
+  bool summary;
+
+  // The parts chosen with -t. Empty if every part should be printed.
+  set<string> selected;
+
+  // The (address, size) ranges chosen with -a. If any are given, only
+  // the memory regions overlapping them are printed, and only the bytes
+  // within them.
+  vector<pair<u_int64_t, u_int64_t> > ranges;
+
+  bool Selected(const char *selector) const {
+    return selected.empty() || selected.count(selector) != 0;
+  }
+};
+
+static const char *StreamName(u_int32_t stream_type) {
+  for (size_t i = 0; i < sizeof(kStreamNames) / sizeof(kStreamNames[0]);
+       ++i) {
+    if (kStreamNames[i].type == stream_type)
+      return kStreamNames[i].name;
+  }
+  return "unknown";
+}
+
+// Reads the element count at OFFSET bytes into the stream described by
+// DIRECTORY_ENTRY, without reading the elements themselves. The count
+// is a 32-bit value if COUNT_SIZE is 4, or a 64-bit value if it is 8.
+static bool ReadStreamCount(Minidump *minidump,
+                            const MDRawDirectory *directory_entry,
+                            u_int32_t offset,
+                            size_t count_size,
+                            u_int64_t *count) {
+  if (directory_entry->location.data_size < offset + count_size ||
+      !minidump->SeekSet(directory_entry->location.rva + offset)) {
+    return false;
+  }
+
+  u_int8_t bytes[sizeof(u_int64_t)];
+  if (!minidump->ReadBytes(bytes, count_size))
+    return false;
+  if (minidump->swap()) {
+    for (size_t i = 0; i < count_size / 2; ++i)
+      std::swap(bytes[i], bytes[count_size - 1 - i]);
+  }
+
+  if (count_size == sizeof(u_int32_t)) {
+    u_int32_t count32;
+    memcpy(&count32, bytes, sizeof(count32));
+    *count = count32;
+  } else {
+    memcpy(count, bytes, sizeof(*count));
+  }
+  return true;
+}
+
+// Prints the header and stream directory, and the element count of each
+// list stream. Only the directory and a few bytes of each list are read,
+// so this takes the same time however large the minidump is.
+static bool PrintMinidumpSummary(Minidump *minidump) {
+  const MDRawHeader *header = minidump->header();
+  printf("Minidump summary\n");
+  printf("  compressed      = %s\n",
+         minidump->compressed() ? "true" : "false");
+  printf("  stream_count    = %d\n", header->stream_count);
+  printf("  time_date_stamp = 0x%x\n", header->time_date_stamp);
+  printf("\n");
+
+  int errors = 0;
+  for (unsigned int stream_index = 0;
+       stream_index < header->stream_count;
+       ++stream_index) {
+    const MDRawDirectory *directory_entry =
+        minidump->GetDirectoryEntryAtIndex(stream_index);
+    if (!directory_entry) {
+      ++errors;
+      continue;
+    }
+
+    printf("stream[%d]\n", stream_index);
+    printf("  stream_type  = 0x%x (%s)\n", directory_entry->stream_type,
+           StreamName(directory_entry->stream_type));
+    printf("  location.rva = 0x%x\n", directory_entry->location.rva);
+    printf("  data_size    = 0x%x\n", directory_entry->location.data_size);
+
+    u_int32_t count_offset = 0;
+    size_t count_size = 0;
+    switch (directory_entry->stream_type) {
+      case MD_THREAD_LIST_STREAM:
+      case MD_MODULE_LIST_STREAM:
+      case MD_MEMORY_LIST_STREAM:
+        count_size = sizeof(u_int32_t);
+        break;
+      case MD_MEMORY_64_LIST_STREAM:
+        count_size = sizeof(u_int64_t);
+        break;
+      case MD_MEMORY_INFO_LIST_STREAM:
+        // The count follows the header and entry sizes.
+        count_offset = 2 * sizeof(u_int32_t);
+        count_size = sizeof(u_int64_t);
+        break;
+    }
+    if (count_size) {
+      u_int64_t count;
+      if (ReadStreamCount(minidump, directory_entry, count_offset,
+                          count_size, &count)) {
+        printf("  count        = %" PRIu64 "\n", count);
+      } else {
+        ++errors;
+        BPLOG(ERROR) << "could not read count of stream " << stream_index;
+      }
+    }
+    printf("\n");
+  }
+
+  return errors == 0;
+}
 
 static void DumpRawStream(Minidump *minidump,
                           u_int32_t stream_type,
@@ -92,123 +278,237 @@ static void DumpRawStream(Minidump *minidump,
   printf("\n\n");
 }
 
-static bool PrintMinidumpDump(const char *minidump_file) {
+static bool PrintMinidumpDump(const char *minidump_file,
+                              const Options &options) {
   Minidump minidump(minidump_file);
   if (!minidump.Read()) {
     BPLOG(ERROR) << "minidump.Read() failed";
     return false;
   }
-  minidump.Print();
+
+  if (options.summary)
+    return PrintMinidumpSummary(&minidump);
+
+  // Each stream is read only if it is to be printed, so choosing a few
+  // small streams of a large minidump doesn't read the rest of it.
+  if (options.Selected("header"))
+    minidump.Print();
 
   int errors = 0;
 
-  MinidumpThreadList *thread_list = minidump.GetThreadList();
-  if (!thread_list) {
-    ++errors;
-    BPLOG(ERROR) << "minidump.GetThreadList() failed";
-  } else {
-    thread_list->Print();
+  if (options.Selected("threads")) {
+    MinidumpThreadList *thread_list = minidump.GetThreadList();
+    if (!thread_list) {
+      ++errors;
+      BPLOG(ERROR) << "minidump.GetThreadList() failed";
+    } else {
+      thread_list->Print();
+    }
   }
 
-  MinidumpModuleList *module_list = minidump.GetModuleList();
-  if (!module_list) {
-    ++errors;
-    BPLOG(ERROR) << "minidump.GetModuleList() failed";
-  } else {
-    module_list->Print();
+  if (options.Selected("modules")) {
+    MinidumpModuleList *module_list = minidump.GetModuleList();
+    if (!module_list) {
+      ++errors;
+      BPLOG(ERROR) << "minidump.GetModuleList() failed";
+    } else {
+      module_list->Print();
+    }
   }
 
-  MinidumpMemoryList *memory_list = minidump.GetMemoryList();
-  if (!memory_list) {
-    ++errors;
-    BPLOG(ERROR) << "minidump.GetMemoryList() failed";
-  } else {
-    memory_list->Print();
+  if (options.Selected("memory")) {
+    MinidumpMemoryList *memory_list = minidump.GetMemoryList();
+    if (!memory_list) {
+      ++errors;
+      BPLOG(ERROR) << "minidump.GetMemoryList() failed";
+    } else if (options.ranges.empty()) {
+      memory_list->Print();
+    } else {
+      for (size_t i = 0; i < options.ranges.size(); ++i) {
+        memory_list->PrintRange(options.ranges[i].first,
+                                options.ranges[i].second);
+      }
+    }
   }
 
-  MinidumpException *exception = minidump.GetException();
-  if (!exception) {
-    BPLOG(INFO) << "minidump.GetException() failed";
-  } else {
-    exception->Print();
+  if (options.Selected("exception")) {
+    MinidumpException *exception = minidump.GetException();
+    if (!exception) {
+      BPLOG(INFO) << "minidump.GetException() failed";
+    } else {
+      exception->Print();
+    }
   }
 
-  MinidumpAssertion *assertion = minidump.GetAssertion();
-  if (!assertion) {
-    BPLOG(INFO) << "minidump.GetAssertion() failed";
-  } else {
-    assertion->Print();
+  if (options.Selected("assertion")) {
+    MinidumpAssertion *assertion = minidump.GetAssertion();
+    if (!assertion) {
+      BPLOG(INFO) << "minidump.GetAssertion() failed";
+    } else {
+      assertion->Print();
+    }
   }
 
-  MinidumpSystemInfo *system_info = minidump.GetSystemInfo();
-  if (!system_info) {
-    ++errors;
-    BPLOG(ERROR) << "minidump.GetSystemInfo() failed";
-  } else {
-    system_info->Print();
+  if (options.Selected("system_info")) {
+    MinidumpSystemInfo *system_info = minidump.GetSystemInfo();
+    if (!system_info) {
+      ++errors;
+      BPLOG(ERROR) << "minidump.GetSystemInfo() failed";
+    } else {
+      system_info->Print();
+    }
   }
 
-  MinidumpMiscInfo *misc_info = minidump.GetMiscInfo();
-  if (!misc_info) {
-    ++errors;
-    BPLOG(ERROR) << "minidump.GetMiscInfo() failed";
-  } else {
-    misc_info->Print();
+  if (options.Selected("misc_info")) {
+    MinidumpMiscInfo *misc_info = minidump.GetMiscInfo();
+    if (!misc_info) {
+      ++errors;
+      BPLOG(ERROR) << "minidump.GetMiscInfo() failed";
+    } else {
+      misc_info->Print();
+    }
   }
 
-  MinidumpBreakpadInfo *breakpad_info = minidump.GetBreakpadInfo();
-  if (!breakpad_info) {
-    // Breakpad info is optional, so don't treat this as an error.
-    BPLOG(INFO) << "minidump.GetBreakpadInfo() failed";
-  } else {
-    breakpad_info->Print();
+  if (options.Selected("breakpad_info")) {
+    MinidumpBreakpadInfo *breakpad_info = minidump.GetBreakpadInfo();
+    if (!breakpad_info) {
+      // Breakpad info is optional, so don't treat this as an error.
+      BPLOG(INFO) << "minidump.GetBreakpadInfo() failed";
+    } else {
+      breakpad_info->Print();
+    }
   }
 
-  MinidumpMemoryInfoList *memory_info_list = minidump.GetMemoryInfoList();
-  if (!memory_info_list) {
-    ++errors;
-    BPLOG(ERROR) << "minidump.GetMemoryInfoList() failed";
-  } else {
-    memory_info_list->Print();
-  }
-
-  DumpRawStream(&minidump,
-                MD_LINUX_CMD_LINE,
-                "MD_LINUX_CMD_LINE",
-                &errors);
-  DumpRawStream(&minidump,
-                MD_LINUX_ENVIRON,
-                "MD_LINUX_ENVIRON",
-                &errors);
-  DumpRawStream(&minidump,
-                MD_LINUX_LSB_RELEASE,
-                "MD_LINUX_LSB_RELEASE",
-                &errors);
-  DumpRawStream(&minidump,
-                MD_LINUX_PROC_STATUS,
-                "MD_LINUX_PROC_STATUS",
-                &errors);
-  DumpRawStream(&minidump,
-                MD_LINUX_CPU_INFO,
-                "MD_LINUX_CPU_INFO",
-                &errors);
-  DumpRawStream(&minidump,
-                MD_LINUX_MAPS,
-                "MD_LINUX_MAPS",
-                &errors);
+  if (options.Selected("memory_info")) {
+    MinidumpMemoryInfoList *memory_info_list = minidump.GetMemoryInfoList();
+    if (!memory_info_list) {
+      ++errors;
+      BPLOG(ERROR) << "minidump.GetMemoryInfoList() failed";
+    } else {
+      memory_info_list->Print();
+    }
+  }
+
+  if (options.Selected("cmd_line")) {
+    DumpRawStream(&minidump,
+                  MD_LINUX_CMD_LINE,
+                  "MD_LINUX_CMD_LINE",
+                  &errors);
+  }
+  if (options.Selected("environ")) {
+    DumpRawStream(&minidump,
+                  MD_LINUX_ENVIRON,
+                  "MD_LINUX_ENVIRON",
+                  &errors);
+  }
+  if (options.Selected("lsb_release")) {
+    DumpRawStream(&minidump,
+                  MD_LINUX_LSB_RELEASE,
+                  "MD_LINUX_LSB_RELEASE",
+                  &errors);
+  }
+  if (options.Selected("proc_status")) {
+    DumpRawStream(&minidump,
+                  MD_LINUX_PROC_STATUS,
+                  "MD_LINUX_PROC_STATUS",
+                  &errors);
+  }
+  if (options.Selected("cpu_info")) {
+    DumpRawStream(&minidump,
+                  MD_LINUX_CPU_INFO,
+                  "MD_LINUX_CPU_INFO",
+                  &errors);
+  }
+  if (options.Selected("maps")) {
+    DumpRawStream(&minidump,
+                  MD_LINUX_MAPS,
+                  "MD_LINUX_MAPS",
+                  &errors);
+  }
 
   return errors == 0;
 }
 
+// Parses an -a argument of the form ADDRESS[:SIZE], with both numbers in
+// any base strtoull accepts. A missing SIZE means one byte.
+static bool ParseRange(const char *argument,
+                       pair<u_int64_t, u_int64_t> *range) {
+  char *end;
+  range->first = strtoull(argument, &end, 0);
+  range->second = 1;
+  if (end == argument)
+    return false;
+  if (*end == ':') {
+    const char *size = end + 1;
+    range->second = strtoull(size, &end, 0);
+    if (end == size || range->second == 0)
+      return false;
+  }
+  return *end == '\0';
+}
+
+static bool IsSelector(const char *name) {
+  for (size_t i = 0; i < sizeof(kSelectors) / sizeof(kSelectors[0]); ++i) {
+    if (strcmp(kSelectors[i], name) == 0)
+      return true;
+  }
+  return false;
+}
+
+static void Usage(const char *program) {
+  fprintf(stderr,
+          "usage: %s [-s] [-t part]... [-a address[:size]]... <file>\n"
+          "  -s  print only the stream directory and list counts\n"
+          "  -t  print only the given part; may be repeated\n"
+          "  -a  print only the memory overlapping the given range;"
+          " may be repeated\n"
+          "parts:",
+          program);
+  for (size_t i = 0; i < sizeof(kSelectors) / sizeof(kSelectors[0]); ++i)
+    fprintf(stderr, " %s", kSelectors[i]);
+  fprintf(stderr, "\n");
+}
+
 }  // namespace
 
 int main(int argc, char **argv) {
   BPLOG_INIT(&argc, &argv);
 
-  if (argc != 2) {
-    fprintf(stderr, "usage: %s <file>\n", argv[0]);
+  Options options;
+  int ch;
+  while ((ch = getopt(argc, argv, "st:a:")) != -1) {
+    switch (ch) {
+      case 's':
+        options.summary = true;
+        break;
+      case 't':
+        if (!IsSelector(optarg)) {
+          fprintf(stderr, "%s: unknown part: %s\n", argv[0], optarg);
+          Usage(argv[0]);
+          return 1;
+        }
+        options.selected.insert(optarg);
+        break;
+      case 'a': {
+        pair<u_int64_t, u_int64_t> range;
+        if (!ParseRange(optarg, &range)) {
+          fprintf(stderr, "%s: bad address range: %s\n", argv[0], optarg);
+          Usage(argv[0]);
+          return 1;
+        }
+        options.ranges.push_back(range);
+        break;
+      }
+      default:
+        Usage(argv[0]);
+        return 1;
+    }
+  }
+
+  if (optind != argc - 1) {
+    Usage(argv[0]);
     return 1;
   }
 
-  return PrintMinidumpDump(argv[1]) ? 0 : 1;
+  return PrintMinidumpDump(argv[optind], options) ? 0 : 1;
 }
@@ -37,6 +37,8 @@
 #include "google_breakpad/processor/process_state.h"
 #include "google_breakpad/processor/exploitability.h"
 #include "processor/logging.h"
+#include "processor/processing_budget.h"
+#include "processor/processor_stats.h"
 #include "processor/scoped_ptr.h"
 #include "processor/stackwalker_x86.h"
 
@@ -45,14 +47,18 @@ namespace google_breakpad {
 MinidumpProcessor::MinidumpProcessor(SymbolSupplier *supplier,
                                      SourceLineResolverInterface *resolver)
     : supplier_(supplier), resolver_(resolver),
-      enable_exploitability_(false) {
+      enable_exploitability_(false),
+      thread_policy_(PROCESS_ALL_THREADS), other_thread_frames_(0),
+      time_limit_ms_(0), max_scan_words_(0), max_symbol_bytes_(0) {
 }
 
 MinidumpProcessor::MinidumpProcessor(SymbolSupplier *supplier,
                                      SourceLineResolverInterface *resolver,
                                      bool enable_exploitability)
     : supplier_(supplier), resolver_(resolver),
-      enable_exploitability_(enable_exploitability) {
+      enable_exploitability_(enable_exploitability),
+      thread_policy_(PROCESS_ALL_THREADS), other_thread_frames_(0),
+      time_limit_ms_(0), max_scan_words_(0), max_symbol_bytes_(0) {
 }
 
 MinidumpProcessor::~MinidumpProcessor() {
@@ -64,6 +70,7 @@ ProcessResult MinidumpProcessor::Process(
   assert(process_state);
 
   process_state->Clear();
+  ProcessorStats::Count(ProcessorStats::MINIDUMPS_PROCESSED);
 
   const MDRawHeader *header = dump->header();
   if (!header) {
@@ -123,6 +130,14 @@ ProcessResult MinidumpProcessor::Process(
       (has_dump_thread        ? "" : "no ") << "dump thread, and " <<
       (has_requesting_thread  ? "" : "no ") << "requesting thread";
 
+  // Charge every thread's stack walk to one budget, so that the limits
+  // apply to the minidump as a whole.
+  scoped_ptr<ProcessingBudget> budget;
+  if (time_limit_ms_ || max_scan_words_ || max_symbol_bytes_) {
+    budget.reset(new ProcessingBudget(u_int64_t(time_limit_ms_) * 1000,
+                                      max_scan_words_, max_symbol_bytes_));
+  }
+
   bool interrupted = false;
   bool found_requesting_thread = false;
   unsigned int thread_count = threads->thread_count();
@@ -159,7 +174,9 @@ ProcessResult MinidumpProcessor::Process(
 
     MinidumpContext *context = thread->GetContext();
 
-    if (has_requesting_thread && thread_id == requesting_thread_id) {
+    bool is_requesting_thread =
+        has_requesting_thread && thread_id == requesting_thread_id;
+    if (is_requesting_thread) {
       if (found_requesting_thread) {
         // There can't be more than one requesting thread.
         BPLOG(ERROR) << "Duplicate requesting thread: " << thread_string;
@@ -195,6 +212,32 @@ ProcessResult MinidumpProcessor::Process(
       return PROCESS_ERROR_NO_MEMORY_FOR_THREAD;
     }
 
+    scoped_ptr<CallStack> stack(new CallStack());
+
+    // Once the processing budget is spent, the remaining threads are not
+    // walked, but get empty CallStacks like those skipped by the thread
+    // policy.
+    if (budget.get() && budget->Exhausted()) {
+      process_state->threads_.push_back(stack.release());
+      process_state->thread_memory_regions_.push_back(thread_memory);
+      continue;
+    }
+
+    // Under a restrictive thread policy, threads other than the requesting
+    // thread are walked only partially, or not at all.  Their CallStacks
+    // are still recorded so that thread indices are unaffected.
+    bool limit_frames = false;
+    if (!is_requesting_thread) {
+      if (thread_policy_ == PROCESS_REQUESTING_THREAD ||
+          (thread_policy_ == PROCESS_REQUESTING_THREAD_AND_TOP_FRAMES &&
+           other_thread_frames_ == 0)) {
+        process_state->threads_.push_back(stack.release());
+        process_state->thread_memory_regions_.push_back(thread_memory);
+        continue;
+      }
+      limit_frames = thread_policy_ == PROCESS_REQUESTING_THREAD_AND_TOP_FRAMES;
+    }
+
     // Use process_state->modules_ instead of module_list, because the
     // |modules| argument will be used to populate the |module| fields in
     // the returned StackFrame objects, which will be placed into the
@@ -215,8 +258,16 @@ ProcessResult MinidumpProcessor::Process(
       return PROCESS_ERROR_NO_STACKWALKER_FOR_THREAD;
     }
 
-    scoped_ptr<CallStack> stack(new CallStack());
-    if (!stackwalker->Walk(stack.get())) {
+    if (limit_frames)
+      stackwalker->set_frame_limit(other_thread_frames_);
+    stackwalker->set_budget(budget.get());
+    ProcessorStats::Count(ProcessorStats::THREADS_WALKED);
+    bool walked;
+    {
+      ScopedStatsTimer timer(ProcessorStats::STACKWALK);
+      walked = stackwalker->Walk(stack.get());
+    }
+    if (!walked) {
       BPLOG(INFO) << "Stackwalker interrupt (missing symbols?) at " <<
           thread_string;
       interrupted = true;
@@ -230,6 +281,11 @@ ProcessResult MinidumpProcessor::Process(
     return PROCESS_SYMBOL_SUPPLIER_INTERRUPTED;
   }
 
+  if (budget.get() && budget->exhausted()) {
+    BPLOG(INFO) << "Processing budget exhausted for " << dump->path();
+    process_state->truncated_ = true;
+  }
+
   // If a requesting thread was indicated, it must be present.
   if (has_requesting_thread && !found_requesting_thread) {
     // Don't mark as an error, but invalidate the requesting thread
@@ -264,7 +320,12 @@ ProcessResult MinidumpProcessor::Process(
   BPLOG(INFO) << "Processing minidump in file " << minidump_file;
 
   Minidump dump(minidump_file);
-  if (!dump.Read()) {
+  bool read;
+  {
+    ScopedStatsTimer timer(ProcessorStats::MINIDUMP_READ);
+    read = dump.Read();
+  }
+  if (!read) {
      BPLOG(ERROR) << "Minidump " << dump.path() << " could not be read";
      return PROCESS_ERROR_MINIDUMP_NOT_FOUND;
   }
@@ -117,7 +117,8 @@ class TestSymbolSupplier : public SymbolSupplier {
   virtual SymbolResult GetCStringSymbolData(const CodeModule *module,
                                             const SystemInfo *system_info,
                                             string *symbol_file,
-                                            char **symbol_data);
+                                            char **symbol_data,
+                                            size_t *symbol_data_size);
 
   virtual void FreeSymbolData(const CodeModule *module);
 
@@ -177,7 +178,8 @@ SymbolSupplier::SymbolResult TestSymbolSupplier::GetCStringSymbolData(
     const CodeModule *module,
     const SystemInfo *system_info,
     string *symbol_file,
-    char **symbol_data) {
+    char **symbol_data,
+    size_t *symbol_data_size) {
   string symbol_data_string;
   SymbolSupplier::SymbolResult s = GetSymbolFile(module,
                                                  system_info,
@@ -191,7 +193,8 @@ SymbolSupplier::SymbolResult TestSymbolSupplier::GetCStringSymbolData(
                    << module->code_file() << " size: " << size;
       return INTERRUPT;
     }
-    strcpy(*symbol_data, symbol_data_string.c_str());
+    memcpy(*symbol_data, symbol_data_string.c_str(), size);
+    *symbol_data_size = size - 1;
     memory_buffers_.insert(make_pair(module->code_file(), *symbol_data));
   }
 
@@ -218,10 +221,11 @@ class MockSymbolSupplier : public SymbolSupplier {
                                            const SystemInfo*,
                                            string*,
                                            string*));
-  MOCK_METHOD4(GetCStringSymbolData, SymbolResult(const CodeModule*,
+  MOCK_METHOD5(GetCStringSymbolData, SymbolResult(const CodeModule*,
                                                   const SystemInfo*,
                                                   string*,
-                                                  char**));
+                                                  char**,
+                                                  size_t*));
   MOCK_METHOD1(FreeSymbolData, void(const CodeModule*));
 };
 
@@ -267,11 +271,11 @@ TEST_F(MinidumpProcessorTest, TestSymbolSupplierLookupCounts) {
   EXPECT_CALL(supplier, GetCStringSymbolData(
       Property(&google_breakpad::CodeModule::code_file,
                "c:\\test_app.exe"),
-      _, _, _)).WillOnce(Return(SymbolSupplier::NOT_FOUND));
+      _, _, _, _)).WillOnce(Return(SymbolSupplier::NOT_FOUND));
   EXPECT_CALL(supplier, GetCStringSymbolData(
       Property(&google_breakpad::CodeModule::code_file,
                Ne("c:\\test_app.exe")),
-      _, _, _)).WillRepeatedly(Return(SymbolSupplier::NOT_FOUND));
+      _, _, _, _)).WillRepeatedly(Return(SymbolSupplier::NOT_FOUND));
   ASSERT_EQ(processor.Process(minidump_file, &state),
             google_breakpad::PROCESS_OK);
 
@@ -282,11 +286,11 @@ TEST_F(MinidumpProcessorTest, TestSymbolSupplierLookupCounts) {
   EXPECT_CALL(supplier, GetCStringSymbolData(
       Property(&google_breakpad::CodeModule::code_file,
                "c:\\test_app.exe"),
-      _, _, _)).WillOnce(Return(SymbolSupplier::NOT_FOUND));
+      _, _, _, _)).WillOnce(Return(SymbolSupplier::NOT_FOUND));
   EXPECT_CALL(supplier, GetCStringSymbolData(
       Property(&google_breakpad::CodeModule::code_file,
                Ne("c:\\test_app.exe")),
-      _, _, _)).WillRepeatedly(Return(SymbolSupplier::NOT_FOUND));
+      _, _, _, _)).WillRepeatedly(Return(SymbolSupplier::NOT_FOUND));
   ASSERT_EQ(processor.Process(minidump_file, &state),
             google_breakpad::PROCESS_OK);
 }
@@ -372,6 +376,65 @@ TEST_F(MinidumpProcessorTest, TestBasicProcessing) {
   ASSERT_EQ(processor.Process(minidump_file, &state),
             google_breakpad::PROCESS_SYMBOL_SUPPLIER_INTERRUPTED);
 }
+
+// Restrictive thread policies must still walk the requesting thread
+// completely.
+TEST_F(MinidumpProcessorTest, TestThreadPolicy) {
+  TestSymbolSupplier supplier;
+  BasicSourceLineResolver resolver;
+  MinidumpProcessor processor(&supplier, &resolver);
+
+  string minidump_file = string(getenv("srcdir") ? getenv("srcdir") : ".") +
+                         "/src/processor/testdata/minidump2.dmp";
+
+  processor.SetThreadPolicy(MinidumpProcessor::PROCESS_REQUESTING_THREAD, 0);
+  ProcessState state;
+  ASSERT_EQ(processor.Process(minidump_file, &state),
+            google_breakpad::PROCESS_OK);
+  ASSERT_EQ(state.threads()->size(), size_t(1));
+  ASSERT_EQ(state.requesting_thread(), 0);
+  ASSERT_EQ(state.threads()->at(0)->frames()->size(), 4U);
+  ASSERT_EQ(state.threads()->at(0)->frames()->at(1)->function_name, "main");
+
+  state.Clear();
+  processor.SetThreadPolicy(
+      MinidumpProcessor::PROCESS_REQUESTING_THREAD_AND_TOP_FRAMES, 1);
+  ASSERT_EQ(processor.Process(minidump_file, &state),
+            google_breakpad::PROCESS_OK);
+  ASSERT_EQ(state.threads()->size(), size_t(1));
+  ASSERT_EQ(state.threads()->at(0)->frames()->size(), 4U);
+}
+
+TEST_F(MinidumpProcessorTest, TestBudget) {
+  TestSymbolSupplier supplier;
+  BasicSourceLineResolver resolver;
+  MinidumpProcessor processor(&supplier, &resolver);
+
+  string minidump_file = string(getenv("srcdir") ? getenv("srcdir") : ".") +
+                         "/src/processor/testdata/minidump2.dmp";
+
+  // A generous budget changes nothing.
+  processor.SetBudget(60 * 1000, 1000000, 1000000);
+  ProcessState state;
+  ASSERT_EQ(processor.Process(minidump_file, &state),
+            google_breakpad::PROCESS_OK);
+  ASSERT_FALSE(state.truncated());
+  ASSERT_EQ(state.threads()->size(), size_t(1));
+  ASSERT_EQ(state.threads()->at(0)->frames()->size(), 4U);
+
+  // The first module's symbols exceed this budget, so they aren't loaded,
+  // and the walk stops after the context frame, which has no symbols.
+  BasicSourceLineResolver resolver2;
+  MinidumpProcessor processor2(&supplier, &resolver2);
+  processor2.SetBudget(0, 0, 1);
+  state.Clear();
+  ASSERT_EQ(processor2.Process(minidump_file, &state),
+            google_breakpad::PROCESS_OK);
+  ASSERT_TRUE(state.truncated());
+  ASSERT_EQ(state.threads()->size(), size_t(1));
+  ASSERT_EQ(state.threads()->at(0)->frames()->size(), 1U);
+  ASSERT_EQ(state.threads()->at(0)->frames()->at(0)->function_name, "");
+}
 }  // namespace
 
 int main(int argc, char *argv[]) {
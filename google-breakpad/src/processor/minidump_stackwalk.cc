@@ -48,7 +48,9 @@
 #include "google_breakpad/processor/process_state.h"
 #include "google_breakpad/processor/stack_frame_cpu.h"
 #include "processor/logging.h"
-#include "processor/pathname_stripper.h"
+#include "processor/output_buffer.h"
+#include "processor/process_state_record.h"
+#include "processor/processor_stats.h"
 #include "processor/scoped_ptr.h"
 #include "processor/simple_symbol_supplier.h"
 
@@ -62,8 +64,12 @@ using google_breakpad::CodeModule;
 using google_breakpad::CodeModules;
 using google_breakpad::MinidumpModule;
 using google_breakpad::MinidumpProcessor;
-using google_breakpad::PathnameStripper;
+using google_breakpad::FileOutputSink;
+using google_breakpad::OutputBuffer;
 using google_breakpad::ProcessState;
+using google_breakpad::ProcessStateRecordWriter;
+using google_breakpad::ProcessorStats;
+using google_breakpad::ScopedStatsTimer;
 using google_breakpad::scoped_ptr;
 using google_breakpad::SimpleSymbolSupplier;
 using google_breakpad::StackFrame;
@@ -73,10 +79,17 @@ using google_breakpad::StackFrameX86;
 using google_breakpad::StackFrameAMD64;
 using google_breakpad::StackFrameARM;
 
+// The formats PrintMinidumpProcess can print a ProcessState in.
+enum OutputFormat {
+  OUTPUT_TEXT,              // human-readable text
+  OUTPUT_MACHINE_READABLE,  // '|'-separated text
+  OUTPUT_BINARY             // a ProcessStateRecord
+};
+
 // Separator character for machine readable output.
 static const char kOutputSeparator = '|';
 
-// PrintRegister prints a register's name and value to stdout.  It will
+// PrintRegister appends a register's name and value to |out|.  It will
 // print four registers on a line.  For the first register in a set,
 // pass 0 for |start_col|.  For registers in a set, pass the most recent
 // return value of PrintRegister.
@@ -84,49 +97,36 @@ static const char kOutputSeparator = '|';
 // of registers is completely printed, regardless of the number of calls
 // to PrintRegister.
 static const int kMaxWidth = 80;  // optimize for an 80-column terminal
-static int PrintRegister(const char *name, u_int32_t value, int start_col) {
-  char buffer[64];
-  snprintf(buffer, sizeof(buffer), " %5s = 0x%08x", name, value);
+static int PrintRegisterDigits(const char *name, u_int64_t value, int digits,
+                               int start_col, OutputBuffer *out) {
+  // The width of " %5s = 0x%0*llx".
+  int name_width = strlen(name);
+  int length = 1 + (name_width > 5 ? name_width : 5) + 5 + digits;
 
-  if (start_col + strlen(buffer) > kMaxWidth) {
+  if (start_col + length > kMaxWidth) {
     start_col = 0;
-    printf("\n ");
+    out->Append("\n ");
   }
-  fputs(buffer, stdout);
+  out->Append(' ');
+  out->AppendPadded(name, 5);
+  out->Append(" = 0x");
+  out->AppendHex(value, digits);
 
-  return start_col + strlen(buffer);
+  return start_col + length;
 }
 
-// PrintRegister64 does the same thing, but for 64-bit registers.
-static int PrintRegister64(const char *name, u_int64_t value, int start_col) {
-  char buffer[64];
-  snprintf(buffer, sizeof(buffer), " %5s = 0x%016" PRIx64 , name, value);
-
-  if (start_col + strlen(buffer) > kMaxWidth) {
-    start_col = 0;
-    printf("\n ");
-  }
-  fputs(buffer, stdout);
-
-  return start_col + strlen(buffer);
+static int PrintRegister(const char *name, u_int32_t value, int start_col,
+                         OutputBuffer *out) {
+  return PrintRegisterDigits(name, value, 8, start_col, out);
 }
 
-// StripSeparator takes a string |original| and returns a copy
-// of the string with all occurences of |kOutputSeparator| removed.
-static string StripSeparator(const string &original) {
-  string result = original;
-  string::size_type position = 0;
-  while ((position = result.find(kOutputSeparator, position)) != string::npos) {
-    result.erase(position, 1);
-  }
-  position = 0;
-  while ((position = result.find('\n', position)) != string::npos) {
-    result.erase(position, 1);
-  }
-  return result;
+// PrintRegister64 does the same thing, but for 64-bit registers.
+static int PrintRegister64(const char *name, u_int64_t value, int start_col,
+                           OutputBuffer *out) {
+  return PrintRegisterDigits(name, value, 16, start_col, out);
 }
 
-// PrintStack prints the call stack in |stack| to stdout, in a reasonably
+// PrintStack appends the call stack in |stack| to |out|, in a reasonably
 // useful form.  Module, function, and source file names are displayed if
 // they are available.  The code offset to the base code address of the
 // source line, function, or module is printed, preferring them in that
@@ -135,33 +135,40 @@ static string StripSeparator(const string &original) {
 //
 // If |cpu| is a recognized CPU name, relevant register state for each stack
 // frame printed is also output, if available.
-static void PrintStack(const CallStack *stack, const string &cpu) {
+static void PrintStack(const CallStack *stack, const string &cpu,
+                       OutputBuffer *out) {
   int frame_count = stack->frames()->size();
   for (int frame_index = 0; frame_index < frame_count; ++frame_index) {
     const StackFrame *frame = stack->frames()->at(frame_index);
-    printf("%2d  ", frame_index);
+    out->AppendDecimal(frame_index, 2);
+    out->Append("  ");
 
     if (frame->module) {
-      printf("%s", PathnameStripper::File(frame->module->code_file()).c_str());
+      out->AppendFileName(frame->module->code_file());
       if (!frame->function_name.empty()) {
-        printf("!%s", frame->function_name.c_str());
+        out->Append('!');
+        out->Append(frame->function_name);
         if (!frame->source_file_name.empty()) {
-          string source_file = PathnameStripper::File(frame->source_file_name);
-          printf(" [%s : %d + 0x%" PRIx64 "]",
-                 source_file.c_str(),
-                 frame->source_line,
-                 frame->instruction - frame->source_line_base);
+          out->Append(" [");
+          out->AppendFileName(frame->source_file_name);
+          out->Append(" : ");
+          out->AppendDecimal(frame->source_line);
+          out->Append(" + 0x");
+          out->AppendHex(frame->instruction - frame->source_line_base);
+          out->Append(']');
         } else {
-          printf(" + 0x%" PRIx64, frame->instruction - frame->function_base);
+          out->Append(" + 0x");
+          out->AppendHex(frame->instruction - frame->function_base);
         }
       } else {
-        printf(" + 0x%" PRIx64,
-               frame->instruction - frame->module->base_address());
+        out->Append(" + 0x");
+        out->AppendHex(frame->instruction - frame->module->base_address());
       }
     } else {
-      printf("0x%" PRIx64, frame->instruction);
+      out->Append("0x");
+      out->AppendHex(frame->instruction);
     }
-    printf("\n ");
+    out->Append("\n ");
 
     int sequence = 0;
     if (cpu == "x86") {
@@ -169,158 +176,187 @@ static void PrintStack(const CallStack *stack, const string &cpu) {
         reinterpret_cast<const StackFrameX86*>(frame);
 
       if (frame_x86->context_validity & StackFrameX86::CONTEXT_VALID_EIP)
-        sequence = PrintRegister("eip", frame_x86->context.eip, sequence);
+        sequence = PrintRegister("eip", frame_x86->context.eip, sequence, out);
       if (frame_x86->context_validity & StackFrameX86::CONTEXT_VALID_ESP)
-        sequence = PrintRegister("esp", frame_x86->context.esp, sequence);
+        sequence = PrintRegister("esp", frame_x86->context.esp, sequence, out);
       if (frame_x86->context_validity & StackFrameX86::CONTEXT_VALID_EBP)
-        sequence = PrintRegister("ebp", frame_x86->context.ebp, sequence);
+        sequence = PrintRegister("ebp", frame_x86->context.ebp, sequence, out);
       if (frame_x86->context_validity & StackFrameX86::CONTEXT_VALID_EBX)
-        sequence = PrintRegister("ebx", frame_x86->context.ebx, sequence);
+        sequence = PrintRegister("ebx", frame_x86->context.ebx, sequence, out);
       if (frame_x86->context_validity & StackFrameX86::CONTEXT_VALID_ESI)
-        sequence = PrintRegister("esi", frame_x86->context.esi, sequence);
+        sequence = PrintRegister("esi", frame_x86->context.esi, sequence, out);
       if (frame_x86->context_validity & StackFrameX86::CONTEXT_VALID_EDI)
-        sequence = PrintRegister("edi", frame_x86->context.edi, sequence);
+        sequence = PrintRegister("edi", frame_x86->context.edi, sequence, out);
       if (frame_x86->context_validity == StackFrameX86::CONTEXT_VALID_ALL) {
-        sequence = PrintRegister("eax", frame_x86->context.eax, sequence);
-        sequence = PrintRegister("ecx", frame_x86->context.ecx, sequence);
-        sequence = PrintRegister("edx", frame_x86->context.edx, sequence);
-        sequence = PrintRegister("efl", frame_x86->context.eflags, sequence);
+        sequence = PrintRegister("eax", frame_x86->context.eax, sequence, out);
+        sequence = PrintRegister("ecx", frame_x86->context.ecx, sequence, out);
+        sequence = PrintRegister("edx", frame_x86->context.edx, sequence, out);
+        sequence = PrintRegister("efl", frame_x86->context.eflags, sequence,
+                                 out);
       }
     } else if (cpu == "ppc") {
       const StackFramePPC *frame_ppc =
         reinterpret_cast<const StackFramePPC*>(frame);
 
       if (frame_ppc->context_validity & StackFramePPC::CONTEXT_VALID_SRR0)
-        sequence = PrintRegister("srr0", frame_ppc->context.srr0, sequence);
+        sequence = PrintRegister("srr0", frame_ppc->context.srr0, sequence,
+                                 out);
       if (frame_ppc->context_validity & StackFramePPC::CONTEXT_VALID_GPR1)
-        sequence = PrintRegister("r1", frame_ppc->context.gpr[1], sequence);
+        sequence = PrintRegister("r1", frame_ppc->context.gpr[1], sequence,
+                                 out);
     } else if (cpu == "amd64") {
       const StackFrameAMD64 *frame_amd64 =
         reinterpret_cast<const StackFrameAMD64*>(frame);
 
       if (frame_amd64->context_validity & StackFrameAMD64::CONTEXT_VALID_RBX)
-        sequence = PrintRegister64("rbx", frame_amd64->context.rbx, sequence);
+        sequence = PrintRegister64("rbx", frame_amd64->context.rbx, sequence,
+                                   out);
       if (frame_amd64->context_validity & StackFrameAMD64::CONTEXT_VALID_R12)
-        sequence = PrintRegister64("r12", frame_amd64->context.r12, sequence);
+        sequence = PrintRegister64("r12", frame_amd64->context.r12, sequence,
+                                   out);
       if (frame_amd64->context_validity & StackFrameAMD64::CONTEXT_VALID_R13)
-        sequence = PrintRegister64("r13", frame_amd64->context.r13, sequence);
+        sequence = PrintRegister64("r13", frame_amd64->context.r13, sequence,
+                                   out);
       if (frame_amd64->context_validity & StackFrameAMD64::CONTEXT_VALID_R14)
-        sequence = PrintRegister64("r14", frame_amd64->context.r14, sequence);
+        sequence = PrintRegister64("r14", frame_amd64->context.r14, sequence,
+                                   out);
       if (frame_amd64->context_validity & StackFrameAMD64::CONTEXT_VALID_R15)
-        sequence = PrintRegister64("r15", frame_amd64->context.r15, sequence);
+        sequence = PrintRegister64("r15", frame_amd64->context.r15, sequence,
+                                   out);
       if (frame_amd64->context_validity & StackFrameAMD64::CONTEXT_VALID_RIP)
-        sequence = PrintRegister64("rip", frame_amd64->context.rip, sequence);
+        sequence = PrintRegister64("rip", frame_amd64->context.rip, sequence,
+                                   out);
       if (frame_amd64->context_validity & StackFrameAMD64::CONTEXT_VALID_RSP)
-        sequence = PrintRegister64("rsp", frame_amd64->context.rsp, sequence);
+        sequence = PrintRegister64("rsp", frame_amd64->context.rsp, sequence,
+                                   out);
       if (frame_amd64->context_validity & StackFrameAMD64::CONTEXT_VALID_RBP)
-        sequence = PrintRegister64("rbp", frame_amd64->context.rbp, sequence);
+        sequence = PrintRegister64("rbp", frame_amd64->context.rbp, sequence,
+                                   out);
     } else if (cpu == "sparc") {
       const StackFrameSPARC *frame_sparc =
         reinterpret_cast<const StackFrameSPARC*>(frame);
 
       if (frame_sparc->context_validity & StackFrameSPARC::CONTEXT_VALID_SP)
-        sequence = PrintRegister("sp", frame_sparc->context.g_r[14], sequence);
+        sequence = PrintRegister("sp", frame_sparc->context.g_r[14], sequence,
+                                 out);
       if (frame_sparc->context_validity & StackFrameSPARC::CONTEXT_VALID_FP)
-        sequence = PrintRegister("fp", frame_sparc->context.g_r[30], sequence);
+        sequence = PrintRegister("fp", frame_sparc->context.g_r[30], sequence,
+                                 out);
       if (frame_sparc->context_validity & StackFrameSPARC::CONTEXT_VALID_PC)
-        sequence = PrintRegister("pc", frame_sparc->context.pc, sequence);
+        sequence = PrintRegister("pc", frame_sparc->context.pc, sequence, out);
     } else if (cpu == "arm") {
       const StackFrameARM *frame_arm =
         reinterpret_cast<const StackFrameARM*>(frame);
 
       // General-purpose callee-saves registers.
       if (frame_arm->context_validity & StackFrameARM::CONTEXT_VALID_R4)
-        sequence = PrintRegister("r4", frame_arm->context.iregs[4], sequence);
+        sequence = PrintRegister("r4", frame_arm->context.iregs[4], sequence,
+                                 out);
       if (frame_arm->context_validity & StackFrameARM::CONTEXT_VALID_R5)
-        sequence = PrintRegister("r5", frame_arm->context.iregs[5], sequence);
+        sequence = PrintRegister("r5", frame_arm->context.iregs[5], sequence,
+                                 out);
       if (frame_arm->context_validity & StackFrameARM::CONTEXT_VALID_R6)
-        sequence = PrintRegister("r6", frame_arm->context.iregs[6], sequence);
+        sequence = PrintRegister("r6", frame_arm->context.iregs[6], sequence,
+                                 out);
       if (frame_arm->context_validity & StackFrameARM::CONTEXT_VALID_R7)
-        sequence = PrintRegister("r7", frame_arm->context.iregs[7], sequence);
+        sequence = PrintRegister("r7", frame_arm->context.iregs[7], sequence,
+                                 out);
       if (frame_arm->context_validity & StackFrameARM::CONTEXT_VALID_R8)
-        sequence = PrintRegister("r8", frame_arm->context.iregs[8], sequence);
+        sequence = PrintRegister("r8", frame_arm->context.iregs[8], sequence,
+                                 out);
       if (frame_arm->context_validity & StackFrameARM::CONTEXT_VALID_R9)
-        sequence = PrintRegister("r9", frame_arm->context.iregs[9], sequence);
+        sequence = PrintRegister("r9", frame_arm->context.iregs[9], sequence,
+                                 out);
       if (frame_arm->context_validity & StackFrameARM::CONTEXT_VALID_R10)
-        sequence = PrintRegister("r10", frame_arm->context.iregs[10], sequence);
+        sequence = PrintRegister("r10", frame_arm->context.iregs[10], sequence,
+                                 out);
 
       // Registers with a dedicated or conventional purpose.
       if (frame_arm->context_validity & StackFrameARM::CONTEXT_VALID_FP)
-        sequence = PrintRegister("fp", frame_arm->context.iregs[11], sequence);
+        sequence = PrintRegister("fp", frame_arm->context.iregs[11], sequence,
+                                 out);
       if (frame_arm->context_validity & StackFrameARM::CONTEXT_VALID_SP)
-        sequence = PrintRegister("sp", frame_arm->context.iregs[13], sequence);
+        sequence = PrintRegister("sp", frame_arm->context.iregs[13], sequence,
+                                 out);
       if (frame_arm->context_validity & StackFrameARM::CONTEXT_VALID_LR)
-        sequence = PrintRegister("lr", frame_arm->context.iregs[14], sequence);
+        sequence = PrintRegister("lr", frame_arm->context.iregs[14], sequence,
+                                 out);
       if (frame_arm->context_validity & StackFrameARM::CONTEXT_VALID_PC)
-        sequence = PrintRegister("pc", frame_arm->context.iregs[15], sequence);
+        sequence = PrintRegister("pc", frame_arm->context.iregs[15], sequence,
+                                 out);
     }
-    printf("\n    Found by: %s\n", frame->trust_description().c_str());
+    out->Append("\n    Found by: ");
+    out->Append(frame->trust_description());
+    out->Append('\n');
   }
 }
 
-// PrintStackMachineReadable prints the call stack in |stack| to stdout,
+// PrintStackMachineReadable appends the call stack in |stack| to |out|,
 // in the following machine readable pipe-delimited text format:
 // thread number|frame number|module|function|source file|line|offset
 //
 // Module, function, source file, and source line may all be empty
 // depending on availability.  The code offset follows the same rules as
 // PrintStack above.
-static void PrintStackMachineReadable(int thread_num, const CallStack *stack) {
+static void PrintStackMachineReadable(int thread_num, const CallStack *stack,
+                                      OutputBuffer *out) {
   int frame_count = stack->frames()->size();
   for (int frame_index = 0; frame_index < frame_count; ++frame_index) {
     const StackFrame *frame = stack->frames()->at(frame_index);
-    printf("%d%c%d%c", thread_num, kOutputSeparator, frame_index,
-           kOutputSeparator);
+    out->AppendDecimal(thread_num);
+    out->Append(kOutputSeparator);
+    out->AppendDecimal(frame_index);
+    out->Append(kOutputSeparator);
 
     if (frame->module) {
       assert(!frame->module->code_file().empty());
-      printf("%s", StripSeparator(PathnameStripper::File(
-                     frame->module->code_file())).c_str());
+      out->AppendStrippedFileName(frame->module->code_file(),
+                                  kOutputSeparator);
       if (!frame->function_name.empty()) {
-        printf("%c%s", kOutputSeparator,
-               StripSeparator(frame->function_name).c_str());
+        out->Append(kOutputSeparator);
+        out->AppendStripped(frame->function_name, kOutputSeparator);
         if (!frame->source_file_name.empty()) {
-          printf("%c%s%c%d%c0x%" PRIx64,
-                 kOutputSeparator,
-                 StripSeparator(frame->source_file_name).c_str(),
-                 kOutputSeparator,
-                 frame->source_line,
-                 kOutputSeparator,
-                 frame->instruction - frame->source_line_base);
+          out->Append(kOutputSeparator);
+          out->AppendStripped(frame->source_file_name, kOutputSeparator);
+          out->Append(kOutputSeparator);
+          out->AppendDecimal(frame->source_line);
+          out->Append(kOutputSeparator);
+          out->Append("0x");
+          out->AppendHex(frame->instruction - frame->source_line_base);
         } else {
-          printf("%c%c%c0x%" PRIx64,
-                 kOutputSeparator,  // empty source file
-                 kOutputSeparator,  // empty source line
-                 kOutputSeparator,
-                 frame->instruction - frame->function_base);
+          out->Append(kOutputSeparator);  // empty source file
+          out->Append(kOutputSeparator);  // empty source line
+          out->Append(kOutputSeparator);
+          out->Append("0x");
+          out->AppendHex(frame->instruction - frame->function_base);
         }
       } else {
-        printf("%c%c%c%c0x%" PRIx64,
-               kOutputSeparator,  // empty function name
-               kOutputSeparator,  // empty source file
-               kOutputSeparator,  // empty source line
-               kOutputSeparator,
-               frame->instruction - frame->module->base_address());
+        out->Append(kOutputSeparator);  // empty function name
+        out->Append(kOutputSeparator);  // empty source file
+        out->Append(kOutputSeparator);  // empty source line
+        out->Append(kOutputSeparator);
+        out->Append("0x");
+        out->AppendHex(frame->instruction - frame->module->base_address());
       }
     } else {
-      // the printf before this prints a trailing separator for module name
-      printf("%c%c%c%c0x%" PRIx64,
-             kOutputSeparator,  // empty function name
-             kOutputSeparator,  // empty source file
-             kOutputSeparator,  // empty source line
-             kOutputSeparator,
-             frame->instruction);
+      // the separator before this is the trailing one for module name
+      out->Append(kOutputSeparator);  // empty function name
+      out->Append(kOutputSeparator);  // empty source file
+      out->Append(kOutputSeparator);  // empty source line
+      out->Append(kOutputSeparator);
+      out->Append("0x");
+      out->AppendHex(frame->instruction);
     }
-    printf("\n");
+    out->Append('\n');
   }
 }
 
-static void PrintModules(const CodeModules *modules) {
+static void PrintModules(const CodeModules *modules, OutputBuffer *out) {
   if (!modules)
     return;
 
-  printf("\n");
-  printf("Loaded modules:\n");
+  out->Append("\n");
+  out->Append("Loaded modules:\n");
 
   u_int64_t main_address = 0;
   const CodeModule *main_module = modules->GetMainModule();
@@ -334,12 +370,17 @@ static void PrintModules(const CodeModules *modules) {
        ++module_sequence) {
     const CodeModule *module = modules->GetModuleAtSequence(module_sequence);
     u_int64_t base_address = module->base_address();
-    printf("0x%08" PRIx64 " - 0x%08" PRIx64 "  %s  %s%s\n",
-           base_address, base_address + module->size() - 1,
-           PathnameStripper::File(module->code_file()).c_str(),
-           module->version().empty() ? "???" : module->version().c_str(),
-           main_module != NULL && base_address == main_address ?
-               "  (main)" : "");
+    out->Append("0x");
+    out->AppendHex(base_address, 8);
+    out->Append(" - 0x");
+    out->AppendHex(base_address + module->size() - 1, 8);
+    out->Append("  ");
+    out->AppendFileName(module->code_file());
+    out->Append("  ");
+    out->Append(module->version().empty() ? "???" : module->version());
+    if (main_module != NULL && base_address == main_address)
+      out->Append("  (main)");
+    out->Append('\n');
   }
 }
 
@@ -348,7 +389,8 @@ static void PrintModules(const CodeModules *modules) {
 // text format:
 // Module|{Module Filename}|{Version}|{Debug Filename}|{Debug Identifier}|
 // {Base Address}|{Max Address}|{Main}
-static void PrintModulesMachineReadable(const CodeModules *modules) {
+static void PrintModulesMachineReadable(const CodeModules *modules,
+                                        OutputBuffer *out) {
   if (!modules)
     return;
 
@@ -364,60 +406,84 @@ static void PrintModulesMachineReadable(const CodeModules *modules) {
        ++module_sequence) {
     const CodeModule *module = modules->GetModuleAtSequence(module_sequence);
     u_int64_t base_address = module->base_address();
-    printf("Module%c%s%c%s%c%s%c%s%c0x%08" PRIx64 "%c0x%08" PRIx64 "%c%d\n",
-           kOutputSeparator,
-           StripSeparator(PathnameStripper::File(module->code_file())).c_str(),
-           kOutputSeparator, StripSeparator(module->version()).c_str(),
-           kOutputSeparator,
-           StripSeparator(PathnameStripper::File(module->debug_file())).c_str(),
-           kOutputSeparator,
-           StripSeparator(module->debug_identifier()).c_str(),
-           kOutputSeparator, base_address,
-           kOutputSeparator, base_address + module->size() - 1,
-           kOutputSeparator,
-           main_module != NULL && base_address == main_address ? 1 : 0);
+    out->Append("Module");
+    out->Append(kOutputSeparator);
+    out->AppendStrippedFileName(module->code_file(), kOutputSeparator);
+    out->Append(kOutputSeparator);
+    out->AppendStripped(module->version(), kOutputSeparator);
+    out->Append(kOutputSeparator);
+    out->AppendStrippedFileName(module->debug_file(), kOutputSeparator);
+    out->Append(kOutputSeparator);
+    out->AppendStripped(module->debug_identifier(), kOutputSeparator);
+    out->Append(kOutputSeparator);
+    out->Append("0x");
+    out->AppendHex(base_address, 8);
+    out->Append(kOutputSeparator);
+    out->Append("0x");
+    out->AppendHex(base_address + module->size() - 1, 8);
+    out->Append(kOutputSeparator);
+    out->Append(main_module != NULL && base_address == main_address ?
+                '1' : '0');
+    out->Append('\n');
   }
 }
 
-static void PrintProcessState(const ProcessState& process_state) {
+static void PrintProcessState(const ProcessState& process_state,
+                              OutputBuffer *out) {
   // Print OS and CPU information.
-  string cpu = process_state.system_info()->cpu;
-  string cpu_info = process_state.system_info()->cpu_info;
-  printf("Operating system: %s\n", process_state.system_info()->os.c_str());
-  printf("                  %s\n",
-         process_state.system_info()->os_version.c_str());
-  printf("CPU: %s\n", cpu.c_str());
+  const string &cpu = process_state.system_info()->cpu;
+  const string &cpu_info = process_state.system_info()->cpu_info;
+  out->Append("Operating system: ");
+  out->Append(process_state.system_info()->os);
+  out->Append("\n                  ");
+  out->Append(process_state.system_info()->os_version);
+  out->Append("\nCPU: ");
+  out->Append(cpu);
+  out->Append('\n');
   if (!cpu_info.empty()) {
     // This field is optional.
-    printf("     %s\n", cpu_info.c_str());
+    out->Append("     ");
+    out->Append(cpu_info);
+    out->Append('\n');
   }
-  printf("     %d CPU%s\n",
-         process_state.system_info()->cpu_count,
-         process_state.system_info()->cpu_count != 1 ? "s" : "");
-  printf("\n");
+  out->Append("     ");
+  out->AppendDecimal(process_state.system_info()->cpu_count);
+  out->Append(process_state.system_info()->cpu_count != 1 ?
+              " CPUs\n" : " CPU\n");
+  out->Append("\n");
 
   // Print crash information.
   if (process_state.crashed()) {
-    printf("Crash reason:  %s\n", process_state.crash_reason().c_str());
-    printf("Crash address: 0x%" PRIx64 "\n", process_state.crash_address());
+    out->Append("Crash reason:  ");
+    out->Append(process_state.crash_reason());
+    out->Append("\nCrash address: 0x");
+    out->AppendHex(process_state.crash_address());
+    out->Append('\n');
   } else {
-    printf("No crash\n");
+    out->Append("No crash\n");
   }
 
   string assertion = process_state.assertion();
   if (!assertion.empty()) {
-    printf("Assertion: %s\n", assertion.c_str());
+    out->Append("Assertion: ");
+    out->Append(assertion);
+    out->Append('\n');
+  }
+
+  if (process_state.truncated()) {
+    out->Append("Processing truncated: the processing budget ran out, so "
+                "stacks may be incomplete\n");
   }
 
   // If the thread that requested the dump is known, print it first.
   int requesting_thread = process_state.requesting_thread();
   if (requesting_thread != -1) {
-    printf("\n");
-    printf("Thread %d (%s)\n",
-          requesting_thread,
-          process_state.crashed() ? "crashed" :
-                                    "requested dump, did not crash");
-    PrintStack(process_state.threads()->at(requesting_thread), cpu);
+    out->Append("\n");
+    out->Append("Thread ");
+    out->AppendDecimal(requesting_thread);
+    out->Append(process_state.crashed() ?
+                " (crashed)\n" : " (requested dump, did not crash)\n");
+    PrintStack(process_state.threads()->at(requesting_thread), cpu, out);
   }
 
   // Print all of the threads in the dump.
@@ -425,68 +491,85 @@ static void PrintProcessState(const ProcessState& process_state) {
   for (int thread_index = 0; thread_index < thread_count; ++thread_index) {
     if (thread_index != requesting_thread) {
       // Don't print the crash thread again, it was already printed.
-      printf("\n");
-      printf("Thread %d\n", thread_index);
-      PrintStack(process_state.threads()->at(thread_index), cpu);
+      out->Append("\n");
+      out->Append("Thread ");
+      out->AppendDecimal(thread_index);
+      out->Append('\n');
+      PrintStack(process_state.threads()->at(thread_index), cpu, out);
     }
   }
 
-  PrintModules(process_state.modules());
+  PrintModules(process_state.modules(), out);
 }
 
-static void PrintProcessStateMachineReadable(const ProcessState& process_state)
+static void PrintProcessStateMachineReadable(const ProcessState& process_state,
+                                             OutputBuffer *out)
 {
   // Print OS and CPU information.
   // OS|{OS Name}|{OS Version}
   // CPU|{CPU Name}|{CPU Info}|{Number of CPUs}
-  printf("OS%c%s%c%s\n", kOutputSeparator,
-         StripSeparator(process_state.system_info()->os).c_str(),
-         kOutputSeparator,
-         StripSeparator(process_state.system_info()->os_version).c_str());
-  printf("CPU%c%s%c%s%c%d\n", kOutputSeparator,
-         StripSeparator(process_state.system_info()->cpu).c_str(),
-         kOutputSeparator,
-         // this may be empty
-         StripSeparator(process_state.system_info()->cpu_info).c_str(),
-         kOutputSeparator,
-         process_state.system_info()->cpu_count);
+  out->Append("OS");
+  out->Append(kOutputSeparator);
+  out->AppendStripped(process_state.system_info()->os, kOutputSeparator);
+  out->Append(kOutputSeparator);
+  out->AppendStripped(process_state.system_info()->os_version,
+                      kOutputSeparator);
+  out->Append("\nCPU");
+  out->Append(kOutputSeparator);
+  out->AppendStripped(process_state.system_info()->cpu, kOutputSeparator);
+  out->Append(kOutputSeparator);
+  // this may be empty
+  out->AppendStripped(process_state.system_info()->cpu_info,
+                      kOutputSeparator);
+  out->Append(kOutputSeparator);
+  out->AppendDecimal(process_state.system_info()->cpu_count);
+  out->Append('\n');
 
   int requesting_thread = process_state.requesting_thread();
 
   // Print crash information.
   // Crash|{Crash Reason}|{Crash Address}|{Crashed Thread}
-  printf("Crash%c", kOutputSeparator);
+  out->Append("Crash");
+  out->Append(kOutputSeparator);
   if (process_state.crashed()) {
-    printf("%s%c0x%" PRIx64 "%c",
-           StripSeparator(process_state.crash_reason()).c_str(),
-           kOutputSeparator, process_state.crash_address(), kOutputSeparator);
+    out->AppendStripped(process_state.crash_reason(), kOutputSeparator);
+    out->Append(kOutputSeparator);
+    out->Append("0x");
+    out->AppendHex(process_state.crash_address());
+    out->Append(kOutputSeparator);
   } else {
     // print assertion info, if available, in place of crash reason,
     // instead of the unhelpful "No crash"
     string assertion = process_state.assertion();
     if (!assertion.empty()) {
-      printf("%s%c%c", StripSeparator(assertion).c_str(),
-             kOutputSeparator, kOutputSeparator);
+      out->AppendStripped(assertion, kOutputSeparator);
     } else {
-      printf("No crash%c%c", kOutputSeparator, kOutputSeparator);
+      out->Append("No crash");
     }
+    out->Append(kOutputSeparator);
+    out->Append(kOutputSeparator);
   }
 
   if (requesting_thread != -1) {
-    printf("%d\n", requesting_thread);
-  } else {
-    printf("\n");
+    out->AppendDecimal(requesting_thread);
   }
+  out->Append('\n');
+
+  // If the processing budget ran out, the stacks may be incomplete.
+  // Truncated
+  if (process_state.truncated())
+    out->Append("Truncated\n");
 
-  PrintModulesMachineReadable(process_state.modules());
+  PrintModulesMachineReadable(process_state.modules(), out);
 
   // blank line to indicate start of threads
-  printf("\n");
+  out->Append("\n");
 
   // If the thread that requested the dump is known, print it first.
   if (requesting_thread != -1) {
     PrintStackMachineReadable(requesting_thread,
-                              process_state.threads()->at(requesting_thread));
+                              process_state.threads()->at(requesting_thread),
+                              out);
   }
 
   // Print all of the threads in the dump.
@@ -495,11 +578,41 @@ static void PrintProcessStateMachineReadable(const ProcessState& process_state)
     if (thread_index != requesting_thread) {
       // Don't print the crash thread again, it was already printed.
       PrintStackMachineReadable(thread_index,
-                                process_state.threads()->at(thread_index));
+                                process_state.threads()->at(thread_index),
+                                out);
     }
   }
 }
 
+// Writes |process_state| to stdout in |format|.  Returns false if it
+// could not be written.
+static bool PrintOutput(const ProcessState &process_state,
+                        OutputFormat format) {
+  OutputBuffer output;
+  switch (format) {
+    case OUTPUT_TEXT:
+      PrintProcessState(process_state, &output);
+      break;
+    case OUTPUT_MACHINE_READABLE:
+      PrintProcessStateMachineReadable(process_state, &output);
+      break;
+    case OUTPUT_BINARY: {
+      string record;
+      ProcessStateRecordWriter::Append(process_state, &record);
+      output.Append(record);
+      break;
+    }
+  }
+
+  FileOutputSink sink(stdout);
+  if (!output.Flush(&sink)) {
+    BPLOG(ERROR) << "Could not write output";
+    return false;
+  }
+
+  return true;
+}
+
 // Processes |minidump_file| using MinidumpProcessor.  |symbol_path|, if
 // non-empty, is the base directory of a symbol storage area, laid out in
 // the format required by SimpleSymbolSupplier.  If such a storage area
@@ -509,10 +622,23 @@ static void PrintProcessStateMachineReadable(const ProcessState& process_state)
 // prints identifying OS and CPU information from the minidump, crash
 // information if the minidump was produced as a result of a crash, and
 // call stacks for each thread contained in the minidump.  All information
-// is printed to stdout.
+// is written to stdout, in the given format, with a single write.
+//
+// If |print_stats| is true, a report of the time spent in each stage of
+// processing and of the processor's counters is printed to stderr, in the
+// form described by ProcessorStats::Report.
+//
+// If |time_limit_ms| is not zero, processing stops after that many
+// milliseconds, and the output notes that its stacks may be incomplete.
 static bool PrintMinidumpProcess(const string &minidump_file,
                                  const vector<string> &symbol_paths,
-                                 bool machine_readable) {
+                                 OutputFormat format,
+                                 bool print_stats,
+                                 u_int32_t time_limit_ms) {
+  ProcessorStats stats;
+  if (print_stats)
+    ProcessorStats::set_active(&stats);
+
   scoped_ptr<SimpleSymbolSupplier> symbol_supplier;
   if (!symbol_paths.empty()) {
     // TODO(mmentovai): check existence of symbol_path if specified?
@@ -521,59 +647,74 @@ static bool PrintMinidumpProcess(const string &minidump_file,
 
   BasicSourceLineResolver resolver;
   MinidumpProcessor minidump_processor(symbol_supplier.get(), &resolver);
+  minidump_processor.SetBudget(time_limit_ms, 0, 0);
 
   // Process the minidump.
   ProcessState process_state;
   if (minidump_processor.Process(minidump_file, &process_state) !=
       google_breakpad::PROCESS_OK) {
     BPLOG(ERROR) << "MinidumpProcessor::Process failed";
+    ProcessorStats::set_active(NULL);
     return false;
   }
 
-  if (machine_readable) {
-    PrintProcessStateMachineReadable(process_state);
-  } else {
-    PrintProcessState(process_state);
+  bool written;
+  {
+    ScopedStatsTimer timer(ProcessorStats::OUTPUT);
+    written = PrintOutput(process_state, format);
   }
+  ProcessorStats::set_active(NULL);
 
-  return true;
+  if (print_stats) {
+    string report;
+    stats.Report("dump", &report);
+    fputs(report.c_str(), stderr);
+  }
+  return written;
 }
 
 }  // namespace
 
 static void usage(const char *program_name) {
-  fprintf(stderr, "usage: %s [-m] <minidump-file> [symbol-path ...]\n"
-          "    -m : Output in machine-readable format\n",
+  fprintf(stderr, "usage: %s [-m|-b] [--stats] [--time-limit <ms>] "
+          "<minidump-file> [symbol-path ...]\n"
+          "    -m : Output in machine-readable format\n"
+          "    -b : Output a binary ProcessState record\n"
+          "    --stats : Print processing statistics to stderr\n"
+          "    --time-limit : Stop walking stacks after <ms> milliseconds\n",
           program_name);
 }
 
 int main(int argc, char **argv) {
   BPLOG_INIT(&argc, &argv);
 
-  if (argc < 2) {
-    usage(argv[0]);
-    return 1;
-  }
-
-  const char *minidump_file;
-  bool machine_readable;
-  int symbol_path_arg;
-
-  if (strcmp(argv[1], "-m") == 0) {
-    if (argc < 3) {
+  OutputFormat format = OUTPUT_TEXT;
+  bool print_stats = false;
+  u_int32_t time_limit_ms = 0;
+  int argi = 1;
+  for (; argi < argc && argv[argi][0] == '-'; ++argi) {
+    if (strcmp(argv[argi], "-m") == 0) {
+      format = OUTPUT_MACHINE_READABLE;
+    } else if (strcmp(argv[argi], "-b") == 0) {
+      format = OUTPUT_BINARY;
+    } else if (strcmp(argv[argi], "--stats") == 0) {
+      print_stats = true;
+    } else if (strcmp(argv[argi], "--time-limit") == 0 && argi + 1 < argc) {
+      time_limit_ms = strtoul(argv[++argi], NULL, 10);
+    } else {
       usage(argv[0]);
       return 1;
     }
+  }
 
-    machine_readable = true;
-    minidump_file = argv[2];
-    symbol_path_arg = 3;
-  } else {
-    machine_readable = false;
-    minidump_file = argv[1];
-    symbol_path_arg = 2;
+  if (argi >= argc) {
+    usage(argv[0]);
+    return 1;
   }
 
+  const char *minidump_file = argv[argi];
+  int symbol_path_arg = argi + 1;
+
   // extra arguments are symbol paths
   std::vector<std::string> symbol_paths;
   if (argc > symbol_path_arg) {
@@ -583,5 +724,7 @@ int main(int argc, char **argv) {
 
   return PrintMinidumpProcess(minidump_file,
                               symbol_paths,
-                              machine_readable) ? 0 : 1;
+                              format,
+                              print_stats,
+                              time_limit_ms) ? 0 : 1;
 }
@@ -33,10 +33,13 @@
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string>
+#include <unistd.h>
 #include <vector>
 #include "breakpad_googletest_includes.h"
+#include "client/minidump_file_writer-inl.h"
 #include "google_breakpad/common/minidump_format.h"
 #include "google_breakpad/processor/minidump.h"
 #include "processor/logging.h"
@@ -46,6 +49,7 @@ namespace {
 
 using google_breakpad::Minidump;
 using google_breakpad::MinidumpContext;
+using google_breakpad::MinidumpFileWriter;
 using google_breakpad::MinidumpException;
 using google_breakpad::MinidumpMemoryInfo;
 using google_breakpad::MinidumpMemoryInfoList;
@@ -65,6 +69,8 @@ using google_breakpad::SynthMinidump::Stream;
 using google_breakpad::SynthMinidump::String;
 using google_breakpad::SynthMinidump::SystemInfo;
 using google_breakpad::SynthMinidump::Thread;
+using google_breakpad::TypedMDRVA;
+using google_breakpad::UntypedMDRVA;
 using google_breakpad::test_assembler::kBigEndian;
 using google_breakpad::test_assembler::kLittleEndian;
 using std::ifstream;
@@ -80,6 +86,87 @@ public:
       "/src/processor/testdata/minidump2.dmp";
   }
   string minidump_file_;
+
+  // Return the contents of minidump_file_.
+  string ReadMinidumpFile() {
+    ifstream file_stream(minidump_file_.c_str(),
+                         std::ios::in | std::ios::binary);
+    std::ostringstream contents;
+    contents << file_stream.rdbuf();
+    return contents.str();
+  }
+
+  // Write |contents| to |writer| as a single allocation, compressing it
+  // in blocks of |block_size| bytes, and close |writer|.
+  static void WriteCompressed(const string &contents, size_t block_size,
+                              MinidumpFileWriter *writer) {
+    ASSERT_TRUE(writer->EnableCompression(block_size));
+    UntypedMDRVA all(writer);
+    ASSERT_TRUE(all.Allocate(contents.size()));
+    ASSERT_TRUE(all.Copy(contents.data(), contents.size()));
+    ASSERT_TRUE(writer->Close());
+  }
+
+  // Check that the minidump in |compressed| reads back the same as the
+  // one in |original|.
+  static void CheckSameMinidump(const string &original,
+                                const string &compressed) {
+    istringstream original_stream(original);
+    Minidump original_minidump(original_stream);
+    ASSERT_TRUE(original_minidump.Read());
+    EXPECT_FALSE(original_minidump.compressed());
+
+    istringstream compressed_stream(compressed);
+    Minidump compressed_minidump(compressed_stream);
+    ASSERT_TRUE(compressed_minidump.Read());
+    EXPECT_TRUE(compressed_minidump.compressed());
+
+    ASSERT_EQ(original_minidump.GetDirectoryEntryCount(),
+              compressed_minidump.GetDirectoryEntryCount());
+    for (unsigned int i = 0;
+         i < original_minidump.GetDirectoryEntryCount(); i++) {
+      const MDRawDirectory *original_entry =
+          original_minidump.GetDirectoryEntryAtIndex(i);
+      const MDRawDirectory *compressed_entry =
+          compressed_minidump.GetDirectoryEntryAtIndex(i);
+      EXPECT_EQ(original_entry->stream_type, compressed_entry->stream_type);
+      EXPECT_EQ(original_entry->location.rva,
+                compressed_entry->location.rva);
+    }
+
+    MinidumpModuleList *original_modules = original_minidump.GetModuleList();
+    MinidumpModuleList *compressed_modules =
+        compressed_minidump.GetModuleList();
+    ASSERT_TRUE(original_modules != NULL);
+    ASSERT_TRUE(compressed_modules != NULL);
+    ASSERT_EQ(original_modules->module_count(),
+              compressed_modules->module_count());
+    for (unsigned int i = 0; i < original_modules->module_count(); i++) {
+      EXPECT_EQ(original_modules->GetModuleAtIndex(i)->code_file(),
+                compressed_modules->GetModuleAtIndex(i)->code_file());
+    }
+
+    MinidumpThreadList *original_threads = original_minidump.GetThreadList();
+    MinidumpThreadList *compressed_threads =
+        compressed_minidump.GetThreadList();
+    ASSERT_TRUE(original_threads != NULL);
+    ASSERT_TRUE(compressed_threads != NULL);
+    ASSERT_EQ(original_threads->thread_count(),
+              compressed_threads->thread_count());
+    for (unsigned int i = 0; i < original_threads->thread_count(); i++) {
+      MinidumpMemoryRegion *original_stack =
+          original_threads->GetThreadAtIndex(i)->GetMemory();
+      MinidumpMemoryRegion *compressed_stack =
+          compressed_threads->GetThreadAtIndex(i)->GetMemory();
+      ASSERT_TRUE(original_stack != NULL);
+      ASSERT_TRUE(compressed_stack != NULL);
+      EXPECT_EQ(original_stack->GetBase(), compressed_stack->GetBase());
+      ASSERT_EQ(original_stack->GetSize(), compressed_stack->GetSize());
+      EXPECT_EQ(0, memcmp(original_stack->GetMemory(),
+                          compressed_stack->GetMemory(),
+                          original_stack->GetSize()));
+    }
+  }
 };
 
 TEST_F(MinidumpTest, TestMinidumpFromFile) {
@@ -118,6 +205,87 @@ TEST_F(MinidumpTest, TestMinidumpFromStream) {
   //TODO: add more checks here
 }
 
+// A minidump that MinidumpFileWriter writes into memory can be read from
+// there directly, without going through a file.
+TEST_F(MinidumpTest, TestMinidumpFromWriterBuffer) {
+  char buffer[4096];
+  MinidumpFileWriter writer;
+  writer.SetBuffer(buffer, sizeof(buffer));
+  {
+    TypedMDRVA<MDRawHeader> header(&writer);
+    TypedMDRVA<MDRawDirectory> dir(&writer);
+    TypedMDRVA<MDRawSystemInfo> system_info(&writer);
+    ASSERT_TRUE(header.Allocate());
+    ASSERT_TRUE(dir.AllocateArray(1));
+    ASSERT_TRUE(system_info.Allocate());
+
+    MDRawHeader *header_ptr = header.get();
+    header_ptr->signature = MD_HEADER_SIGNATURE;
+    header_ptr->version = MD_HEADER_VERSION;
+    header_ptr->stream_count = 1;
+    header_ptr->stream_directory_rva = dir.position();
+
+    MDRawSystemInfo *system_info_ptr = system_info.get();
+    system_info_ptr->processor_architecture = MD_CPU_ARCHITECTURE_X86;
+    system_info_ptr->platform_id = MD_OS_WIN32_NT;
+    MDLocationDescriptor csd_version;
+    ASSERT_TRUE(writer.WriteString("Petulant Pierogi", 0, &csd_version));
+    system_info_ptr->csd_version_rva = csd_version.rva;
+
+    MDRawDirectory entry;
+    entry.stream_type = MD_SYSTEM_INFO_STREAM;
+    entry.location = system_info.location();
+    ASSERT_TRUE(dir.CopyIndex(0, &entry));
+  }
+  ASSERT_TRUE(writer.Close());
+
+  istringstream minidump_stream(string(buffer, writer.position()));
+  Minidump minidump(minidump_stream);
+  ASSERT_TRUE(minidump.Read());
+  ASSERT_EQ(1U, minidump.GetDirectoryEntryCount());
+  MinidumpSystemInfo *md_system_info = minidump.GetSystemInfo();
+  ASSERT_TRUE(md_system_info != NULL);
+  ASSERT_EQ("windows", md_system_info->GetOS());
+  ASSERT_EQ("x86", md_system_info->GetCPU());
+  ASSERT_EQ("Petulant Pierogi", *md_system_info->GetCSDVersion());
+}
+
+// MinidumpFileWriter can compress a minidump in the buffer it was written
+// to, and Minidump reads the result as though it were the original.
+TEST_F(MinidumpTest, TestCompressedMinidumpFromWriterBuffer) {
+  string contents = ReadMinidumpFile();
+  ASSERT_FALSE(contents.empty());
+  vector<char> buffer(contents.size() + 4096);
+  MinidumpFileWriter writer;
+  writer.SetBuffer(&buffer[0], buffer.size());
+  WriteCompressed(contents, 4096, &writer);
+  EXPECT_GT(contents.size(), writer.position());
+
+  CheckSameMinidump(contents, string(&buffer[0], writer.position()));
+}
+
+// The same, compressing in place in a file.
+TEST_F(MinidumpTest, TestCompressedMinidumpFromWriterFile) {
+  string contents = ReadMinidumpFile();
+  ASSERT_FALSE(contents.empty());
+  FILE *file = tmpfile();
+  ASSERT_TRUE(file != NULL);
+  MinidumpFileWriter writer;
+  writer.SetFile(fileno(file));
+  ASSERT_TRUE(writer.EnableWriteBuffer(8192));
+  WriteCompressed(contents, 1024, &writer);
+
+  string compressed(writer.position(), '\0');
+  ASSERT_EQ(0, lseek(fileno(file), 0, SEEK_SET));
+  ASSERT_EQ(static_cast<ssize_t>(compressed.size()),
+            read(fileno(file), &compressed[0], compressed.size()));
+  char extra;
+  EXPECT_EQ(0, read(fileno(file), &extra, 1));
+  fclose(file);
+
+  CheckSameMinidump(contents, compressed);
+}
+
 TEST(Dump, ReadBackEmpty) {
   Dump dump(0);
   dump.Finish();
@@ -93,7 +93,7 @@ bool ModuleComparer::CompareModule(const BasicModule *basic_module,
         && iter2 != fast_module->files_.end()) {
       ASSERT_TRUE(iter1->first == iter2.GetKey());
       string tmp(iter2.GetValuePtr());
-      ASSERT_TRUE(iter1->second == tmp);
+      ASSERT_TRUE(basic_module->CFIRules(iter1->second) == tmp);
       ++iter1;
       ++iter2;
     }
@@ -155,7 +155,7 @@ bool ModuleComparer::CompareModule(const BasicModule *basic_module,
       ASSERT_TRUE(iter1->first == iter2.GetKey());
       ASSERT_TRUE(iter1->second.base() == iter2.GetValuePtr()->base());
       string tmp(iter2.GetValuePtr()->entryptr());
-      ASSERT_TRUE(iter1->second.entry() == tmp);
+      ASSERT_TRUE(basic_module->CFIRules(iter1->second.entry()) == tmp);
       ++iter1;
       ++iter2;
     }
@@ -173,7 +173,7 @@ bool ModuleComparer::CompareModule(const BasicModule *basic_module,
         && iter2 != fast_module->cfi_delta_rules_.end()) {
       ASSERT_TRUE(iter1->first == iter2.GetKey());
       string tmp(iter2.GetValuePtr());
-      ASSERT_TRUE(iter1->second == tmp);
+      ASSERT_TRUE(basic_module->CFIRules(iter1->second) == tmp);
       ++iter1;
       ++iter2;
     }
@@ -59,10 +59,11 @@ size_t ModuleSerializer::SizeOf(const BasicSourceLineResolver::Module &module) {
   for (int i = 0; i < WindowsFrameInfo::STACK_INFO_LAST; ++i)
    map_sizes_[map_index++] =
        wfi_serializer_.SizeOf(&(module.windows_frame_info_[i]));
+  cfi_rules_expanded_ = ExpandCFIRules(module);
   map_sizes_[map_index++] = cfi_init_rules_serializer_.SizeOf(
-     module.cfi_initial_rules_);
+     cfi_rules_expanded_ ? cfi_initial_rules_ : module.cfi_initial_rules_);
   map_sizes_[map_index++] = cfi_delta_rules_serializer_.SizeOf(
-     module.cfi_delta_rules_);
+     cfi_rules_expanded_ ? cfi_delta_rules_ : module.cfi_delta_rules_);
 
   // Header size.
   total_size_alloc_ = kNumberMaps_ * sizeof(u_int32_t);
@@ -87,13 +88,51 @@ char *ModuleSerializer::Write(const BasicSourceLineResolver::Module &module,
   dest = pubsym_serializer_.Write(module.public_symbols_, dest);
   for (int i = 0; i < WindowsFrameInfo::STACK_INFO_LAST; ++i)
     dest = wfi_serializer_.Write(&(module.windows_frame_info_[i]), dest);
-  dest = cfi_init_rules_serializer_.Write(module.cfi_initial_rules_, dest);
-  dest = cfi_delta_rules_serializer_.Write(module.cfi_delta_rules_, dest);
+  dest = cfi_init_rules_serializer_.Write(
+      cfi_rules_expanded_ ? cfi_initial_rules_ : module.cfi_initial_rules_,
+      dest);
+  dest = cfi_delta_rules_serializer_.Write(
+      cfi_rules_expanded_ ? cfi_delta_rules_ : module.cfi_delta_rules_,
+      dest);
   // Write a null terminator.
   dest = SimpleSerializer<char>::Write(0, dest);
+
+  // Don't hold on to the expanded copies.
+  if (cfi_rules_expanded_) {
+    cfi_initial_rules_.Clear();
+    std::map<MemAddr, string>().swap(cfi_delta_rules_);
+    cfi_rules_expanded_ = false;
+  }
   return dest;
 }
 
+bool ModuleSerializer::ExpandCFIRules(
+    const BasicSourceLineResolver::Module &module) {
+  if (module.cfi_rule_sets_.empty())
+    return false;
+
+  // Walk the initial rules from the highest range down.
+  cfi_initial_rules_.Clear();
+  MemAddr address = static_cast<MemAddr>(-1);
+  string rules;
+  MemAddr base, size;
+  while (module.cfi_initial_rules_.RetrieveNearestRange(address, &rules,
+                                                        &base, &size)) {
+    cfi_initial_rules_.StoreRange(base, size, module.CFIRules(rules));
+    if (base == 0)
+      break;
+    address = base - 1;
+  }
+
+  cfi_delta_rules_.clear();
+  for (std::map<MemAddr, string>::const_iterator delta =
+           module.cfi_delta_rules_.begin();
+       delta != module.cfi_delta_rules_.end(); ++delta) {
+    cfi_delta_rules_[delta->first] = module.CFIRules(delta->second);
+  }
+  return true;
+}
+
 char* ModuleSerializer::Serialize(
     const BasicSourceLineResolver::Module &module, unsigned int *size) {
   // Compute size of memory to allocate.
@@ -59,12 +59,15 @@ namespace google_breakpad {
 // FastSourceLineResolver::Module.
 class ModuleSerializer {
  public:
+  ModuleSerializer() : cfi_rules_expanded_(false) { }
+
   // Compute the size of memory required to serialize a module.  Return the
   // total size needed for serialization.
   size_t SizeOf(const BasicSourceLineResolver::Module &module);
 
   // Write a module into an allocated memory chunk with required size.
   // Return the "end" of data, i.e., the address after the final byte of data.
+  // SizeOf must have been called on the same module first.
   char* Write(const BasicSourceLineResolver::Module &module, char *dest);
 
   // Serializes a loaded Module object into a chunk of memory data and returns
@@ -105,6 +108,13 @@ class ModuleSerializer {
       const BasicSourceLineResolver::ModuleMap::const_iterator &iter,
       FastSourceLineResolver *fast_resolver);
 
+  // A FastSourceLineResolver module has no table of shared CFI rule
+  // sets, so if MODULE has one, fill cfi_initial_rules_ and
+  // cfi_delta_rules_ with copies of MODULE's CFI maps in which every
+  // reference is replaced by the rules it refers to.  Return true if
+  // the copies should be serialized in place of MODULE's own maps.
+  bool ExpandCFIRules(const BasicSourceLineResolver::Module &module);
+
   // Number of Maps that Module class contains.
   static const u_int32_t kNumberMaps_ =
       FastSourceLineResolver::Module::kNumberMaps_;
@@ -120,6 +130,12 @@ class ModuleSerializer {
                               linked_ptr<WindowsFrameInfo> > wfi_serializer_;
   RangeMapSerializer<MemAddr, string> cfi_init_rules_serializer_;
   StdMapSerializer<MemAddr, string> cfi_delta_rules_serializer_;
+
+  // The CFI maps of the module being serialized, with shared rule sets
+  // spelled out, if ExpandCFIRules found any.
+  bool cfi_rules_expanded_;
+  RangeMap<MemAddr, string> cfi_initial_rules_;
+  std::map<MemAddr, string> cfi_delta_rules_;
 };
 
 }  // namespace google_breakpad
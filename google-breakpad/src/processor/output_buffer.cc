@@ -0,0 +1,130 @@
+// Copyright (c) 2010, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// output_buffer.cc: Accumulates formatted text in memory, and writes it to
+// an OutputSink in a single call.
+//
+// See output_buffer.h for documentation.
+
+#include "processor/output_buffer.h"
+
+#include <string.h>
+
+namespace google_breakpad {
+
+namespace {
+
+// Returns the offset of the trailing component of path.
+size_t FileNameStart(const string &path) {
+  string::size_type separator = path.find_last_of("/\\");
+  return separator == string::npos ? 0 : separator + 1;
+}
+
+}  // namespace
+
+bool FileOutputSink::Write(const char *data, size_t size) {
+  return fwrite(data, 1, size, file_) == size;
+}
+
+void OutputBuffer::AppendPadded(const char *str, int width) {
+  int length = strlen(str);
+  if (length < width)
+    buffer_.append(width - length, ' ');
+  buffer_.append(str, length);
+}
+
+void OutputBuffer::AppendDecimal(int value, int width) {
+  // Work with the magnitude as unsigned, so that INT_MIN is handled.
+  unsigned int magnitude = value < 0 ? 0U - value : value;
+  char digits[16];
+  char *start = digits + sizeof(digits);
+  do {
+    *--start = '0' + magnitude % 10;
+    magnitude /= 10;
+  } while (magnitude);
+  if (value < 0)
+    *--start = '-';
+
+  int length = digits + sizeof(digits) - start;
+  if (length < width)
+    buffer_.append(width - length, ' ');
+  buffer_.append(start, length);
+}
+
+void OutputBuffer::AppendHex(u_int64_t value, int digits) {
+  static const char kHexDigits[] = "0123456789abcdef";
+  char text[16];
+  char *start = text + sizeof(text);
+  do {
+    *--start = kHexDigits[value & 0xf];
+    value >>= 4;
+  } while (value);
+
+  int length = text + sizeof(text) - start;
+  if (length < digits)
+    buffer_.append(digits - length, '0');
+  buffer_.append(start, length);
+}
+
+void OutputBuffer::AppendFileName(const string &path) {
+  size_t start = FileNameStart(path);
+  buffer_.append(path, start, string::npos);
+}
+
+void OutputBuffer::AppendStripped(const string &str, char separator) {
+  AppendStripped(str.data(), str.size(), separator);
+}
+
+void OutputBuffer::AppendStrippedFileName(const string &path,
+                                          char separator) {
+  size_t start = FileNameStart(path);
+  AppendStripped(path.data() + start, path.size() - start, separator);
+}
+
+void OutputBuffer::AppendStripped(const char *str, size_t size,
+                                  char separator) {
+  // Append runs of characters between the ones removed.
+  const char *end = str + size;
+  const char *run = str;
+  for (const char *cursor = str; cursor != end; ++cursor) {
+    if (*cursor == separator || *cursor == '\n') {
+      buffer_.append(run, cursor - run);
+      run = cursor + 1;
+    }
+  }
+  buffer_.append(run, end - run);
+}
+
+bool OutputBuffer::Flush(OutputSink *sink) {
+  bool result = sink->Write(buffer_.data(), buffer_.size());
+  buffer_.clear();
+  return result;
+}
+
+}  // namespace google_breakpad
@@ -0,0 +1,144 @@
+// -*- mode: c++ -*-
+
+// Copyright (c) 2010, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// output_buffer.h: Accumulates formatted text in memory, and writes it to
+// an OutputSink in a single call.
+//
+// Formatting a processed minidump field by field with printf takes the
+// stdio lock and parses a format string for every field.  OutputBuffer
+// instead appends to a string that keeps its capacity from one use to the
+// next, with formatters for the few conversions the processor's tools
+// need, so that the output for a whole minidump can be written at once to
+// a file, a pipe or memory.
+
+#ifndef PROCESSOR_OUTPUT_BUFFER_H__
+#define PROCESSOR_OUTPUT_BUFFER_H__
+
+#include <stdio.h>
+
+#include <string>
+
+#include "google_breakpad/common/breakpad_types.h"
+
+namespace google_breakpad {
+
+using std::string;
+
+// A destination for the contents of an OutputBuffer.
+class OutputSink {
+ public:
+  virtual ~OutputSink() {}
+
+  // Writes the size bytes at data.  Returns false on error.
+  virtual bool Write(const char *data, size_t size) = 0;
+};
+
+// An OutputSink that writes to a stdio stream.
+class FileOutputSink : public OutputSink {
+ public:
+  // file must remain open while this sink is in use.
+  explicit FileOutputSink(FILE *file) : file_(file) {}
+
+  virtual bool Write(const char *data, size_t size);
+
+ private:
+  FILE *file_;
+};
+
+// An OutputSink that appends to a string.
+class StringOutputSink : public OutputSink {
+ public:
+  explicit StringOutputSink(string *output) : output_(output) {}
+
+  virtual bool Write(const char *data, size_t size) {
+    output_->append(data, size);
+    return true;
+  }
+
+ private:
+  string *output_;
+};
+
+class OutputBuffer {
+ public:
+  OutputBuffer() {}
+
+  void Append(char c) { buffer_.push_back(c); }
+  void Append(const char *str) { buffer_.append(str); }
+  void Append(const string &str) { buffer_.append(str); }
+
+  // Appends str right-aligned in a field of width characters, like
+  // printf's "%*s".
+  void AppendPadded(const char *str, int width);
+
+  // Appends value in decimal, right-aligned in a field of width
+  // characters, like printf's "%*d".
+  void AppendDecimal(int value, int width);
+  void AppendDecimal(int value) { AppendDecimal(value, 0); }
+
+  // Appends value in lowercase hexadecimal without a prefix, zero-padded
+  // to at least digits digits, like printf's "%0*" PRIx64.
+  void AppendHex(u_int64_t value, int digits);
+  void AppendHex(u_int64_t value) { AppendHex(value, 0); }
+
+  // Appends the trailing component of path, as PathnameStripper::File
+  // returns it, without making a copy of path.
+  void AppendFileName(const string &path);
+
+  // Appends str with every separator and newline character removed, for
+  // separator-delimited output.
+  void AppendStripped(const string &str, char separator);
+
+  // Like AppendFileName, but with the result stripped as by
+  // AppendStripped.
+  void AppendStrippedFileName(const string &path, char separator);
+
+  const string &data() const { return buffer_; }
+  size_t size() const { return buffer_.size(); }
+
+  // Discards the buffered text.  The buffer's memory is kept for reuse.
+  void Clear() { buffer_.clear(); }
+
+  // Writes the buffered text to sink in a single call, and clears the
+  // buffer.  Returns the result of the write.
+  bool Flush(OutputSink *sink);
+
+ private:
+  // Appends the size bytes at str with every separator and newline
+  // character removed.
+  void AppendStripped(const char *str, size_t size, char separator);
+
+  string buffer_;
+};
+
+}  // namespace google_breakpad
+
+#endif  // PROCESSOR_OUTPUT_BUFFER_H__
@@ -0,0 +1,143 @@
+// Copyright (c) 2010, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// output_buffer_unittest.cc: Unit tests for OutputBuffer and its sinks.
+
+#include <limits.h>
+#include <stdarg.h>
+#include <stdio.h>
+
+#include <string>
+
+#include "breakpad_googletest_includes.h"
+#include "processor/output_buffer.h"
+
+namespace {
+
+using google_breakpad::OutputBuffer;
+using google_breakpad::StringOutputSink;
+using std::string;
+
+// Formats with snprintf, for comparison.
+string Format(const char *format, ...) {
+  char buffer[128];
+  va_list arguments;
+  va_start(arguments, format);
+  vsnprintf(buffer, sizeof(buffer), format, arguments);
+  va_end(arguments);
+  return buffer;
+}
+
+TEST(OutputBuffer, Append) {
+  OutputBuffer out;
+  out.Append('a');
+  out.Append("bc");
+  out.Append(string("d\0e", 3));
+  EXPECT_EQ(string("abcd\0e", 6), out.data());
+  EXPECT_EQ(6U, out.size());
+  out.Clear();
+  EXPECT_EQ("", out.data());
+}
+
+TEST(OutputBuffer, AppendPadded) {
+  OutputBuffer out;
+  out.AppendPadded("eip", 5);
+  out.AppendPadded("srr0", 5);
+  out.AppendPadded("longer", 5);
+  EXPECT_EQ(Format("%5s%5s%5s", "eip", "srr0", "longer"), out.data());
+}
+
+TEST(OutputBuffer, AppendDecimal) {
+  const int kValues[] = { 0, 1, 9, 10, 42, 327, -1, -57, INT_MAX, INT_MIN };
+  for (size_t i = 0; i < sizeof(kValues) / sizeof(kValues[0]); ++i) {
+    OutputBuffer out;
+    out.AppendDecimal(kValues[i]);
+    out.Append('|');
+    out.AppendDecimal(kValues[i], 2);
+    out.Append('|');
+    out.AppendDecimal(kValues[i], 5);
+    EXPECT_EQ(Format("%d|%2d|%5d", kValues[i], kValues[i], kValues[i]),
+              out.data());
+  }
+}
+
+TEST(OutputBuffer, AppendHex) {
+  const u_int64_t kValues[] = {
+    0, 0x9, 0xa, 0x45, 0x7c801234, 0xffffffff, 0x123456789abcdefULL,
+    0xffffffffffffffffULL
+  };
+  for (size_t i = 0; i < sizeof(kValues) / sizeof(kValues[0]); ++i) {
+    OutputBuffer out;
+    out.AppendHex(kValues[i]);
+    out.Append('|');
+    out.AppendHex(kValues[i], 8);
+    out.Append('|');
+    out.AppendHex(kValues[i], 16);
+    unsigned long long value = kValues[i];
+    EXPECT_EQ(Format("%llx|%08llx|%016llx", value, value, value), out.data());
+  }
+}
+
+TEST(OutputBuffer, FileNames) {
+  OutputBuffer out;
+  out.AppendFileName("c:\\test_app.exe");
+  out.Append(' ');
+  out.AppendFileName("/usr/lib/libc.so");
+  out.Append(' ');
+  out.AppendFileName("dir\\/file");
+  out.Append(' ');
+  out.AppendFileName("file");
+  out.Append(' ');
+  out.AppendFileName("dir/");
+  EXPECT_EQ("test_app.exe libc.so file file ", out.data());
+}
+
+TEST(OutputBuffer, Stripped) {
+  OutputBuffer out;
+  out.AppendStripped("a|b\nc||", '|');
+  out.Append('|');
+  out.AppendStripped("", '|');
+  out.Append('|');
+  out.AppendStrippedFileName("/dir|x/fi|le\n", '|');
+  EXPECT_EQ("abc||file", out.data());
+}
+
+TEST(OutputBuffer, Flush) {
+  string written;
+  StringOutputSink sink(&written);
+  OutputBuffer out;
+  out.Append("first ");
+  EXPECT_TRUE(out.Flush(&sink));
+  EXPECT_EQ(0U, out.size());
+  out.Append("second");
+  EXPECT_TRUE(out.Flush(&sink));
+  EXPECT_EQ("first second", written);
+}
+
+}  // namespace
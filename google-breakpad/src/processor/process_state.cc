@@ -59,6 +59,7 @@ void ProcessState::Clear() {
   system_info_.Clear();
   delete modules_;
   modules_ = NULL;
+  truncated_ = false;
 }
 
 }  // namespace google_breakpad
@@ -0,0 +1,426 @@
+// Copyright (c) 2010, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// process_state_record.cc: A compact binary serialization of ProcessState.
+//
+// See process_state_record.h for documentation.
+
+#include "processor/process_state_record.h"
+
+#include <map>
+#include <utility>
+
+#include "google_breakpad/processor/call_stack.h"
+#include "google_breakpad/processor/code_module.h"
+#include "google_breakpad/processor/code_modules.h"
+#include "google_breakpad/processor/process_state.h"
+#include "google_breakpad/processor/stack_frame_cpu.h"
+#include "processor/logging.h"
+
+namespace google_breakpad {
+
+namespace {
+
+using std::map;
+using std::pair;
+
+typedef vector<pair<const char *, u_int64_t> > RegisterList;
+
+// Appends little-endian integers and strings to a string.
+class RecordBuilder {
+ public:
+  explicit RecordBuilder(string *output) : output_(output) {}
+
+  void U8(u_int8_t value) { output_->push_back(static_cast<char>(value)); }
+  void U16(u_int16_t value) { Unsigned(value, 2); }
+  void U32(u_int32_t value) { Unsigned(value, 4); }
+  void U64(u_int64_t value) { Unsigned(value, 8); }
+  void String(const string &value) {
+    U32(value.size());
+    output_->append(value);
+  }
+
+  // Stores value at offset, which must already be within the output.
+  void PatchU32(size_t offset, u_int32_t value) {
+    for (int i = 0; i < 4; ++i)
+      (*output_)[offset + i] = static_cast<char>((value >> (i * 8)) & 0xff);
+  }
+
+ private:
+  void Unsigned(u_int64_t value, int bytes) {
+    for (int i = 0; i < bytes; ++i)
+      output_->push_back(static_cast<char>((value >> (i * 8)) & 0xff));
+  }
+
+  string *output_;
+};
+
+// Reads little-endian integers and strings from a buffer.  Each method
+// returns false, without advancing, if the buffer is too short.
+class RecordParser {
+ public:
+  RecordParser(const char *cursor, const char *end)
+      : cursor_(cursor), end_(end) {}
+
+  bool U8(u_int8_t *value) {
+    u_int64_t wide;
+    if (!Unsigned(1, &wide)) return false;
+    *value = wide;
+    return true;
+  }
+  bool U16(u_int16_t *value) {
+    u_int64_t wide;
+    if (!Unsigned(2, &wide)) return false;
+    *value = wide;
+    return true;
+  }
+  bool U32(u_int32_t *value) {
+    u_int64_t wide;
+    if (!Unsigned(4, &wide)) return false;
+    *value = wide;
+    return true;
+  }
+  bool U64(u_int64_t *value) { return Unsigned(8, value); }
+  bool String(RecordString *value) {
+    u_int32_t length;
+    if (!U32(&length)) return false;
+    if (static_cast<size_t>(end_ - cursor_) < length) {
+      cursor_ -= 4;
+      return false;
+    }
+    value->data = cursor_;
+    value->length = length;
+    cursor_ += length;
+    return true;
+  }
+
+  // Returns the number of bytes not yet read.
+  size_t remaining() const { return end_ - cursor_; }
+
+ private:
+  bool Unsigned(int bytes, u_int64_t *value) {
+    if (end_ - cursor_ < bytes)
+      return false;
+    *value = 0;
+    for (int i = 0; i < bytes; ++i) {
+      *value |= static_cast<u_int64_t>(
+          static_cast<unsigned char>(cursor_[i])) << (i * 8);
+    }
+    cursor_ += bytes;
+    return true;
+  }
+
+  const char *cursor_;
+  const char *end_;
+};
+
+// Sets *registers to the names and values of the registers in frame that
+// the stackwalker recovered.  These are the registers minidump_stackwalk
+// prints.
+void GetFrameRegisters(const string &cpu, const StackFrame *frame,
+                       RegisterList *registers) {
+  registers->clear();
+  if (cpu == "x86") {
+    const StackFrameX86 *frame_x86 =
+      reinterpret_cast<const StackFrameX86*>(frame);
+    int validity = frame_x86->context_validity;
+    const MDRawContextX86 &context = frame_x86->context;
+    if (validity & StackFrameX86::CONTEXT_VALID_EIP)
+      registers->push_back(std::make_pair("eip", context.eip));
+    if (validity & StackFrameX86::CONTEXT_VALID_ESP)
+      registers->push_back(std::make_pair("esp", context.esp));
+    if (validity & StackFrameX86::CONTEXT_VALID_EBP)
+      registers->push_back(std::make_pair("ebp", context.ebp));
+    if (validity & StackFrameX86::CONTEXT_VALID_EBX)
+      registers->push_back(std::make_pair("ebx", context.ebx));
+    if (validity & StackFrameX86::CONTEXT_VALID_ESI)
+      registers->push_back(std::make_pair("esi", context.esi));
+    if (validity & StackFrameX86::CONTEXT_VALID_EDI)
+      registers->push_back(std::make_pair("edi", context.edi));
+    if (validity == StackFrameX86::CONTEXT_VALID_ALL) {
+      registers->push_back(std::make_pair("eax", context.eax));
+      registers->push_back(std::make_pair("ecx", context.ecx));
+      registers->push_back(std::make_pair("edx", context.edx));
+      registers->push_back(std::make_pair("efl", context.eflags));
+    }
+  } else if (cpu == "ppc") {
+    const StackFramePPC *frame_ppc =
+      reinterpret_cast<const StackFramePPC*>(frame);
+    int validity = frame_ppc->context_validity;
+    if (validity & StackFramePPC::CONTEXT_VALID_SRR0)
+      registers->push_back(std::make_pair("srr0", frame_ppc->context.srr0));
+    if (validity & StackFramePPC::CONTEXT_VALID_GPR1)
+      registers->push_back(std::make_pair("r1", frame_ppc->context.gpr[1]));
+  } else if (cpu == "amd64") {
+    const StackFrameAMD64 *frame_amd64 =
+      reinterpret_cast<const StackFrameAMD64*>(frame);
+    int validity = frame_amd64->context_validity;
+    const MDRawContextAMD64 &context = frame_amd64->context;
+    if (validity & StackFrameAMD64::CONTEXT_VALID_RBX)
+      registers->push_back(std::make_pair("rbx", context.rbx));
+    if (validity & StackFrameAMD64::CONTEXT_VALID_R12)
+      registers->push_back(std::make_pair("r12", context.r12));
+    if (validity & StackFrameAMD64::CONTEXT_VALID_R13)
+      registers->push_back(std::make_pair("r13", context.r13));
+    if (validity & StackFrameAMD64::CONTEXT_VALID_R14)
+      registers->push_back(std::make_pair("r14", context.r14));
+    if (validity & StackFrameAMD64::CONTEXT_VALID_R15)
+      registers->push_back(std::make_pair("r15", context.r15));
+    if (validity & StackFrameAMD64::CONTEXT_VALID_RIP)
+      registers->push_back(std::make_pair("rip", context.rip));
+    if (validity & StackFrameAMD64::CONTEXT_VALID_RSP)
+      registers->push_back(std::make_pair("rsp", context.rsp));
+    if (validity & StackFrameAMD64::CONTEXT_VALID_RBP)
+      registers->push_back(std::make_pair("rbp", context.rbp));
+  } else if (cpu == "sparc") {
+    const StackFrameSPARC *frame_sparc =
+      reinterpret_cast<const StackFrameSPARC*>(frame);
+    int validity = frame_sparc->context_validity;
+    const MDRawContextSPARC &context = frame_sparc->context;
+    if (validity & StackFrameSPARC::CONTEXT_VALID_SP)
+      registers->push_back(std::make_pair("sp", context.g_r[14]));
+    if (validity & StackFrameSPARC::CONTEXT_VALID_FP)
+      registers->push_back(std::make_pair("fp", context.g_r[30]));
+    if (validity & StackFrameSPARC::CONTEXT_VALID_PC)
+      registers->push_back(std::make_pair("pc", context.pc));
+  } else if (cpu == "arm") {
+    static const char *const kNames[] = {
+      "r0", "r1", "r2", "r3", "r4", "r5", "r6", "r7",
+      "r8", "r9", "r10", "fp", "r12", "sp", "lr", "pc"
+    };
+    const StackFrameARM *frame_arm =
+      reinterpret_cast<const StackFrameARM*>(frame);
+    // As minidump_stackwalk does, omit the argument registers and r12.
+    for (int i = 4; i < 16; ++i) {
+      if (i != 12 && (frame_arm->context_validity & (1 << i))) {
+        registers->push_back(std::make_pair(kNames[i],
+                                            frame_arm->context.iregs[i]));
+      }
+    }
+  }
+}
+
+}  // namespace
+
+const u_int32_t ProcessStateRecord::kNoModule;
+
+// static
+void ProcessStateRecordWriter::Append(const ProcessState &state,
+                                      string *output) {
+  RecordBuilder builder(output);
+  size_t size_offset = output->size();
+  builder.U32(0);
+  size_t payload_offset = output->size();
+
+  builder.U16(kProcessStateRecordVersion);
+  builder.U32(state.time_date_stamp());
+  builder.U8(state.crashed());
+  builder.String(state.crash_reason());
+  builder.U64(state.crash_address());
+  builder.String(state.assertion());
+  builder.U32(state.requesting_thread());
+  builder.U8(state.exploitability());
+
+  const SystemInfo *system_info = state.system_info();
+  builder.String(system_info->os);
+  builder.String(system_info->os_short);
+  builder.String(system_info->os_version);
+  builder.String(system_info->cpu);
+  builder.String(system_info->cpu_info);
+  builder.U32(system_info->cpu_count);
+
+  // Frames refer to modules by their position in the module list.
+  map<const CodeModule *, u_int32_t> module_indices;
+  const CodeModules *modules = state.modules();
+  unsigned int module_count = modules ? modules->module_count() : 0;
+  builder.U32(module_count);
+  for (unsigned int i = 0; i < module_count; ++i) {
+    const CodeModule *module = modules->GetModuleAtSequence(i);
+    module_indices[module] = i;
+    builder.U64(module->base_address());
+    builder.U64(module->size());
+    builder.String(module->code_file());
+    builder.String(module->code_identifier());
+    builder.String(module->debug_file());
+    builder.String(module->debug_identifier());
+    builder.String(module->version());
+  }
+
+  RegisterList registers;
+  const vector<CallStack *> *threads = state.threads();
+  builder.U32(threads->size());
+  for (size_t thread = 0; thread < threads->size(); ++thread) {
+    const vector<StackFrame *> *frames = threads->at(thread)->frames();
+    builder.U32(frames->size());
+    for (size_t i = 0; i < frames->size(); ++i) {
+      const StackFrame *frame = frames->at(i);
+      builder.U64(frame->instruction);
+      u_int32_t module_index = ProcessStateRecord::kNoModule;
+      if (frame->module) {
+        map<const CodeModule *, u_int32_t>::const_iterator found =
+            module_indices.find(frame->module);
+        if (found != module_indices.end())
+          module_index = found->second;
+      }
+      builder.U32(module_index);
+      builder.String(frame->function_name);
+      builder.U64(frame->function_base);
+      builder.String(frame->source_file_name);
+      builder.U32(frame->source_line);
+      builder.U64(frame->source_line_base);
+      builder.U8(frame->trust);
+
+      GetFrameRegisters(system_info->cpu, frame, &registers);
+      builder.U8(registers.size());
+      for (RegisterList::const_iterator reg = registers.begin();
+           reg != registers.end(); ++reg) {
+        builder.String(reg->first);
+        builder.U64(reg->second);
+      }
+    }
+  }
+
+  builder.PatchU32(size_offset, output->size() - payload_offset);
+}
+
+bool ProcessStateRecordReader::Read(ProcessStateRecord *record) {
+  RecordParser header(cursor_, end_);
+  u_int32_t payload_size;
+  if (!header.U32(&payload_size))
+    return false;
+  if (header.remaining() < payload_size) {
+    BPLOG(ERROR) << "Truncated ProcessState record";
+    return false;
+  }
+  const char *payload = cursor_ + 4;
+  RecordParser parser(payload, payload + payload_size);
+
+  u_int8_t crashed, exploitability;
+  u_int32_t requesting_thread, cpu_count;
+  if (!parser.U16(&record->version))
+    return false;
+  if (record->version > kProcessStateRecordVersion) {
+    BPLOG(ERROR) << "ProcessState record version " << record->version <<
+                    " is newer than " << kProcessStateRecordVersion;
+    return false;
+  }
+  if (!parser.U32(&record->time_date_stamp) ||
+      !parser.U8(&crashed) ||
+      !parser.String(&record->crash_reason) ||
+      !parser.U64(&record->crash_address) ||
+      !parser.String(&record->assertion) ||
+      !parser.U32(&requesting_thread) ||
+      !parser.U8(&exploitability) ||
+      !parser.String(&record->os) ||
+      !parser.String(&record->os_short) ||
+      !parser.String(&record->os_version) ||
+      !parser.String(&record->cpu) ||
+      !parser.String(&record->cpu_info) ||
+      !parser.U32(&cpu_count)) {
+    BPLOG(ERROR) << "Malformed ProcessState record header";
+    return false;
+  }
+  record->crashed = crashed != 0;
+  record->requesting_thread = static_cast<int>(requesting_thread);
+  record->exploitability = exploitability;
+  record->cpu_count = cpu_count;
+
+  // Counts are checked against the space left before anything is
+  // allocated for them, so a corrupt count cannot exhaust memory.
+  u_int32_t module_count;
+  if (!parser.U32(&module_count) || module_count > parser.remaining()) {
+    BPLOG(ERROR) << "Malformed ProcessState record module count";
+    return false;
+  }
+  record->modules.resize(module_count);
+  for (u_int32_t i = 0; i < module_count; ++i) {
+    ProcessStateRecord::Module &module = record->modules[i];
+    if (!parser.U64(&module.base_address) ||
+        !parser.U64(&module.size) ||
+        !parser.String(&module.code_file) ||
+        !parser.String(&module.code_identifier) ||
+        !parser.String(&module.debug_file) ||
+        !parser.String(&module.debug_identifier) ||
+        !parser.String(&module.version)) {
+      BPLOG(ERROR) << "Malformed ProcessState record module " << i;
+      return false;
+    }
+  }
+
+  u_int32_t thread_count;
+  if (!parser.U32(&thread_count) || thread_count > parser.remaining()) {
+    BPLOG(ERROR) << "Malformed ProcessState record thread count";
+    return false;
+  }
+  record->threads.resize(thread_count);
+  for (u_int32_t thread = 0; thread < thread_count; ++thread) {
+    vector<ProcessStateRecord::Frame> &frames = record->threads[thread].frames;
+    u_int32_t frame_count;
+    if (!parser.U32(&frame_count) || frame_count > parser.remaining()) {
+      BPLOG(ERROR) << "Malformed ProcessState record thread " << thread;
+      return false;
+    }
+    frames.resize(frame_count);
+    for (u_int32_t i = 0; i < frame_count; ++i) {
+      ProcessStateRecord::Frame &frame = frames[i];
+      u_int32_t source_line;
+      u_int8_t trust, register_count;
+      if (!parser.U64(&frame.instruction) ||
+          !parser.U32(&frame.module) ||
+          !parser.String(&frame.function_name) ||
+          !parser.U64(&frame.function_base) ||
+          !parser.String(&frame.source_file_name) ||
+          !parser.U32(&source_line) ||
+          !parser.U64(&frame.source_line_base) ||
+          !parser.U8(&trust) ||
+          !parser.U8(&register_count) ||
+          (frame.module != ProcessStateRecord::kNoModule &&
+           frame.module >= module_count)) {
+        BPLOG(ERROR) << "Malformed ProcessState record frame " << i <<
+                        " of thread " << thread;
+        return false;
+      }
+      frame.source_line = static_cast<int>(source_line);
+      frame.trust = trust;
+      frame.registers.resize(register_count);
+      for (u_int8_t j = 0; j < register_count; ++j) {
+        if (!parser.String(&frame.registers[j].name) ||
+            !parser.U64(&frame.registers[j].value)) {
+          BPLOG(ERROR) << "Malformed ProcessState record register";
+          return false;
+        }
+      }
+    }
+  }
+
+  cursor_ = payload + payload_size;
+  return true;
+}
+
+}  // namespace google_breakpad
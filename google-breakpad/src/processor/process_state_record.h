@@ -0,0 +1,189 @@
+// -*- mode: c++ -*-
+
+// Copyright (c) 2010, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// process_state_record.h: A compact binary serialization of ProcessState.
+//
+// ProcessStateRecordWriter appends a ProcessState to a buffer as a
+// record, and ProcessStateRecordReader parses a buffer of concatenated
+// records back into ProcessStateRecord structures.  The reader does not
+// copy strings: each RecordString points into the buffer, which must
+// outlive the records read from it.
+//
+// A record is a 32-bit payload size followed by the payload.  All
+// integers are little-endian, and a string is a 32-bit length followed by
+// that many bytes.  The payload is:
+//
+//   version            16 bits, kProcessStateRecordVersion
+//   time_date_stamp    32 bits
+//   crashed            8 bits
+//   crash_reason       string
+//   crash_address      64 bits
+//   assertion          string
+//   requesting_thread  32 bits, -1 if none
+//   exploitability     8 bits, an ExploitabilityRating
+//   os, os_short, os_version, cpu, cpu_info  strings
+//   cpu_count          32 bits
+//   module count       32 bits, followed by for each module:
+//     base_address, size                     64 bits each
+//     code_file, code_identifier, debug_file, debug_identifier, version
+//                                            strings
+//   thread count       32 bits, followed by for each thread:
+//     frame count      32 bits, followed by for each frame, innermost first:
+//       instruction      64 bits
+//       module           32 bits, an index into the modules, or
+//                        kNoModule
+//       function_name    string
+//       function_base    64 bits
+//       source_file_name string
+//       source_line      32 bits
+//       source_line_base 64 bits
+//       trust            8 bits, a StackFrame::FrameTrust
+//       register count   8 bits, followed by for each register whose
+//                        value the stackwalker recovered:
+//         name           string
+//         value          64 bits
+//
+// A record's version changes whenever its payload layout changes.
+
+#ifndef PROCESSOR_PROCESS_STATE_RECORD_H__
+#define PROCESSOR_PROCESS_STATE_RECORD_H__
+
+#include <string>
+#include <vector>
+
+#include "google_breakpad/common/breakpad_types.h"
+
+namespace google_breakpad {
+
+using std::string;
+using std::vector;
+
+class ProcessState;
+
+// The payload layout version this code writes and reads.
+static const u_int16_t kProcessStateRecordVersion = 1;
+
+// A string within a buffer of records.
+struct RecordString {
+  RecordString() : data(NULL), length(0) {}
+
+  string ToString() const { return string(data, length); }
+
+  const char *data;
+  u_int32_t length;
+};
+
+// A record's contents.  The fields correspond to those of ProcessState,
+// SystemInfo, CodeModule and StackFrame.
+struct ProcessStateRecord {
+  // The module index of frames outside any module.
+  static const u_int32_t kNoModule = 0xffffffff;
+
+  struct Module {
+    u_int64_t base_address;
+    u_int64_t size;
+    RecordString code_file;
+    RecordString code_identifier;
+    RecordString debug_file;
+    RecordString debug_identifier;
+    RecordString version;
+  };
+
+  struct Register {
+    RecordString name;
+    u_int64_t value;
+  };
+
+  struct Frame {
+    u_int64_t instruction;
+    u_int32_t module;
+    RecordString function_name;
+    u_int64_t function_base;
+    RecordString source_file_name;
+    int source_line;
+    u_int64_t source_line_base;
+    int trust;
+    vector<Register> registers;
+  };
+
+  struct Thread {
+    vector<Frame> frames;
+  };
+
+  u_int16_t version;
+  u_int32_t time_date_stamp;
+  bool crashed;
+  RecordString crash_reason;
+  u_int64_t crash_address;
+  RecordString assertion;
+  int requesting_thread;
+  int exploitability;
+  RecordString os;
+  RecordString os_short;
+  RecordString os_version;
+  RecordString cpu;
+  RecordString cpu_info;
+  int cpu_count;
+  vector<Module> modules;
+  vector<Thread> threads;
+};
+
+class ProcessStateRecordWriter {
+ public:
+  // Appends a record holding state to output.
+  static void Append(const ProcessState &state, string *output);
+};
+
+class ProcessStateRecordReader {
+ public:
+  // Reads the records in the size bytes at buffer.  The buffer is not
+  // copied, and must remain valid while this reader and the records read
+  // from it are in use.
+  ProcessStateRecordReader(const char *buffer, size_t size)
+      : cursor_(buffer), end_(buffer + size) {}
+
+  // Parses the next record into *record and returns true.  Returns false
+  // if there are no more records, or if the next record is truncated,
+  // malformed, or of an unknown version; AtEnd distinguishes the cases.
+  // After a failure, the reader does not advance.
+  bool Read(ProcessStateRecord *record);
+
+  // Returns true if every record in the buffer has been read.
+  bool AtEnd() const { return cursor_ == end_; }
+
+ private:
+  const char *cursor_;
+  const char *end_;
+};
+
+}  // namespace google_breakpad
+
+#endif  // PROCESSOR_PROCESS_STATE_RECORD_H__
@@ -0,0 +1,187 @@
+// Copyright (c) 2010, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// process_state_record_unittest.cc: Unit tests for ProcessStateRecordWriter
+// and ProcessStateRecordReader.
+
+#include <stdlib.h>
+
+#include <string>
+#include <vector>
+
+#include "breakpad_googletest_includes.h"
+#include "google_breakpad/processor/basic_source_line_resolver.h"
+#include "google_breakpad/processor/call_stack.h"
+#include "google_breakpad/processor/code_module.h"
+#include "google_breakpad/processor/code_modules.h"
+#include "google_breakpad/processor/minidump_processor.h"
+#include "google_breakpad/processor/process_state.h"
+#include "google_breakpad/processor/stack_frame.h"
+#include "processor/process_state_record.h"
+
+namespace {
+
+using google_breakpad::BasicSourceLineResolver;
+using google_breakpad::CodeModule;
+using google_breakpad::CodeModules;
+using google_breakpad::MinidumpProcessor;
+using google_breakpad::ProcessState;
+using google_breakpad::ProcessStateRecord;
+using google_breakpad::ProcessStateRecordReader;
+using google_breakpad::ProcessStateRecordWriter;
+using google_breakpad::StackFrame;
+using std::string;
+using std::vector;
+
+class ProcessStateRecordTest : public ::testing::Test {
+ public:
+  void SetUp() {
+    string minidump_file =
+        string(getenv("srcdir") ? getenv("srcdir") : ".") +
+        "/src/processor/testdata/minidump2.dmp";
+    BasicSourceLineResolver resolver;
+    MinidumpProcessor processor(NULL, &resolver);
+    ASSERT_EQ(google_breakpad::PROCESS_OK,
+              processor.Process(minidump_file, &state_));
+  }
+
+  ProcessState state_;
+};
+
+TEST_F(ProcessStateRecordTest, RoundTrip) {
+  string buffer;
+  ProcessStateRecordWriter::Append(state_, &buffer);
+  ProcessStateRecordReader reader(buffer.data(), buffer.size());
+  ProcessStateRecord record;
+  ASSERT_TRUE(reader.Read(&record));
+  EXPECT_TRUE(reader.AtEnd());
+  EXPECT_FALSE(reader.Read(&record));
+
+  EXPECT_EQ(google_breakpad::kProcessStateRecordVersion, record.version);
+  EXPECT_EQ(state_.time_date_stamp(), record.time_date_stamp);
+  EXPECT_TRUE(record.crashed);
+  EXPECT_EQ("EXCEPTION_ACCESS_VIOLATION_WRITE",
+            record.crash_reason.ToString());
+  EXPECT_EQ(0x45U, record.crash_address);
+  EXPECT_EQ("", record.assertion.ToString());
+  EXPECT_EQ(0, record.requesting_thread);
+  EXPECT_EQ(state_.exploitability(), record.exploitability);
+  EXPECT_EQ("Windows NT", record.os.ToString());
+  EXPECT_EQ("windows", record.os_short.ToString());
+  EXPECT_EQ(state_.system_info()->os_version, record.os_version.ToString());
+  EXPECT_EQ("x86", record.cpu.ToString());
+  EXPECT_EQ(state_.system_info()->cpu_info, record.cpu_info.ToString());
+  EXPECT_EQ(state_.system_info()->cpu_count, record.cpu_count);
+
+  const CodeModules *modules = state_.modules();
+  ASSERT_EQ(modules->module_count(), record.modules.size());
+  for (unsigned int i = 0; i < modules->module_count(); ++i) {
+    const CodeModule *module = modules->GetModuleAtSequence(i);
+    const ProcessStateRecord::Module &read = record.modules[i];
+    EXPECT_EQ(module->base_address(), read.base_address);
+    EXPECT_EQ(module->size(), read.size);
+    EXPECT_EQ(module->code_file(), read.code_file.ToString());
+    EXPECT_EQ(module->code_identifier(), read.code_identifier.ToString());
+    EXPECT_EQ(module->debug_file(), read.debug_file.ToString());
+    EXPECT_EQ(module->debug_identifier(), read.debug_identifier.ToString());
+    EXPECT_EQ(module->version(), read.version.ToString());
+  }
+
+  ASSERT_EQ(state_.threads()->size(), record.threads.size());
+  for (size_t thread = 0; thread < record.threads.size(); ++thread) {
+    const vector<StackFrame *> *frames = state_.threads()->at(thread)->frames();
+    ASSERT_EQ(frames->size(), record.threads[thread].frames.size());
+    for (size_t i = 0; i < frames->size(); ++i) {
+      const StackFrame *frame = frames->at(i);
+      const ProcessStateRecord::Frame &read = record.threads[thread].frames[i];
+      EXPECT_EQ(frame->instruction, read.instruction);
+      ASSERT_NE(ProcessStateRecord::kNoModule, read.module);
+      EXPECT_EQ(frame->module->code_file(),
+                record.modules[read.module].code_file.ToString());
+      EXPECT_EQ(frame->function_name, read.function_name.ToString());
+      EXPECT_EQ(frame->trust, read.trust);
+    }
+  }
+
+  // The context frame of an x86 stack has every register.
+  const ProcessStateRecord::Frame &context_frame = record.threads[0].frames[0];
+  ASSERT_EQ(10U, context_frame.registers.size());
+  EXPECT_EQ("eip", context_frame.registers[0].name.ToString());
+  EXPECT_EQ(state_.threads()->at(0)->frames()->at(0)->instruction,
+            context_frame.registers[0].value);
+}
+
+TEST_F(ProcessStateRecordTest, Sequence) {
+  string buffer;
+  ProcessStateRecordWriter::Append(state_, &buffer);
+  size_t record_size = buffer.size();
+  ProcessStateRecordWriter::Append(state_, &buffer);
+  ASSERT_EQ(2 * record_size, buffer.size());
+
+  ProcessStateRecordReader reader(buffer.data(), buffer.size());
+  ProcessStateRecord first, second;
+  ASSERT_TRUE(reader.Read(&first));
+  EXPECT_FALSE(reader.AtEnd());
+  ASSERT_TRUE(reader.Read(&second));
+  EXPECT_TRUE(reader.AtEnd());
+  // Strings point into the buffer rather than being copied.
+  EXPECT_EQ(record_size, second.os.data - first.os.data);
+  EXPECT_GE(second.os.data, buffer.data() + record_size);
+  EXPECT_EQ(first.modules.size(), second.modules.size());
+}
+
+TEST_F(ProcessStateRecordTest, Malformed) {
+  string buffer;
+  ProcessStateRecordWriter::Append(state_, &buffer);
+  ProcessStateRecord record;
+
+  // Every truncation of the record must be rejected.
+  for (size_t size = 0; size < buffer.size(); ++size) {
+    ProcessStateRecordReader reader(buffer.data(), size);
+    EXPECT_FALSE(reader.Read(&record));
+    EXPECT_EQ(size == 0, reader.AtEnd());
+  }
+
+  // A payload that claims to be shorter than it is must be rejected too.
+  string short_payload = buffer;
+  short_payload[0] = 40;
+  short_payload[1] = short_payload[2] = short_payload[3] = 0;
+  ProcessStateRecordReader short_reader(short_payload.data(),
+                                        short_payload.size());
+  EXPECT_FALSE(short_reader.Read(&record));
+
+  // Records from a newer version are rejected.
+  string newer = buffer;
+  newer[4] = google_breakpad::kProcessStateRecordVersion + 1;
+  ProcessStateRecordReader newer_reader(newer.data(), newer.size());
+  EXPECT_FALSE(newer_reader.Read(&record));
+  EXPECT_FALSE(newer_reader.AtEnd());
+}
+
+}  // namespace
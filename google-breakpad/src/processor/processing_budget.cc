@@ -0,0 +1,77 @@
+// Copyright (c) 2010, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// processing_budget.cc: Limits on the resources spent processing one
+// minidump.
+//
+// See processing_budget.h for documentation.
+
+#include "processor/processing_budget.h"
+
+#include "processor/logging.h"
+#include "processor/processor_stats.h"
+
+namespace google_breakpad {
+
+ProcessingBudget::ProcessingBudget(u_int64_t time_limit_us,
+                                   u_int64_t max_scan_words,
+                                   u_int64_t max_symbol_bytes)
+    : deadline_(time_limit_us ? ProcessorStats::Now() + time_limit_us : 0),
+      max_scan_words_(max_scan_words),
+      max_symbol_bytes_(max_symbol_bytes),
+      scan_words_(0),
+      symbol_bytes_(0),
+      exhausted_(false) {
+}
+
+bool ProcessingBudget::Exhausted() {
+  if (!exhausted_ && deadline_ && ProcessorStats::Now() > deadline_)
+    Exhaust("time");
+  return exhausted_;
+}
+
+void ProcessingBudget::ChargeScanWords(u_int64_t words) {
+  scan_words_ += words;
+  if (!exhausted_ && max_scan_words_ && scan_words_ > max_scan_words_)
+    Exhaust("scanned stack word");
+}
+
+void ProcessingBudget::ChargeSymbolBytes(u_int64_t bytes) {
+  symbol_bytes_ += bytes;
+  if (!exhausted_ && max_symbol_bytes_ && symbol_bytes_ > max_symbol_bytes_)
+    Exhaust("symbol byte");
+}
+
+void ProcessingBudget::Exhaust(const char *limit) {
+  BPLOG(ERROR) << "Processing " << limit << " limit exceeded; "
+                  "the remaining stack frames will not be walked";
+  exhausted_ = true;
+}
+
+}  // namespace google_breakpad
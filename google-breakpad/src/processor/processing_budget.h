@@ -0,0 +1,91 @@
+// -*- mode: c++ -*-
+
+// Copyright (c) 2010, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// processing_budget.h: Limits on the resources spent processing one
+// minidump.
+//
+// A corrupt minidump can send a stackwalker around a loop of CFI results,
+// or through a huge stack one scanned word at a time.  A ProcessingBudget
+// bounds that work: MinidumpProcessor creates one per minidump, and the
+// Stackwalkers it creates charge their stack scanning and symbol loading
+// to it, and stop walking once it is exhausted.  The budget is
+// cooperative; it is only checked between frames and stack scans.
+
+#ifndef PROCESSOR_PROCESSING_BUDGET_H__
+#define PROCESSOR_PROCESSING_BUDGET_H__
+
+#include "google_breakpad/common/breakpad_types.h"
+
+namespace google_breakpad {
+
+class ProcessingBudget {
+ public:
+  // Creates a budget allowing time_limit_us microseconds of wall-clock
+  // time from now, max_scan_words stack words examined while scanning for
+  // return addresses, and max_symbol_bytes bytes of symbol data loaded.
+  // A limit of zero means no limit.
+  ProcessingBudget(u_int64_t time_limit_us,
+                   u_int64_t max_scan_words,
+                   u_int64_t max_symbol_bytes);
+
+  // Returns true if any limit has been exceeded, checking the clock.
+  bool Exhausted();
+
+  // Returns true if an earlier call to Exhausted or a Charge method found
+  // a limit exceeded.  Does not check the clock, so it is cheap enough to
+  // call for every word scanned.
+  bool exhausted() const { return exhausted_; }
+
+  void ChargeScanWords(u_int64_t words);
+  void ChargeSymbolBytes(u_int64_t bytes);
+
+  u_int64_t scan_words() const { return scan_words_; }
+  u_int64_t symbol_bytes() const { return symbol_bytes_; }
+
+ private:
+  // Marks the budget exhausted, logging which limit was exceeded.
+  void Exhaust(const char *limit);
+
+  // The absolute time, in microseconds, after which the budget is
+  // exhausted, or zero.
+  u_int64_t deadline_;
+
+  u_int64_t max_scan_words_;
+  u_int64_t max_symbol_bytes_;
+
+  u_int64_t scan_words_;
+  u_int64_t symbol_bytes_;
+  bool exhausted_;
+};
+
+}  // namespace google_breakpad
+
+#endif  // PROCESSOR_PROCESSING_BUDGET_H__
@@ -0,0 +1,649 @@
+// Copyright (c) 2010, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// processor_benchmark.cc: Time the processor's hot paths on synthetic
+// minidumps and symbol files.
+//
+// The inputs are generated in memory with SynthMinidump and
+// test_assembler, so every run with the same options sees the same bytes.
+// There are two modules: one whose symbol file has a FUNC record, sixteen
+// line records and a run of STACK CFI records for each function, and one
+// with no symbols at all.  The minidumps hold threads whose stacks walk
+// through the first module by CFI, or through the second by stack
+// scanning.  The results are written to stdout as a JSON object with an
+// entry per benchmark, so that builds can be compared mechanically.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <list>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "common/test_assembler.h"
+#include "google_breakpad/common/minidump_format.h"
+#include "google_breakpad/processor/basic_source_line_resolver.h"
+#include "google_breakpad/processor/call_stack.h"
+#include "google_breakpad/processor/code_module.h"
+#include "google_breakpad/processor/fast_source_line_resolver.h"
+#include "google_breakpad/processor/minidump.h"
+#include "google_breakpad/processor/minidump_processor.h"
+#include "google_breakpad/processor/process_state.h"
+#include "google_breakpad/processor/stack_frame.h"
+#include "google_breakpad/processor/symbol_supplier.h"
+#include "processor/basic_code_module.h"
+#include "processor/cfi_frame_info.h"
+#include "processor/logging.h"
+#include "processor/module_serializer.h"
+#include "processor/processor_stats.h"
+#include "processor/scoped_ptr.h"
+#include "processor/synth_minidump.h"
+
+namespace {
+
+using google_breakpad::BasicCodeModule;
+using google_breakpad::BasicSourceLineResolver;
+using google_breakpad::CallStack;
+using google_breakpad::CodeModule;
+using google_breakpad::FastSourceLineResolver;
+using google_breakpad::Minidump;
+using google_breakpad::MinidumpProcessor;
+using google_breakpad::ModuleSerializer;
+using google_breakpad::ProcessorStats;
+using google_breakpad::ProcessState;
+using google_breakpad::SourceLineResolverInterface;
+using google_breakpad::StackFrame;
+using google_breakpad::SymbolSupplier;
+using google_breakpad::SystemInfo;
+using google_breakpad::scoped_array;
+using google_breakpad::scoped_ptr;
+using std::istringstream;
+using std::list;
+using std::map;
+using std::string;
+using std::vector;
+
+namespace SynthMinidump = google_breakpad::SynthMinidump;
+
+// The module whose stacks are walked by CFI.  Each function occupies
+// kFunctionSize bytes, and makes its calls from kCallOffset.
+const char kCFIModuleName[] = "cfi_module.dll";
+const u_int32_t kCFIModuleBase = 0x10000000;
+const u_int32_t kFunctionSize = 0x100;
+const u_int32_t kCallOffset = 0x40;
+
+// The module whose stacks are walked by scanning, and the number of words
+// of non-address data between return addresses on its stacks.  The gap
+// must be smaller than the distance Stackwalker::ScanForReturnAddress
+// searches.
+const char kScanModuleName[] = "scan_module.dll";
+const u_int32_t kScanModuleBase = 0x70000000;
+const u_int32_t kScanModuleSize = 0x10000;
+const int kScanGapWords = 16;
+
+// Thread stacks are placed one after another from here.
+const u_int32_t kStackBase = 0x80000000;
+
+struct Options {
+  int threads;      // threads in each minidump
+  int depth;        // frames on each thread's stack
+  int functions;    // FUNC records in the symbol file
+  int cfi_rules;    // STACK CFI records per function after the INIT record
+  int lookups;      // CFI lookups per iteration of the lookup benchmarks
+  int iterations;   // timed runs of each benchmark
+};
+
+// The timings of one benchmark.
+struct Result {
+  Result(const string &name, u_int64_t items, u_int64_t bytes)
+      : name(name), items(items), bytes(bytes),
+        iterations(0), min_us(0), max_us(0), total_us(0) { }
+
+  string name;
+  u_int64_t items;  // units of work per iteration: frames, lookups, etc.
+  u_int64_t bytes;  // bytes of input per iteration, or zero
+  int iterations;
+  u_int64_t min_us, max_us, total_us;
+};
+
+// Records the time since start, in microseconds, as one iteration of
+// result.
+void RecordIteration(u_int64_t start, Result *result) {
+  u_int64_t elapsed = ProcessorStats::Now() - start;
+  if (result->iterations == 0 || elapsed < result->min_us)
+    result->min_us = elapsed;
+  if (elapsed > result->max_us)
+    result->max_us = elapsed;
+  result->total_us += elapsed;
+  result->iterations++;
+}
+
+// Returns the address from which the index'th function of the CFI module
+// makes its calls.
+u_int32_t CallAddress(const Options &options, int index) {
+  return kCFIModuleBase + (index % options.functions) * kFunctionSize +
+         kCallOffset;
+}
+
+// Returns the size of each thread's stack, rounded up to a page.
+u_int32_t StackSpacing(const Options &options) {
+  u_int32_t words = options.depth * (kScanGapWords + 2);
+  return (words * 4 + 0xfff) & ~0xfff;
+}
+
+// Generates the symbol file for the CFI module.  Every function has the
+// same frame layout: at its entry point the return address is at the top
+// of the stack, and after options.cfi_rules further STACK CFI records,
+// each describing the same state, the caller's %ebp is saved below it.
+void GenerateSymbols(const Options &options, string *symbols) {
+  std::ostringstream stream;
+  stream << "MODULE windows x86 0123456789ABCDEF0123456789ABCDEF0 "
+         << kCFIModuleName << "\n"
+         << "FILE 0 benchmark.cc\n"
+         << std::hex;
+  for (int i = 0; i < options.functions; i++) {
+    u_int32_t address = i * kFunctionSize;
+    stream << "FUNC " << address << " " << kFunctionSize << " 0 Function"
+           << std::dec << i << std::hex << "\n";
+    for (u_int32_t line = 0; line < 16; line++) {
+      stream << address + line * 0x10 << " 10 " << std::dec
+             << i * 16 + line + 1 << std::hex << " 0\n";
+    }
+  }
+  for (int i = 0; i < options.functions; i++) {
+    u_int32_t address = i * kFunctionSize;
+    stream << "STACK CFI INIT " << address << " " << kFunctionSize
+           << " .cfa: $esp 4 + .ra: .cfa 4 - ^\n";
+    for (int rule = 1; rule <= options.cfi_rules; rule++) {
+      stream << "STACK CFI " << address + rule
+             << " .cfa: $esp 8 + .ra: .cfa 4 - ^ $ebp: .cfa 8 - ^\n";
+    }
+  }
+  *symbols = stream.str();
+}
+
+// Generates a minidump of options.threads threads, each options.depth
+// frames deep.  If scanned is true, the stacks run through the module
+// without symbols, with kScanGapWords words between return addresses;
+// otherwise they run through the CFI module.
+void GenerateMinidump(const Options &options, bool scanned, string *contents) {
+  SynthMinidump::Dump dump(0);
+
+  SynthMinidump::String csd_version(
+      dump, SynthMinidump::SystemInfo::windows_x86_csd_version);
+  SynthMinidump::SystemInfo system_info(
+      dump, SynthMinidump::SystemInfo::windows_x86, csd_version);
+  dump.Add(&system_info);
+  dump.Add(&csd_version);
+
+  SynthMinidump::String cfi_name(dump, kCFIModuleName);
+  SynthMinidump::Module cfi_module(dump, kCFIModuleBase,
+                                   options.functions * kFunctionSize,
+                                   cfi_name);
+  SynthMinidump::String scan_name(dump, kScanModuleName);
+  SynthMinidump::Module scan_module(dump, kScanModuleBase, kScanModuleSize,
+                                    scan_name);
+  dump.Add(&cfi_module);
+  dump.Add(&scan_module);
+  dump.Add(&cfi_name);
+  dump.Add(&scan_name);
+
+  // The threads cite their stacks and contexts by label, so all of them
+  // must live until the dump's contents have been produced.  Lists keep
+  // their elements in place as more are added.
+  list<SynthMinidump::Memory> stacks;
+  list<SynthMinidump::Context> contexts;
+  list<SynthMinidump::Thread> threads;
+  u_int32_t spacing = StackSpacing(options);
+  for (int thread_index = 0; thread_index < options.threads; thread_index++) {
+    u_int32_t stack_start = kStackBase + thread_index * spacing;
+    stacks.push_back(SynthMinidump::Memory(dump, stack_start));
+    SynthMinidump::Memory &stack = stacks.back();
+
+    MDRawContextX86 raw_context;
+    memset(&raw_context, 0, sizeof(raw_context));
+    raw_context.context_flags = MD_CONTEXT_X86_INTEGER |
+                                MD_CONTEXT_X86_CONTROL;
+    raw_context.esp = stack_start;
+    if (scanned) {
+      raw_context.eip = kScanModuleBase + kCallOffset;
+      for (int frame = 1; frame < options.depth; frame++) {
+        for (int word = 0; word < kScanGapWords; word++)
+          stack.D32(frame);
+        stack.D32(kScanModuleBase + frame % (kScanModuleSize / 2) * 2);
+      }
+    } else {
+      raw_context.eip = CallAddress(options, thread_index);
+      for (int frame = 1; frame < options.depth; frame++) {
+        if (options.cfi_rules > 0)
+          stack.D32(0);  // the caller's %ebp
+        stack.D32(CallAddress(options, thread_index + frame));
+      }
+      if (options.cfi_rules > 0)
+        stack.D32(0);
+      stack.D32(0);  // a zero return address ends the stack
+    }
+
+    contexts.push_back(SynthMinidump::Context(dump, raw_context));
+    SynthMinidump::Context &context = contexts.back();
+    threads.push_back(SynthMinidump::Thread(dump, thread_index + 1,
+                                            stack, context));
+    dump.Add(&stack);
+    dump.Add(&context);
+    dump.Add(&threads.back());
+  }
+  dump.Finish();
+  dump.GetContents(contents);
+}
+
+// Supplies the generated symbol file for the CFI module, and reports that
+// there are no symbols for any other module.
+class BenchmarkSymbolSupplier : public SymbolSupplier {
+ public:
+  explicit BenchmarkSymbolSupplier(const string &symbols)
+      : symbols_(symbols) { }
+  virtual ~BenchmarkSymbolSupplier() {
+    for (map<string, char *>::iterator iterator = buffers_.begin();
+         iterator != buffers_.end(); ++iterator) {
+      delete [] iterator->second;
+    }
+  }
+
+  virtual SymbolResult GetSymbolFile(const CodeModule *module,
+                                     const SystemInfo *system_info,
+                                     string *symbol_file) {
+    if (module->code_file() != kCFIModuleName)
+      return NOT_FOUND;
+    *symbol_file = kCFIModuleName;
+    return FOUND;
+  }
+
+  virtual SymbolResult GetSymbolFile(const CodeModule *module,
+                                     const SystemInfo *system_info,
+                                     string *symbol_file,
+                                     string *symbol_data) {
+    SymbolResult result = GetSymbolFile(module, system_info, symbol_file);
+    if (result == FOUND)
+      *symbol_data = symbols_;
+    return result;
+  }
+
+  virtual SymbolResult GetCStringSymbolData(const CodeModule *module,
+                                            const SystemInfo *system_info,
+                                            string *symbol_file,
+                                            char **symbol_data,
+                                            size_t *symbol_data_size) {
+    SymbolResult result = GetSymbolFile(module, system_info, symbol_file);
+    if (result == FOUND) {
+      FreeSymbolData(module);
+      char *buffer = new char[symbols_.size() + 1];
+      memcpy(buffer, symbols_.c_str(), symbols_.size() + 1);
+      buffers_[module->code_file()] = buffer;
+      *symbol_data = buffer;
+      *symbol_data_size = symbols_.size();
+    }
+    return result;
+  }
+
+  virtual void FreeSymbolData(const CodeModule *module) {
+    map<string, char *>::iterator iterator =
+        buffers_.find(module->code_file());
+    if (iterator != buffers_.end()) {
+      delete [] iterator->second;
+      buffers_.erase(iterator);
+    }
+  }
+
+ private:
+  const string &symbols_;
+  map<string, char *> buffers_;
+};
+
+// Returns the total number of frames in state's threads.
+u_int64_t CountFrames(const ProcessState &state) {
+  u_int64_t frames = 0;
+  for (size_t i = 0; i < state.threads()->size(); i++)
+    frames += state.threads()->at(i)->frames()->size();
+  return frames;
+}
+
+// Times reading contents with Minidump, including the thread, module and
+// memory lists.
+bool BenchmarkMinidumpRead(const Options &options, const string &contents,
+                           vector<Result> *results) {
+  Result result("minidump_read", options.threads, contents.size());
+  for (int i = 0; i < options.iterations; i++) {
+    istringstream stream(contents);
+    u_int64_t start = ProcessorStats::Now();
+    Minidump minidump(stream);
+    if (!minidump.Read() || !minidump.GetThreadList() ||
+        !minidump.GetModuleList() || !minidump.GetMemoryList()) {
+      fprintf(stderr, "minidump_read: could not read minidump\n");
+      return false;
+    }
+    RecordIteration(start, &result);
+  }
+  results->push_back(result);
+  return true;
+}
+
+// Times loading symbols into a BasicSourceLineResolver, parsing
+// everything up front if lazy is false, or only indexing the records if
+// lazy is true.
+bool BenchmarkBasicLoad(const Options &options, const string &symbols,
+                        const CodeModule &module, bool lazy,
+                        vector<Result> *results) {
+  Result result(lazy ? "symbol_load_basic_lazy" : "symbol_load_basic",
+                options.functions, symbols.size());
+  for (int i = 0; i < options.iterations; i++) {
+    // Time only the load, not tearing down the loaded module.
+    scoped_ptr<BasicSourceLineResolver> resolver(
+        new BasicSourceLineResolver());
+    resolver->set_lazy_loading(lazy);
+    u_int64_t start = ProcessorStats::Now();
+    if (!resolver->LoadModuleUsingMapBuffer(&module, symbols)) {
+      fprintf(stderr, "%s: could not load symbols\n", result.name.c_str());
+      return false;
+    }
+    RecordIteration(start, &result);
+  }
+  results->push_back(result);
+  return true;
+}
+
+// Times serializing symbols for a FastSourceLineResolver, and then
+// loading the serialized data.  On success, sets *serialized to the
+// serialized data, which the caller owns, and *serialized_size to its
+// size.
+bool BenchmarkFastLoad(const Options &options, const string &symbols,
+                       const CodeModule &module, char **serialized,
+                       size_t *serialized_size, vector<Result> *results) {
+  Result serialize("symbol_serialize", options.functions, symbols.size());
+  scoped_array<char> data;
+  unsigned int size = 0;
+  for (int i = 0; i < options.iterations; i++) {
+    ModuleSerializer serializer;
+    u_int64_t start = ProcessorStats::Now();
+    data.reset(serializer.SerializeSymbolFileData(symbols, &size));
+    if (!data.get()) {
+      fprintf(stderr, "symbol_serialize: could not serialize symbols\n");
+      return false;
+    }
+    RecordIteration(start, &serialize);
+  }
+  results->push_back(serialize);
+
+  Result load("symbol_load_fast", options.functions, size);
+  for (int i = 0; i < options.iterations; i++) {
+    scoped_ptr<FastSourceLineResolver> resolver(new FastSourceLineResolver());
+    u_int64_t start = ProcessorStats::Now();
+    if (!resolver->LoadModuleUsingMemoryBuffer(&module, data.get(), size)) {
+      fprintf(stderr, "symbol_load_fast: could not load symbols\n");
+      return false;
+    }
+    RecordIteration(start, &load);
+  }
+  results->push_back(load);
+  *serialized = data.release();
+  *serialized_size = size;
+  return true;
+}
+
+// Times looking up the CFI rules for options.lookups addresses spread
+// over the CFI module, using resolver, which must have the module loaded.
+bool BenchmarkCFILookup(const Options &options, const string &name,
+                        const CodeModule &module,
+                        SourceLineResolverInterface *resolver,
+                        vector<Result> *results) {
+  vector<u_int64_t> addresses(options.lookups);
+  for (int i = 0; i < options.lookups; i++) {
+    // Multiplying by a large odd constant scatters the lookups over the
+    // module, so successive lookups don't share cache lines.
+    u_int32_t function = (i * 2654435761U) % options.functions;
+    addresses[i] = kCFIModuleBase + function * kFunctionSize +
+                   i % kFunctionSize;
+  }
+
+  Result result(name, options.lookups, 0);
+  StackFrame frame;
+  frame.module = &module;
+  for (int i = 0; i < options.iterations; i++) {
+    int found = 0;
+    u_int64_t start = ProcessorStats::Now();
+    for (int j = 0; j < options.lookups; j++) {
+      frame.instruction = addresses[j];
+      google_breakpad::CFIFrameInfo *cfi = resolver->FindCFIFrameInfo(&frame);
+      if (cfi) {
+        found++;
+        delete cfi;
+      }
+    }
+    RecordIteration(start, &result);
+    if (found != options.lookups) {
+      fprintf(stderr, "%s: found CFI for only %d of %d addresses\n",
+              name.c_str(), found, options.lookups);
+      return false;
+    }
+  }
+  results->push_back(result);
+  return true;
+}
+
+// Times MinidumpProcessor::Process on contents.  If resolver is NULL,
+// each iteration reads the minidump and loads the symbols afresh, as
+// processing a new minidump would; otherwise, the minidump is read before
+// the clock starts, and resolver, which should already hold the symbols,
+// is reused.
+bool BenchmarkProcess(const Options &options, const string &name,
+                      const string &contents, const string &symbols,
+                      SourceLineResolverInterface *resolver,
+                      vector<Result> *results) {
+  u_int64_t expected_frames =
+      static_cast<u_int64_t>(options.threads) * options.depth;
+  Result result(name, expected_frames, contents.size());
+  BenchmarkSymbolSupplier supplier(symbols);
+  for (int i = 0; i < options.iterations; i++) {
+    istringstream stream(contents);
+    scoped_ptr<BasicSourceLineResolver> fresh_resolver;
+    scoped_ptr<Minidump> minidump;
+    ProcessState state;
+    u_int64_t start = 0;
+    if (resolver) {
+      minidump.reset(new Minidump(stream));
+      if (!minidump->Read()) {
+        fprintf(stderr, "%s: could not read minidump\n", name.c_str());
+        return false;
+      }
+      start = ProcessorStats::Now();
+    } else {
+      start = ProcessorStats::Now();
+      fresh_resolver.reset(new BasicSourceLineResolver());
+      minidump.reset(new Minidump(stream));
+      if (!minidump->Read()) {
+        fprintf(stderr, "%s: could not read minidump\n", name.c_str());
+        return false;
+      }
+    }
+    MinidumpProcessor processor(&supplier,
+                                resolver ? resolver : fresh_resolver.get());
+    if (processor.Process(minidump.get(), &state) !=
+        google_breakpad::PROCESS_OK) {
+      fprintf(stderr, "%s: could not process minidump\n", name.c_str());
+      return false;
+    }
+    RecordIteration(start, &result);
+
+    u_int64_t frames = CountFrames(state);
+    if (frames != expected_frames) {
+      fprintf(stderr, "%s: walked %llu frames, expected %llu\n",
+              name.c_str(), static_cast<unsigned long long>(frames),
+              static_cast<unsigned long long>(expected_frames));
+      return false;
+    }
+  }
+  results->push_back(result);
+  return true;
+}
+
+void PrintResults(const Options &options, const vector<Result> &results) {
+  printf("{\n"
+         "  \"options\": {\"threads\": %d, \"depth\": %d, "
+         "\"functions\": %d, \"cfi_rules\": %d, \"lookups\": %d, "
+         "\"iterations\": %d},\n"
+         "  \"benchmarks\": [\n",
+         options.threads, options.depth, options.functions,
+         options.cfi_rules, options.lookups, options.iterations);
+  for (size_t i = 0; i < results.size(); i++) {
+    const Result &result = results[i];
+    u_int64_t mean_us = result.iterations ?
+                        result.total_us / result.iterations : 0;
+    printf("    {\"name\": \"%s\", \"iterations\": %d, \"min_us\": %llu, "
+           "\"mean_us\": %llu, \"max_us\": %llu, \"items\": %llu, "
+           "\"bytes\": %llu}%s\n",
+           result.name.c_str(), result.iterations,
+           static_cast<unsigned long long>(result.min_us),
+           static_cast<unsigned long long>(mean_us),
+           static_cast<unsigned long long>(result.max_us),
+           static_cast<unsigned long long>(result.items),
+           static_cast<unsigned long long>(result.bytes),
+           i + 1 < results.size() ? "," : "");
+  }
+  printf("  ]\n"
+         "}\n");
+}
+
+bool RunBenchmarks(const Options &options) {
+  string symbols, cfi_minidump, scan_minidump;
+  GenerateSymbols(options, &symbols);
+  GenerateMinidump(options, false, &cfi_minidump);
+  GenerateMinidump(options, true, &scan_minidump);
+
+  BasicCodeModule module(kCFIModuleBase, options.functions * kFunctionSize,
+                         kCFIModuleName, "", "", "", "");
+  vector<Result> results;
+  if (!BenchmarkMinidumpRead(options, cfi_minidump, &results) ||
+      !BenchmarkBasicLoad(options, symbols, module, false, &results) ||
+      !BenchmarkBasicLoad(options, symbols, module, true, &results))
+    return false;
+
+  char *serialized = NULL;
+  size_t serialized_size = 0;
+  if (!BenchmarkFastLoad(options, symbols, module, &serialized,
+                         &serialized_size, &results))
+    return false;
+  scoped_array<char> serialized_owner(serialized);
+
+  BasicSourceLineResolver basic_resolver;
+  FastSourceLineResolver fast_resolver;
+  if (!basic_resolver.LoadModuleUsingMapBuffer(&module, symbols) ||
+      !fast_resolver.LoadModuleUsingMemoryBuffer(&module, serialized,
+                                                 serialized_size)) {
+    fprintf(stderr, "could not load symbols\n");
+    return false;
+  }
+  if (!BenchmarkCFILookup(options, "cfi_lookup_basic", module,
+                          &basic_resolver, &results) ||
+      !BenchmarkCFILookup(options, "cfi_lookup_fast", module,
+                          &fast_resolver, &results) ||
+      !BenchmarkProcess(options, "stackwalk_cfi", cfi_minidump, symbols,
+                        &basic_resolver, &results) ||
+      !BenchmarkProcess(options, "stackwalk_scan", scan_minidump, symbols,
+                        &basic_resolver, &results) ||
+      !BenchmarkProcess(options, "process", cfi_minidump, symbols,
+                        NULL, &results))
+    return false;
+
+  PrintResults(options, results);
+  return true;
+}
+
+void usage(const char *program_name) {
+  fprintf(stderr, "usage: %s [-t threads] [-d depth] [-f functions] "
+          "[-c cfi-rules] [-l lookups] [-i iterations]\n"
+          "    -t : Threads in each minidump (default 16)\n"
+          "    -d : Frames on each thread's stack (default 256)\n"
+          "    -f : Functions in the symbol file (default 20000)\n"
+          "    -c : STACK CFI records per function, up to 62 (default 8)\n"
+          "    -l : CFI lookups per iteration (default 200000)\n"
+          "    -i : Timed iterations of each benchmark (default 5)\n",
+          program_name);
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  BPLOG_INIT(&argc, &argv);
+
+  Options options;
+  options.threads = 16;
+  options.depth = 256;
+  options.functions = 20000;
+  options.cfi_rules = 8;
+  options.lookups = 200000;
+  options.iterations = 5;
+
+  for (int argi = 1; argi < argc; argi += 2) {
+    int *value = NULL;
+    if (strcmp(argv[argi], "-t") == 0) {
+      value = &options.threads;
+    } else if (strcmp(argv[argi], "-d") == 0) {
+      value = &options.depth;
+    } else if (strcmp(argv[argi], "-f") == 0) {
+      value = &options.functions;
+    } else if (strcmp(argv[argi], "-c") == 0) {
+      value = &options.cfi_rules;
+    } else if (strcmp(argv[argi], "-l") == 0) {
+      value = &options.lookups;
+    } else if (strcmp(argv[argi], "-i") == 0) {
+      value = &options.iterations;
+    }
+    if (!value || argi + 1 >= argc) {
+      usage(argv[0]);
+      return 1;
+    }
+    *value = atoi(argv[argi + 1]);
+  }
+
+  // The CFI records must all precede kCallOffset - 1, where the callers'
+  // frames are looked up, and the stacks must fit above kStackBase.
+  if (options.threads < 1 || options.depth < 1 || options.functions < 1 ||
+      options.cfi_rules < 0 ||
+      options.cfi_rules >= static_cast<int>(kCallOffset) - 1 ||
+      options.lookups < 1 || options.iterations < 1 ||
+      static_cast<u_int64_t>(options.threads) * StackSpacing(options) >
+          0xffffffffU - kStackBase) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  return RunBenchmarks(options) ? 0 : 1;
+}
@@ -0,0 +1,127 @@
+// Copyright (c) 2010, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// processor_stats.cc: Counters and timers for the stages of minidump
+// processing.
+//
+// See processor_stats.h for documentation.
+
+#include "processor/processor_stats.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <sys/time.h>
+
+namespace google_breakpad {
+
+ProcessorStats *ProcessorStats::active_ = NULL;
+
+void ProcessorStats::Clear() {
+  for (int i = 0; i < COUNTER_COUNT; ++i)
+    counters_[i] = 0;
+  for (int i = 0; i < TIMER_COUNT; ++i)
+    timers_[i] = 0;
+}
+
+void ProcessorStats::Accumulate(const ProcessorStats &other) {
+  for (int i = 0; i < COUNTER_COUNT; ++i)
+    counters_[i] += other.counters_[i];
+  for (int i = 0; i < TIMER_COUNT; ++i)
+    timers_[i] += other.timers_[i];
+}
+
+void ProcessorStats::Report(const string &label, string *output) const {
+  char value[32];
+  for (int i = 0; i < COUNTER_COUNT; ++i) {
+    snprintf(value, sizeof(value), "%llu",
+             static_cast<unsigned long long>(counters_[i]));
+    output->append("Stats|" + label + "|");
+    output->append(CounterName(static_cast<Counter>(i)));
+    output->append("|");
+    output->append(value);
+    output->append("\n");
+  }
+  for (int i = 0; i < TIMER_COUNT; ++i) {
+    snprintf(value, sizeof(value), "%llu",
+             static_cast<unsigned long long>(timers_[i]));
+    output->append("Stats|" + label + "|");
+    output->append(TimerName(static_cast<Timer>(i)));
+    output->append("_us|");
+    output->append(value);
+    output->append("\n");
+  }
+}
+
+// static
+const char *ProcessorStats::CounterName(Counter counter) {
+  switch (counter) {
+    case MINIDUMPS_PROCESSED:        return "minidumps_processed";
+    case THREADS_WALKED:             return "threads_walked";
+    case FRAMES_TRUST_NONE:          return "frames_trust_none";
+    case FRAMES_TRUST_SCAN:          return "frames_trust_scan";
+    case FRAMES_TRUST_CFI_SCAN:      return "frames_trust_cfi_scan";
+    case FRAMES_TRUST_FP:            return "frames_trust_fp";
+    case FRAMES_TRUST_CFI:           return "frames_trust_cfi";
+    case FRAMES_TRUST_CONTEXT:       return "frames_trust_context";
+    case SYMBOL_LOOKUPS:             return "symbol_lookups";
+    case SYMBOL_CACHE_HITS:          return "symbol_cache_hits";
+    case SYMBOL_FILES_READ:          return "symbol_files_read";
+    case SYMBOL_BYTES_READ:          return "symbol_bytes_read";
+    case SYMBOL_BYTES_PARSED:        return "symbol_bytes_parsed";
+    case CFI_LOOKUPS:                return "cfi_lookups";
+    case WINDOWS_FRAME_INFO_LOOKUPS: return "windows_frame_info_lookups";
+    case SCAN_WORDS:                 return "scan_words";
+    case COUNTER_COUNT:              break;
+  }
+  assert(false);
+  return "unknown";
+}
+
+// static
+const char *ProcessorStats::TimerName(Timer timer) {
+  switch (timer) {
+    case MINIDUMP_READ:  return "minidump_read";
+    case STACKWALK:      return "stackwalk";
+    case SYMBOL_LOOKUP:  return "symbol_lookup";
+    case SYMBOL_PARSE:   return "symbol_parse";
+    case OUTPUT:         return "output";
+    case TIMER_COUNT:    break;
+  }
+  assert(false);
+  return "unknown";
+}
+
+// static
+u_int64_t ProcessorStats::Now() {
+  struct timeval now;
+  gettimeofday(&now, NULL);
+  return static_cast<u_int64_t>(now.tv_sec) * 1000000 + now.tv_usec;
+}
+
+}  // namespace google_breakpad
@@ -0,0 +1,179 @@
+// -*- mode: c++ -*-
+
+// Copyright (c) 2010, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// processor_stats.h: Counters and timers for the stages of minidump
+// processing.
+//
+// The processor's components record what they do into the active
+// ProcessorStats, if one has been set with ProcessorStats::set_active.
+// When none is active, which is the default, recording costs a test of
+// a static pointer.  Like Stackwalker::set_max_frames, the active
+// ProcessorStats applies to every processor object in the program.
+//
+// A program that processes several minidumps can make a ProcessorStats
+// active for each one, and Accumulate them into another for totals.
+
+#ifndef PROCESSOR_PROCESSOR_STATS_H__
+#define PROCESSOR_PROCESSOR_STATS_H__
+
+#include <string>
+
+#include "google_breakpad/common/breakpad_types.h"
+#include "google_breakpad/processor/stack_frame.h"
+
+namespace google_breakpad {
+
+using std::string;
+
+class ProcessorStats {
+ public:
+  enum Counter {
+    MINIDUMPS_PROCESSED,
+    THREADS_WALKED,
+
+    // Frames walked, by how they were found.  These are in the same order
+    // as StackFrame::FrameTrust; see CountFrame.
+    FRAMES_TRUST_NONE,
+    FRAMES_TRUST_SCAN,
+    FRAMES_TRUST_CFI_SCAN,
+    FRAMES_TRUST_FP,
+    FRAMES_TRUST_CFI,
+    FRAMES_TRUST_CONTEXT,
+
+    // Requests for a module's symbols made to the SymbolSupplier, and
+    // frames in modules whose symbols were already loaded or known to be
+    // missing, so that no request was needed.
+    SYMBOL_LOOKUPS,
+    SYMBOL_CACHE_HITS,
+
+    // Symbol files read by SimpleSymbolSupplier, and their total size.
+    SYMBOL_FILES_READ,
+    SYMBOL_BYTES_READ,
+
+    // Bytes of symbol file text handed to the symbol file parser.
+    SYMBOL_BYTES_PARSED,
+
+    // Stack walking information lookups made by stackwalkers.
+    CFI_LOOKUPS,
+    WINDOWS_FRAME_INFO_LOOKUPS,
+
+    // Stack words examined while scanning for return addresses.
+    SCAN_WORDS,
+
+    COUNTER_COUNT
+  };
+
+  // Timers measure wall-clock time, in microseconds.  Some stages run
+  // within others, so the timers overlap: STACKWALK includes time spent
+  // in SYMBOL_LOOKUP and SYMBOL_PARSE.
+  enum Timer {
+    MINIDUMP_READ,
+    STACKWALK,
+    SYMBOL_LOOKUP,
+    SYMBOL_PARSE,
+    OUTPUT,
+
+    TIMER_COUNT
+  };
+
+  ProcessorStats() { Clear(); }
+
+  void Clear();
+
+  // Adds other's counters and timers to this object's.
+  void Accumulate(const ProcessorStats &other);
+
+  void Add(Counter counter, u_int64_t amount) { counters_[counter] += amount; }
+  void AddTime(Timer timer, u_int64_t microseconds) {
+    timers_[timer] += microseconds;
+  }
+
+  u_int64_t counter(Counter counter) const { return counters_[counter]; }
+  u_int64_t time(Timer timer) const { return timers_[timer]; }
+
+  // Appends a machine-readable report of every counter and timer to
+  // output, one per line, in the form:
+  // Stats|{label}|{name}|{value}
+  // Timer names end in "_us", since their values are in microseconds.
+  void Report(const string &label, string *output) const;
+
+  static const char *CounterName(Counter counter);
+  static const char *TimerName(Timer timer);
+
+  // Returns the current wall-clock time, in microseconds.
+  static u_int64_t Now();
+
+  // Sets the ProcessorStats that the processor records into, or NULL to
+  // stop recording.
+  static void set_active(ProcessorStats *stats) { active_ = stats; }
+  static ProcessorStats *active() { return active_; }
+
+  // Adds amount to a counter of the active ProcessorStats, if any.
+  static void Count(Counter counter, u_int64_t amount) {
+    if (active_)
+      active_->counters_[counter] += amount;
+  }
+  static void Count(Counter counter) { Count(counter, 1); }
+
+  // Counts a frame found with the given trust.
+  static void CountFrame(StackFrame::FrameTrust trust) {
+    Count(static_cast<Counter>(FRAMES_TRUST_NONE + trust));
+  }
+
+ private:
+  u_int64_t counters_[COUNTER_COUNT];
+  u_int64_t timers_[TIMER_COUNT];
+
+  static ProcessorStats *active_;
+};
+
+// Adds the time between its construction and destruction to a timer of
+// the ProcessorStats that was active when it was constructed, if any.
+class ScopedStatsTimer {
+ public:
+  explicit ScopedStatsTimer(ProcessorStats::Timer timer)
+      : stats_(ProcessorStats::active()),
+        timer_(timer),
+        start_(stats_ ? ProcessorStats::Now() : 0) {}
+  ~ScopedStatsTimer() {
+    if (stats_)
+      stats_->AddTime(timer_, ProcessorStats::Now() - start_);
+  }
+
+ private:
+  ProcessorStats *stats_;
+  ProcessorStats::Timer timer_;
+  u_int64_t start_;
+};
+
+}  // namespace google_breakpad
+
+#endif  // PROCESSOR_PROCESSOR_STATS_H__
@@ -0,0 +1,143 @@
+// Copyright (c) 2010, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// processor_stats_unittest.cc: Unit tests for ProcessorStats.
+
+#include <stdlib.h>
+
+#include <string>
+
+#include "breakpad_googletest_includes.h"
+#include "google_breakpad/processor/basic_source_line_resolver.h"
+#include "google_breakpad/processor/call_stack.h"
+#include "google_breakpad/processor/minidump_processor.h"
+#include "google_breakpad/processor/process_state.h"
+#include "processor/processor_stats.h"
+
+namespace {
+
+using google_breakpad::BasicSourceLineResolver;
+using google_breakpad::MinidumpProcessor;
+using google_breakpad::ProcessState;
+using google_breakpad::ProcessorStats;
+using google_breakpad::ScopedStatsTimer;
+using google_breakpad::StackFrame;
+using std::string;
+
+TEST(ProcessorStats, Count) {
+  ProcessorStats stats;
+  // Nothing is recorded while no ProcessorStats is active.
+  ProcessorStats::Count(ProcessorStats::SCAN_WORDS, 5);
+  EXPECT_EQ(0U, stats.counter(ProcessorStats::SCAN_WORDS));
+
+  ProcessorStats::set_active(&stats);
+  ProcessorStats::Count(ProcessorStats::SCAN_WORDS, 5);
+  ProcessorStats::Count(ProcessorStats::SCAN_WORDS);
+  ProcessorStats::CountFrame(StackFrame::FRAME_TRUST_CFI);
+  ProcessorStats::CountFrame(StackFrame::FRAME_TRUST_CONTEXT);
+  ProcessorStats::set_active(NULL);
+
+  EXPECT_EQ(6U, stats.counter(ProcessorStats::SCAN_WORDS));
+  EXPECT_EQ(1U, stats.counter(ProcessorStats::FRAMES_TRUST_CFI));
+  EXPECT_EQ(1U, stats.counter(ProcessorStats::FRAMES_TRUST_CONTEXT));
+  EXPECT_EQ(0U, stats.counter(ProcessorStats::FRAMES_TRUST_SCAN));
+
+  stats.Clear();
+  EXPECT_EQ(0U, stats.counter(ProcessorStats::SCAN_WORDS));
+}
+
+TEST(ProcessorStats, Timer) {
+  ProcessorStats stats;
+  {
+    ScopedStatsTimer timer(ProcessorStats::OUTPUT);
+  }
+  EXPECT_EQ(0U, stats.time(ProcessorStats::OUTPUT));
+
+  ProcessorStats::set_active(&stats);
+  {
+    ScopedStatsTimer timer(ProcessorStats::OUTPUT);
+    // Read the clock after the timer has, so that the timer sees at least
+    // as much time pass as this loop does.
+    u_int64_t start = ProcessorStats::Now();
+    while (ProcessorStats::Now() - start < 1000) {
+    }
+  }
+  ProcessorStats::set_active(NULL);
+  EXPECT_LE(1000U, stats.time(ProcessorStats::OUTPUT));
+}
+
+TEST(ProcessorStats, AccumulateAndReport) {
+  ProcessorStats first, second, total;
+  first.Add(ProcessorStats::SYMBOL_LOOKUPS, 2);
+  first.AddTime(ProcessorStats::STACKWALK, 10);
+  second.Add(ProcessorStats::SYMBOL_LOOKUPS, 3);
+  second.AddTime(ProcessorStats::STACKWALK, 5);
+  total.Accumulate(first);
+  total.Accumulate(second);
+  EXPECT_EQ(5U, total.counter(ProcessorStats::SYMBOL_LOOKUPS));
+  EXPECT_EQ(15U, total.time(ProcessorStats::STACKWALK));
+
+  string report;
+  total.Report("total", &report);
+  EXPECT_NE(string::npos, report.find("Stats|total|symbol_lookups|5\n"));
+  EXPECT_NE(string::npos, report.find("Stats|total|stackwalk_us|15\n"));
+  // One line per counter and timer.
+  size_t lines = 0;
+  for (size_t i = 0; i < report.size(); ++i)
+    lines += report[i] == '\n';
+  EXPECT_EQ(static_cast<size_t>(ProcessorStats::COUNTER_COUNT +
+                                ProcessorStats::TIMER_COUNT), lines);
+}
+
+TEST(ProcessorStats, Process) {
+  BasicSourceLineResolver resolver;
+  MinidumpProcessor processor(NULL, &resolver);
+  string minidump_file = string(getenv("srcdir") ? getenv("srcdir") : ".") +
+                         "/src/processor/testdata/minidump2.dmp";
+  ProcessorStats stats;
+  ProcessorStats::set_active(&stats);
+  ProcessState state;
+  ASSERT_EQ(google_breakpad::PROCESS_OK,
+            processor.Process(minidump_file, &state));
+  ProcessorStats::set_active(NULL);
+
+  EXPECT_EQ(1U, stats.counter(ProcessorStats::MINIDUMPS_PROCESSED));
+  EXPECT_EQ(1U, stats.counter(ProcessorStats::THREADS_WALKED));
+  EXPECT_EQ(1U, stats.counter(ProcessorStats::FRAMES_TRUST_CONTEXT));
+  u_int64_t frames = 0;
+  for (int i = ProcessorStats::FRAMES_TRUST_NONE;
+       i <= ProcessorStats::FRAMES_TRUST_CONTEXT; ++i) {
+    frames += stats.counter(static_cast<ProcessorStats::Counter>(i));
+  }
+  EXPECT_EQ(state.threads()->at(0)->frames()->size(), frames);
+  // Without a symbol supplier, no symbols are looked up.
+  EXPECT_EQ(0U, stats.counter(ProcessorStats::SYMBOL_LOOKUPS));
+}
+
+}  // namespace
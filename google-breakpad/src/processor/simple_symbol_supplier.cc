@@ -43,11 +43,13 @@
 #include <algorithm>
 #include <iostream>
 #include <fstream>
+#include <iterator>
 
 #include "google_breakpad/processor/code_module.h"
 #include "google_breakpad/processor/system_info.h"
 #include "processor/logging.h"
 #include "processor/pathname_stripper.h"
+#include "processor/processor_stats.h"
 
 namespace google_breakpad {
 
@@ -86,10 +88,15 @@ SymbolSupplier::SymbolResult SimpleSymbolSupplier::GetSymbolFile(
   SymbolSupplier::SymbolResult s = GetSymbolFile(module, system_info, symbol_file);
 
   if (s == FOUND) {
-    std::ifstream in(symbol_file->c_str());
-    std::getline(in, *symbol_data, std::string::traits_type::to_char_type(
-                     std::string::traits_type::eof()));
+    // Read in binary mode, and not up to some delimiter, since this may
+    // be a symbol container.
+    std::ifstream in(symbol_file->c_str(), std::ios::in | std::ios::binary);
+    symbol_data->assign(std::istreambuf_iterator<char>(in),
+                        std::istreambuf_iterator<char>());
     in.close();
+    ProcessorStats::Count(ProcessorStats::SYMBOL_FILES_READ);
+    ProcessorStats::Count(ProcessorStats::SYMBOL_BYTES_READ,
+                          symbol_data->size());
   }
   return s;
 }
@@ -98,8 +105,10 @@ SymbolSupplier::SymbolResult SimpleSymbolSupplier::GetCStringSymbolData(
     const CodeModule *module,
     const SystemInfo *system_info,
     string *symbol_file,
-    char **symbol_data) {
+    char **symbol_data,
+    size_t *symbol_data_size) {
   assert(symbol_data);
+  assert(symbol_data_size);
 
   string symbol_data_string;
   SymbolSupplier::SymbolResult s =
@@ -114,6 +123,7 @@ SymbolSupplier::SymbolResult SimpleSymbolSupplier::GetCStringSymbolData(
     }
     memcpy(*symbol_data, symbol_data_string.c_str(), size - 1);
     (*symbol_data)[size - 1] = '\0';
+    *symbol_data_size = size - 1;
     memory_buffers_.insert(make_pair(module->code_file(), *symbol_data));
   }
   return s;
@@ -65,6 +65,11 @@
 // SimpleSymbolSupplier will iterate over all root paths searching for
 // a symbol file existing in that path.
 //
+// The .sym file may also be a block-compressed symbol container, as
+// written by dump_syms (see common/symbol_container.h).  Its contents are
+// passed along as they are; the source line resolver decompresses only
+// the blocks it needs.
+//
 // SimpleSymbolSupplier supports any debugging file which can be identified
 // by a CodeModule object's debug_file and debug_identifier accessors.  The
 // expected ultimate source of these CodeModule objects are MinidumpModule
@@ -118,7 +123,8 @@ class SimpleSymbolSupplier : public SymbolSupplier {
   virtual SymbolResult GetCStringSymbolData(const CodeModule *module,
                                             const SystemInfo *system_info,
                                             string *symbol_file,
-                                            char **symbol_data);
+                                            char **symbol_data,
+                                            size_t *symbol_data_size);
 
   // Free the data buffer allocated in the above GetCStringSymbolData();
   virtual void FreeSymbolData(const CodeModule *module);
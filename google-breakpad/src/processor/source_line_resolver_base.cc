@@ -40,21 +40,65 @@
 
 #include <map>
 #include <utility>
+#include <vector>
 
+#include "common/symbol_container.h"
 #include "google_breakpad/processor/source_line_resolver_base.h"
 #include "processor/source_line_resolver_base_types.h"
 #include "processor/module_factory.h"
+#include "processor/processor_stats.h"
 
 using std::map;
 using std::make_pair;
+using std::vector;
 
 namespace google_breakpad {
 
+struct SourceLineResolverBase::PendingSymbols {
+  PendingSymbols() : text(NULL) { }
+
+  // Append to PIECES the indices of the blocks or units covering ADDRESS.
+  void Covering(MemAddr address, vector<size_t> *pieces) const {
+    if (text)
+      index.Find(address, pieces);
+    else
+      container.BlocksCovering(address, pieces);
+  }
+
+  // Set *PIECE to the '\0'-terminated text of the INDEX'th block or unit.
+  bool Read(size_t index, string *piece) const {
+    if (text) {
+      piece->assign(text + units[index].offset, units[index].size);
+    } else if (!container.ReadBlock(index, piece)) {
+      return false;
+    }
+    piece->push_back('\0');
+    return true;
+  }
+
+  // For a module loaded from a symbol container, the container.
+  SymbolContainer container;
+
+  // For a module loaded lazily from a text symbol file, the file's
+  // contents, which whoever supplied them keeps alive (see
+  // ShouldDeleteMemoryBufferAfterLoadModule), the units found in them,
+  // and an index of the units' address ranges.
+  const char *text;
+  vector<SymbolFileUnit> units;
+  AddressRangeIndex index;
+
+  // loaded[i] is true if the i'th block or unit has been added to the
+  // module.
+  vector<bool> loaded;
+};
+
 SourceLineResolverBase::SourceLineResolverBase(
     ModuleFactory *module_factory)
   : modules_(new ModuleMap),
     memory_buffers_(new MemoryMap),
-    module_factory_(module_factory) {
+    pending_symbols_(new PendingSymbolsMap),
+    module_factory_(module_factory),
+    lazy_loading_(false) {
 }
 
 SourceLineResolverBase::~SourceLineResolverBase() {
@@ -74,10 +118,17 @@ SourceLineResolverBase::~SourceLineResolverBase() {
   // Delete the map of memory buffers.
   delete memory_buffers_;
 
+  PendingSymbolsMap::iterator pending_it = pending_symbols_->begin();
+  for (; pending_it != pending_symbols_->end(); ++pending_it) {
+    delete pending_it->second;
+  }
+  delete pending_symbols_;
+
   delete module_factory_;
 }
 
 bool SourceLineResolverBase::ReadSymbolFile(char **symbol_data,
+                                            size_t *symbol_data_size,
                                             const string &map_file) {
   if (symbol_data == NULL) {
     BPLOG(ERROR) << "Could not Read file into Null memory pointer";
@@ -107,7 +158,8 @@ bool SourceLineResolverBase::ReadSymbolFile(char **symbol_data,
 
   BPLOG(INFO) << "Opening " << map_file;
 
-  FILE *f = fopen(map_file.c_str(), "rt");
+  // Read in binary mode, since this may be a symbol container.
+  FILE *f = fopen(map_file.c_str(), "rb");
   if (!f) {
     string error_string;
     int error_code = ErrnoString(&error_string);
@@ -135,6 +187,7 @@ bool SourceLineResolverBase::ReadSymbolFile(char **symbol_data,
   }
 
   (*symbol_data)[file_size] = '\0';
+  *symbol_data_size = file_size;
   return true;
 }
 
@@ -154,12 +207,14 @@ bool SourceLineResolverBase::LoadModule(const CodeModule *module,
               << " from " << map_file;
 
   char *memory_buffer;
-  if (!ReadSymbolFile(&memory_buffer, map_file))
+  size_t memory_buffer_size;
+  if (!ReadSymbolFile(&memory_buffer, &memory_buffer_size, map_file))
     return false;
 
   BPLOG(INFO) << "Read symbol file " << map_file << " succeeded";
 
-  bool load_result = LoadModuleUsingMemoryBuffer(module, memory_buffer);
+  bool load_result = LoadModuleUsingMemoryBuffer(module, memory_buffer,
+                                                 memory_buffer_size);
 
   if (load_result && !ShouldDeleteMemoryBufferAfterLoadModule()) {
     // memory_buffer has to stay alive as long as the module.
@@ -193,7 +248,8 @@ bool SourceLineResolverBase::LoadModuleUsingMapBuffer(
   memcpy(memory_buffer, map_buffer.c_str(), map_buffer.size());
   memory_buffer[map_buffer.size()] = '\0';
 
-  bool load_result = LoadModuleUsingMemoryBuffer(module, memory_buffer);
+  bool load_result = LoadModuleUsingMemoryBuffer(module, memory_buffer,
+                                                 map_buffer.size());
 
   if (load_result && !ShouldDeleteMemoryBufferAfterLoadModule()) {
     // memory_buffer has to stay alive as long as the module.
@@ -206,7 +262,7 @@ bool SourceLineResolverBase::LoadModuleUsingMapBuffer(
 }
 
 bool SourceLineResolverBase::LoadModuleUsingMemoryBuffer(
-    const CodeModule *module, char *memory_buffer) {
+    const CodeModule *module, char *memory_buffer, size_t memory_buffer_size) {
   if (!module)
     return false;
 
@@ -220,22 +276,134 @@ bool SourceLineResolverBase::LoadModuleUsingMemoryBuffer(
   BPLOG(INFO) << "Loading symbols for module " << module->code_file()
              << " from memory buffer";
 
+  ScopedStatsTimer timer(ProcessorStats::SYMBOL_PARSE);
   Module *basic_module = module_factory_->CreateModule(module->code_file());
 
-  // Ownership of memory is NOT transfered to Module::LoadMapFromMemory().
-  if (!basic_module->LoadMapFromMemory(memory_buffer)) {
-    delete basic_module;
-    return false;
+  if (SymbolContainer::IsContainer(memory_buffer, memory_buffer_size)) {
+    if (!LoadContainer(module, basic_module, memory_buffer,
+                       memory_buffer_size)) {
+      delete basic_module;
+      return false;
+    }
+  } else if (lazy_loading_) {
+    if (!LoadLazily(module, basic_module, memory_buffer)) {
+      delete basic_module;
+      return false;
+    }
+  } else {
+    if (ProcessorStats::active()) {
+      ProcessorStats::Count(ProcessorStats::SYMBOL_BYTES_PARSED,
+                            strlen(memory_buffer));
+    }
+    if (!basic_module->LoadMapFromMemory(memory_buffer)) {
+      // Ownership of memory is NOT transfered to Module::LoadMapFromMemory().
+      delete basic_module;
+      return false;
+    }
   }
 
   modules_->insert(make_pair(module->code_file(), basic_module));
   return true;
 }
 
-bool SourceLineResolverBase::ShouldDeleteMemoryBufferAfterLoadModule() {
+bool SourceLineResolverBase::LoadContainer(const CodeModule *code_module,
+                                           Module *module,
+                                           const char *memory_buffer,
+                                           size_t memory_buffer_size) {
+  PendingSymbols *pending = new PendingSymbols;
+  string whole_module;
+  if (!pending->container.Read(memory_buffer, memory_buffer_size) ||
+      !pending->Read(0, &whole_module)) {
+    BPLOG(ERROR) << "Malformed symbol container for module "
+                 << code_module->code_file();
+    delete pending;
+    return false;
+  }
+
+  ProcessorStats::Count(ProcessorStats::SYMBOL_BYTES_PARSED,
+                        whole_module.size());
+  if (!module->AddMapFromMemory(&whole_module[0])) {
+    BPLOG(ERROR) << "Could not load symbol container for module "
+                 << code_module->code_file();
+    delete pending;
+    return false;
+  }
+
+  pending->loaded.resize(pending->container.BlockCount());
+  pending->loaded[0] = true;
+  pending_symbols_->insert(make_pair(code_module->code_file(), pending));
   return true;
 }
 
+bool SourceLineResolverBase::LoadLazily(const CodeModule *code_module,
+                                        Module *module,
+                                        const char *memory_buffer) {
+  PendingSymbols *pending = new PendingSymbols;
+  pending->text = memory_buffer;
+  string whole_module;
+  ScanSymbolFile(memory_buffer, strlen(memory_buffer), &pending->units,
+                 &whole_module);
+  whole_module.push_back('\0');
+  ProcessorStats::Count(ProcessorStats::SYMBOL_BYTES_PARSED,
+                        whole_module.size() - 1);
+  if (!module->AddMapFromMemory(&whole_module[0])) {
+    BPLOG(ERROR) << "Could not load symbols lazily for module "
+                 << code_module->code_file();
+    delete pending;
+    return false;
+  }
+
+  for (size_t i = 0; i < pending->units.size(); ++i) {
+    const SymbolFileUnit &unit = pending->units[i];
+    pending->index.Add(unit.low, unit.high, i);
+  }
+  pending->index.Finish();
+  pending->loaded.resize(pending->units.size());
+  pending_symbols_->insert(make_pair(code_module->code_file(), pending));
+  return true;
+}
+
+void SourceLineResolverBase::LoadPendingSymbols(const StackFrame *frame) {
+  if (!frame->module || pending_symbols_->empty())
+    return;
+  PendingSymbolsMap::iterator pending_it =
+      pending_symbols_->find(frame->module->code_file());
+  if (pending_it == pending_symbols_->end())
+    return;
+  PendingSymbols *pending = pending_it->second;
+  Module *module = (*modules_)[frame->module->code_file()];
+
+  ScopedStatsTimer timer(ProcessorStats::SYMBOL_PARSE);
+  vector<size_t> pieces;
+  pending->Covering(frame->instruction - frame->module->base_address(),
+                    &pieces);
+  string text;
+  for (size_t i = 0; i < pieces.size(); ++i) {
+    size_t piece = pieces[i];
+    if (pending->loaded[piece])
+      continue;
+    // Whatever happens, don't try this piece again.
+    pending->loaded[piece] = true;
+    if (!pending->Read(piece, &text)) {
+      BPLOG(ERROR) << "Malformed block " << piece << " in symbol container "
+                   << "for module " << frame->module->code_file();
+      continue;
+    }
+    ProcessorStats::Count(ProcessorStats::SYMBOL_BYTES_PARSED, text.size());
+    if (!module->AddMapFromMemory(&text[0])) {
+      BPLOG(ERROR) << "Could not load " << (pending->text ? "unit " : "block ")
+                   << piece << " of symbols for module "
+                   << frame->module->code_file();
+    }
+  }
+}
+
+bool SourceLineResolverBase::ShouldDeleteMemoryBufferAfterLoadModule() {
+  // Modules loaded lazily refer to their symbol file text for as long as
+  // they exist.
+  return !lazy_loading_;
+}
+
 void SourceLineResolverBase::UnloadModule(const CodeModule *code_module) {
   if (!code_module)
     return;
@@ -247,15 +415,21 @@ void SourceLineResolverBase::UnloadModule(const CodeModule *code_module) {
     modules_->erase(iter);
   }
 
-  if (ShouldDeleteMemoryBufferAfterLoadModule()) {
-    // No-op.  Because we never store any memory buffers.
-  } else {
-    // There may be a buffer stored locally, we need to find and delete it.
-    MemoryMap::iterator iter = memory_buffers_->find(code_module->code_file());
-    if (iter != memory_buffers_->end()) {
-      delete [] iter->second;
-      memory_buffers_->erase(iter);
-    }
+  PendingSymbolsMap::iterator pending_it =
+      pending_symbols_->find(code_module->code_file());
+  if (pending_it != pending_symbols_->end()) {
+    delete pending_it->second;
+    pending_symbols_->erase(pending_it);
+  }
+
+  // Whether the buffer was kept was decided when the module was loaded;
+  // lazy loading may have been switched since, so go by memory_buffers_
+  // rather than by ShouldDeleteMemoryBufferAfterLoadModule.
+  MemoryMap::iterator buffer_it =
+      memory_buffers_->find(code_module->code_file());
+  if (buffer_it != memory_buffers_->end()) {
+    delete [] buffer_it->second;
+    memory_buffers_->erase(buffer_it);
   }
 }
 
@@ -266,6 +440,7 @@ bool SourceLineResolverBase::HasModule(const CodeModule *module) {
 }
 
 void SourceLineResolverBase::FillSourceLineInfo(StackFrame *frame) {
+  LoadPendingSymbols(frame);
   if (frame->module) {
     ModuleMap::const_iterator it = modules_->find(frame->module->code_file());
     if (it != modules_->end()) {
@@ -276,6 +451,8 @@ void SourceLineResolverBase::FillSourceLineInfo(StackFrame *frame) {
 
 WindowsFrameInfo *SourceLineResolverBase::FindWindowsFrameInfo(
     const StackFrame *frame) {
+  ProcessorStats::Count(ProcessorStats::WINDOWS_FRAME_INFO_LOOKUPS);
+  LoadPendingSymbols(frame);
   if (frame->module) {
     ModuleMap::const_iterator it = modules_->find(frame->module->code_file());
     if (it != modules_->end()) {
@@ -287,6 +464,8 @@ WindowsFrameInfo *SourceLineResolverBase::FindWindowsFrameInfo(
 
 CFIFrameInfo *SourceLineResolverBase::FindCFIFrameInfo(
     const StackFrame *frame) {
+  ProcessorStats::Count(ProcessorStats::CFI_LOOKUPS);
+  LoadPendingSymbols(frame);
   if (frame->module) {
     ModuleMap::const_iterator it = modules_->find(frame->module->code_file());
     if (it != modules_->end()) {
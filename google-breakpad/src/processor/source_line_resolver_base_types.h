@@ -122,6 +122,14 @@ class SourceLineResolverBase::Module {
   // is the owner of memory_buffer).
   virtual bool LoadMapFromMemory(char *memory_buffer) = 0;
 
+  // Adds the records in the given buffer to those already loaded, for
+  // modules whose symbols arrive a piece at a time from a symbol
+  // container (see common/symbol_container.h).  Like LoadMapFromMemory,
+  // does NOT take ownership of memory_buffer.  Returns false if the
+  // buffer can't be parsed, or if this kind of module can't be loaded
+  // in pieces.
+  virtual bool AddMapFromMemory(char *memory_buffer) { return false; }
+
   // Looks up the given relative address, and fills the StackFrame struct
   // with the result.
   virtual void LookupAddress(StackFrame *frame) const = 0;
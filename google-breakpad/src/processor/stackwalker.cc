@@ -46,6 +46,8 @@
 #include "google_breakpad/processor/symbol_supplier.h"
 #include "processor/linked_ptr.h"
 #include "processor/logging.h"
+#include "processor/processing_budget.h"
+#include "processor/processor_stats.h"
 #include "processor/scoped_ptr.h"
 #include "processor/stackwalker_ppc.h"
 #include "processor/stackwalker_sparc.h"
@@ -66,7 +68,9 @@ Stackwalker::Stackwalker(const SystemInfo *system_info,
       memory_(memory),
       modules_(modules),
       resolver_(resolver),
-      supplier_(supplier) {
+      supplier_(supplier),
+      frame_limit_(0),
+      budget_(NULL) {
 }
 
 
@@ -92,23 +96,42 @@ bool Stackwalker::Walk(CallStack *stack) {
           modules_->GetModuleForAddress(frame->instruction);
       if (module) {
         frame->module = module;
+        // Once the budget is exhausted, don't load any more symbols; the
+        // walk is about to stop anyway.
+        bool over_budget = budget_ && budget_->exhausted();
         if (resolver_ &&
             !resolver_->HasModule(frame->module) &&
             no_symbol_modules_.find(
                 module->code_file()) == no_symbol_modules_.end() &&
-            supplier_) {
+            supplier_ &&
+            !over_budget) {
           string symbol_file;
           char *symbol_data = NULL;
-          SymbolSupplier::SymbolResult symbol_result =
-              supplier_->GetCStringSymbolData(module,
-                                              system_info_,
-                                              &symbol_file,
-                                              &symbol_data);
+          size_t symbol_data_size = 0;
+          SymbolSupplier::SymbolResult symbol_result;
+          {
+            ScopedStatsTimer timer(ProcessorStats::SYMBOL_LOOKUP);
+            ProcessorStats::Count(ProcessorStats::SYMBOL_LOOKUPS);
+            symbol_result = supplier_->GetCStringSymbolData(module,
+                                                            system_info_,
+                                                            &symbol_file,
+                                                            &symbol_data,
+                                                            &symbol_data_size);
+          }
 
+          bool loaded = false;
           switch (symbol_result) {
             case SymbolSupplier::FOUND:
-              resolver_->LoadModuleUsingMemoryBuffer(frame->module,
-                                                     symbol_data);
+              // Symbol data that takes the walk over budget is not loaded:
+              // parsing it would cost more of what the budget bounds.
+              if (budget_)
+                budget_->ChargeSymbolBytes(symbol_data_size);
+              if (!budget_ || !budget_->exhausted()) {
+                resolver_->LoadModuleUsingMemoryBuffer(frame->module,
+                                                       symbol_data,
+                                                       symbol_data_size);
+                loaded = true;
+              }
               break;
             case SymbolSupplier::NOT_FOUND:
               no_symbol_modules_.insert(module->code_file());
@@ -117,8 +140,10 @@ bool Stackwalker::Walk(CallStack *stack) {
               return false;
           }
           // Inform symbol supplier to free the unused data memory buffer.
-          if (resolver_->ShouldDeleteMemoryBufferAfterLoadModule())
+          if (!loaded || resolver_->ShouldDeleteMemoryBufferAfterLoadModule())
             supplier_->FreeSymbolData(module);
+        } else if (resolver_ && supplier_ && !over_budget) {
+          ProcessorStats::Count(ProcessorStats::SYMBOL_CACHE_HITS);
         }
         if (resolver_)
           resolver_->FillSourceLineInfo(frame.get());
@@ -127,11 +152,18 @@ bool Stackwalker::Walk(CallStack *stack) {
 
     // Add the frame to the call stack.  Relinquish the ownership claim
     // over the frame, because the stack now owns it.
+    ProcessorStats::CountFrame(frame->trust);
     stack->frames_.push_back(frame.release());
+    if (frame_limit_ && stack->frames_.size() >= frame_limit_)
+      break;
     if (stack->frames_.size() > max_frames_) {
       BPLOG(ERROR) << "The stack is over " << max_frames_ << " frames.";
       break;
     }
+    // Once the budget runs out, keep the frames walked so far; they are
+    // correct, merely incomplete.
+    if (budget_ && budget_->Exhausted())
+      break;
 
     // Get the next frame and take ownership.
     frame.reset(GetCallerFrame(stack));
@@ -141,6 +173,18 @@ bool Stackwalker::Walk(CallStack *stack) {
 }
 
 
+void Stackwalker::ChargeScanWords(int words) {
+  ProcessorStats::Count(ProcessorStats::SCAN_WORDS, words);
+  if (budget_)
+    budget_->ChargeScanWords(words);
+}
+
+
+bool Stackwalker::ScanBudgetExhausted() const {
+  return budget_ && budget_->exhausted();
+}
+
+
 // static
 Stackwalker* Stackwalker::StackwalkerForCPU(
     const SystemInfo *system_info,
@@ -214,15 +258,28 @@ bool Stackwalker::InstructionAddressSeemsValid(u_int64_t address) {
   }
 
   if (!resolver_->HasModule(module)) {
+    // Past the budget, load no more symbols, and treat the module as
+    // having none.
+    if (budget_ && budget_->exhausted())
+      return true;
     string symbol_file;
     char *symbol_data = NULL;
+    size_t symbol_data_size = 0;
     SymbolSupplier::SymbolResult symbol_result =
-      supplier_->GetCStringSymbolData(module, system_info_,
-                                      &symbol_file, &symbol_data);
+      supplier_->GetCStringSymbolData(module, system_info_, &symbol_file,
+                                      &symbol_data, &symbol_data_size);
+    if (symbol_result == SymbolSupplier::FOUND && budget_) {
+      budget_->ChargeSymbolBytes(symbol_data_size);
+      if (budget_->exhausted()) {
+        supplier_->FreeSymbolData(module);
+        return true;
+      }
+    }
 
     if (symbol_result != SymbolSupplier::FOUND ||
         !resolver_->LoadModuleUsingMemoryBuffer(module,
-                                             symbol_data)) {
+                                             symbol_data,
+                                             symbol_data_size)) {
       // we don't have symbols, but we're inside a loaded module
       return true;
     }
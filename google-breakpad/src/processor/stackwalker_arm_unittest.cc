@@ -87,7 +87,7 @@ class StackwalkerARMFixture {
 
     // By default, none of the modules have symbol info; call
     // SetModuleSymbols to override this.
-    EXPECT_CALL(supplier, GetCStringSymbolData(_, _, _, _))
+    EXPECT_CALL(supplier, GetCStringSymbolData(_, _, _, _, _))
       .WillRepeatedly(Return(MockSymbolSupplier::NOT_FOUND));
   }
 
@@ -97,8 +97,9 @@ class StackwalkerARMFixture {
     unsigned int buffer_size = info.size() + 1;
     char *buffer = reinterpret_cast<char*>(operator new(buffer_size));
     strcpy(buffer, info.c_str());
-    EXPECT_CALL(supplier, GetCStringSymbolData(module, &system_info, _, _))
+    EXPECT_CALL(supplier, GetCStringSymbolData(module, &system_info, _, _, _))
       .WillRepeatedly(DoAll(SetArgumentPointee<3>(buffer),
+                            SetArgumentPointee<4>(info.size()),
                             Return(MockSymbolSupplier::FOUND)));
   }
 
@@ -170,10 +170,11 @@ class MockSymbolSupplier: public google_breakpad::SymbolSupplier {
                                            const SystemInfo *system_info,
                                            std::string *symbol_file,
                                            std::string *symbol_data));
-  MOCK_METHOD4(GetCStringSymbolData, SymbolResult(const CodeModule *module,
+  MOCK_METHOD5(GetCStringSymbolData, SymbolResult(const CodeModule *module,
                                                   const SystemInfo *system_info,
                                                   std::string *symbol_file,
-                                                  char **symbol_data));
+                                                  char **symbol_data,
+                                                  size_t *symbol_data_size));
   MOCK_METHOD1(FreeSymbolData, void(const CodeModule *module));
 };
 
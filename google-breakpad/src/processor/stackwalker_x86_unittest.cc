@@ -41,12 +41,14 @@
 #include "google_breakpad/processor/call_stack.h"
 #include "google_breakpad/processor/source_line_resolver_interface.h"
 #include "google_breakpad/processor/stack_frame_cpu.h"
+#include "processor/processing_budget.h"
 #include "processor/stackwalker_unittest_utils.h"
 #include "processor/stackwalker_x86.h"
 #include "processor/windows_frame_info.h"
 
 using google_breakpad::BasicSourceLineResolver;
 using google_breakpad::CallStack;
+using google_breakpad::ProcessingBudget;
 using google_breakpad::StackFrame;
 using google_breakpad::StackFrameX86;
 using google_breakpad::StackwalkerX86;
@@ -86,7 +88,7 @@ class StackwalkerX86Fixture {
 
     // By default, none of the modules have symbol info; call
     // SetModuleSymbols to override this.
-    EXPECT_CALL(supplier, GetCStringSymbolData(_, _, _, _))
+    EXPECT_CALL(supplier, GetCStringSymbolData(_, _, _, _, _))
       .WillRepeatedly(Return(MockSymbolSupplier::NOT_FOUND));
   }
 
@@ -96,8 +98,9 @@ class StackwalkerX86Fixture {
     unsigned int buffer_size = info.size() + 1;
     char *buffer = reinterpret_cast<char*>(operator new(buffer_size));
     strcpy(buffer, info.c_str());
-    EXPECT_CALL(supplier, GetCStringSymbolData(module, &system_info, _, _))
+    EXPECT_CALL(supplier, GetCStringSymbolData(module, &system_info, _, _, _))
       .WillRepeatedly(DoAll(SetArgumentPointee<3>(buffer),
+                            SetArgumentPointee<4>(info.size()),
                             Return(MockSymbolSupplier::FOUND)));
   }
 
@@ -168,6 +171,28 @@ TEST_F(GetContextFrame, Simple) {
   EXPECT_EQ(0, memcmp(&raw_context, &frame->context, sizeof(raw_context)));
 }
 
+// Symbol data that would exceed the processing budget is not loaded.
+TEST_F(GetContextFrame, SymbolBudget) {
+  stack_section.start() = 0x80000000;
+  stack_section.D32(0).D32(0); // end-of-stack marker
+  RegionFromSection();
+  raw_context.eip = 0x40000200;
+  raw_context.ebp = 0x80000000;
+  SetModuleSymbols(&module1, "FUNC 100 400 10 enchiridion\n");
+
+  ProcessingBudget budget(0, 0, 10);
+  StackwalkerX86 walker(&system_info, &raw_context, &stack_region, &modules,
+                        &supplier, &resolver);
+  walker.set_budget(&budget);
+  ASSERT_TRUE(walker.Walk(&call_stack));
+  EXPECT_TRUE(budget.exhausted());
+  EXPECT_FALSE(resolver.HasModule(&module1));
+  frames = call_stack.frames();
+  ASSERT_EQ(1U, frames->size());
+  EXPECT_EQ(&module1, frames->at(0)->module);
+  EXPECT_EQ("", frames->at(0)->function_name);
+}
+
 class GetCallerFrame: public StackwalkerX86Fixture, public Test { };
 
 // Walk a traditional frame. A traditional frame saves the caller's
@@ -41,8 +41,13 @@ Section::Section(const Dump &dump)
   : test_assembler::Section(dump.endianness()) { }
 
 void Section::CiteLocationIn(test_assembler::Section *section) const {
-  if (this)
-    (*section).D32(size_).D32(file_offset_);
+  (*section).D32(size_).D32(file_offset_);
+}
+
+void Section::CiteLocationOrNullIn(const Section *cited,
+                                   test_assembler::Section *section) {
+  if (cited)
+    cited->CiteLocationIn(section);
   else
     (*section).D32(0).D32(0);
 }
@@ -230,8 +235,8 @@ Module::Module(const Dump &dump,
   D32(version_info.file_subtype);
   D32(version_info.file_date_hi);
   D32(version_info.file_date_lo);
-  cv_record->CiteLocationIn(this);
-  misc_record->CiteLocationIn(this);
+  CiteLocationOrNullIn(cv_record, this);
+  CiteLocationOrNullIn(misc_record, this);
   D64(0).D64(0);
 }
 
@@ -138,15 +138,15 @@ class Section: public test_assembler::Section {
   explicit Section(const Dump &dump);
 
   // Append an MDLocationDescriptor referring to this section to SECTION.
-  // If 'this' is NULL, append a descriptor with a zero length and MDRVA.
-  //
-  // (I couldn't find the language in the C++ standard that says that
-  // invoking member functions of a NULL pointer to a class type is
-  // bad, if such language exists. Having this function handle NULL
-  // 'this' is convenient, but if it causes trouble, it's not hard to
-  // do differently.)
   void CiteLocationIn(test_assembler::Section *section) const;
 
+  // Append an MDLocationDescriptor referring to CITED to SECTION. If
+  // CITED is NULL, append a descriptor with a zero length and MDRVA.
+  // (This used to be done by calling CiteLocationIn on a NULL pointer,
+  // which optimizing compilers are entitled to miscompile.)
+  static void CiteLocationOrNullIn(const Section *cited,
+                                   test_assembler::Section *section);
+
   // Note that this section's contents are complete, and that it has
   // been placed in the minidump file at OFFSET. The 'Add' member
   // functions call the Finish member function of the object being
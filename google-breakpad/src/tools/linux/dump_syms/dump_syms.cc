@@ -0,0 +1,105 @@
+// Copyright (c) 2011, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// dump_syms.cc: Command line tool that writes a Breakpad symbol file
+// for an ELF executable or shared library.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <iostream>
+#include <string>
+
+#include "common/linux/dump_symbols.h"
+
+using google_breakpad::WriteCompressedSymbolFile;
+using google_breakpad::WriteSymbolFile;
+
+static void Usage(int argc, const char *argv[]) {
+  fprintf(stderr, "Output a Breakpad symbol file from an ELF file.\n");
+  fprintf(stderr, "Usage: %s [-c] [-C] [-z] <binary-with-debugging-info> "
+          "[directory-for-debug-file]\n", argv[0]);
+  fprintf(stderr, "\t-c: Do not generate CFI section\n");
+  fprintf(stderr, "\t-C: Write shared CFI rule sets only once; older\n");
+  fprintf(stderr, "\t    symbol file readers can't read the result\n");
+  fprintf(stderr, "\t-z: Write a block-compressed symbol container\n");
+  fprintf(stderr, "\t-h: Usage\n");
+  fprintf(stderr, "\t-?: Usage\n");
+}
+
+int main(int argc, const char *argv[]) {
+  bool cfi = true;
+  bool compact_cfi = false;
+  bool compressed = false;
+  int ch;
+
+  while ((ch = getopt(argc, (char * const *)argv, "cCzh?")) != -1) {
+    switch (ch) {
+      case 'c':
+        cfi = false;
+        break;
+      case 'C':
+        compact_cfi = true;
+        break;
+      case 'z':
+        compressed = true;
+        break;
+      case '?':
+      case 'h':
+      default:
+        Usage(argc, argv);
+        return 1;
+    }
+  }
+
+  if (argc - optind < 1 || argc - optind > 2) {
+    Usage(argc, argv);
+    return 1;
+  }
+
+  const char *binary = argv[optind];
+  std::string debug_dir;
+  if (argc - optind == 2)
+    debug_dir = argv[optind + 1];
+
+  bool result;
+  if (compressed) {
+    result = WriteCompressedSymbolFile(binary, debug_dir, cfi, compact_cfi,
+                                       std::cout);
+  } else {
+    result = WriteSymbolFile(binary, debug_dir, cfi, compact_cfi, std::cout);
+  }
+  if (!result) {
+    fprintf(stderr, "Failed to write symbol file.\n");
+    return 1;
+  }
+
+  return 0;
+}
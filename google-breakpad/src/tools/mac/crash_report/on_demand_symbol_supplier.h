@@ -66,7 +66,8 @@ class OnDemandSymbolSupplier : public SymbolSupplier {
   virtual SymbolResult GetCStringSymbolData(const CodeModule *module,
                                             const SystemInfo *system_info,
                                             string *symbol_file,
-                                            char **symbol_data);
+                                            char **symbol_data,
+                                            size_t *symbol_data_size);
 
   // Delete the data buffer allocated for module in GetCStringSymbolData().
   virtual void FreeSymbolData(const CodeModule *module);
@@ -0,0 +1,242 @@
+// -*- mode: c++ -*-
+
+// Copyright (c) 2010, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// dump_syms_mac.cc: Command line tool that uses the MachoDumpSymbols
+// class. Unlike dump_syms_tool.mm, it uses no Mac OS X frameworks, so it
+// can produce symbol files for Mac OS X binaries on any build host.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "common/mac/arch_utilities.h"
+#include "common/mac/macho_dump_symbols.h"
+
+using google_breakpad::ArchInfo;
+using google_breakpad::GetArchInfoFromCpuType;
+using google_breakpad::GetArchInfoFromName;
+using google_breakpad::GetModuleArchitectureName;
+using google_breakpad::MachoDumpSymbols;
+using std::find;
+using std::ostringstream;
+using std::string;
+using std::vector;
+
+struct Options {
+  Options()
+      : srcPath(), archs(), all_archs(false), cfi(true), header_only(false) { }
+  string srcPath;
+  vector<const ArchInfo *> archs;
+  bool all_archs;
+  bool cfi;
+  bool header_only;
+};
+
+//=============================================================================
+static void ReportMissingArchitecture(const Options &options,
+                                      const MachoDumpSymbols &dump_symbols,
+                                      const ArchInfo *missing) {
+  fprintf(stderr, "%s: no architecture '%s' is present in file.\n",
+          options.srcPath.c_str(), missing->name);
+  const vector<struct fat_arch> &available = dump_symbols.object_files();
+  if (available.size() == 1)
+    fprintf(stderr, "the file's architecture is: ");
+  else
+    fprintf(stderr, "architectures present in the file are:\n");
+  for (size_t i = 0; i < available.size(); i++) {
+    const struct fat_arch *arch = &available[i];
+    const ArchInfo *arch_info =
+      GetArchInfoFromCpuType(arch->cputype, arch->cpusubtype);
+    if (arch_info)
+      fprintf(stderr, "%s\n", arch_info->name);
+    else
+      fprintf(stderr, "unrecognized cpu type 0x%x, subtype 0x%x\n",
+              arch->cputype, arch->cpusubtype);
+  }
+}
+
+//=============================================================================
+static bool Start(const Options &options) {
+  MachoDumpSymbols dump_symbols;
+
+  if (!dump_symbols.Read(options.srcPath))
+    return false;
+
+  if (!options.header_only && !options.all_archs &&
+      options.archs.size() <= 1) {
+    if (!options.archs.empty() &&
+        !dump_symbols.SetArchitecture(options.archs[0]->cpu_type,
+                                      options.archs[0]->cpu_subtype)) {
+      ReportMissingArchitecture(options, dump_symbols, options.archs[0]);
+      return false;
+    }
+    return dump_symbols.WriteSymbolFile(std::cout, options.cfi);
+  }
+
+  // Process several architectures from the one mapped file, all at once,
+  // and then print their output one after another.
+  vector<const struct fat_arch *> object_files;
+  if (options.all_archs ||
+      (options.header_only && options.archs.empty())) {
+    for (size_t i = 0; i < dump_symbols.object_files().size(); i++)
+      object_files.push_back(&dump_symbols.object_files()[i]);
+  } else {
+    // Skip requested architectures that the file doesn't have, so that
+    // one list of architectures can be used for a set of files that
+    // don't all contain every one of them.
+    for (size_t i = 0; i < options.archs.size(); i++) {
+      const struct fat_arch *object_file =
+        dump_symbols.FindObjectFile(options.archs[i]->cpu_type,
+                                    options.archs[i]->cpu_subtype);
+      if (!object_file) {
+        ReportMissingArchitecture(options, dump_symbols, options.archs[i]);
+        continue;
+      }
+      if (find(object_files.begin(), object_files.end(), object_file) ==
+          object_files.end())
+        object_files.push_back(object_file);
+    }
+    if (object_files.empty())
+      return false;
+  }
+
+  if (options.header_only) {
+    // Print just the MODULE record for each architecture. This needs
+    // only the load commands, or for files without LC_UUID, a hash of the
+    // section contents, so it is much quicker than a full dump.
+    vector<string> identifiers;
+    bool result = dump_symbols.Identifiers(object_files, &identifiers);
+    string module_name = dump_symbols.object_filename();
+    size_t slash = module_name.rfind('/');
+    if (slash != string::npos)
+      module_name.erase(0, slash + 1);
+    for (size_t i = 0; i < object_files.size(); i++) {
+      if (identifiers[i].empty())
+        continue;
+      printf("MODULE mac %s %s %s\n",
+             GetModuleArchitectureName(object_files[i]->cputype,
+                                       object_files[i]->cpusubtype),
+             identifiers[i].c_str(), module_name.c_str());
+    }
+    return result;
+  }
+
+  vector<ostringstream *> buffers;
+  vector<std::ostream *> streams;
+  for (size_t i = 0; i < object_files.size(); i++) {
+    buffers.push_back(new ostringstream);
+    streams.push_back(buffers.back());
+  }
+  bool result = dump_symbols.WriteSymbolFiles(object_files, streams,
+                                              options.cfi);
+  // An architecture that couldn't be dumped produces no output; print
+  // the rest anyway.
+  for (size_t i = 0; i < buffers.size(); i++) {
+    std::cout << buffers[i]->str();
+    delete buffers[i];
+  }
+  return result;
+}
+
+//=============================================================================
+static void Usage(int argc, const char *argv[]) {
+  fprintf(stderr, "Output a Breakpad symbol file from a Mach-o file.\n");
+  fprintf(stderr, "Usage: %s [-a ARCHITECTURE]... [-A] [-c] [-i] "
+          "<Mach-o file>\n", argv[0]);
+  fprintf(stderr, "\t-a: Architecture type [default: whatever is in the\n");
+  fprintf(stderr, "\t    file, if it contains only one architecture]\n");
+  fprintf(stderr, "\t    May be repeated to dump several architectures,\n");
+  fprintf(stderr, "\t    printing one symbol file for each that the\n");
+  fprintf(stderr, "\t    file contains\n");
+  fprintf(stderr, "\t-A: Dump every architecture in the file\n");
+  fprintf(stderr, "\t-c: Do not generate CFI section\n");
+  fprintf(stderr, "\t-i: Output only the MODULE record for each\n");
+  fprintf(stderr, "\t    architecture [default: every architecture]\n");
+  fprintf(stderr, "\t-h: Usage\n");
+  fprintf(stderr, "\t-?: Usage\n");
+}
+
+//=============================================================================
+static void SetupOptions(int argc, const char *argv[], Options *options) {
+  extern int optind;
+  int ch;
+
+  while ((ch = getopt(argc, (char * const *)argv, "a:Acih?")) != -1) {
+    switch (ch) {
+      case 'a': {
+        const ArchInfo *arch_info = GetArchInfoFromName(optarg);
+        if (!arch_info) {
+          fprintf(stderr, "%s: Invalid architecture: %s\n", argv[0], optarg);
+          Usage(argc, argv);
+          exit(1);
+        }
+        options->archs.push_back(arch_info);
+        break;
+      }
+      case 'A':
+        options->all_archs = true;
+        break;
+      case 'c':
+        options->cfi = false;
+        break;
+      case 'i':
+        options->header_only = true;
+        break;
+      case '?':
+      case 'h':
+        Usage(argc, argv);
+        exit(0);
+        break;
+    }
+  }
+
+  if ((argc - optind) != 1) {
+    fprintf(stderr, "Must specify Mach-o file\n");
+    Usage(argc, argv);
+    exit(1);
+  }
+
+  options->srcPath = argv[optind];
+}
+
+//=============================================================================
+int main (int argc, const char * argv[]) {
+  Options options;
+
+  SetupOptions(argc, argv, &options);
+  return !Start(options);
+}
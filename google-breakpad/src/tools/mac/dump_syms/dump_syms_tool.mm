@@ -45,24 +45,20 @@ using google_breakpad::DumpSymbols;
 using std::vector;
 
 struct Options {
-  Options() : srcPath(), arch(), cfi(true) { }
+  Options() : srcPath(), archs(), cfi(true) { }
   NSString *srcPath;
-  const NXArchInfo *arch;
+  vector<const NXArchInfo *> archs;
   bool cfi;
 };
 
 //=============================================================================
-static bool Start(const Options &options) {
-  DumpSymbols dump_symbols;
-
-  if (!dump_symbols.Read(options.srcPath))
-    return false;
-
-  if (options.arch) {
-    if (!dump_symbols.SetArchitecture(options.arch->cputype,
-                                      options.arch->cpusubtype)) {
+static bool DumpArchitecture(DumpSymbols &dump_symbols,
+                             const Options &options,
+                             const NXArchInfo *arch) {
+  if (arch) {
+    if (!dump_symbols.SetArchitecture(arch->cputype, arch->cpusubtype)) {
       fprintf(stderr, "%s: no architecture '%s' is present in file.\n",
-              [options.srcPath fileSystemRepresentation], options.arch->name);
+              [options.srcPath fileSystemRepresentation], arch->name);
       size_t available_size;
       const struct fat_arch *available =
         dump_symbols.AvailableArchitectures(&available_size);
@@ -87,13 +83,35 @@ static bool Start(const Options &options) {
   return dump_symbols.WriteSymbolFile(std::cout, options.cfi);
 }
 
+//=============================================================================
+static bool Start(const Options &options) {
+  DumpSymbols dump_symbols;
+
+  if (!dump_symbols.Read(options.srcPath))
+    return false;
+
+  if (options.archs.empty())
+    return DumpArchitecture(dump_symbols, options, NULL);
+
+  // Print one symbol file for each architecture requested, reading the
+  // file only once.
+  bool result = true;
+  for (size_t i = 0; i < options.archs.size(); i++) {
+    if (!DumpArchitecture(dump_symbols, options, options.archs[i]))
+      result = false;
+  }
+  return result;
+}
+
 //=============================================================================
 static void Usage(int argc, const char *argv[]) {
   fprintf(stderr, "Output a Breakpad symbol file from a Mach-o file.\n");
-  fprintf(stderr, "Usage: %s [-a ARCHITECTURE] [-c] <Mach-o file>\n",
+  fprintf(stderr, "Usage: %s [-a ARCHITECTURE]... [-c] <Mach-o file>\n",
           argv[0]);
   fprintf(stderr, "\t-a: Architecture type [default: native, or whatever is\n");
   fprintf(stderr, "\t    in the file, if it contains only one architecture]\n");
+  fprintf(stderr, "\t    May be repeated to print a symbol file for each of\n");
+  fprintf(stderr, "\t    several architectures\n");
   fprintf(stderr, "\t-c: Do not generate CFI section\n");
   fprintf(stderr, "\t-h: Usage\n");
   fprintf(stderr, "\t-?: Usage\n");
@@ -113,7 +131,7 @@ static void SetupOptions(int argc, const char *argv[], Options *options) {
           Usage(argc, argv);
           exit(1);
         }
-        options->arch = arch_info;
+        options->archs.push_back(arch_info);
         break;
       }
       case 'c':
@@ -18,6 +18,9 @@
 #   trying to make a dSYM will fail due to permissions).
 # - Changed srcdirs to an array of tuples, containing the VCS root and the
 #   build root, to allow for the possibility that they are different.
+# - Added a --batch-archs option that passes every architecture from -a to
+#   a single dump_syms run, which prints one symbol file per architecture,
+#   instead of running dump_syms once per architecture.
 #
 # Usage: symbolstore.py <params> <dump_syms path> <symbol store path>
 #                                <debug info files or dirs>
@@ -33,6 +36,8 @@
 #                    as sym files
 #     -a "<archs>" : Run dump_syms -a <arch> for each space separated
 #                    cpu architecture in <archs> (only on OS X)
+#     -b           : With -a, run dump_syms once per file with all of the
+#                    architectures in <archs>, rather than once per arch
 #     -s <srcdir>  : Use <srcdir> as the top source directory to
 #                    generate relative filenames.
 
@@ -356,6 +361,19 @@ def GetVCSFilename(file, srcdirs):
     # we want forward slashes on win32 paths
     return (file.replace("\\", "/"), root)
 
+def SplitSymbolFiles(output):
+    """Split the output of a dump_syms run into the symbol files it
+    contains. dump_syms prints one symbol file for each architecture it
+    is asked for, one after another, each starting with a MODULE line.
+    Returns a list of (first line, remaining lines) pairs."""
+    files = []
+    for line in output:
+        if line.startswith("MODULE") or not files:
+            files.append((line, []))
+        else:
+            files[-1][1].append(line)
+    return files
+
 def GetPlatformSpecificDumper(**kwargs):
     """This function simply returns a instance of a subclass of Dumper
     that is appropriate for the current platform."""
@@ -395,13 +413,18 @@ class Dumper:
     ProcessDir.  Instead, call GetPlatformSpecificDumper to
     get an instance of a subclass."""
     def __init__(self, dump_syms, symbol_path,
-                 archs=None, srcdirs=None, copy_debug=False, vcsinfo=False, srcsrv=False, no_dsym=False):
+                 archs=None, srcdirs=None, copy_debug=False, vcsinfo=False, srcsrv=False, no_dsym=False,
+                 batch_archs=False):
         # popen likes absolute paths, at least on windows
         self.dump_syms = os.path.abspath(dump_syms)
         self.symbol_path = symbol_path
         if archs is None:
             # makes the loop logic simpler
             self.archs = ['']
+        elif batch_archs:
+            # dump_syms prints a symbol file for each -a option it's given,
+            # so one run covers every architecture.
+            self.archs = [' '.join(['-a %s' % a for a in archs.split()])]
         else:
             self.archs = ['-a %s' % a for a in archs.split()]
         if srcdirs is not None:
@@ -478,8 +501,9 @@ class Dumper:
         for arch in self.archs:
             try:
                 cmd = os.popen("\"%s\" %s \"%s\"" % (self.dump_syms, arch, file), "r")
-                module_line = cmd.next()
-                if module_line.startswith("MODULE"):
+                for (module_line, lines) in SplitSymbolFiles(cmd):
+                    if not module_line.startswith("MODULE"):
+                        continue
                     # MODULE os cpu guid debug_file
                     (guid, debug_file) = (module_line.split(None, 4))[3:5]
                     if guid == "000000000000000000000000000000000":
@@ -499,8 +523,10 @@ class Dumper:
                         pass
                     f = open(full_path, "w")
                     f.write(module_line)
-                    # now process the rest of the output
-                    for line in cmd:
+                    # whether this symbol file has anything but MODULE and FILE lines
+                    has_records = False
+                    # now process the rest of this symbol file
+                    for line in lines:
                         if line.startswith("FILE"):
                             # FILE index filename
                             (x, index, filename) = line.split(None, 2)
@@ -526,12 +552,10 @@ class Dumper:
                         else:
                             # pass through all other lines unchanged
                             f.write(line)
-                            # we want to return true only if at least one line is not a MODULE or FILE line
-                            result = True
+                            has_records = True
                     f.close()
-                    cmd.close()
                     # If the symbol file was empty, throw it away and don't report it.
-                    if result == False:
+                    if not has_records:
                         os.remove(full_path)
                         # If the two enclosing directories that we (potentially) made above
                         # are empty, remove them too. If they aren't empty, fail silently.
@@ -542,6 +566,9 @@ class Dumper:
                         except:
                             pass
                         continue
+                    # we want to return true only if at least one symbol file
+                    # has a line that is not a MODULE or FILE line
+                    result = True
                     # we output relative paths so callers can get a list of what
                     # was generated
                     print rel_path
@@ -550,8 +577,7 @@ class Dumper:
                         self.SourceServerIndexing(file, guid, sourceFileStream, vcs_root)
                     if self.copy_debug:
                         self.CopyDebug(file, debug_file, guid)
-            except StopIteration:
-                pass
+                cmd.close()
             except:
                 print >> sys.stderr, "Unexpected error: ", sys.exc_info()[0]
                 raise
@@ -749,6 +775,9 @@ def main():
     parser.add_option("-a", "--archs",
                       action="store", dest="archs",
                       help="Run dump_syms -a <arch> for each space separated cpu architecture in ARCHS (only on OS X)")
+    parser.add_option("-b", "--batch-archs",
+                      action="store_true", dest="batch_archs", default=False,
+                      help="Pass all of ARCHS to a single dump_syms run for each file, rather than running dump_syms once per architecture")
     parser.add_option("-s", "--srcdir",
                       action="append", dest="srcdir", default=[],
                       help="Use SRCDIR to determine relative paths to source files. This can be either a single path (taken to be both the build root and the VCS root), or two paths in the form buildroot,vcsroot if they aren't the same.")
@@ -789,7 +818,8 @@ def main():
                                        srcdirs=srcdirs,
                                        vcsinfo=options.vcsinfo,
                                        srcsrv=options.srcsrv,
-                                       no_dsym=options.no_dsym)
+                                       no_dsym=options.no_dsym,
+                                       batch_archs=options.batch_archs)
     for arg in args[2:]:
         dumper.Process(arg)
 